@@ -174,6 +174,21 @@ static const wxChar Skip3DModelMemoryCache[] = wxT( "Skip3DModelMemoryCache" );
 
 static const wxChar HideVersionFromTitle[] = wxT( "HideVersionFromTitle" );
 
+/**
+ * When true, DRC test providers which only read the board are run concurrently.
+ */
+static const wxChar ConcurrentDRCProviders[] = wxT( "ConcurrentDRCProviders" );
+
+/**
+ * When true, the items touched by each board commit are re-tested by the DRC.
+ */
+static const wxChar IncrementalDRC[] = wxT( "IncrementalDRC" );
+
+/**
+ * When true, zone fills are skipped for zones whose fill inputs haven't changed.
+ */
+static const wxChar IncrementalZoneFill[] = wxT( "IncrementalZoneFill" );
+
 } // namespace KEYS
 
 
@@ -280,6 +295,9 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_Skip3DModelFileCache      = false;
     m_Skip3DModelMemoryCache    = false;
     m_HideVersionFromTitle      = false;
+    m_ConcurrentDRCProviders    = false;
+    m_IncrementalDRC            = false;
+    m_IncrementalZoneFill       = false;
 
     loadFromConfigFile();
 }
@@ -392,6 +410,15 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::HideVersionFromTitle,
                                                 &m_HideVersionFromTitle, false ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ConcurrentDRCProviders,
+                                                &m_ConcurrentDRCProviders, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalDRC,
+                                                &m_IncrementalDRC, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::IncrementalZoneFill,
+                                                &m_IncrementalZoneFill, false ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     dumpCfg( configParams );
@@ -0,0 +1,193 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <functional>
+#include <string>
+
+#include <cache_index_file.h>
+#include <macros.h>
+#include <paths.h>
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+
+namespace
+{
+
+bool readFile( const wxString& aFilePath, std::vector<char>& aData )
+{
+    if( !wxFileExists( aFilePath ) )
+        return false;
+
+    wxFFile file( aFilePath, wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return false;
+
+    aData.resize( file.Length() );
+
+    return file.Read( aData.data(), aData.size() ) == aData.size();
+}
+
+
+bool writeFile( const wxString& aFilePath, const std::vector<char>& aData )
+{
+    wxFileName fn( aFilePath );
+
+    if( !fn.DirExists() && !fn.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        return false;
+
+    // Write to a temporary file first, and swap it in once it is complete
+    wxString tmpFileName = wxFileName::CreateTempFileName( aFilePath );
+    bool     ok = false;
+
+    {
+        wxFFile file( tmpFileName, wxT( "wb" ) );
+
+        ok = file.IsOpened() && file.Write( aData.data(), aData.size() ) == aData.size();
+    }
+
+    if( !ok || !wxRenameFile( tmpFileName, aFilePath, true ) )
+    {
+        wxRemoveFile( tmpFileName );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+CACHE_INDEX_FILE::CACHE_INDEX_FILE( const wxString& aKind, const char* aMagic,
+                                    uint32_t aVersion, const wxString& aLibraryPath ) :
+        m_kind( aKind ),
+        m_version( aVersion ),
+        m_libraryPath( aLibraryPath ),
+        m_pos( 0 )
+{
+    memcpy( m_magic, aMagic, sizeof( m_magic ) );
+}
+
+
+wxString CACHE_INDEX_FILE::GetFilePath() const
+{
+    size_t     hash = std::hash<std::string>()( TO_UTF8( m_libraryPath ) );
+    wxFileName fn;
+
+    fn.AssignDir( PATHS::GetUserCachePath() );
+    fn.AppendDir( m_kind );
+    fn.SetName( wxString::Format( wxT( "%016llx" ), (unsigned long long) hash ) );
+    fn.SetExt( wxT( "idx" ) );
+
+    return fn.GetFullPath();
+}
+
+
+bool CACHE_INDEX_FILE::Load()
+{
+    m_data.clear();
+    m_pos = 0;
+
+    if( !readFile( GetFilePath(), m_data ) )
+        return false;
+
+    char     magic[8];
+    uint32_t version;
+    wxString libraryPath;
+
+    // A hash collision or an older format is no worse than no index at all
+    return Read( magic ) && memcmp( magic, m_magic, sizeof( magic ) ) == 0
+            && Read( version ) && version == m_version
+            && ReadString( libraryPath ) && libraryPath == m_libraryPath;
+}
+
+
+void CACHE_INDEX_FILE::Clear()
+{
+    m_data.assign( m_magic, m_magic + sizeof( m_magic ) );
+    m_pos = 0;
+
+    Append<uint32_t>( m_version );
+    AppendString( m_libraryPath );
+}
+
+
+bool CACHE_INDEX_FILE::Save() const
+{
+    return writeFile( GetFilePath(), m_data );
+}
+
+
+bool CACHE_INDEX_FILE::ReadString( wxString& aValue )
+{
+    uint32_t len;
+
+    if( !Read( len ) || m_data.size() - m_pos < len )
+        return false;
+
+    aValue = wxString::FromUTF8( m_data.data() + m_pos, len );
+    m_pos += len;
+    return true;
+}
+
+
+void CACHE_INDEX_FILE::AppendString( const wxString& aValue )
+{
+    std::string utf8 = TO_UTF8( aValue );
+
+    Append<uint32_t>( utf8.size() );
+    m_data.insert( m_data.end(), utf8.begin(), utf8.end() );
+}
+
+
+bool CACHE_INDEX_FILE::GetFileStat( const wxString& aFilePath, long long& aModTime,
+                                    long long& aSize )
+{
+    wxStructStat fileStat;
+
+    // wxStat() follows symlinks, so this is the library file and not the link
+    if( wxStat( aFilePath, &fileStat ) != 0 )
+        return false;
+
+    // Seconds are too coarse: a file may well be saved twice within one second without
+    // changing size
+#if defined( _WIN32 )
+    // wxStat() only has seconds here, the file times read by wxFileName have milliseconds
+    wxDateTime modTime;
+
+    if( !wxFileName( aFilePath ).GetTimes( nullptr, &modTime, nullptr ) )
+        return false;
+
+    aModTime = modTime.GetValue().GetValue() * 1000000LL;
+#elif defined( __APPLE__ )
+    aModTime = fileStat.st_mtimespec.tv_sec * 1000000000LL + fileStat.st_mtimespec.tv_nsec;
+#else
+    aModTime = fileStat.st_mtim.tv_sec * 1000000000LL + fileStat.st_mtim.tv_nsec;
+#endif
+
+    aSize = fileStat.st_size;
+    return true;
+}
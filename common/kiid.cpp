@@ -35,10 +35,17 @@
 
 #include <wx/log.h>
 
+#include <atomic>
+#include <mutex>
+
 
 // Create only once, as seeding is *very* expensive
 static boost::uuids::random_generator randomGenerator;
 
+// The generator is not thread-safe, and items are created on worker threads (e.g. when loading
+// libraries); without this threads could draw the same UUID
+static std::mutex randomGeneratorMutex;
+
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
 static boost::uuids::nil_generator    nilGenerator;
@@ -47,7 +54,15 @@ static boost::uuids::nil_generator    nilGenerator;
 KIID niluuid( 0 );
 
 // When true, always create nil uuids for performance, when valid ones aren't needed
-static bool createNilUuids = false;
+static std::atomic<bool> createNilUuids( false );
+
+
+static boost::uuids::uuid newRandomUuid()
+{
+    std::lock_guard<std::mutex> lock( randomGeneratorMutex );
+
+    return randomGenerator();
+}
 
 
 // For static initialization
@@ -70,7 +85,7 @@ KIID::KIID()
         if( createNilUuids )
             m_uuid = nilGenerator();
         else
-            m_uuid = randomGenerator();
+            m_uuid = newRandomUuid();
 
 #if BOOST_VERSION >= 106700
     }
@@ -122,7 +137,7 @@ KIID::KIID( const wxString& aString ) : m_uuid(), m_cached_timestamp( 0 )
             {
 #endif
 
-                m_uuid = randomGenerator();
+                m_uuid = newRandomUuid();
 
 #if BOOST_VERSION >= 106700
             }
@@ -233,7 +248,7 @@ void KIID::ConvertTimestampToUuid()
         return;
 
     m_cached_timestamp = 0;
-    m_uuid             = randomGenerator();
+    m_uuid             = newRandomUuid();
 }
 
 
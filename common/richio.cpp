@@ -23,6 +23,7 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
@@ -32,6 +33,21 @@
 #include <wx/file.h>
 #include <wx/translation.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined( __linux__ )
+#include <sys/vfs.h>
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ ) || defined( __OpenBSD__ )
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -245,13 +261,306 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+#ifdef _WIN32
+/**
+ * @return true if the file \a aFileName is known to be on a local drive.
+ */
+static bool isLocalFile( const wxString& aFileName )
+{
+    wchar_t volume[MAX_PATH];
+
+    if( !GetVolumePathNameW( aFileName.wc_str(), volume, MAX_PATH ) )
+        return false;
+
+    return GetDriveTypeW( volume ) != DRIVE_REMOTE;
+}
+#else
+/**
+ * @return true if the open file \a aFd is known to be on a local file system.
+ */
+static bool isLocalFile( int aFd )
+{
+#if defined( __linux__ )
+    struct statfs fsStat;
+
+    if( fstatfs( aFd, &fsStat ) != 0 )
+        return false;
+
+    switch( (uint32_t) fsStat.f_type )
+    {
+    case 0x6969:        // NFS
+    case 0x517B:        // SMB
+    case 0xFF534D42:    // CIFS
+    case 0xFE534D42:    // SMB2
+    case 0x65735546:    // FUSE (sshfs and the like)
+    case 0x5346414F:    // AFS
+    case 0x01021997:    // 9P
+    case 0x73757245:    // Coda
+    case 0x00C36400:    // Ceph
+        return false;
+
+    default:
+        return true;
+    }
+#elif defined( __APPLE__ ) || defined( __FreeBSD__ ) || defined( __OpenBSD__ )
+    struct statfs fsStat;
+
+    if( fstatfs( aFd, &fsStat ) != 0 )
+        return false;
+
+    return ( fsStat.f_flags & MNT_LOCAL ) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber,
+                                    unsigned aMaxLineLength ) :
+        LINE_READER( aMaxLineLength ),
+        m_data( nullptr ),
+        m_size( 0 ),
+        m_ndx( 0 ),
+        m_nul( nullptr ),
+        m_savedChar( 0 ),
+        m_mapped( false )
+#ifdef _WIN32
+        , m_mapping( nullptr )
+#endif
+{
+    // Lines are handed out in place; the base class' buffer is never needed
+    delete[] m_line;
+    m_line = nullptr;
+    m_capacity = 0;
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+
+    wxString msg = wxString::Format( _( "Unable to open %s for reading." ), aFileName );
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+
+    if( file == INVALID_HANDLE_VALUE )
+        THROW_IO_ERROR( msg );
+
+    LARGE_INTEGER size;
+
+    if( !GetFileSizeEx( file, &size ) )
+    {
+        CloseHandle( file );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_size = (size_t) size.QuadPart;
+
+    // A zero length file cannot be mapped, and doesn't need to be
+    if( m_size && isLocalFile( aFileName ) )
+    {
+        m_mapping = CreateFileMappingW( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+
+        if( m_mapping )
+            m_data = (char*) MapViewOfFile( m_mapping, FILE_MAP_COPY, 0, 0, 0 );
+
+        if( m_data )
+        {
+            m_mapped = true;
+        }
+        else if( m_mapping )
+        {
+            CloseHandle( m_mapping );
+            m_mapping = nullptr;
+        }
+    }
+
+    if( m_size && !m_mapped )
+    {
+        size_t got = 0;
+
+        m_buffer.resize( m_size );
+
+        while( got < m_size )
+        {
+            DWORD chunk = (DWORD) std::min<size_t>( m_size - got, 1 << 30 );
+            DWORD count = 0;
+
+            if( !ReadFile( file, m_buffer.data() + got, chunk, &count, nullptr ) )
+            {
+                CloseHandle( file );
+                THROW_IO_ERROR( msg );
+            }
+
+            if( count == 0 )
+                break;
+
+            got += count;
+        }
+
+        // The file may have been truncated since its size was read
+        m_size = got;
+        m_data = m_buffer.data();
+    }
+
+    // The mapping keeps the file open
+    CloseHandle( file );
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        THROW_IO_ERROR( msg );
+
+    struct stat fileStat;
+
+    if( fstat( fd, &fileStat ) != 0 )
+    {
+        close( fd );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_size = (size_t) fileStat.st_size;
+
+    if( m_size && isLocalFile( fd ) )
+    {
+        void* data = mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+
+        if( data != MAP_FAILED )
+        {
+            m_data = (char*) data;
+            m_mapped = true;
+            madvise( data, m_size, MADV_SEQUENTIAL );
+        }
+    }
+
+    if( m_size && !m_mapped )
+    {
+        size_t got = 0;
+
+        m_buffer.resize( m_size );
+
+        while( got < m_size )
+        {
+            ssize_t count = read( fd, m_buffer.data() + got, m_size - got );
+
+            if( count < 0 && errno == EINTR )
+                continue;
+
+            if( count < 0 )
+            {
+                close( fd );
+                THROW_IO_ERROR( msg );
+            }
+
+            if( count == 0 )
+                break;
+
+            got += count;
+        }
+
+        // The file may have been truncated since its size was read
+        m_size = got;
+        m_data = m_buffer.data();
+    }
+
+    // The mapping keeps the file open
+    close( fd );
+#endif
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+    // m_line points into the mapping or m_lastLine; the base class must not free it
+    m_line = nullptr;
+
+#ifdef _WIN32
+    if( m_mapped )
+        UnmapViewOfFile( m_data );
+
+    if( m_mapping )
+        CloseHandle( m_mapping );
+#else
+    if( m_mapped )
+        munmap( m_data, m_size );
+#endif
+}
+
+
+void MMAP_LINE_READER::restoreEndOfLine()
+{
+    if( m_nul )
+    {
+        *m_nul = m_savedChar;
+        m_nul = nullptr;
+    }
+}
+
+
+void MMAP_LINE_READER::Rewind()
+{
+    restoreEndOfLine();
+    m_ndx = 0;
+    m_lineNum = 0;
+}
+
+
+char* MMAP_LINE_READER::ReadLine()
+{
+    restoreEndOfLine();
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    if( m_ndx >= m_size )
+    {
+        m_length = 0;
+        m_lastLine.assign( 1, '\0' );
+        m_line = m_lastLine.data();
+        return nullptr;
+    }
+
+    char*  start = m_data + m_ndx;
+    char*  eol = (char*) memchr( start, '\n', m_size - m_ndx );
+    size_t end = eol ? ( eol - m_data ) + 1 : m_size;
+
+    if( end - m_ndx > m_maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_length = (unsigned) ( end - m_ndx );
+
+    if( end < m_size )
+    {
+        // Borrow the first character of the next line for this line's nul
+        m_nul = m_data + end;
+        m_savedChar = *m_nul;
+        *m_nul = 0;
+        m_line = start;
+    }
+    else
+    {
+        // Nothing to borrow after the last line: that one line gets copied
+        m_lastLine.assign( start, start + m_length );
+        m_lastLine.push_back( '\0' );
+        m_line = m_lastLine.data();
+    }
+
+    m_ndx = end;
+
+    return m_line;
+}
+
+
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -26,6 +26,7 @@
  * @brief Some useful functions to handle strings.
  */
 
+#include <climits>
 #include <clocale>
 #include <cmath>
 #include <macros.h>
@@ -982,6 +983,122 @@ std::string Double2Str( double aValue )
 }
 
 
+/**
+ * Split the plain decimal number \a aText in a sign, the digits without the decimal point,
+ * and the count of digits after the decimal point.  Trailing zeros after the decimal point
+ * are dropped.
+ *
+ * @return false if \a aText isn't [+-]digits[.digits], or has more significant digits than
+ *         an unsigned long long can hold.
+ */
+static bool splitDecimal( const char* aText, bool& aNegative, unsigned long long& aMantissa,
+                          int& aFracDigits )
+{
+    const char*        cp = aText;
+    unsigned long long mantissa = 0;
+    int                sigDigits = 0;
+    int                fracDigits = 0;
+    bool               hasDigits = false;
+    bool               inFraction = false;
+
+    aNegative = ( *cp == '-' );
+
+    if( *cp == '-' || *cp == '+' )
+        ++cp;
+
+    for( ; *cp; ++cp )
+    {
+        if( *cp >= '0' && *cp <= '9' )
+        {
+            // Leading zeros don't count towards the limit
+            if( ( mantissa || *cp != '0' ) && ++sigDigits > 18 )
+                return false;
+
+            mantissa = mantissa * 10 + ( *cp - '0' );
+            hasDigits = true;
+
+            if( inFraction )
+                ++fracDigits;
+        }
+        else if( *cp == '.' && !inFraction )
+        {
+            inFraction = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if( !hasDigits )
+        return false;
+
+    while( fracDigits > 0 && mantissa % 10 == 0 )
+    {
+        mantissa /= 10;
+        --fracDigits;
+    }
+
+    aMantissa = mantissa;
+    aFracDigits = fracDigits;
+    return true;
+}
+
+
+bool ParseDecimalFixed( const char* aText, long long aScale, long long& aResult )
+{
+    bool               negative;
+    unsigned long long mantissa;
+    int                fracDigits;
+
+    if( aScale <= 0 || !splitDecimal( aText, negative, mantissa, fracDigits ) )
+        return false;
+
+    if( fracDigits > 18 || mantissa > (unsigned long long) LLONG_MAX / aScale )
+        return false;
+
+    unsigned long long divisor = 1;
+
+    for( int ii = 0; ii < fracDigits; ++ii )
+        divisor *= 10;
+
+    unsigned long long value = mantissa * aScale;
+
+    // Finer than a unit: leave the rounding to the caller
+    if( value % divisor )
+        return false;
+
+    value /= divisor;
+    aResult = negative ? -(long long) value : (long long) value;
+    return true;
+}
+
+
+bool ParseDecimalDouble( const char* aText, double& aResult )
+{
+    // Powers of ten which are exact in a double
+    static const double pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    bool               negative;
+    unsigned long long mantissa;
+    int                fracDigits;
+
+    if( !splitDecimal( aText, negative, mantissa, fracDigits ) )
+        return false;
+
+    // With both operands exact, the one IEEE division rounds exactly like strtod() does
+    if( mantissa > ( 1ULL << 53 ) || fracDigits > 22 )
+        return false;
+
+    double value = (double) mantissa / pow10[fracDigits];
+
+    aResult = negative ? -value : value;
+    return true;
+}
+
+
 wxString AngleToStringDegrees( double aAngle )
 {
     wxString text;
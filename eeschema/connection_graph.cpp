@@ -414,6 +414,13 @@ bool CONNECTION_GRAPH::m_allowRealTime = true;
 
 
 void CONNECTION_GRAPH::Reset()
+{
+    resetGraph();
+    m_sheetModifyCounts.clear();
+}
+
+
+void CONNECTION_GRAPH::resetGraph()
 {
     for( auto& subgraph : m_subgraphs )
         delete subgraph;
@@ -444,29 +451,70 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 
     if( aUnconditional )
         Reset();
+    else
+        resetGraph();
 
     PROF_COUNTER update_items( "updateItemConnectivity" );
 
     m_sheetList = aSheetList;
 
+    // Screens are shared by all the instances of a sheet, so the dirty flags (which are
+    // cleared by the first instance updated) must be collected before updating anything
+    std::set<SCH_SCREEN*> dirtyScreens;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( item->IsConnectable() && item->IsConnectivityDirty() )
+            {
+                dirtyScreens.insert( sheet.LastScreen() );
+                break;
+            }
+        }
+    }
+
+    std::unordered_map<SCH_SHEET_PATH, int> lastModifyCounts;
+
+    std::swap( lastModifyCounts, m_sheetModifyCounts );
+
+    size_t updatedSheets = 0;
+
     for( const SCH_SHEET_PATH& sheet : aSheetList )
     {
+        SCH_SCREEN*            screen = sheet.LastScreen();
         std::vector<SCH_ITEM*> items;
 
-        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        for( SCH_ITEM* item : screen->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
+            if( item->IsConnectable() )
                 items.push_back( item );
         }
 
         m_items.reserve( m_items.size() + items.size() );
 
-        updateItemConnectivity( sheet, items );
+        // Deleted items and rebuilt pins don't leave a dirty flag behind, but they do bump the
+        // modification count of the screen
+        auto last = lastModifyCounts.find( sheet );
+        bool stale = aUnconditional || dirtyScreens.count( screen )
+                        || last == lastModifyCounts.end()
+                        || last->second != screen->GetModifyCount();
+
+        updateItemConnectivity( sheet, items, stale );
 
         // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet, aChangedItemHandler );
+        if( stale )
+        {
+            screen->TestDanglingEnds( &sheet, aChangedItemHandler );
+            updatedSheets++;
+        }
+
+        m_sheetModifyCounts[sheet] = screen->GetModifyCount();
     }
 
+    wxLogTrace( ConnTrace, "Updated item connectivity of %zu of %zu sheets", updatedSheets,
+                aSheetList.size() );
+
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         update_items.Show();
 
@@ -496,14 +544,15 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 
 
 void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
-                                               const std::vector<SCH_ITEM*>& aItemList )
+                                               const std::vector<SCH_ITEM*>& aItemList,
+                                               bool aUpdateLinks )
 {
     std::map< wxPoint, std::vector<SCH_ITEM*> > connection_map;
 
     for( SCH_ITEM* item : aItemList )
     {
-        std::vector< wxPoint > points = item->GetConnectionPoints();
-        item->ConnectedItems( aSheet ).clear();
+        if( aUpdateLinks )
+            item->ConnectedItems( aSheet ).clear();
 
         if( item->Type() == SCH_SHEET_T )
         {
@@ -511,9 +560,12 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
             {
                 pin->InitializeConnection( aSheet, this );
 
-                pin->ConnectedItems( aSheet ).clear();
+                if( aUpdateLinks )
+                {
+                    pin->ConnectedItems( aSheet ).clear();
+                    connection_map[ pin->GetTextPos() ].push_back( pin );
+                }
 
-                connection_map[ pin->GetTextPos() ].push_back( pin );
                 m_items.emplace_back( pin );
             }
         }
@@ -529,14 +581,18 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
                 // because calling the first time is not thread-safe
                 pin->GetDefaultNetName( aSheet );
-                pin->ConnectedItems( aSheet ).clear();
 
                 // Invisible power pins need to be post-processed later
 
                 if( pin->IsPowerConnection() && !pin->IsVisible() )
                     m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
 
-                connection_map[ pos ].push_back( pin );
+                if( aUpdateLinks )
+                {
+                    pin->ConnectedItems( aSheet ).clear();
+                    connection_map[ pos ].push_back( pin );
+                }
+
                 m_items.emplace_back( pin );
             }
         }
@@ -555,9 +611,14 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             case SCH_BUS_BUS_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::BUS );
+
                 // clean previous (old) links:
-                static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
-                static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
+                if( aUpdateLinks )
+                {
+                    static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
+                    static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
+                }
+
                 break;
 
             case SCH_PIN_T:
@@ -566,16 +627,22 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             case SCH_BUS_WIRE_ENTRY_T:
                 conn->SetType( CONNECTION_TYPE::NET );
+
                 // clean previous (old) link:
-                static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
+                if( aUpdateLinks )
+                    static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
+
                 break;
 
             default:
                 break;
             }
 
-            for( const wxPoint& point : points )
-                connection_map[ point ].push_back( item );
+            if( aUpdateLinks )
+            {
+                for( const wxPoint& point : item->GetConnectionPoints() )
+                    connection_map[ point ].push_back( item );
+            }
         }
 
         item->SetConnectivityDirty( false );
@@ -270,6 +270,11 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * The links between the items of a sheet are only rebuilt when one of them is dirty or the
+     * modification count of its screen changed since the last recalculation, unless
+     * \a aUnconditional is set.  Subgraphs and nets are not updated incrementally: they are
+     * always built again for the whole schematic.
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      * @param aChangedItemHandler an optional handler to receive any changed items
@@ -325,6 +330,12 @@ public:
     CONNECTION_SUBGRAPH* GetSubgraphForItem( SCH_ITEM* aItem );
 
 private:
+    /**
+     * Clears the subgraphs and net caches, but keeps the modification counts used to skip the
+     * unchanged sheets in the next recalculation.
+     */
+    void resetGraph();
+
     /**
      * Updates the graphical connectivity between items (i.e. where they touch)
      * The items passed in must be on the same sheet.
@@ -351,9 +362,13 @@ private:
      *
      * @param aSheet is the path to the sheet of all items in the list
      * @param aItemList is a list of items to consider
+     * @param aUpdateLinks is false to keep the links between the items from the last update
+     *                     (when nothing changed on the sheet since) and only reset their
+     *                     connections
      */
     void updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
-                                 const std::vector<SCH_ITEM*>& aItemList );
+                                 const std::vector<SCH_ITEM*>& aItemList,
+                                 bool aUpdateLinks = true );
 
     /**
      * Generates the connection graph (after all item connectivity has been updated)
@@ -514,6 +529,9 @@ private:
     // All connectable items in the schematic
     std::vector<SCH_ITEM*> m_items;
 
+    // The modification count of the screen of each sheet when its links were last updated
+    std::unordered_map<SCH_SHEET_PATH, int> m_sheetModifyCounts;
+
     // The owner of all CONNECTION_SUBGRAPH objects
     std::vector<CONNECTION_SUBGRAPH*> m_subgraphs;
 
@@ -23,6 +23,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+
 #include "connection_graph.h"
 #include <common.h>     // for ExpandEnvVarSubstitutions
 #include <erc.h>
@@ -115,6 +121,261 @@ const std::set<ELECTRICAL_PINTYPE> DrivenPinTypes =
             ELECTRICAL_PINTYPE::PT_POWER_IN
         };
 
+
+/**
+ * Run \a aTask on as many threads as \a aCount work items are worth.  The task takes its items
+ * from a shared counter and returns when there are none left, so it also works when it is run
+ * only once.
+ */
+static void runParallel( const std::function<size_t()>& aTask, size_t aCount )
+{
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   ( aCount + 7 ) / 8 );
+
+    if( parallelThreadCount <= 1 )
+    {
+        aTask();
+        return;
+    }
+
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        returns[ii] = std::async( std::launch::async, aTask );
+
+    for( const std::future<size_t>& ret : returns )
+        ret.wait();
+}
+
+
+/*
+ * The per-net tests run on several threads, but only record what they find: markers get new
+ * KIIDs, which can't be generated concurrently, and screens aren't thread-safe either.  The
+ * markers are created afterwards, in net order, so the results don't depend on the threads.
+ *
+ * Shown texts are never resolved on the worker threads: text variables are expanded through
+ * the schematic and the project, which aren't thread-safe.
+ */
+
+///< A pair of conflicting pins, or an undriven pin when m_testPin is null
+struct PIN_CONFLICT
+{
+    SCH_PIN*    m_refPin;
+    SCH_PIN*    m_testPin;
+    int         m_errorCode;
+    SCH_SCREEN* m_screen;
+};
+
+
+///< Scratch buffers of the pin-to-pin test, reused for all the nets tested by a thread
+struct PIN_TO_PIN_SCRATCH
+{
+    std::vector<SCH_PIN*>                m_pins;
+    std::vector<SCH_SCREEN*>             m_screens;     ///< Screen of each pin
+    std::unordered_map<SCH_PIN*, size_t> m_indices;     ///< Index of each pin in m_pins
+};
+
+
+static void testPinToPin( const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs,
+                          const ERC_SETTINGS& aSettings, PIN_TO_PIN_SCRATCH& aScratch,
+                          std::vector<PIN_CONFLICT>& aConflicts )
+{
+    std::vector<SCH_PIN*>&    pins = aScratch.m_pins;
+    std::vector<SCH_SCREEN*>& pinScreens = aScratch.m_screens;
+    size_t                    pinCount = 0;
+
+    pins.clear();
+    pinScreens.clear();
+    aScratch.m_indices.clear();
+
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( item->Type() != SCH_PIN_T )
+                continue;
+
+            SCH_PIN* pin = static_cast<SCH_PIN*>( item );
+            auto     inserted = aScratch.m_indices.emplace( pin, pins.size() );
+
+            pinCount++;
+
+            // A pin of a symbol used in several sheet instances is only tested once, and
+            // reported on the last of its screens
+            if( inserted.second )
+            {
+                pins.push_back( pin );
+                pinScreens.push_back( subgraph->m_sheet.LastScreen() );
+            }
+            else
+            {
+                pinScreens[inserted.first->second] = subgraph->m_sheet.LastScreen();
+            }
+        }
+    }
+
+    // Single-pin nets are handled elsewhere
+    if( pinCount < 2 )
+        return;
+
+    size_t needsDriver = pins.size();
+    bool   hasDriver   = false;
+
+    // We need different drivers for power nets and normal nets.
+    // A power net has at least one pin having the ELECTRICAL_PINTYPE::PT_POWER_IN
+    // and power nets can be driven only by ELECTRICAL_PINTYPE::PT_POWER_OUT pins
+    bool   ispowerNet  = false;
+
+    for( SCH_PIN* refPin : pins )
+    {
+        if( refPin->GetType() == ELECTRICAL_PINTYPE::PT_POWER_IN )
+        {
+            ispowerNet = true;
+            break;
+        }
+    }
+
+    const std::set<ELECTRICAL_PINTYPE>& drivingTypes = ispowerNet ? DrivingPowerPinTypes
+                                                                  : DrivingPinTypes;
+
+    for( size_t ii = 0; ii < pins.size(); ++ii )
+    {
+        SCH_PIN*           refPin = pins[ii];
+        ELECTRICAL_PINTYPE refType = refPin->GetType();
+
+        if( DrivenPinTypes.count( refType ) )
+        {
+            // needsDriver will be the pin shown in the error report eventually, so try to
+            // upgrade to a "better" pin if possible: something visible and only a power symbol
+            // if this net needs a power driver
+            if( needsDriver == pins.size() ||
+                ( !pins[needsDriver]->IsVisible() && refPin->IsVisible() ) ||
+                ( ispowerNet != pins[needsDriver]->IsPowerConnection() &&
+                  ispowerNet == refPin->IsPowerConnection() ) )
+            {
+                needsDriver = ii;
+            }
+        }
+
+        hasDriver |= ( drivingTypes.count( refType ) != 0 );
+
+        // Each pair of pins is tested once, with the first one as reference
+        for( size_t jj = ii + 1; jj < pins.size(); ++jj )
+        {
+            SCH_PIN*  testPin = pins[jj];
+            PIN_ERROR erc = aSettings.GetPinMapValue( refType, testPin->GetType() );
+
+            if( erc != PIN_ERROR::OK )
+            {
+                aConflicts.push_back( { refPin, testPin,
+                                        erc == PIN_ERROR::WARNING ? ERCE_PIN_TO_PIN_WARNING :
+                                                                    ERCE_PIN_TO_PIN_ERROR,
+                                        pinScreens[ii] } );
+            }
+        }
+    }
+
+    if( needsDriver < pins.size() && !hasDriver )
+    {
+        aConflicts.push_back( { pins[needsDriver], nullptr,
+                                ispowerNet ? ERCE_POWERPIN_NOT_DRIVEN : ERCE_PIN_NOT_DRIVEN,
+                                pinScreens[needsDriver] } );
+    }
+}
+
+
+///< A label of a net, with its shown text resolved once
+struct NET_LABEL
+{
+    SCH_TEXT*   m_label;
+    SCH_SCREEN* m_screen;
+    wxString    m_shownText;
+    wxString    m_normalized;
+};
+
+
+static void collectLabels( const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs,
+                           std::vector<NET_LABEL>& aLabels )
+{
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            switch( item->Type() )
+            {
+            case SCH_LABEL_T:
+            case SCH_HIER_LABEL_T:
+            case SCH_GLOBAL_LABEL_T:
+            {
+                SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
+                wxString  shownText = text->GetShownText();
+
+                aLabels.push_back( { text, subgraph->m_sheet.LastScreen(), shownText,
+                                     shownText.Lower() } );
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    }
+}
+
+
+///< A set of "no connection" pins stacked at the same position
+struct STACKED_NC_PINS
+{
+    std::vector<SCH_PIN*> m_pins;
+    wxPoint               m_position;
+};
+
+
+static void findStackedNCPins( const SCH_SHEET_PATH& aSheet, std::vector<SCH_PIN*>& aScratch,
+                               std::vector<STACKED_NC_PINS>& aStacks )
+{
+    std::vector<SCH_PIN*>& ncPins = aScratch;
+
+    ncPins.clear();
+
+    for( SCH_ITEM* item : aSheet.LastScreen()->Items().OfType( SCH_SYMBOL_T ) )
+    {
+        SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+
+        for( SCH_PIN* pin : symbol->GetPins( &aSheet ) )
+        {
+            if( pin->GetLibPin()->GetType() == ELECTRICAL_PINTYPE::PT_NC )
+                ncPins.push_back( pin );
+        }
+    }
+
+    // Group the pins by position, in the same order as a std::map<wxPoint> would
+    std::stable_sort( ncPins.begin(), ncPins.end(),
+                      []( SCH_PIN* a, SCH_PIN* b )
+                      {
+                          return std::less<wxPoint>()( a->GetPosition(), b->GetPosition() );
+                      } );
+
+    for( size_t first = 0, last; first < ncPins.size(); first = last )
+    {
+        wxPoint pos = ncPins[first]->GetPosition();
+
+        for( last = first + 1; last < ncPins.size(); ++last )
+        {
+            if( ncPins[last]->GetPosition() != pos )
+                break;
+        }
+
+        if( last - first > 1 )
+        {
+            aStacks.push_back( { std::vector<SCH_PIN*>( ncPins.begin() + first,
+                                                        ncPins.begin() + last ),
+                                 pos } );
+        }
+    }
+}
+
+
 int ERC_TESTER::TestDuplicateSheetNames( bool aCreateMarker )
 {
     SCH_SCREEN* screen;
@@ -388,39 +649,42 @@ int ERC_TESTER::TestMultiunitFootprints()
 
 int ERC_TESTER::TestNoConnectPins()
 {
-    int err_count = 0;
+    SCH_SHEET_LIST      sheets = m_schematic->GetSheets();
+    std::atomic<size_t> nextSheet( 0 );
+    int                 err_count = 0;
 
-    for( const SCH_SHEET_PATH& sheet : m_schematic->GetSheets() )
-    {
-        std::map<wxPoint, std::vector<SCH_PIN*>> pinMap;
-
-        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_SYMBOL_T ) )
-        {
-            SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+    std::vector<std::vector<STACKED_NC_PINS>> stacks( sheets.size() );
 
-            for( SCH_PIN* pin : symbol->GetPins( &sheet ) )
+    auto testSheets =
+            [&]() -> size_t
             {
-                if( pin->GetLibPin()->GetType() == ELECTRICAL_PINTYPE::PT_NC )
-                    pinMap[pin->GetPosition()].emplace_back( pin );
-            }
-        }
+                std::vector<SCH_PIN*> scratch;
+
+                for( size_t ii = nextSheet++; ii < sheets.size(); ii = nextSheet++ )
+                    findStackedNCPins( sheets[ii], scratch, stacks[ii] );
 
-        for( auto& pair : pinMap )
+                return 1;
+            };
+
+    runParallel( testSheets, sheets.size() );
+
+    for( size_t ii = 0; ii < sheets.size(); ++ii )
+    {
+        for( const STACKED_NC_PINS& stack : stacks[ii] )
         {
-            if( pair.second.size() > 1 )
-            {
-                err_count++;
+            const std::vector<SCH_PIN*>& pins = stack.m_pins;
 
-                std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
+            err_count++;
 
-                ercItem->SetItems( pair.second[0], pair.second[1],
-                                   pair.second.size() > 2 ? pair.second[2] : nullptr,
-                                   pair.second.size() > 3 ? pair.second[3] : nullptr );
-                ercItem->SetErrorMessage( _( "Pins with \"no connection\" type are connected" ) );
+            std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
 
-                SCH_MARKER* marker = new SCH_MARKER( ercItem, pair.first );
-                sheet.LastScreen()->Append( marker );
-            }
+            ercItem->SetItems( pins[0], pins[1],
+                               pins.size() > 2 ? pins[2] : nullptr,
+                               pins.size() > 3 ? pins[3] : nullptr );
+            ercItem->SetErrorMessage( _( "Pins with \"no connection\" type are connected" ) );
+
+            SCH_MARKER* marker = new SCH_MARKER( ercItem, stack.m_position );
+            sheets[ii].LastScreen()->Append( marker );
         }
     }
 
@@ -433,124 +697,55 @@ int ERC_TESTER::TestPinToPin()
     ERC_SETTINGS&  settings = m_schematic->ErcSettings();
     const NET_MAP& nets     = m_schematic->ConnectionGraph()->GetNetMap();
 
-    int errors = 0;
+    std::vector<const std::vector<CONNECTION_SUBGRAPH*>*> netList;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
-    {
-        std::vector<SCH_PIN*> pins;
-        std::unordered_map<EDA_ITEM*, SCH_SCREEN*> pinToScreenMap;
+    netList.reserve( nets.size() );
 
-        for( CONNECTION_SUBGRAPH* subgraph: net.second )
-        {
-            for( EDA_ITEM* item : subgraph->m_items )
-            {
-                if( item->Type() == SCH_PIN_T )
-                {
-                    pins.emplace_back( static_cast<SCH_PIN*>( item ) );
-                    pinToScreenMap[item] = subgraph->m_sheet.LastScreen();
-                }
-            }
-        }
+    for( const NET_MAP::value_type& net : nets )
+        netList.push_back( &net.second );
 
-        // Single-pin nets are handled elsewhere
-        if( pins.size() < 2 )
-            continue;
+    std::vector<std::vector<PIN_CONFLICT>> conflicts( netList.size() );
+    std::atomic<size_t>                    nextNet( 0 );
 
-        std::set<std::pair<SCH_PIN*, SCH_PIN*>> tested;
+    auto testNets =
+            [&]() -> size_t
+            {
+                PIN_TO_PIN_SCRATCH scratch;
 
-        SCH_PIN* needsDriver = nullptr;
-        bool     hasDriver   = false;
+                for( size_t ii = nextNet++; ii < netList.size(); ii = nextNet++ )
+                    testPinToPin( *netList[ii], settings, scratch, conflicts[ii] );
 
-        // We need different drivers for power nets and normal nets.
-        // A power net has at least one pin having the ELECTRICAL_PINTYPE::PT_POWER_IN
-        // and power nets can be driven only by ELECTRICAL_PINTYPE::PT_POWER_OUT pins
-        bool     ispowerNet  = false;
+                return 1;
+            };
 
-        for( SCH_PIN* refPin : pins )
-        {
-            if( refPin->GetType() == ELECTRICAL_PINTYPE::PT_POWER_IN )
-            {
-                ispowerNet = true;
-                break;
-            }
-        }
+    runParallel( testNets, netList.size() );
 
-        for( SCH_PIN* refPin : pins )
+    int errors = 0;
+
+    for( const std::vector<PIN_CONFLICT>& netConflicts : conflicts )
+    {
+        for( const PIN_CONFLICT& conflict : netConflicts )
         {
-            ELECTRICAL_PINTYPE refType = refPin->GetType();
+            std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( conflict.m_errorCode );
 
-            if( DrivenPinTypes.count( refType ) )
+            if( conflict.m_testPin )
             {
-                // needsDriver will be the pin shown in the error report eventually, so try to
-                // upgrade to a "better" pin if possible: something visible and only a power symbol
-                // if this net needs a power driver
-                if( !needsDriver ||
-                    ( !needsDriver->IsVisible() && refPin->IsVisible() ) ||
-                    ( ispowerNet != needsDriver->IsPowerConnection() &&
-                      ispowerNet == refPin->IsPowerConnection() ) )
-                {
-                    needsDriver = refPin;
-                }
-            }
+                ercItem->SetItems( conflict.m_refPin, conflict.m_testPin );
+                ercItem->SetIsSheetSpecific();
 
-            if( ispowerNet )
-                hasDriver |= ( DrivingPowerPinTypes.count( refType ) != 0 );
+                ercItem->SetErrorMessage(
+                        wxString::Format( _( "Pins of type %s and %s are connected" ),
+                                ElectricalPinTypeGetText( conflict.m_refPin->GetType() ),
+                                ElectricalPinTypeGetText( conflict.m_testPin->GetType() ) ) );
+            }
             else
-                hasDriver |= ( DrivingPinTypes.count( refType ) != 0 );
-
-            for( SCH_PIN* testPin : pins )
             {
-                if( testPin == refPin )
-                    continue;
-
-                std::pair<SCH_PIN*, SCH_PIN*> pair1 = std::make_pair( refPin, testPin );
-                std::pair<SCH_PIN*, SCH_PIN*> pair2 = std::make_pair( testPin, refPin );
-
-                if( tested.count( pair1 ) || tested.count( pair2 ) )
-                    continue;
-
-                tested.insert( pair1 );
-                tested.insert( pair2 );
-
-                ELECTRICAL_PINTYPE testType = testPin->GetType();
-
-                if( ispowerNet )
-                    hasDriver |= ( DrivingPowerPinTypes.count( testType ) != 0 );
-                else
-                    hasDriver |= ( DrivingPinTypes.count( testType ) != 0 );
-
-                PIN_ERROR erc = settings.GetPinMapValue( refType, testType );
-
-                if( erc != PIN_ERROR::OK )
-                {
-                    std::shared_ptr<ERC_ITEM> ercItem =
-                            ERC_ITEM::Create( erc == PIN_ERROR::WARNING ? ERCE_PIN_TO_PIN_WARNING :
-                                                                          ERCE_PIN_TO_PIN_ERROR );
-                    ercItem->SetItems( refPin, testPin );
-                    ercItem->SetIsSheetSpecific();
-
-                    ercItem->SetErrorMessage(
-                            wxString::Format( _( "Pins of type %s and %s are connected" ),
-                                    ElectricalPinTypeGetText( refType ),
-                                    ElectricalPinTypeGetText( testType ) ) );
-
-                    SCH_MARKER* marker =
-                            new SCH_MARKER( ercItem, refPin->GetTransformedPosition() );
-                    pinToScreenMap[refPin]->Append( marker );
-                    errors++;
-                }
+                ercItem->SetItems( conflict.m_refPin );
             }
-        }
-
-        if( needsDriver && !hasDriver )
-        {
-            int err_code = ispowerNet ? ERCE_POWERPIN_NOT_DRIVEN : ERCE_PIN_NOT_DRIVEN;
-            std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( err_code );
 
-            ercItem->SetItems( needsDriver );
-
-            SCH_MARKER* marker = new SCH_MARKER( ercItem, needsDriver->GetTransformedPosition() );
-            pinToScreenMap[needsDriver]->Append( marker );
+            SCH_MARKER* marker =
+                    new SCH_MARKER( ercItem, conflict.m_refPin->GetTransformedPosition() );
+            conflict.m_screen->Append( marker );
             errors++;
         }
     }
@@ -567,7 +762,7 @@ int ERC_TESTER::TestMultUnitPinConflicts()
 
     std::unordered_map<wxString, std::pair<wxString, SCH_PIN*>> pinToNetMap;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
+    for( const NET_MAP::value_type& net : nets )
     {
         const wxString& netName = net.first.first;
         std::vector<SCH_PIN*> pins;
@@ -622,49 +817,31 @@ int ERC_TESTER::TestSimilarLabels()
 {
     const NET_MAP& nets = m_schematic->ConnectionGraph()->GetNetMap();
 
+    std::vector<NET_LABEL> labels;
+
+    for( const NET_MAP::value_type& net : nets )
+        collectLabels( net.second, labels );
+
     int errors = 0;
 
-    std::unordered_map<wxString, SCH_TEXT*> labelMap;
+    std::unordered_map<wxString, const NET_LABEL*> labelMap;
 
-    for( const std::pair<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> net : nets )
+    for( const NET_LABEL& label : labels )
     {
-        std::vector<SCH_PIN*> pins;
+        auto it = labelMap.find( label.m_normalized );
 
-        for( CONNECTION_SUBGRAPH* subgraph : net.second )
+        if( it == labelMap.end() )
         {
-            for( EDA_ITEM* item : subgraph->m_items )
-            {
-                switch( item->Type() )
-                {
-                case SCH_LABEL_T:
-                case SCH_HIER_LABEL_T:
-                case SCH_GLOBAL_LABEL_T:
-                {
-                    SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
-
-                    wxString normalized = text->GetShownText().Lower();
-
-                    if( !labelMap.count( normalized ) )
-                    {
-                        labelMap[normalized] = text;
-                    }
-                    else if( labelMap.at( normalized )->GetShownText() != text->GetShownText() )
-                    {
-                        std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_SIMILAR_LABELS );
-                        ercItem->SetItems( text, labelMap.at( normalized ) );
-
-                        SCH_MARKER* marker = new SCH_MARKER( ercItem, text->GetPosition() );
-                        subgraph->m_sheet.LastScreen()->Append( marker );
-                        errors += 1;
-                    }
-
-                    break;
-                }
+            labelMap.emplace( label.m_normalized, &label );
+        }
+        else if( it->second->m_shownText != label.m_shownText )
+        {
+            std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_SIMILAR_LABELS );
+            ercItem->SetItems( label.m_label, it->second->m_label );
 
-                default:
-                    break;
-                }
-            }
+            SCH_MARKER* marker = new SCH_MARKER( ercItem, label.m_label->GetPosition() );
+            label.m_screen->Append( marker );
+            errors += 1;
         }
     }
 
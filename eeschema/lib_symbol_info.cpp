@@ -0,0 +1,50 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <lib_symbol.h>
+#include <lib_symbol_info.h>
+
+
+LIB_SYMBOL_INFO::LIB_SYMBOL_INFO( LIB_SYMBOL& aSymbol ) :
+        m_nickname( aSymbol.GetLibNickname() ),
+        m_name( aSymbol.GetName() ),
+        m_description( aSymbol.GetDescription() ),
+        m_keywords( aSymbol.GetKeyWords() ),
+        m_footprint( aSymbol.GetFootprintField().GetText() ),
+        m_unitCount( aSymbol.GetUnitCount() ),
+        m_pinCount( (int) aSymbol.GetPinCount() ),
+        m_isPower( aSymbol.IsPower() )
+{
+    // The pins of a derived symbol are those of its parent
+    if( LIB_SYMBOL_SPTR parent = aSymbol.GetParent().lock() )
+    {
+        m_parentName = parent->GetName();
+        m_pinCount = (int) parent->GetPinCount();
+    }
+}
+
+
+wxString LIB_SYMBOL_INFO::GetUnitReference( int aUnit )
+{
+    return LIB_SYMBOL::SubReference( aUnit, false );
+}
@@ -0,0 +1,89 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef LIB_SYMBOL_INFO_H
+#define LIB_SYMBOL_INFO_H
+
+#include <lib_tree_item.h>
+
+class LIB_SYMBOL;
+
+
+/**
+ * What the symbol chooser needs to know about a library symbol, without the symbol itself.
+ *
+ * This is the symbol counterpart of #FOOTPRINT_INFO.  Plugins which keep an index of their
+ * libraries can provide it without parsing the symbols; see SCH_PLUGIN::EnumerateSymbolInfo().
+ */
+class LIB_SYMBOL_INFO : public LIB_TREE_ITEM
+{
+public:
+    LIB_SYMBOL_INFO() :
+            m_unitCount( 1 ),
+            m_pinCount( 0 ),
+            m_isPower( false )
+    {}
+
+    LIB_SYMBOL_INFO( LIB_SYMBOL& aSymbol );
+
+    LIB_ID GetLibId() const override { return LIB_ID( m_nickname, m_name ); }
+
+    wxString GetName() const override { return m_name; }
+
+    wxString GetLibNickname() const override { return m_nickname; }
+
+    wxString GetDescription() override { return m_description; }
+
+    wxString GetSearchText() override
+    {
+        // Matches are scored by offset from front of string, so inclusion of this spacer
+        // discounts matches found after it.
+        static const wxString discount( wxT( "        " ) );
+
+        wxString text = m_keywords + discount + m_description;
+
+        if( !m_footprint.IsEmpty() )
+            text += discount + m_footprint;
+
+        return text;
+    }
+
+    ///< Derived symbols are not roots; see LIB_SYMBOL::IsRoot()
+    bool IsRoot() const override { return m_parentName.IsEmpty(); }
+
+    int GetUnitCount() const override { return m_unitCount; }
+
+    wxString GetUnitReference( int aUnit ) override;
+
+    wxString m_nickname;
+    wxString m_name;
+    wxString m_parentName;      ///< Name of the parent of a derived symbol, empty for roots
+    wxString m_description;
+    wxString m_keywords;
+    wxString m_footprint;
+    int      m_unitCount;
+    int      m_pinCount;
+    bool     m_isPower;
+};
+
+#endif // LIB_SYMBOL_INFO_H
@@ -1320,7 +1320,10 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
                 GetCanvas()->GetView()->Update( aChangedItem, KIGFX::REPAINT );
             };
 
-    Schematic().ConnectionGraph()->Recalculate( list, true, &changeHandler );
+    // Only the sheets changed since the last recalculation need their item links rebuilt,
+    // except after a global cleanup which may have touched any of them
+    Schematic().ConnectionGraph()->Recalculate( list, aCleanupFlags == GLOBAL_CLEANUP,
+                                                &changeHandler );
 
     GetCanvas()->GetView()->UpdateAllItemsConditionally( KIGFX::REPAINT,
             []( KIGFX::VIEW_ITEM* aItem )
@@ -20,6 +20,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <lib_symbol.h>
+#include <lib_symbol_info.h>
 #include <properties.h>
 
 #include <sch_io_mgr.h>
@@ -82,6 +84,19 @@ void SCH_PLUGIN::EnumerateSymbolLib( std::vector<LIB_SYMBOL*>& aSymbolList,
 }
 
 
+void SCH_PLUGIN::EnumerateSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolInfoList,
+                                      const wxString&   aLibraryPath,
+                                      const PROPERTIES* aProperties )
+{
+    std::vector<LIB_SYMBOL*> symbols;
+
+    EnumerateSymbolLib( symbols, aLibraryPath, aProperties );
+
+    for( LIB_SYMBOL* symbol : symbols )
+        aSymbolInfoList.emplace_back( *symbol );
+}
+
+
 LIB_SYMBOL* SCH_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxString& aSymbolName,
                                   const PROPERTIES* aProperties )
 {
@@ -0,0 +1,142 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+
+#include <cache_index_file.h>
+#include <lib_symbol.h>
+#include <sch_plugins/kicad/sch_sexpr_lib_index.h>
+#include <trace_helpers.h>
+#include <wx/log.h>
+
+
+/*
+ * Index file layout, after the header written by CACHE_INDEX_FILE:
+ *
+ *   int64     modification time of the library file
+ *   int64     size of the library file
+ *   uint32    number of symbols, then for each symbol:
+ *     string    name
+ *     string    parent name
+ *     string    description
+ *     string    keywords
+ *     string    footprint
+ *     int32     unit count
+ *     int32     pin count
+ *     uint8     1 for power symbols, 0 otherwise
+ */
+static const char     INDEX_MAGIC[8] = "KISYIDX";
+static const uint32_t INDEX_VERSION = 2;
+
+
+SCH_SEXPR_LIB_INDEX::SCH_SEXPR_LIB_INDEX( const wxString& aLibraryPath ) :
+        m_libraryPath( aLibraryPath )
+{
+}
+
+
+bool SCH_SEXPR_LIB_INDEX::Read()
+{
+    m_symbols.clear();
+
+    CACHE_INDEX_FILE file( wxT( "symbols" ), INDEX_MAGIC, INDEX_VERSION, m_libraryPath );
+    long long        libModTime;
+    long long        libSize;
+    int64_t          modTime;
+    int64_t          size;
+    uint32_t         count;
+
+    // A changed library is no worse than no index at all
+    if( !CACHE_INDEX_FILE::GetFileStat( m_libraryPath, libModTime, libSize ) || !file.Load()
+            || !file.Read( modTime ) || modTime != libModTime
+            || !file.Read( size ) || size != libSize
+            || !file.Read( count ) )
+    {
+        return false;
+    }
+
+    m_symbols.resize( count );
+
+    for( LIB_SYMBOL_INFO& symbol : m_symbols )
+    {
+        int32_t unitCount;
+        int32_t pinCount;
+        uint8_t isPower;
+
+        if( !file.ReadString( symbol.m_name ) || !file.ReadString( symbol.m_parentName )
+                || !file.ReadString( symbol.m_description )
+                || !file.ReadString( symbol.m_keywords )
+                || !file.ReadString( symbol.m_footprint )
+                || !file.Read( unitCount ) || !file.Read( pinCount )
+                || !file.Read( isPower ) )
+        {
+            wxLogTrace( traceSchLegacyPlugin, wxT( "Symbol index '%s' is truncated." ),
+                        file.GetFilePath() );
+            m_symbols.clear();
+            return false;
+        }
+
+        symbol.m_unitCount = unitCount;
+        symbol.m_pinCount = pinCount;
+        symbol.m_isPower = isPower != 0;
+    }
+
+    return true;
+}
+
+
+void SCH_SEXPR_LIB_INDEX::Write( const LIB_SYMBOL_MAP& aSymbols, long long aModTime,
+                                 long long aSize )
+{
+    m_symbols.clear();
+    m_symbols.reserve( aSymbols.size() );
+
+    for( const std::pair<const wxString, LIB_SYMBOL*>& entry : aSymbols )
+        m_symbols.emplace_back( *entry.second );
+
+    CACHE_INDEX_FILE file( wxT( "symbols" ), INDEX_MAGIC, INDEX_VERSION, m_libraryPath );
+
+    file.Clear();
+    file.Append<int64_t>( aModTime );
+    file.Append<int64_t>( aSize );
+    file.Append<uint32_t>( m_symbols.size() );
+
+    for( const LIB_SYMBOL_INFO& symbol : m_symbols )
+    {
+        file.AppendString( symbol.m_name );
+        file.AppendString( symbol.m_parentName );
+        file.AppendString( symbol.m_description );
+        file.AppendString( symbol.m_keywords );
+        file.AppendString( symbol.m_footprint );
+        file.Append<int32_t>( symbol.m_unitCount );
+        file.Append<int32_t>( symbol.m_pinCount );
+        file.Append<uint8_t>( symbol.m_isPower ? 1 : 0 );
+    }
+
+    // Not the end of the world: it's just a cache file
+    if( !file.Save() )
+    {
+        wxLogTrace( traceSchLegacyPlugin, wxT( "Cannot write symbol index '%s'." ),
+                    file.GetFilePath() );
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SCH_SEXPR_LIB_INDEX_H
+#define SCH_SEXPR_LIB_INDEX_H
+
+#include <vector>
+
+#include <lib_symbol_info.h>
+#include <symbol_library.h>
+#include <wx/string.h>
+
+
+/**
+ * A persistent summary of the symbols of one .kicad_sym library.
+ *
+ * The index holds a #LIB_SYMBOL_INFO for each symbol of the library, along with the
+ * modification time and size the library file had when it was parsed.  As long as the file
+ * still matches, the symbol names and the contents of the symbol chooser can be taken from
+ * the index without parsing the library at all.
+ *
+ * The index is stored in a binary file in the user cache directory (one file per library
+ * path), never next to the library which may be read only or shared.  It is only a cache:
+ * a missing, stale or damaged index file is simply ignored and rebuilt the next time the
+ * library is parsed.
+ */
+class SCH_SEXPR_LIB_INDEX
+{
+public:
+    SCH_SEXPR_LIB_INDEX( const wxString& aLibraryPath );
+
+    /**
+     * Read the index file of the library.
+     *
+     * @return true if there is a valid index for the library file as it is now.
+     */
+    bool Read();
+
+    /**
+     * Replace the index by a summary of \a aSymbols and write the index file.  Failures are
+     * silently ignored.
+     *
+     * @param aSymbols are the symbols of the library.
+     * @param aModTime is the modification time of the library file the symbols were read from.
+     * @param aSize is the size of the library file the symbols were read from.
+     */
+    void Write( const LIB_SYMBOL_MAP& aSymbols, long long aModTime, long long aSize );
+
+    const std::vector<LIB_SYMBOL_INFO>& GetSymbols() const { return m_symbols; }
+
+private:
+    wxString                     m_libraryPath;
+    std::vector<LIB_SYMBOL_INFO> m_symbols;
+};
+
+#endif // SCH_SEXPR_LIB_INDEX_H
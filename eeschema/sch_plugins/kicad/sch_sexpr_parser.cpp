@@ -255,7 +255,8 @@ LIB_SYMBOL* SCH_SEXPR_PARSER::ParseSymbol( LIB_SYMBOL_MAP& aSymbolLibMap, int aF
             name = FromUTF8();
             auto it = aSymbolLibMap.find( name );
 
-            if( it == aSymbolLibMap.end() )
+            // A null parent is one the library cache failed to parse
+            if( it == aSymbolLibMap.end() || !it->second )
             {
                 error.Printf( _( "No parent for extended symbol %s" ), name.c_str() );
                 THROW_PARSE_ERROR( error, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
@@ -420,7 +421,12 @@ LIB_ITEM* SCH_SEXPR_PARSER::ParseDrawItem()
 
 double SCH_SEXPR_PARSER::parseDouble()
 {
-    char* tmp;
+    char*  tmp;
+    double fval;
+
+    // Quick, and exactly what strtod() gives, for the plain decimals we write ourselves
+    if( ParseDecimalDouble( CurText(), fval ) )
+        return fval;
 
     // In case the file got saved with the wrong locale.
     if( strchr( CurText(), ',' ) != nullptr )
@@ -431,7 +437,7 @@ double SCH_SEXPR_PARSER::parseDouble()
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    fval = strtod( CurText(), &tmp );
 
     if( errno )
     {
@@ -451,12 +457,18 @@ double SCH_SEXPR_PARSER::parseDouble()
 
 int SCH_SEXPR_PARSER::parseInternalUnits()
 {
-    auto retval = parseDouble() * IU_PER_MM;
-
     // Schematic internal units are represented as integers.  Any values that are
     // larger or smaller than the schematic units represent undefined behavior for
     // the system.  Limit values to the largest that can be displayed on the screen.
-    double int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
+    double    int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
+    long long iu;
+
+    // Values with no more than internal unit resolution convert exactly, with no need to go
+    // through a double
+    if( ParseDecimalFixed( CurText(), (long long) IU_PER_MM, iu ) && std::abs( iu ) <= int_limit )
+        return (int) iu;
+
+    auto retval = parseDouble() * IU_PER_MM;
 
     return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
 }
@@ -464,11 +476,9 @@ int SCH_SEXPR_PARSER::parseInternalUnits()
 
 int SCH_SEXPR_PARSER::parseInternalUnits( const char* aExpected )
 {
-    auto retval = parseDouble( aExpected ) * IU_PER_MM;
+    NeedNUMBER( aExpected );
 
-    double int_limit = std::numeric_limits<int>::max() * 0.7071;
-
-    return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
+    return parseInternalUnits();
 }
 
 
@@ -21,14 +21,21 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <map>
+#include <set>
+#include <thread>
 
 // For some reason wxWidgets is built with wxUSE_BASE64 unset so expose the wxWidgets
 // base64 code.
 #define wxUSE_BASE64 1
 #include <wx/base64.h>
+#include <wx/ffile.h>
 #include <wx/log.h>
 #include <wx/mstream.h>
 #include <advanced_config.h>
+#include <cache_index_file.h>
 #include <trace_helpers.h>
 #include <locale_io.h>
 #include <sch_bitmap.h>
@@ -56,6 +63,7 @@
 #include <eeschema_id.h>       // for MAX_UNIT_COUNT_PER_PACKAGE definition
 #include <sch_file_versions.h>
 #include <schematic_lexer.h>
+#include <sch_plugins/kicad/sch_sexpr_lib_index.h>
 #include <sch_plugins/kicad/sch_sexpr_parser.h>
 #include <symbol_lib_table.h>  // for PropPowerSymsOnly definition.
 #include <ee_selection.h>
@@ -284,6 +292,136 @@ static void formatStroke( OUTPUTFORMATTER* aFormatter, int aNestLevel,
 }
 
 
+/**
+ * Libraries at least this large are only skimmed when loaded, and their symbols parsed when
+ * they are first needed.  Most projects use a handful of symbols of the large vendor libraries.
+ */
+static const long long LAZY_LOAD_MIN_FILE_SIZE = 1024 * 1024;
+
+
+/**
+ * A minimal s-expression scanner, just good enough to find the extent of the symbols of a
+ * library file.  It follows the rules of DSNLEXER but gives up (returning #END) on whatever
+ * it cannot handle: comment lines, unterminated strings and escape sequences other than the
+ * quote and the backslash.
+ */
+class SEXPR_SKIMMER
+{
+public:
+    enum TOKEN { LEFT, RIGHT, ATOM, END };
+
+    SEXPR_SKIMMER( const std::string& aData ) :
+            m_data( aData ),
+            m_pos( 0 ),
+            m_line( 1 )
+    {}
+
+    size_t Pos() const { return m_pos; }
+
+    /// The line of #Pos(), counted from 1.
+    int Line() const { return m_line; }
+
+    /**
+     * Read the next token.  Quoted strings are returned as atoms, unquoted and unescaped.
+     */
+    TOKEN Next( std::string& aAtom )
+    {
+        bool lineStart = ( m_pos == 0 );
+
+        while( m_pos < m_data.size() && isSpace( m_data[m_pos] ) )
+        {
+            if( m_data[m_pos] == '\n' )
+            {
+                lineStart = true;
+                m_line++;
+            }
+
+            m_pos++;
+        }
+
+        if( m_pos >= m_data.size() || ( lineStart && m_data[m_pos] == '#' ) )
+            return END;
+
+        char c = m_data[m_pos];
+
+        if( c == '(' || c == ')' )
+        {
+            m_pos++;
+            return c == '(' ? LEFT : RIGHT;
+        }
+
+        aAtom.clear();
+
+        if( c != '"' )
+        {
+            while( m_pos < m_data.size() && !isSpace( m_data[m_pos] )
+                    && m_data[m_pos] != '(' && m_data[m_pos] != ')' )
+            {
+                aAtom += m_data[m_pos++];
+            }
+
+            return ATOM;
+        }
+
+        // Strings cannot span lines
+        for( m_pos++; m_pos < m_data.size() && m_data[m_pos] != '\n'; m_pos++ )
+        {
+            c = m_data[m_pos];
+
+            if( c == '"' )
+            {
+                m_pos++;
+                return ATOM;
+            }
+
+            if( c == '\\' && m_pos + 1 < m_data.size() )
+            {
+                c = m_data[++m_pos];
+
+                if( c != '"' && c != '\\' )
+                    return END;
+            }
+
+            aAtom += c;
+        }
+
+        return END;
+    }
+
+    /**
+     * Skip the rest of the list whose opening parenthesis has just been read.
+     */
+    bool SkipList()
+    {
+        std::string atom;
+        int         depth = 1;
+
+        while( depth > 0 )
+        {
+            switch( Next( atom ) )
+            {
+            case LEFT:  depth++;      break;
+            case RIGHT: depth--;      break;
+            case ATOM:                break;
+            case END:   return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    static bool isSpace( char c )
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\0';
+    }
+
+    const std::string& m_data;
+    size_t             m_pos;
+    int                m_line;     // Strings cannot span lines, so only spaces count.
+};
+
+
 /**
  * A cache assistant for the symbol library portion of the #SCH_PLUGIN API, and only for the
  * #SCH_SEXPR_PLUGIN, so therefore is private to this implementation file, i.e. not placed
@@ -291,19 +429,67 @@ static void formatStroke( OUTPUTFORMATTER* aFormatter, int aNestLevel,
  */
 class SCH_SEXPR_PLUGIN_CACHE
 {
+    /// Where to find a symbol which has not been parsed yet in #m_fileData.
+    struct LAZY_SYMBOL
+    {
+        size_t   m_begin;       // Offset of the opening parenthesis of the symbol.
+        size_t   m_end;         // Offset just past its closing parenthesis.
+        int      m_line;        // Line of the opening parenthesis, counted from 1.
+        wxString m_parentName;  // Name of the parent of a derived symbol, empty for roots.
+        bool     m_isPower;
+    };
+
     static int      m_modHash;      // Keep track of the modification status of the library.
 
     wxString        m_fileName;     // Absolute path and file name.
     wxFileName      m_libFileName;  // Absolute path and file name is required here.
     wxDateTime      m_fileModTime;
-    LIB_SYMBOL_MAP  m_symbols;      // Map of names of #LIB_SYMBOL pointers.
+    LIB_SYMBOL_MAP  m_symbols;      // Map of names of #LIB_SYMBOL pointers, nullptr for the
+                                    // symbols still in #m_lazySymbols.
     bool            m_isWritable;
     bool            m_isModified;
     int             m_versionMajor;
     SCH_LIB_TYPE    m_libType;      // Is this cache a symbol or symbol library.
 
+    std::string     m_fileData;     // Contents of the library file while symbols are unparsed.
+    int             m_fileVersion;  // Format version of the library file.
+    std::map<wxString, LAZY_SYMBOL> m_lazySymbols;
+    int             m_lazyParseDepth; // Nesting of parseLazySymbol(), which parses parents first.
+    wxString        m_lazyLoadError; // Why a symbol failed to parse, which makes the whole cache
+                                     // unusable.
+
+    bool            m_haveFileStat; // Library file state at load time, for the index.
+    long long       m_fileStatModTime;
+    long long       m_fileStatSize;
+
     LIB_SYMBOL*       removeSymbol( LIB_SYMBOL* aAlias );
 
+    /**
+     * Read the library file and find the extent of each symbol without parsing it.
+     *
+     * @return false if the file is not laid out as expected, in which case nothing has been
+     *         loaded and the file has to be parsed the usual way.
+     */
+    bool            skimLib();
+    bool            skimSymbols( std::map<wxString, LAZY_SYMBOL>& aSymbols );
+
+    LIB_SYMBOL*     parseLazySymbol( const wxString& aName );
+
+    /**
+     * Put the cache in the state of a library which failed to parse: the symbols still
+     * unparsed are forgotten and every later access to the symbols throws \a aError, so that
+     * the library is never saved (or indexed) without them.
+     */
+    void            failLazyLoad( const wxString& aError );
+
+    /// @throw IO_ERROR if a symbol of the library failed to parse.
+    void            throwIfLazyLoadFailed() const;
+
+    /// Parse the symbols still unparsed, for everything that needs the whole library.
+    void            loadAllSymbols();
+
+    void            updateIndex();
+
     static void     saveSymbolDrawItem( LIB_ITEM* aItem, OUTPUTFORMATTER& aFormatter,
                                         int aNestLevel );
     static void     saveArc( LIB_ARC* aArc, OUTPUTFORMATTER& aFormatter, int aNestLevel = 0 );
@@ -340,6 +526,13 @@ public:
 
     void Load();
 
+    /**
+     * Get the symbol \a aName, parsing it (and its parent) first if it has not been yet.
+     *
+     * @return the symbol or nullptr if there is no symbol \a aName in the library.
+     */
+    LIB_SYMBOL* GetSymbol( const wxString& aName );
+
     void AddSymbol( const LIB_SYMBOL* aSymbol );
 
     void DeleteSymbol( const wxString& aName );
@@ -443,7 +636,19 @@ SCH_SHEET* SCH_SEXPR_PLUGIN::Load( const wxString& aFileName, SCHEMATIC* aSchema
 
         newSheet->SetFileName( relPath.GetFullPath() );
         m_rootSheet = newSheet.get();
-        loadHierarchy( newSheet.get() );
+
+        try
+        {
+            preloadHierarchy( newSheet.get() );
+            loadHierarchy( newSheet.get() );
+        }
+        catch( ... )
+        {
+            m_preloadedSheets.clear();
+            throw;
+        }
+
+        m_preloadedSheets.clear();
 
         // If we got here, the schematic loaded successfully.
         sheet = newSheet.release();
@@ -499,12 +704,44 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
         }
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            auto preloaded = m_preloadedSheets.find( fileName.GetFullPath() );
 
             try
             {
-                loadFile( fileName.GetFullPath(), aSheet );
+                if( preloaded != m_preloadedSheets.end() )
+                {
+                    // Already parsed by preloadHierarchy(): take over its screen and outcome.
+                    std::unique_ptr<SCH_SHEET> holder = std::move( preloaded->second.m_sheet );
+                    std::exception_ptr         error = preloaded->second.m_error;
+
+                    m_preloadedSheets.erase( preloaded );
+                    aSheet->SetScreen( holder->GetScreen() );
+
+                    // The parser gave the holder what loadFile() would have given aSheet: the
+                    // parent of the sub-sheets, and the root UUID of the sheet instances
+                    for( SCH_ITEM* item : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
+                        item->SetParent( aSheet );
+
+                    for( const SCH_SHEET_INSTANCE& instance :
+                            aSheet->GetScreen()->GetSheetInstances() )
+                    {
+                        if( instance.m_Path.size() > 0 )
+                        {
+                            const_cast<KIID&>( aSheet->m_Uuid ) = instance.m_Path[0];
+                            break;
+                        }
+                    }
+
+                    if( error )
+                        std::rethrow_exception( error );
+                }
+                else
+                {
+                    aSheet->SetScreen( new SCH_SCREEN( m_schematic ) );
+                    aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+
+                    loadFile( fileName.GetFullPath(), aSheet, m_progressReporter );
+                }
             }
             catch( const IO_ERROR& ioe )
             {
@@ -537,17 +774,129 @@ void SCH_SEXPR_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 }
 
 
-void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
+void SCH_SEXPR_PLUGIN::preloadHierarchy( SCH_SHEET* aRootSheet )
+{
+    m_preloadedSheets.clear();
+
+    wxFileName rootFileName = aRootSheet->GetFileName();
+
+    if( !rootFileName.IsAbsolute() )
+        rootFileName.MakeAbsolute( m_currentPath.top() );
+
+    std::set<wxString>    knownFiles = { rootFileName.GetFullPath() };
+    std::vector<wxString> level = { rootFileName.GetFullPath() };
+
+    // The files of a level are only known once the level above it has been parsed
+    while( !level.empty() )
+    {
+        std::vector<PRELOADED_SHEET*> preloaded;
+
+        for( const wxString& fileName : level )
+        {
+            PRELOADED_SHEET& sheet = m_preloadedSheets[fileName];
+
+            sheet.m_sheet = std::make_unique<SCH_SHEET>( m_schematic );
+            sheet.m_sheet->SetScreen( new SCH_SCREEN( m_schematic ) );
+            sheet.m_sheet->GetScreen()->SetFileName( fileName );
+            preloaded.push_back( &sheet );
+        }
+
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       level.size() );
+
+        std::atomic<size_t> nextSheet( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto load_lambda = [&]( PROGRESS_REPORTER* aReporter ) -> size_t
+        {
+            for( size_t i = nextSheet++; i < level.size(); i = nextSheet++ )
+            {
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
+                    break;
+
+                // Errors are reported by loadHierarchy(), when it gets to the sheet
+                try
+                {
+                    loadFile( level[i], preloaded[i]->m_sheet.get(), aReporter );
+                }
+                catch( ... )
+                {
+                    preloaded[i]->m_error = std::current_exception();
+                }
+            }
+
+            return 1;
+        };
+
+        if( parallelThreadCount <= 1 )
+        {
+            load_lambda( m_progressReporter );
+        }
+        else
+        {
+            // The progress reporter can only be updated from this thread
+            if( m_progressReporter )
+            {
+                m_progressReporter->Report( wxString::Format( _( "Loading %s..." ),
+                                                              level.front() ) );
+            }
+
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, load_lambda, nullptr );
+
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            {
+                // Here we balance returns with a 100ms timeout to allow UI updating
+                std::future_status status;
+                do
+                {
+                    if( m_progressReporter )
+                        m_progressReporter->KeepRefreshing();
+
+                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+                } while( status != std::future_status::ready );
+            }
+        }
+
+        if( m_progressReporter && m_progressReporter->IsCancelled() )
+            THROW_IO_ERROR( ( "Open cancelled by user." ) );
+
+        std::vector<wxString> nextLevel;
+
+        for( size_t ii = 0; ii < level.size(); ++ii )
+        {
+            wxString    path = wxFileName( level[ii] ).GetPath();
+            SCH_SCREEN* screen = preloaded[ii]->m_sheet->GetScreen();
+
+            for( SCH_ITEM* item : screen->Items().OfType( SCH_SHEET_T ) )
+            {
+                wxFileName fileName = static_cast<SCH_SHEET*>( item )->GetFileName();
+
+                if( !fileName.IsAbsolute() )
+                    fileName.MakeAbsolute( path );
+
+                if( knownFiles.insert( fileName.GetFullPath() ).second )
+                    nextLevel.push_back( fileName.GetFullPath() );
+            }
+        }
+
+        level = std::move( nextLevel );
+    }
+}
+
+
+void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet,
+                                 PROGRESS_REPORTER* aProgressReporter )
 {
-    FILE_LINE_READER reader( aFileName );
+    MMAP_LINE_READER reader( aFileName );
 
     size_t lineCount = 0;
 
-    if( m_progressReporter )
+    if( aProgressReporter )
     {
-        m_progressReporter->Report( wxString::Format( _( "Loading %s..." ), aFileName ) );
+        aProgressReporter->Report( wxString::Format( _( "Loading %s..." ), aFileName ) );
 
-        if( !m_progressReporter->KeepRefreshing() )
+        if( !aProgressReporter->KeepRefreshing() )
             THROW_IO_ERROR( ( "Open cancelled by user." ) );
 
         while( reader.ReadLine() )
@@ -556,7 +905,7 @@ void SCH_SEXPR_PLUGIN::loadFile( const wxString& aFileName, SCH_SHEET* aSheet )
         reader.Rewind();
     }
 
-    SCH_SEXPR_PARSER parser( &reader, m_progressReporter, lineCount );
+    SCH_SEXPR_PARSER parser( &reader, aProgressReporter, lineCount );
 
     parser.ParseSchematic( aSheet );
 }
@@ -1377,7 +1726,12 @@ SCH_SEXPR_PLUGIN_CACHE::SCH_SEXPR_PLUGIN_CACHE( const wxString& aFullPathAndFile
     m_fileName( aFullPathAndFileName ),
     m_libFileName( aFullPathAndFileName ),
     m_isWritable( true ),
-    m_isModified( false )
+    m_isModified( false ),
+    m_fileVersion( SEXPR_SYMBOL_LIB_FILE_VERSION ),
+    m_lazyParseDepth( 0 ),
+    m_haveFileStat( false ),
+    m_fileStatModTime( 0 ),
+    m_fileStatSize( 0 )
 {
     m_versionMajor = -1;
     m_libType      = SCH_LIB_TYPE::LT_EESCHEMA;
@@ -1499,6 +1853,8 @@ LIB_SYMBOL* SCH_SEXPR_PLUGIN_CACHE::removeSymbol( LIB_SYMBOL* aSymbol )
 
 void SCH_SEXPR_PLUGIN_CACHE::AddSymbol( const LIB_SYMBOL* aSymbol )
 {
+    loadAllSymbols();
+
     // aSymbol is cloned in SYMBOL_LIB::AddSymbol().  The cache takes ownership of aSymbol.
     wxString name = aSymbol->GetName();
     LIB_SYMBOL_MAP::iterator it = m_symbols.find( name );
@@ -1533,17 +1889,289 @@ void SCH_SEXPR_PLUGIN_CACHE::Load()
     wxLogTrace( traceSchLegacyPlugin, "Loading sexpr symbol library file '%s'",
                 m_libFileName.GetFullPath() );
 
-    FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+    // Taken before parsing, so that changes made meanwhile are not taken as indexed
+    m_haveFileStat = CACHE_INDEX_FILE::GetFileStat( m_fileName, m_fileStatModTime,
+                                                    m_fileStatSize );
 
-    SCH_SEXPR_PARSER parser( &reader );
+    // Small libraries are parsed at once, which reports any error in the file right away
+    if( !m_haveFileStat || m_fileStatSize < LAZY_LOAD_MIN_FILE_SIZE || !skimLib() )
+    {
+        FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+
+        SCH_SEXPR_PARSER parser( &reader );
+
+        parser.ParseLib( m_symbols );
+    }
 
-    parser.ParseLib( m_symbols );
     ++m_modHash;
 
     // Remember the file modification time of library file when the
     // cache snapshot was made, so that in a networked environment we will
     // reload the cache as needed.
     m_fileModTime = GetLibModificationTime();
+
+    // Otherwise done once the last symbol is parsed, the index needs all of them
+    if( m_lazySymbols.empty() )
+        updateIndex();
+}
+
+
+bool SCH_SEXPR_PLUGIN_CACHE::skimLib()
+{
+    wxFFile file( m_libFileName.GetFullPath(), wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return false;
+
+    m_fileData.resize( file.Length() );
+
+    std::map<wxString, LAZY_SYMBOL> symbols;
+
+    if( file.Read( &m_fileData[0], m_fileData.size() ) != m_fileData.size()
+            || !skimSymbols( symbols ) )
+    {
+        wxLogTrace( traceSchLegacyPlugin, "Cannot skim symbol library file '%s', parsing it.",
+                    m_libFileName.GetFullPath() );
+        m_fileData.clear();
+        m_fileData.shrink_to_fit();
+        return false;
+    }
+
+    for( std::pair<const wxString, LAZY_SYMBOL>& entry : symbols )
+    {
+        // Derived symbols are power symbols if their parent is one, see LIB_SYMBOL::IsPower()
+        auto parent = symbols.find( entry.second.m_parentName );
+
+        if( parent != symbols.end() )
+            entry.second.m_isPower = parent->second.m_isPower;
+
+        // The symbols which are already there stay
+        if( m_symbols.emplace( entry.first, nullptr ).second )
+            m_lazySymbols.insert( entry );
+    }
+
+    if( m_lazySymbols.empty() )
+    {
+        m_fileData.clear();
+        m_fileData.shrink_to_fit();
+    }
+
+    wxLogTrace( traceSchLegacyPlugin, "Skimmed %zu symbols of library file '%s'.",
+                m_lazySymbols.size(), m_libFileName.GetFullPath() );
+
+    return true;
+}
+
+
+bool SCH_SEXPR_PLUGIN_CACHE::skimSymbols( std::map<wxString, LAZY_SYMBOL>& aSymbols )
+{
+    SEXPR_SKIMMER lexer( m_fileData );
+    std::string   atom;
+    char*         end;
+
+    // Only the layout written by Save(): the header, then nothing but symbols
+    if( lexer.Next( atom ) != SEXPR_SKIMMER::LEFT || lexer.Next( atom ) != SEXPR_SKIMMER::ATOM
+            || atom != "kicad_symbol_lib"
+            || lexer.Next( atom ) != SEXPR_SKIMMER::LEFT
+            || lexer.Next( atom ) != SEXPR_SKIMMER::ATOM || atom != "version"
+            || lexer.Next( atom ) != SEXPR_SKIMMER::ATOM )
+    {
+        return false;
+    }
+
+    m_fileVersion = (int) strtol( atom.c_str(), &end, 10 );
+
+    // Newer files are left to the parser, which knows how to complain about them
+    if( *end || m_fileVersion > SEXPR_SYMBOL_LIB_FILE_VERSION
+            || lexer.Next( atom ) != SEXPR_SKIMMER::RIGHT
+            || lexer.Next( atom ) != SEXPR_SKIMMER::LEFT || !lexer.SkipList() )
+    {
+        return false;
+    }
+
+    for( SEXPR_SKIMMER::TOKEN token = lexer.Next( atom );  token != SEXPR_SKIMMER::RIGHT;
+            token = lexer.Next( atom ) )
+    {
+        std::string name;
+        LAZY_SYMBOL symbol;
+
+        symbol.m_begin = lexer.Pos() - 1;
+        symbol.m_line = lexer.Line();
+        symbol.m_isPower = false;
+
+        if( token != SEXPR_SKIMMER::LEFT || lexer.Next( atom ) != SEXPR_SKIMMER::ATOM
+                || atom != "symbol" || lexer.Next( name ) != SEXPR_SKIMMER::ATOM )
+        {
+            return false;
+        }
+
+        for( token = lexer.Next( atom );  token != SEXPR_SKIMMER::RIGHT;
+                token = lexer.Next( atom ) )
+        {
+            if( token != SEXPR_SKIMMER::LEFT || lexer.Next( atom ) != SEXPR_SKIMMER::ATOM )
+                return false;
+
+            if( atom == "extends" )
+            {
+                if( lexer.Next( atom ) != SEXPR_SKIMMER::ATOM )
+                    return false;
+
+                symbol.m_parentName = wxString::FromUTF8( atom.c_str() );
+
+                if( lexer.Next( atom ) != SEXPR_SKIMMER::RIGHT )
+                    return false;
+
+                continue;
+            }
+
+            if( atom == "power" )
+                symbol.m_isPower = true;
+
+            if( !lexer.SkipList() )
+                return false;
+        }
+
+        symbol.m_end = lexer.Pos();
+
+        // Named the way SCH_SEXPR_PARSER::ParseSymbol() does
+        LIB_ID id;
+
+        if( id.Parse( wxString::FromUTF8( name.c_str() ) ) >= 0 )
+            return false;
+
+        // As in SCH_SEXPR_PARSER::ParseLib(), the last symbol of a given name wins
+        aSymbols[id.GetLibItemName().wx_str()] = symbol;
+    }
+
+    return true;
+}
+
+
+LIB_SYMBOL* SCH_SEXPR_PLUGIN_CACHE::GetSymbol( const wxString& aName )
+{
+    throwIfLazyLoadFailed();
+
+    LIB_SYMBOL_MAP::iterator it = m_symbols.find( aName );
+
+    if( it == m_symbols.end() )
+        return nullptr;
+
+    if( !it->second && m_lazySymbols.count( aName ) )
+        return parseLazySymbol( aName );
+
+    return it->second;
+}
+
+
+LIB_SYMBOL* SCH_SEXPR_PLUGIN_CACHE::parseLazySymbol( const wxString& aName )
+{
+    auto lazyIt = m_lazySymbols.find( aName );
+
+    wxCHECK( lazyIt != m_lazySymbols.end(), nullptr );
+
+    LAZY_SYMBOL lazy = lazyIt->second;
+    LIB_SYMBOL* symbol = nullptr;
+
+    // Forgotten first so that a symbol derived from itself, even indirectly, fails to parse
+    // rather than recursing endlessly
+    m_lazySymbols.erase( lazyIt );
+    m_lazyParseDepth++;
+
+    try
+    {
+        // ParseSymbol() takes the parent of a derived symbol from m_symbols
+        if( !lazy.m_parentName.IsEmpty() )
+            GetSymbol( lazy.m_parentName );
+
+        // Read from the start of its line, so that parse errors report the line and column of
+        // the symbol in the file
+        size_t begin = lazy.m_begin;
+
+        while( begin > 0 && ( m_fileData[begin - 1] == ' ' || m_fileData[begin - 1] == '\t' ) )
+            begin--;
+
+        STRING_LINE_READER reader( m_fileData.substr( begin, lazy.m_end - begin ), m_fileName,
+                                   lazy.m_line - 1 );
+        SCH_SEXPR_PARSER   parser( &reader );
+
+        parser.NeedLEFT();
+        parser.NextTok();
+        symbol = parser.ParseSymbol( m_symbols, m_fileVersion );
+        m_symbols[aName] = symbol;
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        m_lazyParseDepth--;
+        failLazyLoad( ioe.What() );
+        throw;
+    }
+    catch( ... )
+    {
+        m_lazyParseDepth--;
+        failLazyLoad( wxString::Format( _( "Error loading symbol '%s' from library '%s'." ),
+                                        aName, m_fileName ) );
+        throw;
+    }
+
+    m_lazyParseDepth--;
+
+    // Not while the symbols derived from this one are still being parsed
+    if( m_lazySymbols.empty() && m_lazyParseDepth == 0 )
+    {
+        m_fileData.clear();
+        m_fileData.shrink_to_fit();
+        updateIndex();
+    }
+
+    return symbol;
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::failLazyLoad( const wxString& aError )
+{
+    // A derived symbol fails along with its parent, which is the one to report
+    if( m_lazyLoadError.IsEmpty() )
+        m_lazyLoadError = aError;
+
+    wxLogTrace( traceSchLegacyPlugin, "Cannot parse a symbol of library file '%s': %s",
+                m_libFileName.GetFullPath(), aError );
+
+    for( LIB_SYMBOL_MAP::iterator it = m_symbols.begin();  it != m_symbols.end(); )
+    {
+        if( it->second )
+            ++it;
+        else
+            it = m_symbols.erase( it );
+    }
+
+    m_lazySymbols.clear();
+    m_fileData.clear();
+    m_fileData.shrink_to_fit();
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::throwIfLazyLoadFailed() const
+{
+    if( !m_lazyLoadError.IsEmpty() )
+        THROW_IO_ERROR( m_lazyLoadError );
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::loadAllSymbols()
+{
+    throwIfLazyLoadFailed();
+
+    while( !m_lazySymbols.empty() )
+        GetSymbol( m_lazySymbols.begin()->first );
+}
+
+
+void SCH_SEXPR_PLUGIN_CACHE::updateIndex()
+{
+    SCH_SEXPR_LIB_INDEX index( m_fileName );
+
+    if( m_haveFileStat && !index.Read() )
+        index.Write( m_symbols, m_fileStatModTime, m_fileStatSize );
 }
 
 
@@ -1554,6 +2182,8 @@ void SCH_SEXPR_PLUGIN_CACHE::Save()
 
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
+    loadAllSymbols();
+
     // Write through symlinks, don't replace them.
     wxFileName fn = GetRealFile();
 
@@ -1591,6 +2221,12 @@ void SCH_SEXPR_PLUGIN_CACHE::Save()
 
     m_fileModTime = fn.GetModificationTime();
     m_isModified = false;
+
+    long long modTime;
+    long long size;
+
+    if( CACHE_INDEX_FILE::GetFileStat( m_fileName, modTime, size ) )
+        SCH_SEXPR_LIB_INDEX( m_fileName ).Write( m_symbols, modTime, size );
 }
 
 
@@ -2073,6 +2709,8 @@ void SCH_SEXPR_PLUGIN_CACHE::saveText( LIB_TEXT* aText, OUTPUTFORMATTER& aFormat
 
 void SCH_SEXPR_PLUGIN_CACHE::DeleteSymbol( const wxString& aSymbolName )
 {
+    loadAllSymbols();
+
     LIB_SYMBOL_MAP::iterator it = m_symbols.find( aSymbolName );
 
     if( it == m_symbols.end() )
@@ -2143,6 +2781,23 @@ bool SCH_SEXPR_PLUGIN::isBuffering( const PROPERTIES* aProperties )
 }
 
 
+bool SCH_SEXPR_PLUGIN::readLibIndex( const wxString& aLibraryFileName,
+                                     const PROPERTIES* aProperties, SCH_SEXPR_LIB_INDEX& aIndex )
+{
+    if( isBuffering( aProperties ) )
+        return false;
+
+    // A fully parsed cache is as good as the index, and up to date with unsaved changes
+    if( m_cache && m_cache->IsFile( aLibraryFileName ) && !m_cache->IsFileChanged()
+            && m_cache->m_lazySymbols.empty() )
+    {
+        return false;
+    }
+
+    return aIndex.Read();
+}
+
+
 int SCH_SEXPR_PLUGIN::GetModifyHash() const
 {
     if( m_cache )
@@ -2162,13 +2817,31 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( wxArrayString&    aSymbolNameList,
     bool powerSymbolsOnly = ( aProperties &&
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
 
+    SCH_SEXPR_LIB_INDEX index( aLibraryPath );
+
+    if( readLibIndex( aLibraryPath, aProperties, index ) )
+    {
+        for( const LIB_SYMBOL_INFO& symbol : index.GetSymbols() )
+        {
+            if( !powerSymbolsOnly || symbol.m_isPower )
+                aSymbolNameList.Add( symbol.m_name );
+        }
+
+        return;
+    }
+
     cacheLib( aLibraryPath, aProperties );
+    m_cache->throwIfLazyLoadFailed();
 
     const LIB_SYMBOL_MAP& symbols = m_cache->m_symbols;
 
     for( LIB_SYMBOL_MAP::const_iterator it = symbols.begin();  it != symbols.end();  ++it )
     {
-        if( !powerSymbolsOnly || it->second->IsPower() )
+        // No need to parse the symbols which are not parsed yet for their names
+        bool isPower = it->second ? it->second->IsPower()
+                                  : m_cache->m_lazySymbols.at( it->first ).m_isPower;
+
+        if( !powerSymbolsOnly || isPower )
             aSymbolNameList.Add( it->first );
     }
 }
@@ -2184,6 +2857,7 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( std::vector<LIB_SYMBOL*>& aSymbolList
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
 
     cacheLib( aLibraryPath, aProperties );
+    m_cache->loadAllSymbols();
 
     const LIB_SYMBOL_MAP& symbols = m_cache->m_symbols;
 
@@ -2195,6 +2869,41 @@ void SCH_SEXPR_PLUGIN::EnumerateSymbolLib( std::vector<LIB_SYMBOL*>& aSymbolList
 }
 
 
+void SCH_SEXPR_PLUGIN::EnumerateSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolInfoList,
+                                            const wxString&               aLibraryPath,
+                                            const PROPERTIES*             aProperties )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+
+    bool powerSymbolsOnly = ( aProperties &&
+                              aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
+
+    SCH_SEXPR_LIB_INDEX index( aLibraryPath );
+
+    if( readLibIndex( aLibraryPath, aProperties, index ) )
+    {
+        for( const LIB_SYMBOL_INFO& symbol : index.GetSymbols() )
+        {
+            if( !powerSymbolsOnly || symbol.m_isPower )
+                aSymbolInfoList.push_back( symbol );
+        }
+
+        return;
+    }
+
+    cacheLib( aLibraryPath, aProperties );
+    m_cache->loadAllSymbols();
+
+    const LIB_SYMBOL_MAP& symbols = m_cache->m_symbols;
+
+    for( LIB_SYMBOL_MAP::const_iterator it = symbols.begin();  it != symbols.end();  ++it )
+    {
+        if( !powerSymbolsOnly || it->second->IsPower() )
+            aSymbolInfoList.emplace_back( *it->second );
+    }
+}
+
+
 LIB_SYMBOL* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wxString& aSymbolName,
                                           const PROPERTIES* aProperties )
 {
@@ -2202,12 +2911,7 @@ LIB_SYMBOL* SCH_SEXPR_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wx
 
     cacheLib( aLibraryPath, aProperties );
 
-    LIB_SYMBOL_MAP::const_iterator it = m_cache->m_symbols.find( aSymbolName );
-
-    if( it == m_cache->m_symbols.end() )
-        return nullptr;
-
-    return it->second;
+    return m_cache->GetSymbol( aSymbolName );
 }
 
 
@@ -23,6 +23,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <exception>
+#include <map>
 #include <memory>
 #include <sch_io_mgr.h>
 #include <sch_file_versions.h>
@@ -47,6 +49,7 @@ struct SYMBOL_INSTANCE_REFERENCE;
 class PROPERTIES;
 class EE_SELECTION;
 class SCH_SEXPR_PLUGIN_CACHE;
+class SCH_SEXPR_LIB_INDEX;
 class LIB_SYMBOL;
 class SYMBOL_LIB;
 class BUS_ALIAS;
@@ -114,6 +117,9 @@ public:
     void EnumerateSymbolLib( std::vector<LIB_SYMBOL*>& aSymbolList,
                              const wxString&           aLibraryPath,
                              const PROPERTIES*         aProperties = nullptr ) override;
+    void EnumerateSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolInfoList,
+                              const wxString&               aLibraryPath,
+                              const PROPERTIES*             aProperties = nullptr ) override;
     LIB_SYMBOL* LoadSymbol( const wxString& aLibraryPath, const wxString& aAliasName,
                             const PROPERTIES* aProperties = nullptr ) override;
     void SaveSymbol( const wxString& aLibraryPath, const LIB_SYMBOL* aSymbol,
@@ -138,7 +144,19 @@ public:
 
 private:
     void loadHierarchy( SCH_SHEET* aSheet );
-    void loadFile( const wxString& aFileName, SCH_SHEET* aSheet );
+
+    /**
+     * Parse the sheet files of the hierarchy below \a aRootSheet ahead of loadHierarchy(),
+     * concurrently, one level of the hierarchy at a time.
+     *
+     * Each file is parsed once, into a screen of its own, by a parser of its own.  The screens
+     * are kept in #m_preloadedSheets for loadHierarchy() to adopt, in the same order and with
+     * the same sharing of screens and error reporting as if it had parsed them itself.
+     */
+    void preloadHierarchy( SCH_SHEET* aRootSheet );
+
+    void loadFile( const wxString& aFileName, SCH_SHEET* aSheet,
+                   PROGRESS_REPORTER* aProgressReporter );
 
     void saveSymbol( SCH_SYMBOL* aSymbol, SCH_SHEET_PATH* aSheetPath, int aNestLevel );
     void saveField( SCH_FIELD* aField, int aNestLevel );
@@ -156,6 +174,16 @@ private:
     void cacheLib( const wxString& aLibraryFileName, const PROPERTIES* aProperties );
     bool isBuffering( const PROPERTIES* aProperties );
 
+    /**
+     * Read the symbol index of \a aLibraryFileName into \a aIndex, when it can be used in
+     * place of the library cache.
+     *
+     * @return false if the cache is already loaded, if buffering, or if there is no index up
+     *         to date with the library file.
+     */
+    bool readLibIndex( const wxString& aLibraryFileName, const PROPERTIES* aProperties,
+                       SCH_SEXPR_LIB_INDEX& aIndex );
+
 protected:
     int                     m_version;          ///< Version of file being loaded.
     int                     m_nextFreeFieldId;
@@ -171,6 +199,16 @@ protected:
     OUTPUTFORMATTER*        m_out;              ///< The formatter for saving SCH_SCREEN objects.
     SCH_SEXPR_PLUGIN_CACHE* m_cache;
 
+    /// A sheet file parsed by preloadHierarchy()
+    struct PRELOADED_SHEET
+    {
+        std::unique_ptr<SCH_SHEET> m_sheet;     ///< Holds the screen the file was parsed into.
+        std::exception_ptr         m_error;     ///< What parsing the file threw, if anything.
+    };
+
+    /// Sheet files waiting to be adopted by loadHierarchy(), by full file name.
+    std::map<wxString, PRELOADED_SHEET> m_preloadedSheets;
+
     /// initialize PLUGIN like a constructor would.
     void init( SCHEMATIC* aSchematic, const PROPERTIES* aProperties = nullptr );
 };
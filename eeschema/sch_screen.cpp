@@ -58,17 +58,24 @@
 #include <tool/common_tools.h>
 
 #include <algorithm>
+#include <atomic>
 
 // TODO(JE) Debugging only
 #include <profile.h>
 #include "sch_bus_entry.h"
 
+
+// The last modification count given to any screen
+static std::atomic<int> s_modifyCount( 0 );
+
+
 SCH_SCREEN::SCH_SCREEN( EDA_ITEM* aParent ) :
     BASE_SCREEN( aParent, SCH_SCREEN_T ),
     m_fileFormatVersionAtLoad( 0 ),
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_modifyCount = ++s_modifyCount;
     m_refCount = 0;
     m_zoomInitialized = false;
     m_LastZoomLevel = 1.0;
@@ -127,6 +134,12 @@ void SCH_SCREEN::DecRefCount()
 }
 
 
+void SCH_SCREEN::IncModifyCount()
+{
+    m_modifyCount = ++s_modifyCount;
+}
+
+
 bool SCH_SCREEN::HasItems( KICAD_T aItemType ) const
 {
     EE_RTREE::EE_TYPE sheets = m_rtree.OfType( aItemType );
@@ -195,6 +208,9 @@ void SCH_SCREEN::Append( SCH_ITEM* aItem )
 
         m_rtree.insert( aItem );
         --m_modification_sync;
+
+        if( aItem->IsConnectable() )
+            IncModifyCount();
     }
 }
 
@@ -224,6 +240,8 @@ void SCH_SCREEN::Clear( bool aFree )
         m_rtree.clear();
     }
 
+    IncModifyCount();
+
     // Clear the project settings
     m_virtualPageNumber = m_pageCount = 1;
 
@@ -244,6 +262,7 @@ void SCH_SCREEN::FreeDrawList()
             } );
 
     m_rtree.clear();
+    IncModifyCount();
 
     for( auto item : delete_list )
         delete item;
@@ -261,6 +280,9 @@ bool SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
     bool retv = m_rtree.remove( aItem );
 
+    if( retv && aItem->IsConnectable() )
+        IncModifyCount();
+
     // Check if the library symbol for the removed schematic symbol is still required.
     if( retv && aItem->Type() == SCH_SYMBOL_T )
     {
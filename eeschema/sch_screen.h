@@ -147,6 +147,19 @@ public:
     void IncRefCount();
     int GetRefCount() const                                 { return m_refCount; }
 
+    /**
+     * Record a change to the connectable items of the screen.  Called when they are added or
+     * removed, when the pins of a symbol or a sheet are rebuilt, and by the undo paths.
+     */
+    void IncModifyCount();
+
+    /**
+     * Return the modification count, which clients caching data derived from the items compare
+     * with the count they last saw.  The counts of all screens come from a single sequence, so
+     * a screen allocated in place of another one never repeats one of its counts.
+     */
+    int GetModifyCount() const                              { return m_modifyCount; }
+
     /**
      * Return the number of times this screen is used.
      *
@@ -503,6 +516,8 @@ private:
     int         m_modification_sync;        // Inequality with SYMBOL_LIBS::GetModificationHash()
                                             // will trigger ResolveAll().
 
+    int         m_modifyCount;              // See GetModifyCount().
+
     bool        m_zoomInitialized;          // Set to true once the zoom value is initialized with
                                             // `InitZoom()`.
 
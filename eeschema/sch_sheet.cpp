@@ -297,6 +297,16 @@ void SCH_SHEET::SwapData( SCH_ITEM* aItem )
 }
 
 
+/**
+ * Record a change to the pins of \a aSheet on the screen holding it.
+ */
+static void pinsChanged( SCH_SHEET* aSheet )
+{
+    if( aSheet->GetParent() && aSheet->GetParent()->Type() == SCH_SCREEN_T )
+        static_cast<SCH_SCREEN*>( aSheet->GetParent() )->IncModifyCount();
+}
+
+
 void SCH_SHEET::AddPin( SCH_SHEET_PIN* aSheetPin )
 {
     wxASSERT( aSheetPin != nullptr );
@@ -305,6 +315,7 @@ void SCH_SHEET::AddPin( SCH_SHEET_PIN* aSheetPin )
     aSheetPin->SetParent( this );
     m_pins.push_back( aSheetPin );
     renumberPins();
+    pinsChanged( this );
 }
 
 
@@ -319,6 +330,7 @@ void SCH_SHEET::RemovePin( const SCH_SHEET_PIN* aSheetPin )
         {
             m_pins.erase( i );
             renumberPins();
+            pinsChanged( this );
             return;
         }
     }
@@ -488,9 +500,14 @@ void SCH_SHEET::CleanupSheet()
         }
 
         if( HLabel == nullptr )   // Hlabel not found: delete sheet label.
+        {
             i = m_pins.erase( i );
+            pinsChanged( this );
+        }
         else
+        {
             ++i;
+        }
     }
 }
 
@@ -288,6 +288,10 @@ void SCH_SYMBOL::UpdatePins()
     m_pins.clear();
     m_pinMap.clear();
 
+    // New pins may be allocated where the old ones were
+    if( GetParent() && GetParent()->Type() == SCH_SCREEN_T )
+        static_cast<SCH_SCREEN*>( GetParent() )->IncModifyCount();
+
     if( !m_part )
         return;
 
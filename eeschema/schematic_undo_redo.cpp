@@ -114,6 +114,9 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( SCH_SCREEN*    aScreen,
     // Connectivity may change
     aItem->SetConnectivityDirty();
 
+    if( aScreen )
+        aScreen->IncModifyCount();
+
     PICKED_ITEMS_LIST* lastUndo = PopCommandFromUndoList();
 
     // If the last stack was empty, use that one instead of creating a new stack
@@ -211,6 +214,12 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
         // Connectivity may change
         sch_item->SetConnectivityDirty();
 
+        SCH_SCREEN* screen =
+                dynamic_cast< SCH_SCREEN* >( commandToUndo->GetScreenForItem( ii ) );
+
+        if( screen )
+            screen->IncModifyCount();
+
         UNDO_REDO command = commandToUndo->GetPickedItemStatus( ii );
 
         if( command == UNDO_REDO::UNSPECIFIED )
@@ -273,6 +282,9 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList )
 
         wxCHECK( screen, /* void */ );
 
+        // Items are swapped and pins rebuilt in place; clients caching them must notice
+        screen->IncModifyCount();
+
         eda_item->SetFlags( aList->GetPickerFlags( (unsigned) ii ) );
         eda_item->ClearEditFlags();
         eda_item->ClearTempFlags();
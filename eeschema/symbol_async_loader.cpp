@@ -21,6 +21,7 @@
 #include <thread>
 
 #include <core/wx_stl_compat.h>
+#include <lib_symbol_info.h>
 #include <symbol_async_loader.h>
 #include <symbol_lib_table.h>
 #include <widgets/progress_reporter.h>
@@ -28,7 +29,7 @@
 
 SYMBOL_ASYNC_LOADER::SYMBOL_ASYNC_LOADER( const std::vector<wxString>& aNicknames,
         SYMBOL_LIB_TABLE* aTable, bool aOnlyPowerSymbols,
-        std::unordered_map<wxString, std::vector<LIB_SYMBOL*>>* aOutput,
+        std::unordered_map<wxString, std::vector<LIB_SYMBOL_INFO>>* aOutput,
         PROGRESS_REPORTER* aReporter ) :
         m_nicknames( aNicknames ),
         m_table( aTable ),
@@ -118,7 +119,16 @@ std::vector<SYMBOL_ASYNC_LOADER::LOADED_PAIR> SYMBOL_ASYNC_LOADER::worker()
 
         try
         {
-            m_table->LoadSymbolLib( pair.second, nickname, onlyPower );
+            if( m_output )
+            {
+                m_table->LoadSymbolInfo( pair.second, nickname, onlyPower );
+            }
+            else
+            {
+                std::vector<LIB_SYMBOL*> symbols;
+                m_table->LoadSymbolLib( symbols, nickname, onlyPower );
+            }
+
             ret.emplace_back( std::move( pair ) );
         }
         catch( const IO_ERROR& ioe )
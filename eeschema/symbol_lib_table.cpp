@@ -31,6 +31,7 @@
 #include <systemdirsappend.h>
 #include <symbol_lib_table.h>
 #include <lib_symbol.h>
+#include <lib_symbol_info.h>
 
 #define OPT_SEP     '|'         ///< options separator character
 
@@ -350,6 +351,33 @@ void SYMBOL_LIB_TABLE::LoadSymbolLib( std::vector<LIB_SYMBOL*>& aSymbolList,
 }
 
 
+void SYMBOL_LIB_TABLE::LoadSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolInfoList,
+                                       const wxString& aNickname, bool aPowerSymbolsOnly )
+{
+    SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname, true );
+    wxCHECK( row && row->plugin, /* void */  );
+
+    wxString options = row->GetOptions();
+
+    if( aPowerSymbolsOnly )
+        row->SetOptions( row->GetOptions() + " " + PropPowerSymsOnly );
+
+    size_t first = aSymbolInfoList.size();
+
+    row->SetLoaded( false );
+    row->plugin->EnumerateSymbolInfo( aSymbolInfoList, row->GetFullURI( true ),
+                                      row->GetProperties() );
+    row->SetLoaded( true );
+
+    if( aPowerSymbolsOnly )
+        row->SetOptions( options );
+
+    // Same as for LoadSymbolLib(): only the table knows the library nickname
+    for( size_t ii = first; ii < aSymbolInfoList.size(); ++ii )
+        aSymbolInfoList[ii].m_nickname = row->GetNickName();
+}
+
+
 LIB_SYMBOL* SYMBOL_LIB_TABLE::LoadSymbol( const wxString& aNickname, const wxString& aSymbolName )
 {
     SYMBOL_LIB_TABLE_ROW* row = FindRow( aNickname, true );
@@ -159,6 +159,20 @@ public:
     void LoadSymbolLib( std::vector<LIB_SYMBOL*>& aAliasList, const wxString& aNickname,
                         bool aPowerSymbolsOnly = false );
 
+    /**
+     * Return the summaries of the symbols contained within the library given by @a aNickname.
+     *
+     * Unlike LoadSymbolLib(), this doesn't need to load the symbols themselves when the
+     * library plugin keeps an index of the library.
+     *
+     * @param aSymbolInfoList is a reference to an array for the symbol summaries.
+     * @param aNickname is a locator for the "library", it is a "name" in LIB_TABLE_ROW.
+     * @param aPowerSymbolsOnly is a flag to enumerate only power symbols.
+     * @throw IO_ERROR if the library cannot be found or loaded.
+     */
+    void LoadSymbolInfo( std::vector<LIB_SYMBOL_INFO>& aSymbolInfoList,
+                         const wxString& aNickname, bool aPowerSymbolsOnly = false );
+
     /**
      * Load a #LIB_SYMBOL having @a aName from the library given by @a aNickname.
      *
@@ -28,6 +28,7 @@
 #include <eda_pattern_match.h>
 #include <generate_alias_info.h>
 #include <lib_symbol.h>
+#include <lib_symbol_info.h>
 #include <locale_io.h>
 #include <symbol_async_loader.h>
 #include <symbol_lib_table.h>
@@ -71,7 +72,7 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibraries( const std::vector<wxString>& aNick
     // Disable KIID generation: not needed for library parts; sometimes very slow
     KIID::CreateNilUuids( true );
 
-    std::unordered_map<wxString, std::vector<LIB_SYMBOL*>> loadedSymbols;
+    std::unordered_map<wxString, std::vector<LIB_SYMBOL_INFO>> loadedSymbols;
 
     SYMBOL_ASYNC_LOADER loader( aNicknames, m_libs,
                                 GetFilter() == LIB_TREE_MODEL_ADAPTER::SYM_FILTER_POWER,
@@ -113,9 +114,13 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibraries( const std::vector<wxString>& aNick
 
     if( loadedSymbols.size() > 0 )
     {
-        for( const std::pair<const wxString, std::vector<LIB_SYMBOL*>>& pair : loadedSymbols )
+        for( std::pair<const wxString, std::vector<LIB_SYMBOL_INFO>>& pair : loadedSymbols )
         {
-            std::vector<LIB_TREE_ITEM*> treeItems( pair.second.begin(), pair.second.end() );
+            std::vector<LIB_TREE_ITEM*> treeItems;
+
+            for( LIB_SYMBOL_INFO& symbol : pair.second )
+                treeItems.push_back( &symbol );
+
             DoAddLibrary( pair.first, m_libs->GetDescription( pair.first ), treeItems, false );
         }
     }
@@ -140,13 +145,13 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibraries( const std::vector<wxString>& aNick
 
 void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 {
-    bool                        onlyPowerSymbols = ( GetFilter() == SYM_FILTER_POWER );
-    std::vector<LIB_SYMBOL*>    symbols;
-    std::vector<LIB_TREE_ITEM*> comp_list;
+    bool                         onlyPowerSymbols = ( GetFilter() == SYM_FILTER_POWER );
+    std::vector<LIB_SYMBOL_INFO> symbols;
+    std::vector<LIB_TREE_ITEM*>  comp_list;
 
     try
     {
-        m_libs->LoadSymbolLib( symbols, aLibNickname, onlyPowerSymbols );
+        m_libs->LoadSymbolInfo( symbols, aLibNickname, onlyPowerSymbols );
     }
     catch( const IO_ERROR& ioe )
     {
@@ -158,7 +163,9 @@ void SYMBOL_TREE_MODEL_ADAPTER::AddLibrary( wxString const& aLibNickname )
 
     if( symbols.size() > 0 )
     {
-        comp_list.assign( symbols.begin(), symbols.end() );
+        for( LIB_SYMBOL_INFO& symbol : symbols )
+            comp_list.push_back( &symbol );
+
         DoAddLibrary( aLibNickname, m_libs->GetDescription( aLibNickname ), comp_list, false );
     }
 }
@@ -195,6 +195,24 @@ public:
      */
     bool m_HideVersionFromTitle;
 
+    /**
+     * Run the thread-safe DRC test providers concurrently.  Violations are still reported in
+     * provider order, so the results are identical to a serial run.
+     */
+    bool m_ConcurrentDRCProviders;
+
+    /**
+     * Re-test the items touched by each board commit (and the items within clearance range of
+     * them) and update their DRC markers.
+     */
+    bool m_IncrementalDRC;
+
+    /**
+     * Only refill zones whose outline, settings or nearby items have changed since they were
+     * last filled.
+     */
+    bool m_IncrementalZoneFill;
+
 private:
     ADVANCED_CFG();
 
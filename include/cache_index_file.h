@@ -0,0 +1,133 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef CACHE_INDEX_FILE_H
+#define CACHE_INDEX_FILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+ * The binary file of an index a library plugin keeps about one library, so that it does not
+ * have to parse the unchanged parts of the library again.
+ *
+ * Index files live in a subdirectory of the user cache directory, one file per library path.
+ * They are written in native byte order (the files never leave the machine) and start with
+ * a header:
+ *
+ *   char[8]   magic, including the terminating nul
+ *   uint32    format version
+ *   uint32    length of the library path, then the path itself in UTF-8
+ *
+ * The rest of the file belongs to the index, which reads it with the bounds-checked Read()
+ * and ReadString() and writes it with Append() and AppendString().  Strings are always
+ * stored as a uint32 length followed by the string in UTF-8.
+ *
+ * An index file is only a cache: a missing, damaged or mismatched one is no worse than no
+ * index at all.
+ */
+class CACHE_INDEX_FILE
+{
+public:
+    /**
+     * @param aKind is the name of the subdirectory of the user cache directory for this kind
+     *              of index.
+     * @param aMagic is the magic of this kind of index, 7 characters and a nul.
+     * @param aVersion is the version of the format of this kind of index.
+     * @param aLibraryPath is the library the index is about.
+     */
+    CACHE_INDEX_FILE( const wxString& aKind, const char* aMagic, uint32_t aVersion,
+                      const wxString& aLibraryPath );
+
+    wxString GetFilePath() const;
+
+    /**
+     * Read the index file and check its header.
+     *
+     * @return false if there is no index file, or if it is not for the same kind of index,
+     *         format version and library.
+     */
+    bool Load();
+
+    /**
+     * Start a new index file, holding only the header.
+     */
+    void Clear();
+
+    /**
+     * Write the index file.  The file is replaced at once, so that concurrent readers never
+     * see half an index.
+     *
+     * @return false if the file could not be written.
+     */
+    bool Save() const;
+
+    template <typename T>
+    bool Read( T& aValue )
+    {
+        if( m_data.size() - m_pos < sizeof( T ) )
+            return false;
+
+        memcpy( &aValue, m_data.data() + m_pos, sizeof( T ) );
+        m_pos += sizeof( T );
+        return true;
+    }
+
+    bool ReadString( wxString& aValue );
+
+    template <typename T>
+    void Append( T aValue )
+    {
+        const char* bytes = reinterpret_cast<const char*>( &aValue );
+
+        m_data.insert( m_data.end(), bytes, bytes + sizeof( T ) );
+    }
+
+    void AppendString( const wxString& aValue );
+
+    /**
+     * Get the modification time and size of the file \a aFilePath, which are what indexes
+     * compare to tell whether a file changed.
+     *
+     * The modification time is in nanoseconds since the epoch, with whatever resolution the
+     * platform and file system provide.  It is only meant to be compared with another one
+     * from this function.
+     *
+     * @return false if the file cannot be accessed.
+     */
+    static bool GetFileStat( const wxString& aFilePath, long long& aModTime, long long& aSize );
+
+private:
+    wxString          m_kind;
+    char              m_magic[8];
+    uint32_t          m_version;
+    wxString          m_libraryPath;
+    std::vector<char> m_data;
+    size_t            m_pos;        ///< Offset of the next Read() in m_data
+};
+
+#endif // CACHE_INDEX_FILE_H
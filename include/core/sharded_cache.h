@@ -0,0 +1,144 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __KICAD_SHARDED_CACHE_H
+#define __KICAD_SHARDED_CACHE_H
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+
+/**
+ * Hash for a pair of pointers, used to key item-to-item caches.
+ */
+struct POINTER_PAIR_HASH
+{
+    template <typename A, typename B>
+    std::size_t operator()( const std::pair<A*, B*>& aPair ) const
+    {
+        std::size_t seed = std::hash<A*>()( aPair.first );
+
+        seed ^= std::hash<B*>()( aPair.second ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+        return seed;
+    }
+};
+
+
+/**
+ * A key/value cache which can be read and written from many threads at once.
+ *
+ * Entries are spread over a fixed number of independently locked shards so that concurrent
+ * users rarely contend on the same lock, and locks are only held for the lookup or insertion
+ * itself (never while the value is being computed).
+ *
+ * Each entry belongs to an epoch (typically a modification counter of the owning document).
+ * Looking up or storing a value with a newer epoch discards the shard's older entries, so
+ * the cache can be invalidated simply by moving to a new epoch.
+ */
+template <typename KEY, typename VALUE, typename HASH = std::hash<KEY>, std::size_t SHARDS = 64>
+class SHARDED_CACHE
+{
+public:
+    SHARDED_CACHE() = default;
+
+    SHARDED_CACHE( const SHARDED_CACHE& ) = delete;
+    SHARDED_CACHE& operator=( const SHARDED_CACHE& ) = delete;
+
+    /**
+     * Look up \a aKey in epoch \a aEpoch.
+     *
+     * @return true and the cached value in \a aValue if present.
+     */
+    bool Get( const KEY& aKey, int aEpoch, VALUE& aValue )
+    {
+        std::size_t hash = m_hash( aKey );
+        SHARD&      shard = shardFor( hash );
+
+        std::lock_guard<std::mutex> lock( shard.m_mutex );
+
+        if( shard.m_epoch != aEpoch )
+            return false;
+
+        auto it = shard.m_map.find( aKey );
+
+        if( it == shard.m_map.end() )
+            return false;
+
+        aValue = it->second;
+        return true;
+    }
+
+    /**
+     * Store \a aValue for \a aKey in epoch \a aEpoch.  Values for older epochs are discarded.
+     */
+    void Set( const KEY& aKey, int aEpoch, const VALUE& aValue )
+    {
+        std::size_t hash = m_hash( aKey );
+        SHARD&      shard = shardFor( hash );
+
+        std::lock_guard<std::mutex> lock( shard.m_mutex );
+
+        if( shard.m_epoch != aEpoch )
+        {
+            shard.m_map.clear();
+            shard.m_epoch = aEpoch;
+        }
+
+        shard.m_map[ aKey ] = aValue;
+    }
+
+    /**
+     * Return the cached value for \a aKey, computing (and caching) it with \a aCompute if
+     * needed.  Concurrent callers may both compute a missing value; the results must agree.
+     */
+    template <typename FUNC>
+    VALUE GetOrCompute( const KEY& aKey, int aEpoch, FUNC&& aCompute )
+    {
+        VALUE value;
+
+        if( Get( aKey, aEpoch, value ) )
+            return value;
+
+        value = aCompute();
+        Set( aKey, aEpoch, value );
+        return value;
+    }
+
+private:
+    struct SHARD
+    {
+        std::mutex                           m_mutex;
+        int                                  m_epoch = -1;
+        std::unordered_map<KEY, VALUE, HASH> m_map;
+    };
+
+    SHARD& shardFor( std::size_t aHash )
+    {
+        // Mix the high bits in; pointer-based hashes are often poorly distributed in the low ones
+        return m_shards[ ( aHash ^ ( aHash >> 12 ) ^ ( aHash >> 24 ) ) % SHARDS ];
+    }
+
+    HASH                      m_hash;
+    std::array<SHARD, SHARDS> m_shards;
+};
+
+#endif
@@ -349,6 +349,27 @@ void StripTrailingZeros( wxString& aStringValue, unsigned aTrailingZeroAllowed =
  */
 std::string Double2Str( double aValue );
 
+/**
+ * Convert the decimal number \a aText to a whole number of 1/\a aScale units, exactly.
+ *
+ * This is a fast, locale independent alternative to strtod() for the numbers written in our
+ * s-expression files: a text in millimeters is converted straight to internal units (e.g.
+ * "1.27" with a scale of 1000000 gives 1270000) without rounding through a double.  Only plain
+ * decimal notation ([+-]digits[.digits]) is handled, and only when the result is a whole
+ * number of units.
+ *
+ * @return false if \a aText is anything else, in which case \a aResult is left untouched.
+ */
+bool ParseDecimalFixed( const char* aText, long long aScale, long long& aResult );
+
+/**
+ * Convert the decimal number \a aText to a double, with exactly the same result as strtod()
+ * in the C locale, for the numbers where that can be done quickly.
+ *
+ * @return false if \a aText is not plain decimal notation, or has too many digits.
+ */
+bool ParseDecimalDouble( const char* aText, double& aResult );
+
 /**
  * A helper to convert the \a double \a aAngle (in internal unit) to a string in degrees.
  */
@@ -234,6 +234,67 @@ protected:
 };
 
 
+/**
+ * A #LINE_READER that maps a whole file into memory and hands out its lines in place.
+ *
+ * Unlike #FILE_LINE_READER no line is ever copied into a buffer of its own: the nul ending
+ * each line temporarily replaces the first character of the next one, in a private
+ * (copy-on-write) mapping which leaves the file itself untouched.  The lines are therefore
+ * writable, like those of the other readers, but only until the next ReadLine().
+ *
+ * Lines keep their line terminator, including the '\r' of a CR/LF line ending.
+ *
+ * Reading a mapped file that another process truncates raises SIGBUS (or an in-page error on
+ * Windows) rather than an I/O error.  Files on network file systems, where that is most
+ * likely, are therefore read into memory in one go instead of being mapped.  A local file
+ * truncated while it is being read can still bring the process down.
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+public:
+    /**
+     * Map (or read, if it is on a network file system) the file @a aFileName.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the length of the longest line accepted.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or mapped.
+     */
+    MMAP_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber = 0,
+                      unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Go back to the start of the file and reset the line number back to zero.
+     */
+    void Rewind();
+
+    long int FileLength() const { return (long int) m_size; }
+    long int CurPos() const     { return (long int) m_ndx; }
+
+protected:
+    /// Put back the character overwritten by the nul ending the current line.
+    void restoreEndOfLine();
+
+    char*             m_data;       ///< the file contents, or nullptr if it is empty
+    size_t            m_size;       ///< no. bytes in the file
+    size_t            m_ndx;        ///< start of the next line
+    char*             m_nul;        ///< where the current line's nul went, or nullptr
+    char              m_savedChar;  ///< what m_nul overwrote
+    std::vector<char> m_lastLine;   ///< copy of a last line with no room for its nul
+    bool              m_mapped;     ///< m_data is a mapping, rather than m_buffer
+    std::vector<char> m_buffer;     ///< the contents of a file which isn't mapped
+
+#ifdef _WIN32
+    void*             m_mapping;    ///< file mapping object handle
+#endif
+};
+
+
 /**
  * Is a #LINE_READER that reads from a multiline 8 bit wide std::string
  */
@@ -253,8 +314,13 @@ public:
      * The last line does not necessarily need a trailing '\n'.
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaningful, such as wxT( "clipboard" ).
+     * @param aStartingLineNumber is the initial line number to report on error, for the
+     *  case where \a aString is an excerpt of a larger source.  Internally it is incremented
+     *  by one after each ReadLine(), so the first reported line number will always be one
+     *  greater than what is provided here.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Construct a string line reader.
@@ -0,0 +1,123 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_BOOLEAN_BUILDER_H
+#define __POLY_BOOLEAN_BUILDER_H
+
+#include <vector>
+
+#include <clipper.hpp>
+#include <geometry/shape_poly_set.h>
+#include <math/box2.h>
+
+
+/**
+ * Accumulates the operands of a boolean operation and carries it out in a single pass.
+ *
+ * Calling SHAPE_POLY_SET::BooleanAdd() or BooleanSubtract() once per item converts the
+ * (growing) result to Clipper paths and back every time.  The builder instead converts each
+ * operand once, when it is added, and keeps it in Clipper's integer form until the result is
+ * requested:
+ *
+ *     POLY_BOOLEAN_BUILDER builder;
+ *
+ *     builder.AddSubject( fill );
+ *
+ *     for( ZONE* zone : knockouts )
+ *         builder.AddClip( *zone->Outline() );
+ *
+ *     builder.Subtract( fill, SHAPE_POLY_SET::PM_FAST );
+ *
+ * Large sets of operands (thousands of pad and track knockouts) are unioned divide-and-conquer
+ * style: operands are sorted along x and merged in small neighbourhoods first, which keeps
+ * Clipper's active edge lists short.
+ *
+ * Arcs are not preserved; operands are taken as their polyline approximation, as they would
+ * be after SHAPE_POLY_SET::ClearArcs().
+ */
+class POLY_BOOLEAN_BUILDER
+{
+public:
+    POLY_BOOLEAN_BUILDER() {}
+
+    void AddSubject( const SHAPE_POLY_SET& aPolys );
+    void AddSubject( const SHAPE_LINE_CHAIN& aOutline );
+
+    void AddClip( const SHAPE_POLY_SET& aPolys );
+    void AddClip( const SHAPE_LINE_CHAIN& aOutline );
+
+    void Clear();
+
+    bool IsEmpty() const { return m_subject.empty() && m_clip.empty(); }
+
+    /**
+     * Store the union of all the subject and clip operands in \a aResult.
+     */
+    void Union( SHAPE_POLY_SET& aResult, SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const;
+
+    /**
+     * Store the subject operands minus the clip operands in \a aResult.
+     */
+    void Subtract( SHAPE_POLY_SET& aResult, SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const;
+
+    /**
+     * Store the intersection of the subject operands with the clip operands in \a aResult.
+     */
+    void Intersect( SHAPE_POLY_SET& aResult, SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const;
+
+    ///< Operand counts above which unions are split in halves
+    static const size_t DIVIDE_THRESHOLD = 256;
+
+private:
+    ///< The paths of one SHAPE_POLY_SET or SHAPE_LINE_CHAIN, with their bounding box
+    struct OPERAND
+    {
+        ClipperLib::Paths m_paths;
+        BOX2I             m_bbox;
+    };
+
+    static void addOperand( std::vector<OPERAND>& aOperands, const SHAPE_POLY_SET& aPolys );
+    static void addOperand( std::vector<OPERAND>& aOperands, const SHAPE_LINE_CHAIN& aOutline );
+
+    /**
+     * Union the operands in [\a aFirst, \a aLast) of \a aOperands (sorted along x) into
+     * \a aResult.
+     */
+    static void unionRange( const std::vector<const OPERAND*>& aOperands, size_t aFirst,
+                            size_t aLast, ClipperLib::Paths& aResult );
+
+    /**
+     * @return the paths of all \a aOperands, pre-unioned if there are many of them.
+     */
+    static ClipperLib::Paths mergedPaths( std::vector<const OPERAND*> aOperands );
+
+    static std::vector<const OPERAND*> pointers( const std::vector<OPERAND>& aOperands );
+
+    void execute( ClipperLib::ClipType aType, SHAPE_POLY_SET& aResult,
+                  SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const;
+
+    std::vector<OPERAND> m_subject;
+    std::vector<OPERAND> m_clip;
+};
+
+#endif // __POLY_BOOLEAN_BUILDER_H
@@ -47,8 +47,9 @@
 #define __POLYGON_TRIANGULATION_H
 
 #include <algorithm>
-#include <deque>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include <clipper.hpp>
 #include <geometry/shape_line_chain.h>
@@ -67,18 +68,30 @@ public:
     {
         m_bbox = aPoly.BBox();
         m_result.Clear();
+        m_vertices.clear();
 
         if( !m_bbox.GetWidth() || !m_bbox.GetHeight() )
             return false;
 
+        m_zScaleX = 32767.0 / m_bbox.GetWidth();
+        m_zScaleY = 32767.0 / m_bbox.GetHeight();
+
+        // Splitting the polygon adds a few vertices; leave some room for them
+        m_vertices.reserve( aPoly.PointCount() + aPoly.PointCount() / 8 + 16 );
+
         /// Place the polygon Vertices into a circular linked list
         /// and check for lists that have only 0, 1 or 2 elements and
         /// therefore cannot be polygons
-        Vertex* firstVertex = createList( aPoly );
-        if( !firstVertex || firstVertex->prev == firstVertex->next )
+        int32_t firstVertex = createList( aPoly );
+
+        if( firstVertex == NO_VERTEX
+                || m_vertices[firstVertex].prev == m_vertices[firstVertex].next )
+        {
             return false;
+        }
 
-        firstVertex->updateList();
+        updateList( firstVertex );
+        firstVertex = sortPool( firstVertex );
 
         auto retval = earcutList( firstVertex );
         m_vertices.clear();
@@ -86,174 +99,264 @@ public:
     }
 
 private:
+    ///< Null link value
+    enum : int32_t { NO_VERTEX = -1 };
+
+    /**
+     * A node of the linked lists.  Vertices live in a single pool (m_vertices) and are linked
+     * by their index in it, so the pool can grow while the lists are being cut up and the
+     * nodes stay small and contiguous.
+     */
     struct Vertex
     {
-        Vertex( size_t aIndex, double aX, double aY, PolygonTriangulation* aParent ) :
-                i( aIndex ),
+        Vertex( int32_t aIndex, double aX, double aY ) :
                 x( aX ),
                 y( aY ),
-                parent( aParent )
+                i( aIndex )
         {
         }
 
-        Vertex& operator=( const Vertex& ) = delete;
-        Vertex& operator=( Vertex&& ) = delete;
-
         bool operator==( const Vertex& rhs ) const
         {
             return this->x == rhs.x && this->y == rhs.y;
         }
         bool operator!=( const Vertex& rhs ) const { return !( *this == rhs ); }
 
-
         /**
-         * Split the referenced polygon between the reference point and
-         * vertex b, assuming they are in the same polygon.  Notes that while we
-         * create a new vertex pointer for the linked list, we maintain the same
-         * vertex index value from the original polygon.  In this way, we have
-         * two polygons that both share the same vertices.
-         *
-         * @return the newly created vertex in the polygon that does not include the
-         *         reference vertex.
+         * Check to see if triangle surrounds our current vertex
          */
-        Vertex* split( Vertex* b )
+        bool inTriangle( const Vertex& a, const Vertex& b, const Vertex& c ) const
         {
-            parent->m_vertices.emplace_back( i, x, y, parent );
-            Vertex* a2 = &parent->m_vertices.back();
-            parent->m_vertices.emplace_back( b->i, b->x, b->y, parent );
-            Vertex* b2 = &parent->m_vertices.back();
-            Vertex* an = next;
-            Vertex* bp = b->prev;
+            return     ( c.x - x ) * ( a.y - y ) - ( a.x - x ) * ( c.y - y ) >= 0
+                    && ( a.x - x ) * ( b.y - y ) - ( b.x - x ) * ( a.y - y ) >= 0
+                    && ( b.x - x ) * ( c.y - y ) - ( c.x - x ) * ( b.y - y ) >= 0;
+        }
 
-            next = b;
-            b->prev = this;
+        double  x;
+        double  y;
 
-            a2->next = an;
-            an->prev = a2;
+        // index of the point in the triangulated polygon
+        int32_t i;
 
-            b2->next = a2;
-            a2->prev = b2;
+        // previous and next vertices nodes in a polygon ring
+        int32_t prev = NO_VERTEX;
+        int32_t next = NO_VERTEX;
 
-            bp->next = b2;
-            b2->prev = bp;
+        // previous and next nodes in z-order
+        int32_t prevZ = NO_VERTEX;
+        int32_t nextZ = NO_VERTEX;
 
-            return b2;
-        }
+        // z-order curve value
+        int32_t z = 0;
+    };
 
-        /**
-         * Remove the node from the linked list and z-ordered linked list.
-         */
-        void remove()
-        {
-            next->prev = prev;
-            prev->next = next;
+    /**
+     * Split the referenced polygon between vertex a and vertex b, assuming they are in the
+     * same polygon.  Notes that while we create new vertex nodes for the linked list, we
+     * maintain the same vertex index value from the original polygon.  In this way, we have
+     * two polygons that both share the same vertices.
+     *
+     * @return the newly created vertex in the polygon that does not include vertex a.
+     */
+    int32_t split( int32_t a, int32_t b )
+    {
+        // Adding to the pool may move it, so copy what we need first
+        const Vertex aCopy = m_vertices[a];
+        const Vertex bCopy = m_vertices[b];
 
-            if( prevZ )
-                prevZ->nextZ = nextZ;
+        int32_t a2 = addVertex( aCopy.i, aCopy.x, aCopy.y );
+        int32_t b2 = addVertex( bCopy.i, bCopy.x, bCopy.y );
+        int32_t an = aCopy.next;
+        int32_t bp = bCopy.prev;
 
-            if( nextZ )
-                nextZ->prevZ = prevZ;
+        m_vertices[a].next = b;
+        m_vertices[b].prev = a;
 
-            next = nullptr;
-            prev = nullptr;
-            nextZ = nullptr;
-            prevZ = nullptr;
-        }
+        m_vertices[a2].next = an;
+        m_vertices[an].prev = a2;
 
-        void updateOrder()
-        {
-            if( !z )
-                z = parent->zOrder( x, y );
-        }
+        m_vertices[b2].next = a2;
+        m_vertices[a2].prev = b2;
 
-        /**
-         * After inserting or changing nodes, this function should be called to
-         * remove duplicate vertices and ensure z-ordering is correct.
-         */
-        void updateList()
-        {
-            Vertex* p = next;
+        m_vertices[bp].next = b2;
+        m_vertices[b2].prev = bp;
+
+        return b2;
+    }
+
+    /**
+     * Remove the node from the linked list and z-ordered linked list.
+     */
+    void remove( int32_t aVertex )
+    {
+        Vertex& p = m_vertices[aVertex];
+
+        m_vertices[p.next].prev = p.prev;
+        m_vertices[p.prev].next = p.next;
+
+        if( p.prevZ != NO_VERTEX )
+            m_vertices[p.prevZ].nextZ = p.nextZ;
+
+        if( p.nextZ != NO_VERTEX )
+            m_vertices[p.nextZ].prevZ = p.prevZ;
+
+        p.next = NO_VERTEX;
+        p.prev = NO_VERTEX;
+        p.nextZ = NO_VERTEX;
+        p.prevZ = NO_VERTEX;
+    }
+
+    void updateOrder( int32_t aVertex )
+    {
+        Vertex& p = m_vertices[aVertex];
+
+        if( !p.z )
+            p.z = zOrder( p.x, p.y );
+    }
 
-            while( p != this )
+    /**
+     * After inserting or changing nodes, this function should be called to
+     * remove duplicate vertices and ensure z-ordering is correct.
+     */
+    void updateList( int32_t aStart )
+    {
+        int32_t p = m_vertices[aStart].next;
+
+        while( p != aStart )
+        {
+            /**
+             * Remove duplicates
+             */
+            if( m_vertices[p] == m_vertices[m_vertices[p].next] )
             {
-                /**
-                 * Remove duplicates
-                 */
-                if( *p == *p->next )
-                {
-                    p = p->prev;
-                    p->next->remove();
+                p = m_vertices[p].prev;
+                remove( m_vertices[p].next );
 
-                    if( p == p->next )
-                        break;
-                }
+                if( p == m_vertices[p].next )
+                    break;
+            }
+
+            updateOrder( p );
+            p = m_vertices[p].next;
+        };
 
-                p->updateOrder();
-                p = p->next;
-            };
+        updateOrder( aStart );
+        zSort( aStart );
+    }
 
-            updateOrder();
-            zSort();
+    /**
+     * Sort all vertices in the list of \a aStart by their Morton code and link them in
+     * that order.
+     *
+     * Morton codes use 30 bits, so large lists are sorted with three 10-bit radix passes.
+     * The order of vertices with equal codes doesn't matter: isEar() scans all of them.
+     */
+    void zSort( int32_t aStart )
+    {
+        std::vector<int32_t>& queue = m_zQueue;
+
+        queue.clear();
+        queue.push_back( aStart );
+
+        for( int32_t p = m_vertices[aStart].next; p != NO_VERTEX && p != aStart;
+             p = m_vertices[p].next )
+        {
+            queue.push_back( p );
         }
 
-        /**
-         * Sort all vertices in this vertex's list by their Morton code.
-         */
-        void zSort()
+        auto zOf = [&]( int32_t aVertex ) { return m_vertices[aVertex].z; };
+
+        if( queue.size() < 256 )
         {
-            std::deque<Vertex*> queue;
+            std::sort( queue.begin(), queue.end(),
+                       [&]( int32_t a, int32_t b ) { return zOf( a ) < zOf( b ); } );
+        }
+        else
+        {
+            const int RADIX_BITS = 10;
+            const int BUCKETS = 1 << RADIX_BITS;
 
-            queue.push_back( this );
+            std::vector<int32_t>& sorted = m_zSorted;
+            size_t                counts[BUCKETS];
 
-            for( auto p = next; p && p != this; p = p->next )
-                queue.push_back( p );
+            sorted.resize( queue.size() );
 
-            std::sort( queue.begin(), queue.end(), []( const Vertex* a, const Vertex* b )
+            for( int shift = 0; shift < 30; shift += RADIX_BITS )
             {
-                return a->z < b->z;
-            } );
+                std::fill( counts, counts + BUCKETS, 0 );
 
-            Vertex* prev_elem = nullptr;
+                for( int32_t p : queue )
+                    counts[( zOf( p ) >> shift ) & ( BUCKETS - 1 )]++;
 
-            for( auto elem : queue )
-            {
-                if( prev_elem )
-                    prev_elem->nextZ = elem;
+                size_t offset = 0;
 
-                elem->prevZ = prev_elem;
-                prev_elem = elem;
-            }
+                for( size_t& count : counts )
+                {
+                    size_t bucketSize = count;
+                    count = offset;
+                    offset += bucketSize;
+                }
 
-            prev_elem->nextZ = nullptr;
+                for( int32_t p : queue )
+                    sorted[counts[( zOf( p ) >> shift ) & ( BUCKETS - 1 )]++] = p;
+
+                queue.swap( sorted );
+            }
         }
 
+        int32_t prev_elem = NO_VERTEX;
 
-        /**
-         * Check to see if triangle surrounds our current vertex
-         */
-        bool inTriangle( const Vertex& a, const Vertex& b, const Vertex& c )
+        for( int32_t elem : queue )
         {
-            return     ( c.x - x ) * ( a.y - y ) - ( a.x - x ) * ( c.y - y ) >= 0
-                    && ( a.x - x ) * ( b.y - y ) - ( b.x - x ) * ( a.y - y ) >= 0
-                    && ( b.x - x ) * ( c.y - y ) - ( c.x - x ) * ( b.y - y ) >= 0;
+            if( prev_elem != NO_VERTEX )
+                m_vertices[prev_elem].nextZ = elem;
+
+            m_vertices[elem].prevZ = prev_elem;
+            prev_elem = elem;
         }
 
-        const size_t i;
-        const double x;
-        const double y;
-        PolygonTriangulation* parent;
+        m_vertices[prev_elem].nextZ = NO_VERTEX;
+    }
 
-        // previous and next vertices nodes in a polygon ring
-        Vertex* prev = nullptr;
-        Vertex* next = nullptr;
+    /**
+     * Renumber the vertices of the list of \a aStart (which must be the only list in the pool,
+     * just z-sorted) so that the pool is in z-order.  Walking the z-order links in isEar()
+     * then reads memory sequentially.  Vertices already removed from the list are dropped.
+     *
+     * @return the new index of \a aStart.
+     */
+    int32_t sortPool( int32_t aStart )
+    {
+        const std::vector<int32_t>& order = m_zQueue;
+        std::vector<int32_t>&       newIndex = m_zSorted;
+        std::vector<Vertex>         sorted;
 
-        // z-order curve value
-        int32_t z = 0;
+        newIndex.assign( m_vertices.size(), NO_VERTEX );
+        sorted.reserve( m_vertices.capacity() );
 
-        // previous and next nodes in z-order
-        Vertex* prevZ = nullptr;
-        Vertex* nextZ = nullptr;
-    };
+        for( size_t ii = 0; ii < order.size(); ++ii )
+            newIndex[order[ii]] = static_cast<int32_t>( ii );
+
+        auto remap =
+                [&]( int32_t aVertex )
+                {
+                    return aVertex == NO_VERTEX ? NO_VERTEX : newIndex[aVertex];
+                };
+
+        for( int32_t old : order )
+        {
+            sorted.push_back( m_vertices[old] );
+
+            Vertex& v = sorted.back();
+            v.prev = remap( v.prev );
+            v.next = remap( v.next );
+            v.prevZ = remap( v.prevZ );
+            v.nextZ = remap( v.nextZ );
+        }
+
+        m_vertices.swap( sorted );
+        return newIndex[aStart];
+    }
 
     /**
      * Calculate the Morton code of the Vertex
@@ -262,8 +365,8 @@ private:
      */
     int32_t zOrder( const double aX, const double aY ) const
     {
-        int32_t x = static_cast<int32_t>( 32767.0 * ( aX - m_bbox.GetX() ) / m_bbox.GetWidth() );
-        int32_t y = static_cast<int32_t>( 32767.0 * ( aY - m_bbox.GetY() ) / m_bbox.GetHeight() );
+        int32_t x = static_cast<int32_t>( ( aX - m_bbox.GetX() ) * m_zScaleX );
+        int32_t y = static_cast<int32_t>( ( aY - m_bbox.GetY() ) * m_zScaleY );
 
         x = ( x | ( x << 8 ) ) & 0x00FF00FF;
         x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
@@ -285,31 +388,31 @@ private:
      * as the NULL triangles are inserted as Steiner points to improve the
      * triangulation regularity of polygons
      */
-    Vertex* removeNullTriangles( Vertex* aStart )
+    int32_t removeNullTriangles( int32_t aStart )
     {
-        Vertex* retval = nullptr;
-        Vertex* p = aStart->next;
+        int32_t retval = NO_VERTEX;
+        int32_t p = m_vertices[aStart].next;
 
         while( p != aStart )
         {
-            if( area( p->prev, p, p->next ) == 0.0 )
+            if( area( m_vertices[p].prev, p, m_vertices[p].next ) == 0.0 )
             {
-                p = p->prev;
-                p->next->remove();
+                p = m_vertices[p].prev;
+                remove( m_vertices[p].next );
                 retval = aStart;
 
-                if( p == p->next )
+                if( p == m_vertices[p].next )
                     break;
             }
-            p = p->next;
+            p = m_vertices[p].next;
         };
 
         // We needed an end point above that wouldn't be removed, so
         // here we do the final check for this as a Steiner point
-        if( area( aStart->prev, aStart, aStart->next ) == 0.0 )
+        if( area( m_vertices[aStart].prev, aStart, m_vertices[aStart].next ) == 0.0 )
         {
-            retval = p->next;
-            p->remove();
+            retval = m_vertices[p].next;
+            remove( p );
         }
 
         return retval;
@@ -318,9 +421,9 @@ private:
     /**
      * Take a Clipper path and converts it into a circular, doubly-linked list for triangulation.
      */
-    Vertex* createList( const ClipperLib::Path& aPath )
+    int32_t createList( const ClipperLib::Path& aPath )
     {
-        Vertex* tail = nullptr;
+        int32_t tail = NO_VERTEX;
         double sum = 0.0;
         auto len = aPath.size();
 
@@ -347,9 +450,9 @@ private:
             }
         }
 
-        if( tail && ( *tail == *tail->next ) )
+        if( tail != NO_VERTEX && ( m_vertices[tail] == m_vertices[m_vertices[tail].next] ) )
         {
-            tail->next->remove();
+            remove( m_vertices[tail].next );
         }
 
         return tail;
@@ -359,9 +462,9 @@ private:
     /**
      * Take a #SHAPE_LINE_CHAIN and links each point into a circular, doubly-linked list.
      */
-    Vertex* createList( const SHAPE_LINE_CHAIN& points )
+    int32_t createList( const SHAPE_LINE_CHAIN& points )
     {
-        Vertex* tail = nullptr;
+        int32_t tail = NO_VERTEX;
         double sum = 0.0;
 
         // Check for winding order
@@ -380,9 +483,9 @@ private:
             for( int i = 0; i < points.PointCount(); i++ )
                 tail = insertVertex( points.CPoint( i ), tail );
 
-        if( tail && ( *tail == *tail->next ) )
+        if( tail != NO_VERTEX && ( m_vertices[tail] == m_vertices[m_vertices[tail].next] ) )
         {
-            tail->next->remove();
+            remove( m_vertices[tail].next );
         }
 
         return tail;
@@ -401,43 +504,46 @@ private:
      * an edited file), we create a single triangle and remove both vertices before attempting
      * to.
      */
-    bool earcutList( Vertex* aPoint, int pass = 0 )
+    bool earcutList( int32_t aPoint, int pass = 0 )
     {
-        if( !aPoint )
+        if( aPoint == NO_VERTEX )
             return true;
 
-        Vertex* stop = aPoint;
-        Vertex* prev;
-        Vertex* next;
+        int32_t stop = aPoint;
+        int32_t prev;
+        int32_t next;
 
-        while( aPoint->prev != aPoint->next )
+        while( m_vertices[aPoint].prev != m_vertices[aPoint].next )
         {
-            prev = aPoint->prev;
-            next = aPoint->next;
+            prev = m_vertices[aPoint].prev;
+            next = m_vertices[aPoint].next;
 
             if( isEar( aPoint ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, next->i );
-                aPoint->remove();
+                m_result.AddTriangle( m_vertices[prev].i, m_vertices[aPoint].i,
+                                      m_vertices[next].i );
+                remove( aPoint );
 
                 // Skip one vertex as the triangle will account for the prev node
-                aPoint = next->next;
-                stop = next->next;
+                aPoint = m_vertices[next].next;
+                stop = m_vertices[next].next;
 
                 continue;
             }
 
-            Vertex* nextNext = next->next;
+            int32_t nextNext = m_vertices[next].next;
 
-            if( *prev != *nextNext && intersects( prev, aPoint, next, nextNext ) &&
-                    locallyInside( prev, nextNext ) &&
-                    locallyInside( nextNext, prev ) )
+            if( m_vertices[prev] != m_vertices[nextNext]
+                    && intersects( prev, aPoint, next, nextNext )
+                    && locallyInside( prev, nextNext )
+                    && locallyInside( nextNext, prev ) )
             {
-                m_result.AddTriangle( prev->i, aPoint->i, nextNext->i );
+                m_result.AddTriangle( m_vertices[prev].i, m_vertices[aPoint].i,
+                                      m_vertices[nextNext].i );
 
                 // remove two nodes involved
-                next->remove();
-                aPoint->remove();
+                remove( next );
+                remove( aPoint );
 
                 aPoint = nextNext;
                 stop = nextNext;
@@ -455,7 +561,9 @@ private:
             {
                 // First, try to remove the remaining steiner points
                 // If aPoint is a steiner, we need to re-assign both the start and stop points
-                if( auto newPoint = removeNullTriangles( aPoint ) )
+                int32_t newPoint = removeNullTriangles( aPoint );
+
+                if( newPoint != NO_VERTEX )
                 {
                     aPoint = newPoint;
                     stop = newPoint;
@@ -471,7 +579,7 @@ private:
         /*
          * At this point, our polygon should be fully tessellated.
          */
-        return( aPoint->prev == aPoint->next );
+        return( m_vertices[aPoint].prev == m_vertices[aPoint].next );
     }
 
     /**
@@ -483,11 +591,11 @@ private:
      *
      * @return true if aEar is the apex point of a ear in the polygon.
      */
-    bool isEar( Vertex* aEar ) const
+    bool isEar( int32_t aEar ) const
     {
-        const Vertex* a = aEar->prev;
-        const Vertex* b = aEar;
-        const Vertex* c = aEar->next;
+        const Vertex& a = m_vertices[m_vertices[aEar].prev];
+        const Vertex& b = m_vertices[aEar];
+        const Vertex& c = m_vertices[m_vertices[aEar].next];
 
         // If the area >=0, then the three points for a concave sequence
         // with b as the reflex point
@@ -495,39 +603,56 @@ private:
             return false;
 
         // triangle bbox
-        const double minTX = std::min( a->x, std::min( b->x, c->x ) );
-        const double minTY = std::min( a->y, std::min( b->y, c->y ) );
-        const double maxTX = std::max( a->x, std::max( b->x, c->x ) );
-        const double maxTY = std::max( a->y, std::max( b->y, c->y ) );
+        const double minTX = std::min( a.x, std::min( b.x, c.x ) );
+        const double minTY = std::min( a.y, std::min( b.y, c.y ) );
+        const double maxTX = std::max( a.x, std::max( b.x, c.x ) );
+        const double maxTY = std::max( a.y, std::max( b.y, c.y ) );
 
         // z-order range for the current triangle bounding box
         const int32_t minZ = zOrder( minTX, minTY );
         const int32_t maxZ = zOrder( maxTX, maxTY );
 
-        // first look for points inside the triangle in increasing z-order
-        Vertex* p = aEar->nextZ;
-
-        while( p && p->z <= maxZ )
+        // Cheap bounding box rejection first; most of the points in the z-order range are
+        // nowhere near the triangle
+        auto blocksEar =
+                [&]( const Vertex& p )
+                {
+                    return p.x >= minTX && p.x <= maxTX && p.y >= minTY && p.y <= maxTY
+                            && &p != &a && &p != &c
+                            && p.inTriangle( a, b, c )
+                            && area( m_vertices[p.prev], p, m_vertices[p.next] ) >= 0;
+                };
+
+        // look for points inside the triangle in both directions of z-order at once
+        int32_t p = b.prevZ;
+        int32_t n = b.nextZ;
+
+        while( p != NO_VERTEX && m_vertices[p].z >= minZ
+                && n != NO_VERTEX && m_vertices[n].z <= maxZ )
         {
-            if( p != a && p != c
-                    && p->inTriangle( *a, *b, *c )
-                    && area( p->prev, p, p->next ) >= 0 )
+            if( blocksEar( m_vertices[p] ) || blocksEar( m_vertices[n] ) )
                 return false;
 
-            p = p->nextZ;
+            p = m_vertices[p].prevZ;
+            n = m_vertices[n].nextZ;
         }
 
-        // then look for points in decreasing z-order
-        p = aEar->prevZ;
+        // then finish the remaining points in decreasing z-order
+        while( p != NO_VERTEX && m_vertices[p].z >= minZ )
+        {
+            if( blocksEar( m_vertices[p] ) )
+                return false;
+
+            p = m_vertices[p].prevZ;
+        }
 
-        while( p && p->z >= minZ )
+        // and in increasing z-order
+        while( n != NO_VERTEX && m_vertices[n].z <= maxZ )
         {
-            if( p != a && p != c
-                    && p->inTriangle( *a, *b, *c )
-                    && area( p->prev, p, p->next ) >= 0 )
+            if( blocksEar( m_vertices[n] ) )
                 return false;
 
-            p = p->prevZ;
+            n = m_vertices[n].nextZ;
         }
 
         return true;
@@ -539,33 +664,34 @@ private:
      * independently.  This is assured to generate at least one new ear if the
      * split is successful
      */
-    void splitPolygon( Vertex* start )
+    void splitPolygon( int32_t start )
     {
-        Vertex* origPoly = start;
+        int32_t origPoly = start;
 
         do
         {
-            Vertex* marker = origPoly->next->next;
+            int32_t marker = m_vertices[m_vertices[origPoly].next].next;
 
-            while( marker != origPoly->prev )
+            while( marker != m_vertices[origPoly].prev )
             {
                 // Find a diagonal line that is wholly enclosed by the polygon interior
-                if( origPoly->i != marker->i && goodSplit( origPoly, marker ) )
+                if( m_vertices[origPoly].i != m_vertices[marker].i
+                        && goodSplit( origPoly, marker ) )
                 {
-                    Vertex* newPoly = origPoly->split( marker );
+                    int32_t newPoly = split( origPoly, marker );
 
-                    origPoly->updateList();
-                    newPoly->updateList();
+                    updateList( origPoly );
+                    updateList( newPoly );
 
                     earcutList( origPoly );
                     earcutList( newPoly );
                     return;
                 }
 
-                marker = marker->next;
+                marker = m_vertices[marker].next;
             }
 
-            origPoly = origPoly->next;
+            origPoly = m_vertices[origPoly].next;
         } while( origPoly != start );
     }
 
@@ -577,10 +703,13 @@ private:
      * the segment is enclosed by the local triangles, we distinguish between
      * these two cases and no further checks are needed.
      */
-    bool goodSplit( const Vertex* a, const Vertex* b ) const
+    bool goodSplit( int32_t a, int32_t b ) const
     {
-        return a->next->i != b->i &&
-               a->prev->i != b->i &&
+        const Vertex& va = m_vertices[a];
+        const Vertex& vb = m_vertices[b];
+
+        return m_vertices[va.next].i != vb.i &&
+               m_vertices[va.prev].i != vb.i &&
                !intersectsPolygon( a, b ) &&
                locallyInside( a, b );
     }
@@ -588,9 +717,14 @@ private:
     /**
      * Return the twice the signed area of the triangle formed by vertices p, q, and r.
      */
-    double area( const Vertex* p, const Vertex* q, const Vertex* r ) const
+    double area( const Vertex& p, const Vertex& q, const Vertex& r ) const
+    {
+        return ( q.y - p.y ) * ( r.x - q.x ) - ( q.x - p.x ) * ( r.y - q.y );
+    }
+
+    double area( int32_t p, int32_t q, int32_t r ) const
     {
-        return ( q->y - p->y ) * ( r->x - q->x ) - ( q->x - p->x ) * ( r->y - q->y );
+        return area( m_vertices[p], m_vertices[q], m_vertices[r] );
     }
 
     /**
@@ -598,34 +732,44 @@ private:
      *
      * @return true if p1-p2 intersects q1-q2.
      */
-    bool intersects( const Vertex* p1, const Vertex* q1, const Vertex* p2, const Vertex* q2 ) const
+    bool intersects( const Vertex& p1, const Vertex& q1, const Vertex& p2, const Vertex& q2 ) const
     {
-        if( ( *p1 == *q1 && *p2 == *q2 ) || ( *p1 == *q2 && *p2 == *q1 ) )
+        if( ( p1 == q1 && p2 == q2 ) || ( p1 == q2 && p2 == q1 ) )
             return true;
 
         return ( area( p1, q1, p2 ) > 0 ) != ( area( p1, q1, q2 ) > 0 )
                 && ( area( p2, q2, p1 ) > 0 ) != ( area( p2, q2, q1 ) > 0 );
     }
 
+    bool intersects( int32_t p1, int32_t q1, int32_t p2, int32_t q2 ) const
+    {
+        return intersects( m_vertices[p1], m_vertices[q1], m_vertices[p2], m_vertices[q2] );
+    }
+
     /**
      * Check whether the segment from vertex a -> vertex b crosses any of the segments
      * of the polygon of which vertex a is a member.
      *
      * @return true if the segment intersects the edge of the polygon.
      */
-    bool intersectsPolygon( const Vertex* a, const Vertex* b ) const
+    bool intersectsPolygon( int32_t a, int32_t b ) const
     {
-        const Vertex* p = a->next;
+        const Vertex& va = m_vertices[a];
+        const Vertex& vb = m_vertices[b];
+        int32_t       p = va.next;
 
         do
         {
-            if( p->i != a->i &&
-                p->next->i != a->i &&
-                p->i != b->i &&
-                p->next->i != b->i && intersects( p, p->next, a, b ) )
+            const Vertex& vp = m_vertices[p];
+            const Vertex& vn = m_vertices[vp.next];
+
+            if( vp.i != va.i &&
+                vn.i != va.i &&
+                vp.i != vb.i &&
+                vn.i != vb.i && intersects( vp, vn, va, vb ) )
                 return true;
 
-            p = p->next;
+            p = vp.next;
         } while( p != a );
 
         return false;
@@ -640,45 +784,67 @@ private:
      *
      * @return true if the segment from a->b is inside a's polygon next to vertex a.
      */
-    bool locallyInside( const Vertex* a, const Vertex* b ) const
+    bool locallyInside( int32_t a, int32_t b ) const
     {
-        if( area( a->prev, a, a->next ) < 0 )
-            return area( a, b, a->next ) >= 0 && area( a, a->prev, b ) >= 0;
+        const Vertex& va = m_vertices[a];
+        const Vertex& vb = m_vertices[b];
+        const Vertex& prev = m_vertices[va.prev];
+        const Vertex& next = m_vertices[va.next];
+
+        if( area( prev, va, next ) < 0 )
+            return area( va, vb, next ) >= 0 && area( va, prev, vb ) >= 0;
         else
-            return area( a, b, a->prev ) < 0 || area( a, a->next, b ) < 0;
+            return area( va, vb, prev ) < 0 || area( va, next, vb ) < 0;
+    }
+
+    /**
+     * Add an unlinked vertex to the pool.
+     *
+     * @return the index of the new vertex.
+     */
+    int32_t addVertex( int32_t aIndex, double aX, double aY )
+    {
+        m_vertices.emplace_back( aIndex, aX, aY );
+        return static_cast<int32_t>( m_vertices.size() - 1 );
     }
 
     /**
      * Create an entry in the vertices lookup and optionally inserts the newly created vertex
      * into an existing linked list.
      *
-     * @return a pointer to the newly created vertex.
+     * @return the index of the newly created vertex.
      */
-    Vertex* insertVertex( const VECTOR2I& pt, Vertex* last )
+    int32_t insertVertex( const VECTOR2I& pt, int32_t last )
     {
         m_result.AddVertex( pt );
-        m_vertices.emplace_back( m_result.GetVertexCount() - 1, pt.x, pt.y, this );
 
-        Vertex* p = &m_vertices.back();
+        int32_t p = addVertex( m_result.GetVertexCount() - 1, pt.x, pt.y );
+        Vertex& vp = m_vertices[p];
 
-        if( !last )
+        if( last == NO_VERTEX )
         {
-            p->prev = p;
-            p->next = p;
+            vp.prev = p;
+            vp.next = p;
         }
         else
         {
-            p->next = last->next;
-            p->prev = last;
-            last->next->prev = p;
-            last->next = p;
+            Vertex& vl = m_vertices[last];
+
+            vp.next = vl.next;
+            vp.prev = last;
+            m_vertices[vl.next].prev = p;
+            vl.next = p;
         }
         return p;
     }
 
 private:
     BOX2I                                 m_bbox;
-    std::deque<Vertex>                    m_vertices;
+    double                                m_zScaleX;    ///< zOrder() scale factors
+    double                                m_zScaleY;
+    std::vector<Vertex>                   m_vertices;   ///< Pool of all the list nodes
+    std::vector<int32_t>                  m_zQueue;     ///< zSort() scratch buffers
+    std::vector<int32_t>                  m_zSorted;
     SHAPE_POLY_SET::TRIANGULATED_POLYGON& m_result;
 };
 
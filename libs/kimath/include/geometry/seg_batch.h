@@ -0,0 +1,138 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+
+class SHAPE_LINE_CHAIN_BASE;
+
+
+/**
+ * A block of segments stored as a structure of arrays, for testing one reference segment or
+ * point against many segments at once.
+ *
+ * Collision queries run in two phases.  A vectorized kernel first computes (exactly, in 64-bit
+ * lanes) the squared distance between the bounding box of the reference and the bounding box
+ * of each segment, which is a lower bound of the true distance.  Only the segments that pass
+ * this test are handed to the usual scalar SEG code, so results are identical to testing each
+ * segment in turn with SEG::SquaredDistance().
+ *
+ * The kernel is picked at run time from the best one supported by the CPU.
+ */
+class SEG_BATCH
+{
+public:
+    enum class KERNEL
+    {
+        SCALAR,
+        SSE4,
+        AVX2
+    };
+
+    SEG_BATCH();
+
+    /**
+     * Build a batch from all the segments of \a aChain.
+     */
+    explicit SEG_BATCH( const SHAPE_LINE_CHAIN_BASE& aChain );
+
+    void Clear();
+
+    void Reserve( size_t aCount );
+
+    void Add( const SEG& aSeg );
+
+    size_t Size() const { return m_segs.size(); }
+
+    const SEG& Segment( size_t aIndex ) const { return m_segs[aIndex]; }
+
+    /**
+     * Check if any segment of the batch lies closer to \a aSeg than \a aClearance.
+     *
+     * Behaves as SHAPE_LINE_CHAIN_BASE::Collide( const SEG& ) does for an open chain: when
+     * \a aActual or \a aLocation is requested the closest colliding segment is reported,
+     * otherwise the first collision found is.
+     */
+    bool Collide( const SEG& aSeg, int aClearance, int* aActual = nullptr,
+                  VECTOR2I* aLocation = nullptr ) const;
+
+    /**
+     * Check if any segment of the batch lies closer to \a aP than \a aClearance.
+     */
+    bool Collide( const VECTOR2I& aP, int aClearance, int* aActual = nullptr,
+                  VECTOR2I* aLocation = nullptr ) const;
+
+    /**
+     * Select the kernel used by this batch (mostly for testing and benchmarking).  Requesting
+     * a kernel the CPU does not support falls back to the best supported one.
+     */
+    void SetKernel( KERNEL aKernel );
+
+    KERNEL GetKernel() const { return m_kernel; }
+
+    /**
+     * @return the fastest kernel supported by the running CPU.
+     */
+    static KERNEL BestKernel();
+
+    static bool IsSupported( KERNEL aKernel );
+
+    static const char* KernelName( KERNEL aKernel );
+
+    /**
+     * Signature of a filter kernel: return the index of the first segment in
+     * [\a aStart, \a aCount) whose bounding box lies at a squared distance less than
+     * \a aThresholdSq from the box [\a aRefMin, \a aRefMax], or \a aCount if there is none.
+     */
+    typedef size_t ( *FILTER_FUNC )( const int32_t* aMinX, const int32_t* aMinY,
+                                     const int32_t* aMaxX, const int32_t* aMaxY,
+                                     size_t aStart, size_t aCount,
+                                     const VECTOR2I& aRefMin, const VECTOR2I& aRefMax,
+                                     int64_t aThresholdSq );
+
+private:
+    size_t nextCandidate( size_t aStart, const VECTOR2I& aRefMin, const VECTOR2I& aRefMax,
+                          int64_t aThresholdSq ) const
+    {
+        return m_filter( m_minX.data(), m_minY.data(), m_maxX.data(), m_maxY.data(), aStart,
+                         m_segs.size(), aRefMin, aRefMax, aThresholdSq );
+    }
+
+    std::vector<SEG>     m_segs;
+
+    ///< Segment bounding boxes, one array per coordinate
+    std::vector<int32_t> m_minX;
+    std::vector<int32_t> m_minY;
+    std::vector<int32_t> m_maxX;
+    std::vector<int32_t> m_maxY;
+
+    KERNEL               m_kernel;
+    FILTER_FUNC          m_filter;
+};
+
+#endif // __SEG_BATCH_H
@@ -167,8 +167,6 @@ public:
 
         for( auto pt : aV )
             m_points.emplace_back( pt.x, pt.y );
-
-        m_shapes = std::vector<std::pair<ssize_t, ssize_t>>( aV.size(), SHAPES_ARE_PT );
     }
 
     SHAPE_LINE_CHAIN( const std::vector<VECTOR2I>& aV, bool aClosed = false ) :
@@ -177,7 +175,6 @@ public:
             m_width( 0 )
     {
         m_points = aV;
-        m_shapes = std::vector<std::pair<ssize_t, ssize_t>>( aV.size(), SHAPES_ARE_PT );
     }
 
     SHAPE_LINE_CHAIN( const SHAPE_ARC& aArc, bool aClosed = false ) :
@@ -385,7 +382,8 @@ public:
     }
 
     /**
-     * @return the vector of values indicating shape type and location.
+     * @return the vector of values indicating shape type and location.  Empty for chains made
+     *         of straight segments only, which don't store shape indices.
      */
     const std::vector<std::pair<ssize_t, ssize_t>>& CShapes() const
     {
@@ -477,7 +475,10 @@ public:
         if( m_points.size() == 0 || aAllowDuplication || CPoint( -1 ) != aP )
         {
             m_points.push_back( aP );
-            m_shapes.push_back( SHAPES_ARE_PT );
+
+            if( !m_shapes.empty() )
+                m_shapes.push_back( SHAPES_ARE_PT );
+
             m_bbox.Merge( aP );
         }
     }
@@ -755,7 +756,7 @@ public:
         if( IsSharedPt( aSegment ) )
             return m_shapes[aSegment].second;
         else
-            return m_shapes[aSegment].first;
+            return shapeAt( aSegment ).first;
     }
 
     const SHAPE_ARC& Arc( size_t aArc ) const
@@ -770,7 +771,7 @@ public:
     */
     bool IsSharedPt( size_t aIndex ) const
     {
-        return aIndex < m_shapes.size() - 1
+        return aIndex + 1 < m_shapes.size()
                && m_shapes[aIndex].first != SHAPE_IS_PT
                && m_shapes[aIndex].second != SHAPE_IS_PT;
     }
@@ -791,8 +792,8 @@ public:
          */
         size_t nextIdx = aSegment + 1;
 
-        if( nextIdx > m_shapes.size() - 1 )
-            return false; // Always false, even if the shape is closed
+        if( nextIdx >= m_shapes.size() )
+            return false; // Always false, even if the shape is closed (or has no arcs)
 
         return ( IsPtOnArc( aSegment )
                  && ( IsSharedPt( aSegment )
@@ -865,6 +866,35 @@ protected:
                                        std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                        std::vector<SHAPE_ARC>&       aArcBuffer ) const;
 
+    /**
+     * @return the shape indices of point \a aIndex (SHAPES_ARE_PT in a chain without arcs).
+     */
+    const std::pair<ssize_t, ssize_t>& shapeAt( size_t aIndex ) const
+    {
+        return m_shapes.empty() ? SHAPES_ARE_PT : m_shapes[aIndex];
+    }
+
+    /**
+     * Allocate the shape indices of a chain without arcs, before storing arc references in them.
+     */
+    void expandShapes()
+    {
+        if( m_shapes.empty() )
+            m_shapes.assign( m_points.size(), SHAPES_ARE_PT );
+    }
+
+    /**
+     * Release the shape indices once the last arc has gone.
+     */
+    void compactShapes()
+    {
+        if( m_arcs.empty() )
+        {
+            m_shapes.clear();
+            m_shapes.shrink_to_fit();
+        }
+    }
+
 private:
 
     static const ssize_t SHAPE_IS_PT;
@@ -887,6 +917,9 @@ private:
      * is shared, then both the first and second element of the pair should be populated.
      *
      * The second element must always be SHAPE_IS_PT if the first element is SHAPE_IS_PT.
+     *
+     * Chains made of straight segments only (by far the most common ones) leave this empty,
+     * rather than storing SHAPES_ARE_PT for each point.  Otherwise it holds one entry per point.
      */
     std::vector<std::pair<ssize_t, ssize_t>> m_shapes;
 
@@ -28,6 +28,7 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <atomic>
 #include <cstdio>
 #include <deque>                        // for deque
 #include <vector>                       // for vector
@@ -59,7 +60,10 @@
  *      outline or a hole.
  *      - Vertex (or corner): each one of the points that define a contour.
  *
- * TODO: add convex partitioning & spatial index
+ * Large polygons which are queried repeatedly (point containment, distance and collision
+ * tests) get a spatial index of their edges, built on demand and dropped by any modification.
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -291,7 +295,7 @@ public:
 
         const T& Get()
         {
-            return m_poly->Polygon( m_currentPolygon )[m_currentContour].CPoint( m_currentVertex );
+            return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CPoint( m_currentVertex );
         }
 
         const T& operator*()
@@ -407,7 +411,9 @@ public:
 
         T Get()
         {
-            return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+            const SHAPE_LINE_CHAIN& contour = m_poly->CPolygon( m_currentPolygon )[m_currentContour];
+
+            return contour.CSegment( m_currentSegment );
         }
 
         T operator*()
@@ -497,7 +503,16 @@ public:
 
     SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& aOther );
 
-    void CacheTriangulation( bool aPartition = true );
+    /**
+     * Build (if out of date) the triangulation of the set.
+     *
+     * @param aPartition set to split the polygons into a regular grid of cells before
+     *                   tessellation, which keeps the ear-clipping of huge polygons fast.
+     * @param aParallel set to tessellate the outlines (or cells) concurrently.  The result is
+     *                  identical to the serial one; use it when the caller isn't already
+     *                  running on a worker thread.
+     */
+    void CacheTriangulation( bool aPartition = true, bool aParallel = false );
     bool IsTriangulationUpToDate() const;
 
     MD5_HASH GetHash() const;
@@ -659,9 +674,17 @@ public:
         return m_polys[aOutline].size() - 1;
     }
 
-    ///< Return the reference to aIndex-th outline in the set
+    /**
+     * Return the reference to aIndex-th outline in the set.
+     *
+     * The polygons may be modified through the references given out by Outline(), Hole() and
+     * Polygon() at any time, so these disable the edge index of the set until its polygons
+     * are rebuilt (by a boolean operation, RemoveAllContours() or an assignment).  Read-only
+     * code should use COutline(), CHole() and CPolygon() instead.
+     */
     SHAPE_LINE_CHAIN& Outline( int aIndex )
     {
+        exposePolygons();
         return m_polys[aIndex][0];
     }
 
@@ -689,12 +712,14 @@ public:
     ///< Return the reference to aHole-th hole in the aIndex-th outline
     SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
     {
+        exposePolygons();
         return m_polys[aOutline][aHole + 1];
     }
 
     ///< Return the aIndex-th subpolygon in the set
     POLYGON& Polygon( int aIndex )
     {
+        exposePolygons();
         return m_polys[aIndex];
     }
 
@@ -1418,6 +1443,38 @@ private:
 
     MD5_HASH checksum() const;
 
+    class EDGE_INDEX;
+
+    /**
+     * Return the edge index to use for queries on the \a aPolygonIndex-th polygon.
+     *
+     * The index covers the whole set; it is built once the set has been queried a few times
+     * since its last modification, and only if the queried polygon is large enough to make
+     * it worthwhile.  Safe to call from several threads at once.
+     *
+     * @return the index, or nullptr if the caller should search the edges linearly.
+     */
+    const EDGE_INDEX* edgeIndex( int aPolygonIndex ) const;
+
+    ///< Drop the edge index.  Must be called by anything which modifies the polygons.
+    void invalidateEdgeIndex()
+    {
+        m_edgeIndexQueries.store( 0, std::memory_order_relaxed );
+
+        if( m_edgeIndex.load( std::memory_order_relaxed ) )
+            freeEdgeIndex();
+    }
+
+    ///< Drop the edge index and don't build it again until the polygons are rebuilt, as they
+    ///< may be modified later through a non-const reference without the set knowing.
+    void exposePolygons()
+    {
+        invalidateEdgeIndex();
+        m_polygonsExposed = true;
+    }
+
+    void freeEdgeIndex();
+
 private:
     typedef std::vector<POLYGON> POLYSET;
 
@@ -1427,6 +1484,15 @@ private:
 
     bool     m_triangulationValid = false;
     MD5_HASH m_hash;
+
+    ///< Spatial index of the polygon edges (owned), or nullptr if not built
+    mutable std::atomic<EDGE_INDEX*> m_edgeIndex { nullptr };
+
+    ///< Number of queries since the last modification, to decide when to build the index
+    mutable std::atomic<int>         m_edgeIndexQueries { 0 };
+
+    ///< Non-const references to the polygons have been given out, see exposePolygons()
+    bool                             m_polygonsExposed = false;
 };
 
 #endif // __SHAPE_POLY_SET_H
@@ -0,0 +1,259 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <geometry/poly_boolean_builder.h>
+#include <geometry/shape_line_chain.h>
+
+
+/**
+ * Append \a aChain to \a aPaths, oriented as an outline or as a hole.  Clipper is run with
+ * the non-zero fill rule, so holes must wind the other way round from outlines.
+ */
+static void appendPath( ClipperLib::Paths& aPaths, const SHAPE_LINE_CHAIN& aChain,
+                        bool aOutline, BOX2I& aBBox, bool& aBBoxValid )
+{
+    const std::vector<VECTOR2I>& points = aChain.CPoints();
+
+    if( points.empty() )
+        return;
+
+    // Same orientation convention as SHAPE_LINE_CHAIN::convertToClipper()
+    bool reverse = ( aChain.Area( false ) >= 0 ) != aOutline;
+
+    aPaths.emplace_back();
+    ClipperLib::Path& path = aPaths.back();
+    path.reserve( points.size() );
+
+    for( size_t ii = 0; ii < points.size(); ++ii )
+    {
+        const VECTOR2I& pt = reverse ? points[points.size() - 1 - ii] : points[ii];
+
+        path.emplace_back( pt.x, pt.y, 0 );
+    }
+
+    BOX2I bbox = aChain.BBox();
+
+    if( aBBoxValid )
+        aBBox.Merge( bbox );
+    else
+        aBBox = bbox;
+
+    aBBoxValid = true;
+}
+
+
+void POLY_BOOLEAN_BUILDER::addOperand( std::vector<OPERAND>& aOperands,
+                                       const SHAPE_POLY_SET& aPolys )
+{
+    OPERAND operand;
+    bool    bboxValid = false;
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aPolys.CPolygon( ii );
+
+        for( size_t jj = 0; jj < poly.size(); ++jj )
+            appendPath( operand.m_paths, poly[jj], jj == 0, operand.m_bbox, bboxValid );
+    }
+
+    if( !operand.m_paths.empty() )
+        aOperands.push_back( std::move( operand ) );
+}
+
+
+void POLY_BOOLEAN_BUILDER::addOperand( std::vector<OPERAND>& aOperands,
+                                       const SHAPE_LINE_CHAIN& aOutline )
+{
+    OPERAND operand;
+    bool    bboxValid = false;
+
+    appendPath( operand.m_paths, aOutline, true, operand.m_bbox, bboxValid );
+
+    if( !operand.m_paths.empty() )
+        aOperands.push_back( std::move( operand ) );
+}
+
+
+void POLY_BOOLEAN_BUILDER::AddSubject( const SHAPE_POLY_SET& aPolys )
+{
+    addOperand( m_subject, aPolys );
+}
+
+
+void POLY_BOOLEAN_BUILDER::AddSubject( const SHAPE_LINE_CHAIN& aOutline )
+{
+    addOperand( m_subject, aOutline );
+}
+
+
+void POLY_BOOLEAN_BUILDER::AddClip( const SHAPE_POLY_SET& aPolys )
+{
+    addOperand( m_clip, aPolys );
+}
+
+
+void POLY_BOOLEAN_BUILDER::AddClip( const SHAPE_LINE_CHAIN& aOutline )
+{
+    addOperand( m_clip, aOutline );
+}
+
+
+void POLY_BOOLEAN_BUILDER::Clear()
+{
+    m_subject.clear();
+    m_clip.clear();
+}
+
+
+void POLY_BOOLEAN_BUILDER::unionRange( const std::vector<const OPERAND*>& aOperands,
+                                       size_t aFirst, size_t aLast, ClipperLib::Paths& aResult )
+{
+    ClipperLib::Clipper c;
+
+    if( aLast - aFirst <= DIVIDE_THRESHOLD )
+    {
+        for( size_t ii = aFirst; ii < aLast; ++ii )
+            c.AddPaths( aOperands[ii]->m_paths, ClipperLib::ptSubject, true );
+    }
+    else
+    {
+        size_t            mid = aFirst + ( aLast - aFirst ) / 2;
+        ClipperLib::Paths lower;
+        ClipperLib::Paths upper;
+
+        unionRange( aOperands, aFirst, mid, lower );
+        unionRange( aOperands, mid, aLast, upper );
+
+        c.AddPaths( lower, ClipperLib::ptSubject, true );
+        c.AddPaths( upper, ClipperLib::ptSubject, true );
+    }
+
+    c.Execute( ClipperLib::ctUnion, aResult, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
+}
+
+
+ClipperLib::Paths POLY_BOOLEAN_BUILDER::mergedPaths( std::vector<const OPERAND*> aOperands )
+{
+    ClipperLib::Paths paths;
+
+    if( aOperands.size() <= DIVIDE_THRESHOLD )
+    {
+        // Few enough to go straight into the final pass
+        for( const OPERAND* operand : aOperands )
+            paths.insert( paths.end(), operand->m_paths.begin(), operand->m_paths.end() );
+    }
+    else
+    {
+        // Neighbouring operands end up in the same (small) unions this way
+        std::sort( aOperands.begin(), aOperands.end(),
+                   []( const OPERAND* a, const OPERAND* b )
+                   {
+                       return a->m_bbox.GetX() < b->m_bbox.GetX();
+                   } );
+
+        unionRange( aOperands, 0, aOperands.size(), paths );
+    }
+
+    return paths;
+}
+
+
+std::vector<const POLY_BOOLEAN_BUILDER::OPERAND*>
+POLY_BOOLEAN_BUILDER::pointers( const std::vector<OPERAND>& aOperands )
+{
+    std::vector<const OPERAND*> ptrs;
+
+    ptrs.reserve( aOperands.size() );
+
+    for( const OPERAND& operand : aOperands )
+        ptrs.push_back( &operand );
+
+    return ptrs;
+}
+
+
+void POLY_BOOLEAN_BUILDER::execute( ClipperLib::ClipType aType, SHAPE_POLY_SET& aResult,
+                                    SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const
+{
+    ClipperLib::Clipper c;
+
+    c.StrictlySimple( aFastMode == SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
+    if( aType == ClipperLib::ctUnion )
+    {
+        std::vector<const OPERAND*> all = pointers( m_subject );
+        std::vector<const OPERAND*> clip = pointers( m_clip );
+
+        all.insert( all.end(), clip.begin(), clip.end() );
+        c.AddPaths( mergedPaths( all ), ClipperLib::ptSubject, true );
+    }
+    else
+    {
+        c.AddPaths( mergedPaths( pointers( m_subject ) ), ClipperLib::ptSubject, true );
+        c.AddPaths( mergedPaths( pointers( m_clip ) ), ClipperLib::ptClip, true );
+    }
+
+    ClipperLib::PolyTree solution;
+
+    c.Execute( aType, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
+
+    // All the points have a Z of 0: plain points, no arcs
+    std::vector<CLIPPER_Z_VALUE> zValues( 1 );
+    std::vector<SHAPE_ARC>       arcBuffer;
+
+    aResult.RemoveAllContours();
+
+    for( ClipperLib::PolyNode* n = solution.GetFirst(); n; n = n->GetNext() )
+    {
+        if( n->IsHole() )
+            continue;
+
+        int outline = aResult.AddOutline( SHAPE_LINE_CHAIN( n->Contour, zValues, arcBuffer ) );
+
+        for( ClipperLib::PolyNode* hole : n->Childs )
+            aResult.AddHole( SHAPE_LINE_CHAIN( hole->Contour, zValues, arcBuffer ), outline );
+    }
+}
+
+
+void POLY_BOOLEAN_BUILDER::Union( SHAPE_POLY_SET& aResult,
+                                  SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const
+{
+    execute( ClipperLib::ctUnion, aResult, aFastMode );
+}
+
+
+void POLY_BOOLEAN_BUILDER::Subtract( SHAPE_POLY_SET& aResult,
+                                     SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const
+{
+    execute( ClipperLib::ctDifference, aResult, aFastMode );
+}
+
+
+void POLY_BOOLEAN_BUILDER::Intersect( SHAPE_POLY_SET& aResult,
+                                      SHAPE_POLY_SET::POLYGON_MODE aFastMode ) const
+{
+    execute( ClipperLib::ctIntersection, aResult, aFastMode );
+}
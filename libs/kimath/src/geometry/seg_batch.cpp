@@ -0,0 +1,373 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape.h>
+
+// The vector kernels are built with per-function target attributes, so the rest of kimath
+// doesn't need to be compiled for a newer instruction set than the baseline.
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#define SEG_BATCH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Box-to-box gaps are clamped to this, so that their squares (and the sum of two of them)
+ * can't overflow.  Clamping keeps the result a lower bound of the real distance.
+ */
+static const int64_t MAX_GAP = INT32_MAX;
+
+
+static size_t filterScalar( const int32_t* aMinX, const int32_t* aMinY, const int32_t* aMaxX,
+                            const int32_t* aMaxY, size_t aStart, size_t aCount,
+                            const VECTOR2I& aRefMin, const VECTOR2I& aRefMax,
+                            int64_t aThresholdSq )
+{
+    for( size_t i = aStart; i < aCount; i++ )
+    {
+        int64_t dx = std::max( { int64_t( 0 ), int64_t( aRefMin.x ) - aMaxX[i],
+                                 int64_t( aMinX[i] ) - aRefMax.x } );
+        int64_t dy = std::max( { int64_t( 0 ), int64_t( aRefMin.y ) - aMaxY[i],
+                                 int64_t( aMinY[i] ) - aRefMax.y } );
+
+        dx = std::min( dx, MAX_GAP );
+        dy = std::min( dy, MAX_GAP );
+
+        if( dx * dx + dy * dy < aThresholdSq )
+            return i;
+    }
+
+    return aCount;
+}
+
+
+#ifdef SEG_BATCH_X86_KERNELS
+
+__attribute__(( target( "sse4.2" ) ))
+static inline __m128i gapSSE4( const int32_t* aMin, const int32_t* aMax, __m128i aRefMin,
+                               __m128i aRefMax, __m128i aZero, __m128i aLimit )
+{
+    __m128i lo = _mm_cvtepi32_epi64( _mm_loadl_epi64( (const __m128i*) aMin ) );
+    __m128i hi = _mm_cvtepi32_epi64( _mm_loadl_epi64( (const __m128i*) aMax ) );
+    __m128i g1 = _mm_sub_epi64( aRefMin, hi );
+    __m128i g2 = _mm_sub_epi64( lo, aRefMax );
+    __m128i gap = _mm_blendv_epi8( g2, g1, _mm_cmpgt_epi64( g1, g2 ) );
+
+    gap = _mm_and_si128( gap, _mm_cmpgt_epi64( gap, aZero ) );
+    return _mm_blendv_epi8( gap, aLimit, _mm_cmpgt_epi64( gap, aLimit ) );
+}
+
+
+__attribute__(( target( "sse4.2" ) ))
+static size_t filterSSE4( const int32_t* aMinX, const int32_t* aMinY, const int32_t* aMaxX,
+                          const int32_t* aMaxY, size_t aStart, size_t aCount,
+                          const VECTOR2I& aRefMin, const VECTOR2I& aRefMax,
+                          int64_t aThresholdSq )
+{
+    const __m128i refMinX = _mm_set1_epi64x( aRefMin.x );
+    const __m128i refMinY = _mm_set1_epi64x( aRefMin.y );
+    const __m128i refMaxX = _mm_set1_epi64x( aRefMax.x );
+    const __m128i refMaxY = _mm_set1_epi64x( aRefMax.y );
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i limit = _mm_set1_epi64x( MAX_GAP );
+    const __m128i threshold = _mm_set1_epi64x( aThresholdSq );
+
+    size_t i = aStart;
+
+    for( ; i + 2 <= aCount; i += 2 )
+    {
+        __m128i dx = gapSSE4( aMinX + i, aMaxX + i, refMinX, refMaxX, zero, limit );
+        __m128i dy = gapSSE4( aMinY + i, aMaxY + i, refMinY, refMaxY, zero, limit );
+
+        // The gaps are non-negative and fit in 32 bits, so a 32x32->64 multiply is exact
+        __m128i distSq = _mm_add_epi64( _mm_mul_epi32( dx, dx ), _mm_mul_epi32( dy, dy ) );
+        int     hits = _mm_movemask_pd( _mm_castsi128_pd( _mm_cmpgt_epi64( threshold, distSq ) ) );
+
+        if( hits )
+            return i + __builtin_ctz( hits );
+    }
+
+    return filterScalar( aMinX, aMinY, aMaxX, aMaxY, i, aCount, aRefMin, aRefMax,
+                         aThresholdSq );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static inline __m256i gapAVX2( const int32_t* aMin, const int32_t* aMax, __m256i aRefMin,
+                               __m256i aRefMax, __m256i aZero, __m256i aLimit )
+{
+    __m256i lo = _mm256_cvtepi32_epi64( _mm_loadu_si128( (const __m128i*) aMin ) );
+    __m256i hi = _mm256_cvtepi32_epi64( _mm_loadu_si128( (const __m128i*) aMax ) );
+    __m256i g1 = _mm256_sub_epi64( aRefMin, hi );
+    __m256i g2 = _mm256_sub_epi64( lo, aRefMax );
+    __m256i gap = _mm256_blendv_epi8( g2, g1, _mm256_cmpgt_epi64( g1, g2 ) );
+
+    gap = _mm256_and_si256( gap, _mm256_cmpgt_epi64( gap, aZero ) );
+    return _mm256_blendv_epi8( gap, aLimit, _mm256_cmpgt_epi64( gap, aLimit ) );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+static size_t filterAVX2( const int32_t* aMinX, const int32_t* aMinY, const int32_t* aMaxX,
+                          const int32_t* aMaxY, size_t aStart, size_t aCount,
+                          const VECTOR2I& aRefMin, const VECTOR2I& aRefMax,
+                          int64_t aThresholdSq )
+{
+    const __m256i refMinX = _mm256_set1_epi64x( aRefMin.x );
+    const __m256i refMinY = _mm256_set1_epi64x( aRefMin.y );
+    const __m256i refMaxX = _mm256_set1_epi64x( aRefMax.x );
+    const __m256i refMaxY = _mm256_set1_epi64x( aRefMax.y );
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i limit = _mm256_set1_epi64x( MAX_GAP );
+    const __m256i threshold = _mm256_set1_epi64x( aThresholdSq );
+
+    size_t i = aStart;
+
+    for( ; i + 4 <= aCount; i += 4 )
+    {
+        __m256i dx = gapAVX2( aMinX + i, aMaxX + i, refMinX, refMaxX, zero, limit );
+        __m256i dy = gapAVX2( aMinY + i, aMaxY + i, refMinY, refMaxY, zero, limit );
+
+        __m256i distSq = _mm256_add_epi64( _mm256_mul_epi32( dx, dx ),
+                                           _mm256_mul_epi32( dy, dy ) );
+        int     hits = _mm256_movemask_pd(
+                _mm256_castsi256_pd( _mm256_cmpgt_epi64( threshold, distSq ) ) );
+
+        if( hits )
+            return i + __builtin_ctz( hits );
+    }
+
+    return filterScalar( aMinX, aMinY, aMaxX, aMaxY, i, aCount, aRefMin, aRefMax,
+                         aThresholdSq );
+}
+
+#endif // SEG_BATCH_X86_KERNELS
+
+
+bool SEG_BATCH::IsSupported( KERNEL aKernel )
+{
+    switch( aKernel )
+    {
+    case KERNEL::SCALAR:
+        return true;
+
+#ifdef SEG_BATCH_X86_KERNELS
+    case KERNEL::SSE4:
+        return __builtin_cpu_supports( "sse4.2" );
+
+    case KERNEL::AVX2:
+        return __builtin_cpu_supports( "avx2" );
+#endif
+
+    default:
+        return false;
+    }
+}
+
+
+SEG_BATCH::KERNEL SEG_BATCH::BestKernel()
+{
+    static const KERNEL best = IsSupported( KERNEL::AVX2 ) ? KERNEL::AVX2
+                             : IsSupported( KERNEL::SSE4 ) ? KERNEL::SSE4
+                                                           : KERNEL::SCALAR;
+    return best;
+}
+
+
+const char* SEG_BATCH::KernelName( KERNEL aKernel )
+{
+    switch( aKernel )
+    {
+    case KERNEL::SCALAR: return "scalar";
+    case KERNEL::SSE4:   return "SSE4.2";
+    case KERNEL::AVX2:   return "AVX2";
+    default:             return "unknown";
+    }
+}
+
+
+SEG_BATCH::SEG_BATCH()
+{
+    SetKernel( BestKernel() );
+}
+
+
+SEG_BATCH::SEG_BATCH( const SHAPE_LINE_CHAIN_BASE& aChain )
+{
+    SetKernel( BestKernel() );
+    Reserve( aChain.GetSegmentCount() );
+
+    for( size_t i = 0; i < aChain.GetSegmentCount(); i++ )
+        Add( aChain.GetSegment( i ) );
+}
+
+
+void SEG_BATCH::SetKernel( KERNEL aKernel )
+{
+    if( !IsSupported( aKernel ) )
+        aKernel = BestKernel();
+
+    m_kernel = aKernel;
+
+    switch( aKernel )
+    {
+#ifdef SEG_BATCH_X86_KERNELS
+    case KERNEL::SSE4: m_filter = filterSSE4;   break;
+    case KERNEL::AVX2: m_filter = filterAVX2;   break;
+#endif
+    default:           m_filter = filterScalar; break;
+    }
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_segs.clear();
+    m_minX.clear();
+    m_minY.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+}
+
+
+void SEG_BATCH::Reserve( size_t aCount )
+{
+    m_segs.reserve( aCount );
+    m_minX.reserve( aCount );
+    m_minY.reserve( aCount );
+    m_maxX.reserve( aCount );
+    m_maxY.reserve( aCount );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    m_segs.push_back( aSeg );
+    m_minX.push_back( std::min( aSeg.A.x, aSeg.B.x ) );
+    m_minY.push_back( std::min( aSeg.A.y, aSeg.B.y ) );
+    m_maxX.push_back( std::max( aSeg.A.x, aSeg.B.x ) );
+    m_maxY.push_back( std::max( aSeg.A.y, aSeg.B.y ) );
+}
+
+
+bool SEG_BATCH::Collide( const SEG& aSeg, int aClearance, int* aActual,
+                         VECTOR2I* aLocation ) const
+{
+    const VECTOR2I refMin( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) );
+    const VECTOR2I refMax( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) );
+
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    SEG::ecoord clearance_sq = SEG::Square( aClearance );
+    VECTOR2I    nearest;
+
+    // Only segments closer than the clearance (or touching) can produce a collision.  Once one
+    // is found, only closer ones can change the result.
+    int64_t threshold = std::max( clearance_sq, SEG::ecoord( 1 ) );
+
+    for( size_t i = nextCandidate( 0, refMin, refMax, threshold ); i < m_segs.size();
+         i = nextCandidate( i + 1, refMin, refMax, threshold ) )
+    {
+        const SEG&  s = m_segs[i];
+        SEG::ecoord dist_sq = s.SquaredDistance( aSeg );
+
+        if( dist_sq < closest_dist_sq )
+        {
+            if( aLocation )
+                nearest = s.NearestPoint( aSeg );
+
+            closest_dist_sq = dist_sq;
+
+            if( closest_dist_sq == 0 )
+                break;
+
+            // If we're not looking for aActual then any collision will do
+            if( closest_dist_sq < clearance_sq && !aActual )
+                break;
+
+            threshold = std::min( threshold, int64_t( closest_dist_sq ) );
+        }
+    }
+
+    if( closest_dist_sq == 0 || closest_dist_sq < clearance_sq )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = sqrt( closest_dist_sq );
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool SEG_BATCH::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
+                         VECTOR2I* aLocation ) const
+{
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    SEG::ecoord clearance_sq = SEG::Square( aClearance );
+    VECTOR2I    nearest;
+
+    int64_t threshold = std::max( clearance_sq, SEG::ecoord( 1 ) );
+
+    for( size_t i = nextCandidate( 0, aP, aP, threshold ); i < m_segs.size();
+         i = nextCandidate( i + 1, aP, aP, threshold ) )
+    {
+        VECTOR2I    pn = m_segs[i].NearestPoint( aP );
+        SEG::ecoord dist_sq = ( pn - aP ).SquaredEuclideanNorm();
+
+        if( dist_sq < closest_dist_sq )
+        {
+            nearest = pn;
+            closest_dist_sq = dist_sq;
+
+            if( closest_dist_sq == 0 )
+                break;
+
+            // If we're not looking for aActual then any collision will do
+            if( closest_dist_sq < clearance_sq && !aActual )
+                break;
+
+            threshold = std::min( threshold, int64_t( closest_dist_sq ) );
+        }
+    }
+
+    if( closest_dist_sq == 0 || closest_dist_sq < clearance_sq )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = sqrt( closest_dist_sq );
+
+        return true;
+    }
+
+    return false;
+}
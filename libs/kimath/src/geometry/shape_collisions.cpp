@@ -27,6 +27,7 @@
 #include <limits.h>                               // for INT_MAX
 
 #include <geometry/seg.h>                         // for SEG
+#include <geometry/seg_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
@@ -286,6 +287,13 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 }
 
 
+/**
+ * Chains with fewer segments than this are tested one segment at a time, as building a
+ * #SEG_BATCH for them costs more than it saves.
+ */
+static const size_t SEG_BATCH_MIN_SEGMENTS = 16;
+
+
 static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CHAIN_BASE& aB,
                             int aClearance, int* aActual, VECTOR2I* aLocation, VECTOR2I* aMTV )
 {
@@ -303,14 +311,40 @@ static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CH
     }
     else
     {
+        // Test each segment of aB against all of aA's at once rather than one pair at a time
+        bool      useBatch = aA.GetSegmentCount() >= SEG_BATCH_MIN_SEGMENTS;
+        SEG_BATCH batchA;
+
+        if( useBatch )
+            batchA = SEG_BATCH( aA );
+
         for( size_t i = 0; i < aB.GetSegmentCount(); i++ )
         {
             int collision_dist = 0;
             VECTOR2I pn;
+            SEG seg = aB.GetSegment( i );
+            bool collided;
 
-            if( aA.Collide( aB.GetSegment( i ), aClearance,
-                            aActual || aLocation ? &collision_dist : nullptr,
-                            aLocation ? &pn : nullptr ) )
+            if( !useBatch )
+            {
+                collided = aA.Collide( seg, aClearance,
+                                       aActual || aLocation ? &collision_dist : nullptr,
+                                       aLocation ? &pn : nullptr );
+            }
+            // Same as aA.Collide( seg, ... ), which checks for containment first
+            else if( aA.IsClosed() && aA.PointInside( seg.A ) )
+            {
+                pn = seg.A;
+                collided = true;
+            }
+            else
+            {
+                collided = batchA.Collide( seg, aClearance,
+                                           aActual || aLocation ? &collision_dist : nullptr,
+                                           aLocation ? &pn : nullptr );
+            }
+
+            if( collided )
             {
                 if( collision_dist < closest_dist )
                 {
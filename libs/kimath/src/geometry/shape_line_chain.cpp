@@ -63,7 +63,6 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const ClipperLib::Path&             aPath,
 {
     std::map<ssize_t, ssize_t> loadedArcs;
     m_points.reserve( aPath.size() );
-    m_shapes.reserve( aPath.size() );
 
     auto loadArc =
         [&]( ssize_t aArcIndex ) -> ssize_t
@@ -85,8 +84,19 @@ SHAPE_LINE_CHAIN::SHAPE_LINE_CHAIN( const ClipperLib::Path&             aPath,
     {
         Append( aPath[ii].X, aPath[ii].Y );
 
-        m_shapes[ii].first = loadArc( aZValueBuffer[aPath[ii].Z].m_FirstArcIdx );
-        m_shapes[ii].second = loadArc( aZValueBuffer[aPath[ii].Z].m_SecondArcIdx );
+        const CLIPPER_Z_VALUE& zValue = aZValueBuffer[aPath[ii].Z];
+
+        // Plain points don't need shape indices until the first arc shows up
+        if( m_shapes.empty() && zValue.m_FirstArcIdx == SHAPE_IS_PT
+                && zValue.m_SecondArcIdx == SHAPE_IS_PT )
+        {
+            continue;
+        }
+
+        expandShapes();
+
+        m_shapes[ii].first = loadArc( zValue.m_FirstArcIdx );
+        m_shapes[ii].second = loadArc( zValue.m_SecondArcIdx );
     }
 }
 
@@ -108,7 +118,7 @@ ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation,
     {
         const VECTOR2I& vertex = input.CPoint( i );
 
-        CLIPPER_Z_VALUE z_value( input.m_shapes[i], shape_offset );
+        CLIPPER_Z_VALUE z_value( input.shapeAt( i ), shape_offset );
         size_t          z_value_ptr = aZValueBuffer.size();
         aZValueBuffer.push_back( z_value );
 
@@ -170,7 +180,7 @@ void SHAPE_LINE_CHAIN::amendArc( size_t aArcIndex, const VECTOR2I& aNewStart,
 void SHAPE_LINE_CHAIN::splitArc( ssize_t aPtIndex, bool aCoincident )
 {
     if( aPtIndex < 0 )
-        aPtIndex += m_shapes.size();
+        aPtIndex += m_points.size();
 
     if( !IsSharedPt( aPtIndex ) && IsArcStart( aPtIndex ) )
         return; // Nothing to do
@@ -406,6 +416,8 @@ void SHAPE_LINE_CHAIN::ClearArcs()
 {
     for( ssize_t arcIndex = m_arcs.size() - 1; arcIndex >= 0; --arcIndex )
         convertArc( arcIndex );
+
+    compactShapes();
 }
 
 
@@ -457,7 +469,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
 {
     Remove( aStartIndex, aEndIndex );
     Insert( aStartIndex, aP );
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -493,32 +505,42 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
     if( !newLine.PointCount() )
         return;
 
-    // The total new arcs index is added to the new arc indices
-    size_t prev_arc_count = m_arcs.size();
-    std::vector<std::pair<ssize_t, ssize_t>> new_shapes = newLine.m_shapes;
+    // Shape indices are only needed if either chain has some
+    if( !newLine.m_shapes.empty() )
+        expandShapes();
+    else if( !m_shapes.empty() )
+        newLine.expandShapes();
 
-    for( std::pair<ssize_t, ssize_t>& shape_pair : new_shapes )
+    if( !newLine.m_shapes.empty() )
     {
-        alg::run_on_pair( shape_pair,
-            [&]( ssize_t& aShape )
-            {
-                if( aShape != SHAPE_IS_PT )
-                    aShape += prev_arc_count;
-            } );
+        // The total new arcs index is added to the new arc indices
+        size_t prev_arc_count = m_arcs.size();
+        std::vector<std::pair<ssize_t, ssize_t>> new_shapes = newLine.m_shapes;
+
+        for( std::pair<ssize_t, ssize_t>& shape_pair : new_shapes )
+        {
+            alg::run_on_pair( shape_pair,
+                [&]( ssize_t& aShape )
+                {
+                    if( aShape != SHAPE_IS_PT )
+                        aShape += prev_arc_count;
+                } );
+        }
+
+        m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
     }
 
-    m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
     m_points.insert( m_points.begin() + aStartIndex, newLine.m_points.begin(),
                      newLine.m_points.end() );
     m_arcs.insert( m_arcs.end(), newLine.m_arcs.begin(), newLine.m_arcs.end() );
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
@@ -531,6 +553,13 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 
     aEndIndex = std::min( aEndIndex, PointCount() - 1 );
 
+    if( m_shapes.empty() )
+    {
+        // No arcs to split or remove
+        m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+        return;
+    }
+
     // Split arcs at start index and end just after the end index
     if( IsPtOnArc( aStartIndex ) )
         splitArc( aStartIndex );
@@ -582,6 +611,8 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
     m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     assert( m_shapes.size() == m_points.size() );
+
+    compactShapes();
 }
 
 
@@ -640,7 +671,9 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
             ii--;
 
         m_points.insert( m_points.begin() + ( ii + 1 ), aP );
-        m_shapes.insert( m_shapes.begin() + ( ii + 1 ), SHAPES_ARE_PT );
+
+        if( !m_shapes.empty() )
+            m_shapes.insert( m_shapes.begin() + ( ii + 1 ), SHAPES_ARE_PT );
 
         return ii + 1;
     }
@@ -686,6 +719,10 @@ int SHAPE_LINE_CHAIN::ShapeCount() const
     if( m_points.empty() )
         return 0;
 
+    // Without arcs every segment is a shape of its own
+    if( m_shapes.empty() )
+        return static_cast<int>( m_points.size() ) - 1;
+
     int numPoints = static_cast<int>( m_shapes.size() );
     int numShapes = 0;
     int arcIdx    = -1;
@@ -745,7 +782,7 @@ int SHAPE_LINE_CHAIN::NextShape( int aPointIndex, bool aForwards ) const
 
     int delta = aForwards ? 1 : -1;
 
-    if( m_shapes[aPointIndex] == SHAPES_ARE_PT )
+    if( shapeAt( aPointIndex ) == SHAPES_ARE_PT )
         return aPointIndex + delta;
 
     int arcStart = aPointIndex;
@@ -786,12 +823,17 @@ void SHAPE_LINE_CHAIN::SetPoint( int aIndex, const VECTOR2I& aPos )
 
     m_points[aIndex] = aPos;
 
+    if( m_shapes.empty() )
+        return;
+
     alg::run_on_pair( m_shapes[aIndex],
         [&]( ssize_t& aIdx )
         {
             if( aIdx != SHAPE_IS_PT )
                 convertArc( aIdx );
         } );
+
+    compactShapes();
 }
 
 
@@ -800,7 +842,7 @@ void SHAPE_LINE_CHAIN::RemoveShape( int aPointIndex )
     if( aPointIndex < 0 )
         aPointIndex += PointCount();
 
-    if( m_shapes[aPointIndex] == SHAPES_ARE_PT )
+    if( shapeAt( aPointIndex ) == SHAPES_ARE_PT )
     {
         Remove( aPointIndex );
         return;
@@ -845,7 +887,7 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
     for( int i = aStartIndex; i <= aEndIndex && i < numPoints; i++ )
     {
-        if( m_shapes[i] != SHAPES_ARE_PT )
+        if( shapeAt( i ) != SHAPES_ARE_PT )
         {
             int  arcIdx = ArcIndex( i );
             bool wholeArc = true;
@@ -886,13 +928,36 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 
     if( aOtherLine.PointCount() == 0 )
     {
         return;
     }
 
+    // Shape indices are only needed if either chain has some
+    if( !aOtherLine.m_shapes.empty() )
+        expandShapes();
+
+    bool withShapes = !m_shapes.empty() || !aOtherLine.m_shapes.empty();
+
+    if( !withShapes )
+    {
+        const VECTOR2I* first = &aOtherLine.m_points[0];
+        const VECTOR2I* last = first + aOtherLine.m_points.size();
+
+        if( PointCount() > 0 && *first == CPoint( -1 ) )
+            first++;
+
+        m_points.insert( m_points.end(), first, last );
+        m_arcs.insert( m_arcs.end(), aOtherLine.m_arcs.begin(), aOtherLine.m_arcs.end() );
+
+        for( const VECTOR2I* p = first; p != last; p++ )
+            m_bbox.Merge( *p );
+
+        return;
+    }
+
     size_t num_arcs = m_arcs.size();
     m_arcs.insert( m_arcs.end(), aOtherLine.m_arcs.begin(), aOtherLine.m_arcs.end() );
 
@@ -914,16 +979,16 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
     {
         const VECTOR2I p = aOtherLine.CPoint( 0 );
         m_points.push_back( p );
-        m_shapes.push_back( fixShapeIndices( aOtherLine.CShapes()[0] ) );
+        m_shapes.push_back( fixShapeIndices( aOtherLine.shapeAt( 0 ) ) );
         m_bbox.Merge( p );
     }
     else if( aOtherLine.IsArcSegment( 0 ) )
     {
         // Associate the new arc shape with the last point of this chain
         if( m_shapes.back() == SHAPES_ARE_PT )
-            m_shapes.back().first = aOtherLine.CShapes()[0].first + num_arcs;
+            m_shapes.back().first = aOtherLine.m_shapes[0].first + num_arcs;
         else
-            m_shapes.back().second = aOtherLine.CShapes()[0].first + num_arcs;
+            m_shapes.back().second = aOtherLine.m_shapes[0].first + num_arcs;
     }
 
 
@@ -952,8 +1017,9 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
     SHAPE_LINE_CHAIN chain = aArc.ConvertToPolyline();
 
-    // @todo should the below 4 LOC be moved to SHAPE_ARC::ConvertToPolyline ?
+    // @todo should the below 5 LOC be moved to SHAPE_ARC::ConvertToPolyline ?
     chain.m_arcs.push_back( aArc );
+    chain.expandShapes();
 
     for( auto& sh : chain.m_shapes )
         sh.first = 0;
@@ -973,9 +1039,11 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 
     //@todo need to check we aren't creating duplicate points
     m_points.insert( m_points.begin() + aVertex, aP );
-    m_shapes.insert( m_shapes.begin() + aVertex, SHAPES_ARE_PT );
 
-    assert( m_shapes.size() == m_points.size() );
+    if( !m_shapes.empty() )
+        m_shapes.insert( m_shapes.begin() + aVertex, SHAPES_ARE_PT );
+
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -986,6 +1054,8 @@ void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
     if( aVertex > 0 && IsPtOnArc( aVertex ) )
         splitArc( aVertex );
 
+    expandShapes();
+
     /// Step 1: Find the position for the new arc in the existing arc vector
     ssize_t arc_pos = m_arcs.size();
 
@@ -1404,17 +1474,17 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify( bool aRemoveColinear )
         // We can eliminate duplicate vertices as long as they are part of the same shape, OR if
         // one of them is part of a shape and one is not.
         while( j < np && m_points[i] == m_points[j] &&
-               ( m_shapes[i] == m_shapes[j] ||
-                 m_shapes[i] == SHAPES_ARE_PT ||
-                 m_shapes[j] == SHAPES_ARE_PT ) )
+               ( shapeAt( i ) == shapeAt( j ) ||
+                 shapeAt( i ) == SHAPES_ARE_PT ||
+                 shapeAt( j ) == SHAPES_ARE_PT ) )
         {
             j++;
         }
 
-        std::pair<ssize_t,ssize_t> shapeToKeep = m_shapes[i];
+        std::pair<ssize_t,ssize_t> shapeToKeep = shapeAt( i );
 
         if( shapeToKeep == SHAPES_ARE_PT )
-            shapeToKeep = m_shapes[j - 1];
+            shapeToKeep = shapeAt( j - 1 );
 
         assert( shapeToKeep.first < static_cast<int>( m_arcs.size() ) );
         assert( shapeToKeep.second < static_cast<int>( m_arcs.size() ) );
@@ -1425,6 +1495,17 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify( bool aRemoveColinear )
         i = j;
     }
 
+    bool withShapes = !m_shapes.empty();
+
+    auto appendUnique =
+            [&]( int aIndex )
+            {
+                m_points.push_back( pts_unique[aIndex] );
+
+                if( withShapes )
+                    m_shapes.push_back( shapes_unique[aIndex] );
+            };
+
     m_points.clear();
     m_shapes.clear();
     np = pts_unique.size();
@@ -1447,16 +1528,14 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify( bool aRemoveColinear )
                 n++;
         }
 
-        m_points.push_back( p0 );
-        m_shapes.push_back( shapes_unique[i] );
+        appendUnique( i );
 
         if( n > i )
             i = n;
 
         if( n == np - 2 )
         {
-            m_points.push_back( pts_unique[np - 1] );
-            m_shapes.push_back( shapes_unique[np - 1] );
+            appendUnique( np - 1 );
             return *this;
         }
 
@@ -1464,15 +1543,11 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify( bool aRemoveColinear )
     }
 
     if( np > 1 )
-    {
-        m_points.push_back( pts_unique[np - 2] );
-        m_shapes.push_back( shapes_unique[np - 2] );
-    }
+        appendUnique( np - 2 );
 
-    m_points.push_back( pts_unique[np - 1] );
-    m_shapes.push_back( shapes_unique[np - 1] );
+    appendUnique( np - 1 );
 
-    assert( m_points.size() == m_shapes.size() );
+    assert( m_shapes.empty() || m_points.size() == m_shapes.size() );
 
     return *this;
 }
@@ -1492,9 +1567,9 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP,
 
         // An internal shape point here is everything after the start of an arc and before the
         // second-to-last vertex of the arc, because we are looking at segments here!
-        if( i > 0 && i < SegmentCount() - 1 && m_shapes[i] != SHAPES_ARE_PT
-            && ( ( m_shapes[i - 1] != SHAPES_ARE_PT && m_shapes[i - 1] == m_shapes[i] )
-                 && ( m_shapes[i + 2] != SHAPES_ARE_PT && m_shapes[i + 2] == m_shapes[i] ) ) )
+        if( i > 0 && i < SegmentCount() - 1 && shapeAt( i ) != SHAPES_ARE_PT
+            && ( ( shapeAt( i - 1 ) != SHAPES_ARE_PT && shapeAt( i - 1 ) == shapeAt( i ) )
+                 && ( shapeAt( i + 2 ) != SHAPES_ARE_PT && shapeAt( i + 2 ) == shapeAt( i ) ) ) )
         {
             isInternalShapePoint = true;
         }
@@ -1625,6 +1700,7 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     size_t n_arcs;
 
     m_points.clear();
+    m_shapes.clear();
     aStream >> n_pts;
 
     // Rough sanity check, just make sure the loop bounds aren't absolutely outlandish
@@ -1663,6 +1739,8 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
         m_arcs.emplace_back( pc, p0, angle );
     }
 
+    compactShapes();
+
     return true;
 }
 
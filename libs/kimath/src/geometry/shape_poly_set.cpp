@@ -28,15 +28,20 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <assert.h>                          // for assert
+#include <climits>                           // for INT_MAX
 #include <cmath>                             // for sqrt, cos, hypot, isinf
 #include <cstdio>
+#include <future>
 #include <istream>                           // for operator<<, operator>>
 #include <limits>                            // for numeric_limits
 #include <map>
 #include <memory>
+#include <queue>
 #include <set>
 #include <string>                            // for char_traits, operator!=
+#include <thread>
 #include <type_traits>                       // for swap, move
 #include <unordered_set>
 #include <vector>
@@ -56,6 +61,452 @@
 #include <geometry/shape_circle.h>
 
 
+///< Polygons with fewer edges than this are searched linearly
+static const int EDGE_INDEX_MIN_EDGES = 64;
+
+///< Number of queries a set must get (between modifications) before its edges are indexed
+static const int EDGE_INDEX_MIN_QUERIES = 4;
+
+
+/**
+ * A spatial index of the edges of each polygon in a SHAPE_POLY_SET.
+ *
+ * Each polygon gets a static, bulk-loaded R-tree of its edges (sort-tile-recursive packing).
+ * Range queries are used for point containment (only the edges a ray from the point can
+ * cross are tested) and nearest edge queries are answered best-first.
+ *
+ * The queries give exactly the same results as the linear searches in containsSingle() and
+ * SquaredDistanceToPolygon() (ties between equally distant edges are resolved in favour of
+ * the first one in CIterateSegmentsWithHoles() order).
+ */
+class SHAPE_POLY_SET::EDGE_INDEX
+{
+public:
+    class POLYGON_EDGES
+    {
+    public:
+        POLYGON_EDGES( const POLYGON& aPolygon )
+        {
+            for( int contour = 0; contour < (int) aPolygon.size(); contour++ )
+            {
+                const SHAPE_LINE_CHAIN& chain = aPolygon[contour];
+
+                for( int i = 0; i < chain.SegmentCount(); i++ )
+                {
+                    m_edges.push_back( chain.CSegment( i ) );
+                    m_contours.push_back( contour );
+                }
+            }
+
+            m_contourCount = aPolygon.size();
+            build();
+        }
+
+        /**
+         * Same as containsSingle(): inside the outline (or within \a aAccuracy of it) and
+         * not inside any hole.
+         */
+        bool Contains( const VECTOR2I& aP, int aAccuracy ) const
+        {
+            // As in SHAPE_LINE_CHAIN_BASE::PointInside(), count the crossings of a ray in the
+            // positive x direction.  Only edges spanning aP.y and reaching to the right of aP
+            // can be crossed.
+            std::vector<int> crossedContours;
+
+            search( { aP.x, aP.y, INT_MAX, aP.y },
+                    [&]( int aEdge )
+                    {
+                        const VECTOR2I& p1 = m_edges[aEdge].A;
+                        const VECTOR2I& p2 = m_edges[aEdge].B;
+                        const VECTOR2I  diff = p2 - p1;
+
+                        if( diff.y != 0 )
+                        {
+                            const int d = rescale( diff.x, ( aP.y - p1.y ), diff.y );
+
+                            if( ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) && ( aP.x - p1.x < d ) )
+                                crossedContours.push_back( m_contours[aEdge] );
+                        }
+
+                        return true;
+                    } );
+
+            std::vector<bool> inside( m_contourCount, false );
+
+            for( int contour : crossedContours )
+                inside[contour] = !inside[contour];
+
+            if( !inside[0] && ( aAccuracy <= 1 || !outlineEdgeContains( aP, aAccuracy ) ) )
+                return false;
+
+            // Holes are tested without accuracy, as in containsSingle()
+            return std::find( inside.begin() + 1, inside.end(), true ) == inside.end();
+        }
+
+        SEG::ecoord SquaredDistance( const VECTOR2I& aP, VECTOR2I* aNearest ) const
+        {
+            SEG::ecoord distSq;
+            int         edge = closestEdge( { aP.x, aP.y, aP.x, aP.y },
+                                            [&]( const SEG& aEdge )
+                                            {
+                                                return aEdge.SquaredDistance( aP );
+                                            },
+                                            distSq );
+
+            if( aNearest && edge >= 0 )
+                *aNearest = m_edges[edge].NearestPoint( aP );
+
+            return distSq;
+        }
+
+        SEG::ecoord SquaredDistance( const SEG& aSeg, VECTOR2I* aNearest ) const
+        {
+            SEG::ecoord distSq;
+            int         edge = closestEdge( boxOf( aSeg ),
+                                            [&]( const SEG& aEdge )
+                                            {
+                                                return aEdge.SquaredDistance( aSeg );
+                                            },
+                                            distSq );
+
+            if( aNearest && edge >= 0 )
+                *aNearest = m_edges[edge].NearestPoint( aSeg );
+
+            return distSq;
+        }
+
+        /**
+         * @return a lower bound of the squared distance between the polygon and anything in
+         *         the box [\a aMin, \a aMax].
+         */
+        SEG::ecoord SquaredBBoxDistance( const VECTOR2I& aMin, const VECTOR2I& aMax ) const
+        {
+            return m_boxes.back().SquaredDistance( { aMin.x, aMin.y, aMax.x, aMax.y } );
+        }
+
+    private:
+        ///< Fan-out of the tree nodes
+        static const int NODE_SIZE = 16;
+
+        struct BOX
+        {
+            int m_minX, m_minY, m_maxX, m_maxY;
+
+            bool Intersects( const BOX& aOther ) const
+            {
+                return m_minX <= aOther.m_maxX && aOther.m_minX <= m_maxX
+                        && m_minY <= aOther.m_maxY && aOther.m_minY <= m_maxY;
+            }
+
+            void Merge( const BOX& aOther )
+            {
+                m_minX = std::min( m_minX, aOther.m_minX );
+                m_minY = std::min( m_minY, aOther.m_minY );
+                m_maxX = std::max( m_maxX, aOther.m_maxX );
+                m_maxY = std::max( m_maxY, aOther.m_maxY );
+            }
+
+            ///< Squared distance between the boxes, a lower bound for anything inside them
+            SEG::ecoord SquaredDistance( const BOX& aOther ) const
+            {
+                int64_t dx = std::max( { int64_t( 0 ), int64_t( m_minX ) - aOther.m_maxX,
+                                         int64_t( aOther.m_minX ) - m_maxX } );
+                int64_t dy = std::max( { int64_t( 0 ), int64_t( m_minY ) - aOther.m_maxY,
+                                         int64_t( aOther.m_minY ) - m_maxY } );
+
+                return dx * dx + dy * dy;
+            }
+        };
+
+        static BOX boxOf( const SEG& aSeg )
+        {
+            return { std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ),
+                     std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) };
+        }
+
+        /**
+         * Bulk load the tree.  Level 0 holds the edge boxes (in m_leafEdges order); each node
+         * of the next level up covers NODE_SIZE consecutive nodes of the level below, up to a
+         * single root.
+         */
+        void build()
+        {
+            std::vector<int> order( m_edges.size() );
+
+            for( int i = 0; i < (int) order.size(); i++ )
+                order[i] = i;
+
+            auto centreX =
+                    [&]( int aEdge )
+                    {
+                        return (int64_t) m_edges[aEdge].A.x + m_edges[aEdge].B.x;
+                    };
+
+            auto centreY =
+                    [&]( int aEdge )
+                    {
+                        return (int64_t) m_edges[aEdge].A.y + m_edges[aEdge].B.y;
+                    };
+
+            // Sort-tile-recursive: vertical slices by x, then nodes by y within each slice
+            size_t leafCount = ( order.size() + NODE_SIZE - 1 ) / NODE_SIZE;
+            size_t sliceSize = NODE_SIZE * (size_t) std::ceil( std::sqrt( (double) leafCount ) );
+
+            std::sort( order.begin(), order.end(),
+                       [&]( int a, int b ) { return centreX( a ) < centreX( b ); } );
+
+            for( size_t start = 0; start < order.size(); start += sliceSize )
+            {
+                auto end = order.begin() + std::min( order.size(), start + sliceSize );
+
+                std::sort( order.begin() + start, end,
+                           [&]( int a, int b ) { return centreY( a ) < centreY( b ); } );
+            }
+
+            m_leafEdges = order;
+            m_levelStarts.push_back( 0 );
+
+            for( int edge : m_leafEdges )
+                m_boxes.push_back( boxOf( m_edges[edge] ) );
+
+            size_t levelStart = 0;
+            size_t levelSize = m_boxes.size();
+
+            while( levelSize > 1 )
+            {
+                m_levelStarts.push_back( m_boxes.size() );
+
+                for( size_t i = 0; i < levelSize; i += NODE_SIZE )
+                {
+                    BOX box = m_boxes[levelStart + i];
+
+                    for( size_t j = i + 1; j < std::min( levelSize, i + NODE_SIZE ); j++ )
+                        box.Merge( m_boxes[levelStart + j] );
+
+                    m_boxes.push_back( box );
+                }
+
+                levelStart = m_levelStarts.back();
+                levelSize = m_boxes.size() - levelStart;
+            }
+        }
+
+        size_t levelSize( int aLevel ) const
+        {
+            size_t end = aLevel + 1 < (int) m_levelStarts.size() ? m_levelStarts[aLevel + 1]
+                                                                 : m_boxes.size();
+            return end - m_levelStarts[aLevel];
+        }
+
+        /**
+         * Call \a aVisitor with the index of each edge whose box intersects \a aBox.
+         */
+        template <typename VISITOR>
+        void search( const BOX& aBox, VISITOR aVisitor ) const
+        {
+            std::vector<std::pair<int, size_t>> stack;
+
+            stack.emplace_back( (int) m_levelStarts.size() - 1, 0 );
+
+            while( !stack.empty() )
+            {
+                int    level = stack.back().first;
+                size_t node = stack.back().second;
+
+                stack.pop_back();
+
+                if( !m_boxes[m_levelStarts[level] + node].Intersects( aBox ) )
+                    continue;
+
+                if( level == 0 )
+                {
+                    aVisitor( m_leafEdges[node] );
+                    continue;
+                }
+
+                size_t first = node * NODE_SIZE;
+                size_t last = std::min( levelSize( level - 1 ), first + NODE_SIZE );
+
+                for( size_t child = first; child < last; child++ )
+                    stack.emplace_back( level - 1, child );
+            }
+        }
+
+        ///< Same as SHAPE_LINE_CHAIN_BASE::PointOnEdge() for the outline
+        bool outlineEdgeContains( const VECTOR2I& aP, int aAccuracy ) const
+        {
+            const int64_t margin = (int64_t) aAccuracy + 2;
+            bool          found = false;
+
+            auto clamp =
+                    []( int64_t aValue )
+                    {
+                        return (int) std::max<int64_t>( INT_MIN,
+                                                        std::min<int64_t>( INT_MAX, aValue ) );
+                    };
+
+            search( { clamp( aP.x - margin ), clamp( aP.y - margin ),
+                      clamp( aP.x + margin ), clamp( aP.y + margin ) },
+                    [&]( int aEdge )
+                    {
+                        const SEG& s = m_edges[aEdge];
+
+                        if( m_contours[aEdge] == 0
+                                && ( s.A == aP || s.B == aP || s.Distance( aP ) <= aAccuracy + 1 ) )
+                        {
+                            found = true;
+                        }
+                    } );
+
+            return found;
+        }
+
+        /**
+         * Find the edge closest to something inside \a aBox, according to \a aDistance.
+         *
+         * Nodes are visited in order of their distance to \a aBox, until that is more than
+         * the distance of the best edge found so far.
+         *
+         * @return the edge index (or -1 if there are no edges), and its distance in
+         *         \a aDistSq.
+         */
+        template <typename DISTANCE_FUNC>
+        int closestEdge( const BOX& aBox, DISTANCE_FUNC aDistance, SEG::ecoord& aDistSq ) const
+        {
+            struct QUEUED_NODE
+            {
+                SEG::ecoord m_distSq;
+                int         m_level;
+                size_t      m_node;
+
+                bool operator<( const QUEUED_NODE& aOther ) const
+                {
+                    return m_distSq > aOther.m_distSq;    // closest first
+                }
+            };
+
+            std::priority_queue<QUEUED_NODE> queue;
+            int                              best = -1;
+            int                              root = (int) m_levelStarts.size() - 1;
+
+            aDistSq = VECTOR2I::ECOORD_MAX;
+            queue.push( { m_boxes[m_levelStarts[root]].SquaredDistance( aBox ), root, 0 } );
+
+            // Keep going while nodes are no farther than the best edge, so that ties go to the
+            // lowest edge index
+            while( !queue.empty() && queue.top().m_distSq <= aDistSq )
+            {
+                QUEUED_NODE top = queue.top();
+                queue.pop();
+
+                if( top.m_level == 0 )
+                {
+                    int         edge = m_leafEdges[top.m_node];
+                    SEG::ecoord distSq = aDistance( m_edges[edge] );
+
+                    if( distSq < aDistSq || ( distSq == aDistSq && edge < best ) )
+                    {
+                        aDistSq = distSq;
+                        best = edge;
+                    }
+
+                    continue;
+                }
+
+                size_t first = top.m_node * NODE_SIZE;
+                size_t last = std::min( levelSize( top.m_level - 1 ), first + NODE_SIZE );
+
+                for( size_t child = first; child < last; child++ )
+                {
+                    const BOX&  box = m_boxes[m_levelStarts[top.m_level - 1] + child];
+                    SEG::ecoord distSq = box.SquaredDistance( aBox );
+
+                    if( distSq <= aDistSq )
+                        queue.push( { distSq, top.m_level - 1, child } );
+                }
+            }
+
+            return best;
+        }
+
+        std::vector<SEG>    m_edges;        ///< In CIterateSegmentsWithHoles() order
+        std::vector<int>    m_contours;     ///< Contour index of each edge
+        int                 m_contourCount;
+
+        std::vector<BOX>    m_boxes;        ///< All tree levels, leaves first
+        std::vector<size_t> m_levelStarts;  ///< Offset of each level in m_boxes
+        std::vector<int>    m_leafEdges;    ///< Edge index of each leaf
+    };
+
+    EDGE_INDEX( const SHAPE_POLY_SET& aSet )
+    {
+        for( const POLYGON& polygon : aSet.m_polys )
+        {
+            bool indexable = !polygon.empty();
+
+            // Degenerate contours get special treatment from PointInside(); leave them to it
+            for( const SHAPE_LINE_CHAIN& contour : polygon )
+                indexable &= contour.IsClosed() && contour.PointCount() >= 3;
+
+            if( indexable )
+                m_polygons.push_back( std::make_unique<POLYGON_EDGES>( polygon ) );
+            else
+                m_polygons.push_back( nullptr );
+        }
+    }
+
+    ///< @return the index of the \a aIndex-th polygon, or nullptr if it couldn't be indexed
+    const POLYGON_EDGES* Polygon( int aIndex ) const
+    {
+        return m_polygons[aIndex].get();
+    }
+
+private:
+    std::vector<std::unique_ptr<POLYGON_EDGES>> m_polygons;
+};
+
+
+const SHAPE_POLY_SET::EDGE_INDEX* SHAPE_POLY_SET::edgeIndex( int aPolygonIndex ) const
+{
+    if( EDGE_INDEX* index = m_edgeIndex.load( std::memory_order_acquire ) )
+        return index;
+
+    if( m_polygonsExposed )
+        return nullptr;
+
+    // Small polygons are faster to search linearly, and there's no point in indexing a set
+    // which is only queried once or twice between modifications.
+    int edges = 0;
+
+    for( const SHAPE_LINE_CHAIN& contour : m_polys[aPolygonIndex] )
+        edges += contour.SegmentCount();
+
+    if( edges < EDGE_INDEX_MIN_EDGES )
+        return nullptr;
+
+    if( m_edgeIndexQueries.fetch_add( 1, std::memory_order_relaxed ) + 1 < EDGE_INDEX_MIN_QUERIES )
+        return nullptr;
+
+    EDGE_INDEX* index = new EDGE_INDEX( *this );
+    EDGE_INDEX* existing = nullptr;
+
+    // Another thread may have got there first
+    if( !m_edgeIndex.compare_exchange_strong( existing, index, std::memory_order_acq_rel ) )
+    {
+        delete index;
+        return existing;
+    }
+
+    return index;
+}
+
+
+void SHAPE_POLY_SET::freeEdgeIndex()
+{
+    delete m_edgeIndex.exchange( nullptr );
+}
+
+
 SHAPE_POLY_SET::SHAPE_POLY_SET() :
     SHAPE( SH_POLY_SET )
 {
@@ -95,6 +546,7 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
 
 SHAPE_POLY_SET::~SHAPE_POLY_SET()
 {
+    freeEdgeIndex();
 }
 
 
@@ -185,6 +637,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -197,6 +651,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -214,6 +670,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -237,6 +695,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 int SHAPE_POLY_SET::Append( SHAPE_ARC& aArc, int aOutline, int aHole )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -260,6 +720,8 @@ int SHAPE_POLY_SET::Append( SHAPE_ARC& aArc, int aOutline, int aHole )
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, const VECTOR2I& aNewVertex )
 {
+    invalidateEdgeIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -312,7 +774,7 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
     SHAPE_POLY_SET newPolySet;
 
     for( int index = aFirstPolygon; index < aLastPolygon; index++ )
-        newPolySet.m_polys.push_back( Polygon( index ) );
+        newPolySet.m_polys.push_back( CPolygon( index ) );
 
     return newPolySet;
 }
@@ -443,6 +905,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -457,6 +921,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -480,10 +946,10 @@ double SHAPE_POLY_SET::Area()
 
     for( int i = 0; i < OutlineCount(); i++ )
     {
-        area += Outline( i ).Area();
+        area += COutline( i ).Area();
 
         for( int j = 0; j < HoleCount( i ); j++ )
-            area -= Hole( i, j ).Area();
+            area -= CHole( i, j ).Area();
     }
 
     return area;
@@ -519,6 +985,8 @@ void SHAPE_POLY_SET::GetArcs( std::vector<SHAPE_ARC>& aArcBuffer ) const
 
 void SHAPE_POLY_SET::ClearArcs()
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
@@ -537,6 +1005,8 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
 void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
                                 const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     if( ( aShape.OutlineCount() > 1 || aOtherShape.OutlineCount() > 0 )
         && ( aShape.ArcCount() > 0 || aOtherShape.ArcCount() > 0 ) )
     {
@@ -648,7 +1118,7 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
 
                 if( newIntersectPoints.find( pt ) != newIntersectPoints.end() )
                 {
-                    const std::pair<ssize_t, ssize_t>& shape = poly[i].CShapes()[j];
+                    const std::pair<ssize_t, ssize_t>& shape = poly[i].shapeAt( j );
                     CLIPPER_Z_VALUE                    zval = newIntersectPoints.at( pt );
 
                     // Fixup arc end points to match the new intersection points found in clipper
@@ -729,6 +1199,8 @@ void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCou
 
 void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY aCornerStrategy )
 {
+    invalidateEdgeIndex();
+
     using namespace ClipperLib;
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI / aCircleSegCount )
@@ -822,7 +1294,10 @@ void SHAPE_POLY_SET::importTree( ClipperLib::PolyTree*               tree,
                                  const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                  const std::vector<SHAPE_ARC>&       aArcBuffer )
 {
+    invalidateEdgeIndex();
+
     m_polys.clear();
+    m_polygonsExposed = false;
 
     for( ClipperLib::PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
@@ -1054,6 +1529,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1240,6 +1717,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& path : m_polys )
         unfractureSingle( path );
 
@@ -1257,6 +1736,8 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
+    invalidateEdgeIndex();
+
     // We are expecting only one main outline, but this main outline can have holes
     // if holes: combine holes and remove them from the main outline.
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
@@ -1321,6 +1802,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateEdgeIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1550,12 +2033,17 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateEdgeIndex();
+
     m_polys.clear();
+    m_polygonsExposed = false;
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateEdgeIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1566,6 +2054,8 @@ void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 
 int SHAPE_POLY_SET::RemoveNullSegments()
 {
+    invalidateEdgeIndex();
+
     int removed = 0;
 
     ITERATOR iterator = IterateWithHoles();
@@ -1619,12 +2109,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateEdgeIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateEdgeIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1750,6 +2244,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1767,6 +2263,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1774,6 +2272,11 @@ void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                                      bool aUseBBoxCaches ) const
 {
+    const EDGE_INDEX* index = edgeIndex( aSubpolyIndex );
+
+    if( index && index->Polygon( aSubpolyIndex ) )
+        return index->Polygon( aSubpolyIndex )->Contains( aP, aAccuracy );
+
     // Check that the point is inside the outline
     if( m_polys[aSubpolyIndex][0].PointInside( aP, aAccuracy ) )
     {
@@ -1797,6 +2300,8 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1812,6 +2317,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1825,6 +2332,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1879,6 +2388,11 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPoly
         return 0;
     }
 
+    const EDGE_INDEX* index = edgeIndex( aPolygonIndex );
+
+    if( index && index->Polygon( aPolygonIndex ) )
+        return index->Polygon( aPolygonIndex )->SquaredDistance( aPoint, aNearest );
+
     CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
 
     SEG::ecoord minDistance = (*iterator).SquaredDistance( aPoint );
@@ -1913,6 +2427,11 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int a
         return 0;
     }
 
+    const EDGE_INDEX* index = edgeIndex( aPolygonIndex );
+
+    if( index && index->Polygon( aPolygonIndex ) )
+        return index->Polygon( aPolygonIndex )->SquaredDistance( aSegment, aNearest );
+
     CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
     SEG::ecoord            minDistance = (*iterator).SquaredDistance( aSegment );
 
@@ -1946,6 +2465,16 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistance( VECTOR2I aPoint, VECTOR2I* aNearest
     // Iterate through all the polygons and get the minimum distance.
     for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
     {
+        const EDGE_INDEX* index = edgeIndex( polygonIdx );
+
+        // Polygons whose bounding box is farther away than the closest one so far can't win
+        if( index && index->Polygon( polygonIdx )
+                && index->Polygon( polygonIdx )->SquaredBBoxDistance( aPoint, aPoint )
+                           >= minDistance_sq )
+        {
+            continue;
+        }
+
         currentDistance_sq = SquaredDistanceToPolygon( aPoint, polygonIdx,
                                                        aNearest ? &nearest : nullptr );
 
@@ -1968,9 +2497,24 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistance( const SEG& aSegment, VECTOR2I* aNea
     SEG::ecoord minDistance_sq = VECTOR2I::ECOORD_MAX;
     VECTOR2I    nearest;
 
+    const VECTOR2I segMin( std::min( aSegment.A.x, aSegment.B.x ),
+                           std::min( aSegment.A.y, aSegment.B.y ) );
+    const VECTOR2I segMax( std::max( aSegment.A.x, aSegment.B.x ),
+                           std::max( aSegment.A.y, aSegment.B.y ) );
+
     // Iterate through all the polygons and get the minimum distance.
     for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
     {
+        const EDGE_INDEX* index = edgeIndex( polygonIdx );
+
+        // Polygons whose bounding box is farther away than the closest one so far can't win
+        if( index && index->Polygon( polygonIdx )
+                && index->Polygon( polygonIdx )->SquaredBBoxDistance( segMin, segMax )
+                           >= minDistance_sq )
+        {
+            continue;
+        }
+
         currentDistance_sq = SquaredDistanceToPolygon( aSegment, polygonIdx,
                                                        aNearest ? &nearest : nullptr );
 
@@ -2029,7 +2573,7 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
     // Null segments create serious issues in calculations. Remove them:
     RemoveNullSegments();
 
-    SHAPE_POLY_SET::POLYGON currentPoly = Polygon( aIndex );
+    SHAPE_POLY_SET::POLYGON currentPoly = CPolygon( aIndex );
     SHAPE_POLY_SET::POLYGON newPoly;
 
     // If the chamfering distance is zero, then the polygon remain intact.
@@ -2186,8 +2730,13 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
 
 SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
 {
+    invalidateEdgeIndex();
+
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
+
+    // References to the old polygons are not to be used to modify the new ones
+    m_polygonsExposed = false;
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
 
@@ -2300,7 +2849,7 @@ static void partitionPolyIntoRegularCellGrid( const SHAPE_POLY_SET& aPoly, int a
 }
 
 
-void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
+void SHAPE_POLY_SET::CacheTriangulation( bool aPartition, bool aParallel )
 {
     bool recalculate = !m_hash.IsValid();
     MD5_HASH hash;
@@ -2342,6 +2891,53 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
 
+    if( aParallel && tmpSet.OutlineCount() > 1 )
+    {
+        // Tessellate each outline on its own, then keep the results in outline order up to
+        // the first failure.  From there on the serial loop below takes over, so the result
+        // is the same as if everything had been done serially.
+        const size_t count = tmpSet.OutlineCount();
+
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> results( count );
+        std::vector<char>                                  succeeded( count, 0 );
+        std::atomic<size_t>                                nextPoly( 0 );
+
+        auto tesselate_lambda =
+                [&]()
+                {
+                    for( size_t i = nextPoly++; i < count; i = nextPoly++ )
+                    {
+                        results[i] = std::make_unique<TRIANGULATED_POLYGON>();
+                        PolygonTriangulation tess( *results[i] );
+
+                        succeeded[i] = tess.TesselatePolygon( tmpSet.CPolygon( i ).front() );
+                    }
+                };
+
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       count );
+        std::vector<std::future<void>> returns;
+
+        for( size_t ii = 1; ii < parallelThreadCount; ++ii )
+            returns.push_back( std::async( std::launch::async, tesselate_lambda ) );
+
+        tesselate_lambda();
+
+        for( std::future<void>& ret : returns )
+            ret.wait();
+
+        size_t done = 0;
+
+        while( done < count && succeeded[done] )
+        {
+            m_triangulatedPolys.push_back( std::move( results[done] ) );
+            m_triangulationValid = true;
+            done++;
+        }
+
+        tmpSet.m_polys.erase( tmpSet.m_polys.begin(), tmpSet.m_polys.begin() + done );
+    }
+
     while( tmpSet.OutlineCount() > 0 )
     {
         m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
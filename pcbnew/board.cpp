@@ -190,16 +190,10 @@ void BOARD::ClearProject()
 
 void BOARD::IncrementTimeStamp()
 {
+    // The courtyard and area caches are keyed to the timestamp, so there's no need to clear
+    // them here.
     m_timeStamp++;
 
-    {
-        std::unique_lock<std::mutex> cacheLock( m_CachesMutex );
-        m_InsideAreaCache.clear();
-        m_InsideCourtyardCache.clear();
-        m_InsideFCourtyardCache.clear();
-        m_InsideBCourtyardCache.clear();
-    }
-
     m_CopperZoneRTrees.clear();
 }
 
@@ -34,6 +34,7 @@
 #include <pcb_plot_params.h>
 #include <title_block.h>
 #include <tools/pcb_selection.h>
+#include <core/sharded_cache.h>
 #include <mutex>
 #include <list>
 
@@ -1079,11 +1080,15 @@ public:
     GroupLegalOpsField GroupLegalOps( const PCB_SELECTION& selection ) const;
 
     // ------------ Run-time caches -------------
-    std::mutex                                            m_CachesMutex;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideFCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideBCourtyardCache;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool > m_InsideAreaCache;
+    // Safe for concurrent use; entries are keyed to the board timestamp (see GetTimeStamp())
+    // and so are invalidated by IncrementTimeStamp().
+    typedef SHARDED_CACHE< std::pair<BOARD_ITEM*, BOARD_ITEM*>, bool,
+                           POINTER_PAIR_HASH > ITEM_PAIR_CACHE;
+
+    ITEM_PAIR_CACHE                                       m_InsideCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideFCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideBCourtyardCache;
+    ITEM_PAIR_CACHE                                       m_InsideAreaCache;
 
     std::map< ZONE*, std::unique_ptr<DRC_RTREE> >         m_CopperZoneRTrees;
 
@@ -28,6 +28,8 @@
 #include <pcb_group.h>
 #include <tool/tool_manager.h>
 #include <tools/pcb_selection_tool.h>
+#include <tools/drc_tool.h>
+#include <advanced_config.h>
 #include <view/view.h>
 #include <board_commit.h>
 #include <tools/pcb_tool_base.h>
@@ -103,6 +105,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     std::vector<BOARD_ITEM*> bulkRemovedItems;
     std::vector<BOARD_ITEM*> itemsChanged;
 
+    // Change set for the incremental DRC
+    std::vector<BOARD_ITEM*> drcItems;
+    std::set<KIID>           drcRemovedItems;
+
     if( Empty() )
         return;
 
@@ -181,6 +187,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 if( boardItem->Type() != PCB_NETINFO_T )
                     view->Add( boardItem );
 
+                if( boardItem->Type() != PCB_NETINFO_T && boardItem->Type() != PCB_MARKER_T )
+                    drcItems.push_back( boardItem );
+
                 break;
             }
 
@@ -197,6 +206,20 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                     itemsDeselected = true;
                 }
 
+                if( boardItem->Type() != PCB_NETINFO_T && boardItem->Type() != PCB_MARKER_T )
+                {
+                    drcRemovedItems.insert( boardItem->m_Uuid );
+
+                    if( boardItem->Type() == PCB_FOOTPRINT_T )
+                    {
+                        static_cast<FOOTPRINT*>( boardItem )->RunOnChildren(
+                                [&]( BOARD_ITEM* aChild )
+                                {
+                                    drcRemovedItems.insert( aChild->m_Uuid );
+                                } );
+                    }
+                }
+
                 switch( boardItem->Type() )
                 {
                 // Footprint items
@@ -327,6 +350,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 }
 
                 itemsChanged.push_back( boardItem );
+                drcItems.push_back( boardItem );
 
                 // if no undo entry is needed, the copy would create a memory leak
                 if( !aCreateUndoEntry )
@@ -385,6 +409,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 }
 
                 view->Update( boardItem );
+                drcItems.push_back( boardItem );
             }
         }
     }
@@ -403,6 +428,14 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
         frame->Update3DView( true, frame->GetDisplayOptions().m_Live3DRefresh );
 
     clear();
+
+    if( !m_isFootprintEditor && ADVANCED_CFG::GetCfg().m_IncrementalDRC )
+    {
+        DRC_TOOL* drcTool = m_toolMgr->GetTool<DRC_TOOL>();
+
+        if( drcTool )
+            drcTool->RunIncrementalTests( drcItems, drcRemovedItems );
+    }
 }
 
 
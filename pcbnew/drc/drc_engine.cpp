@@ -23,6 +23,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <advanced_config.h>
 #include <reporter.h>
 #include <widgets/progress_reporter.h>
 #include <kicad_string.h>
@@ -40,6 +45,31 @@
 #include <geometry/shape.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_null.h>
+#include <hash_eda.h>
+
+/**
+ * Violations and log messages produced by a single test provider while the providers are run
+ * concurrently.  They are replayed in provider order once all providers have finished.
+ */
+struct DRC_DEFERRED_REPORTS
+{
+    struct ENTRY
+    {
+        std::shared_ptr<DRC_ITEM> m_item;   // nullptr for log messages
+        wxPoint                   m_pos;
+        wxString                  m_aux;
+    };
+
+    std::vector<ENTRY> m_entries;
+    bool               m_onWorkerThread = false;
+    bool               m_ran = false;
+    bool               m_completed = false;
+};
+
+
+// The reports of the provider currently running on this thread (if we're running concurrently)
+static thread_local DRC_DEFERRED_REPORTS* s_deferredReports = nullptr;
+
 
 void drcPrintDebugMessage( int level, const wxString& msg, const char *function, int line )
 {
@@ -63,9 +93,14 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_drawingSheet( nullptr ),
     m_schematicNetlist( nullptr ),
     m_rulesValid( false ),
+    m_rulesHash( 0 ),
     m_userUnits( EDA_UNITS::MILLIMETRES ),
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
+    m_concurrentTestProviders( ADVANCED_CFG::GetCfg().m_ConcurrentDRCProviders ),
+    m_incremental( false ),
+    m_constraintCacheTimeStamp( -1 ),
+    m_cacheItemConstraints( false ),
     m_reporter( nullptr ),
     m_progressReporter( nullptr )
 {
@@ -120,6 +155,80 @@ static bool isKeepoutZone( const BOARD_ITEM* aItem, bool aCheckFlags )
 }
 
 
+/**
+ * Return true if a rule condition only references the item type, via type, layer and netclass
+ * of the items.  Anything else (function calls, other properties, etc.) may depend on the
+ * individual item.
+ */
+static bool isClassBasedCondition( const wxString& aExpr )
+{
+    static const wxString classFields[] = { "NetClass", "Type", "Via Type", "Layer" };
+
+    size_t len = aExpr.length();
+    size_t ii = 0;
+
+    while( ii < len )
+    {
+        wxUniChar ch = aExpr[ii];
+
+        if( ch == '\'' || ch == '"' )
+        {
+            size_t end = aExpr.find( ch, ii + 1 );
+
+            if( end == wxString::npos )
+                return false;
+
+            ii = end + 1;
+        }
+        else if( wxIsdigit( ch ) )
+        {
+            // Numeric literal, including any units suffix
+            while( ii < len && ( wxIsalnum( aExpr[ii] ) || aExpr[ii] == '.' ) )
+                ii++;
+        }
+        else if( wxIsalpha( ch ) || ch == '_' )
+        {
+            size_t start = ii;
+
+            while( ii < len && ( wxIsalnum( aExpr[ii] ) || aExpr[ii] == '_' || aExpr[ii] == '.' ) )
+                ii++;
+
+            size_t next = ii;
+
+            while( next < len && wxIsspace( aExpr[next] ) )
+                next++;
+
+            if( next < len && aExpr[next] == '(' )
+                return false;
+
+            wxString token = aExpr.Mid( start, ii - start );
+            wxString var = token.BeforeFirst( '.' );
+            wxString field = token.AfterFirst( '.' );
+
+            if( var != "A" && var != "B" && var != "AB" )
+                return false;
+
+            field.Replace( "_", " " );
+
+            if( std::none_of( std::begin( classFields ), std::end( classFields ),
+                              [&]( const wxString& aField )
+                              {
+                                  return field.CmpNoCase( aField ) == 0;
+                              } ) )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            ii++;
+        }
+    }
+
+    return true;
+}
+
+
 DRC_RULE* DRC_ENGINE::createImplicitRule( const wxString& name )
 {
     DRC_RULE *rule = new DRC_RULE;
@@ -593,6 +702,15 @@ void DRC_ENGINE::compileRules()
                     rcons->constraint = constraint;
                     rcons->parentRule = rule;
                     m_constraintMap[ id ]->push_back( rcons );
+
+                    if( !m_classBasedConstraints.count( id ) )
+                        m_classBasedConstraints[ id ] = id != DISALLOW_CONSTRAINT;
+
+                    if( condition && !( compileOk
+                                        && isClassBasedCondition( condition->GetExpression() ) ) )
+                    {
+                        m_classBasedConstraints[ id ] = false;
+                    }
                 }
 
                 if( !matchingConstraints.empty() )
@@ -616,6 +734,28 @@ void DRC_ENGINE::compileRules()
             }
         }
     }
+    // Hash the compiled rules so that clients can tell when their results are out of date.
+    // (Netclass settings are included by way of the implicit rules.)
+    m_rulesHash = hash_val( m_rules.size() );
+
+    for( DRC_RULE* rule : m_rules )
+    {
+        hash_combine( m_rulesHash, rule->m_Name.ToStdString(),
+                      rule->m_LayerSource.ToStdString(),
+                      std::hash<BASE_SET>()( rule->m_LayerCondition ) );
+
+        if( rule->m_Condition )
+            hash_combine( m_rulesHash, rule->m_Condition->GetExpression().ToStdString() );
+
+        for( const DRC_CONSTRAINT& constraint : rule->m_Constraints )
+        {
+            const MINOPTMAX<int>& value = constraint.GetValue();
+
+            hash_combine( m_rulesHash, (int) constraint.m_Type, constraint.m_DisallowFlags,
+                          value.HasMin(), value.Min(), value.HasOpt(), value.Opt(),
+                          value.HasMax(), value.Max() );
+        }
+    }
 }
 
 
@@ -644,6 +784,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     }
 
     m_constraintMap.clear();
+    m_classBasedConstraints.clear();
+    clearConstraintCache();
 
     m_board->IncrementTimeStamp();  // Clear board-level caches
 
@@ -683,77 +825,463 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
     m_reportAllTrackErrors = aReportAllTrackErrors;
     m_testFootprints = aTestFootprints;
 
-    for( int ii = DRCE_FIRST; ii < DRCE_LAST; ++ii )
-    {
-        if( m_designSettings->Ignore( ii ) )
-            m_errorLimits[ ii ] = 0;
-        else
-            m_errorLimits[ ii ] = INT_MAX;
-    }
+    initErrorLimits();
 
     m_board->IncrementTimeStamp();      // Invalidate all caches
 
     if( !ReportPhase( _( "Tessellating copper zones..." ) ) )
         return;
 
-    // Number of zones between progress bar updates
-    int                delta = 5;
-    std::vector<ZONE*> copperZones;
+    std::vector<ZONE*>      zones;
+    std::vector<FOOTPRINT*> footprints;
 
     for( ZONE* zone : m_board->Zones() )
+        zones.push_back( zone );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
     {
-        zone->CacheBoundingBox();
-        zone->CacheTriangulation();
+        for( ZONE* zone : footprint->Zones() )
+            zones.push_back( zone );
 
+        footprints.push_back( footprint );
+    }
+
+    // The map itself isn't thread-safe, so create the (empty) zone trees up front and let the
+    // workers fill them in.
+    for( ZONE* zone : zones )
+    {
         if( !zone->GetIsRuleArea() )
-            copperZones.push_back( zone );
+            m_board->m_CopperZoneRTrees[ zone ] = std::make_unique<DRC_RTREE>();
     }
 
+    // Each zone's triangulation and RTree, and each footprint's courtyards, are independent
+    // of one another so they can all be built concurrently.
+    const size_t        jobCount = zones.size() + footprints.size();
+    std::atomic<size_t> nextItem( 0 );
+    std::atomic<size_t> doneCount( 0 );
+    std::atomic<bool>   cancelled( false );
+
+    auto prepareItem =
+            [&]( size_t i )
+            {
+                if( i < zones.size() )
+                {
+                    ZONE* zone = zones[i];
+
+                    zone->CacheBoundingBox();
+                    zone->CacheTriangulation();
+
+                    if( !zone->GetIsRuleArea() )
+                    {
+                        DRC_RTREE* zoneRTree = m_board->m_CopperZoneRTrees.at( zone ).get();
+
+                        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+                        {
+                            if( IsCopperLayer( layer ) )
+                                zoneRTree->Insert( zone, layer );
+                        }
+                    }
+                }
+                else
+                {
+                    footprints[ i - zones.size() ]->BuildPolyCourtyards();
+                }
+            };
+
+    auto prepare_lambda =
+            [&]() -> size_t
+            {
+                size_t num = 0;
+
+                for( size_t i = nextItem++; i < jobCount && !cancelled; i = nextItem++ )
+                {
+                    prepareItem( i );
+                    doneCount++;
+                    num++;
+                }
+
+                return num;
+            };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   jobCount );
+
+    if( parallelThreadCount <= 1 )
+    {
+        // Number of items between progress bar updates
+        const size_t delta = 5;
+
+        for( size_t i = 0; i < jobCount; ++i )
+        {
+            if( ( i % delta ) == 0 || i == jobCount - 1 )
+            {
+                if( !ReportProgress( (double) i / (double) jobCount ) )
+                    return;
+            }
+
+            prepareItem( i );
+        }
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, prepare_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            // Here we balance returns with a 100ms timeout to allow UI updating
+            std::future_status status;
+            do
+            {
+                if( !ReportProgress( (double) doneCount / (double) jobCount ) )
+                    cancelled = true;
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+        }
+    }
+
+    if( cancelled )
+        return;
+
+    runTestProviders();
+}
+
+
+void DRC_ENGINE::RunIncrementalTests( EDA_UNITS aUnits, const std::vector<BOARD_ITEM*>& aItems )
+{
+    m_userUnits = aUnits;
+
+    // Board-level tests are not run incrementally
+    m_reportAllTrackErrors = false;
+    m_testFootprints = false;
+
+    initErrorLimits();
+
+    m_incrementalItems.clear();
+    m_incrementalScope.clear();
+
+    // Find the largest distance at which an item can interact with one of aItems.  Note that
+    // local clearances can exceed the rule-based ones.
+    DRC_CONSTRAINT worstConstraint;
+    int            reach = 0;
+
+    for( DRC_CONSTRAINT_T id : { CLEARANCE_CONSTRAINT, HOLE_CLEARANCE_CONSTRAINT,
+                                 HOLE_TO_HOLE_CONSTRAINT, EDGE_CLEARANCE_CONSTRAINT,
+                                 COURTYARD_CLEARANCE_CONSTRAINT, SILK_CLEARANCE_CONSTRAINT } )
+    {
+        if( QueryWorstConstraint( id, worstConstraint ) )
+            reach = std::max( reach, worstConstraint.GetValue().Min() );
+    }
+
+    for( ZONE* zone : m_board->Zones() )
+        reach = std::max( reach, zone->GetLocalClearance() );
+
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
+        for( PAD* pad : footprint->Pads() )
+            reach = std::max( reach, pad->GetLocalClearance() );
+
         for( ZONE* zone : footprint->Zones() )
+            reach = std::max( reach, zone->GetLocalClearance() );
+    }
+
+    std::vector<EDA_RECT> regions;
+
+    for( BOARD_ITEM* item : aItems )
+    {
+        EDA_RECT region = item->GetBoundingBox();
+        region.Inflate( reach );
+        regions.push_back( region );
+
+        m_incrementalItems.insert( item->m_Uuid );
+        m_incrementalScope.insert( item );
+
+        if( item->Type() == PCB_FOOTPRINT_T )
         {
+            static_cast<FOOTPRINT*>( item )->RunOnChildren(
+                    [&]( BOARD_ITEM* child )
+                    {
+                        m_incrementalItems.insert( child->m_Uuid );
+                        m_incrementalScope.insert( child );
+                    } );
+        }
+    }
+
+    auto addToScope =
+            [&]( BOARD_ITEM* item )
+            {
+                EDA_RECT bbox = item->GetBoundingBox();
+
+                for( const EDA_RECT& region : regions )
+                {
+                    if( region.Intersects( bbox ) )
+                    {
+                        m_incrementalScope.insert( item );
+                        return;
+                    }
+                }
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        addToScope( track );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        addToScope( item );
+
+    for( ZONE* zone : m_board->Zones() )
+        addToScope( zone );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        addToScope( footprint );
+        footprint->RunOnChildren( addToScope );
+    }
+
+    // Drop the RTrees of the zones which are gone (and whose pointers could be reused)
+    std::set<ZONE*> zones( m_board->Zones().begin(), m_board->Zones().end() );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        zones.insert( footprint->Zones().begin(), footprint->Zones().end() );
+
+    for( auto it = m_board->m_CopperZoneRTrees.begin(); it != m_board->m_CopperZoneRTrees.end(); )
+    {
+        if( zones.count( it->first ) )
+            ++it;
+        else
+            it = m_board->m_CopperZoneRTrees.erase( it );
+    }
+
+    // Only the zones and courtyards within the scope need to be up to date
+    for( const BOARD_ITEM* item : m_incrementalScope )
+    {
+        if( item->Type() == PCB_ZONE_T || item->Type() == PCB_FP_ZONE_T )
+        {
+            ZONE* zone = static_cast<ZONE*>( const_cast<BOARD_ITEM*>( item ) );
+
             zone->CacheBoundingBox();
             zone->CacheTriangulation();
 
-            if( !zone->GetIsRuleArea() )
-                copperZones.push_back( zone );
-        }
+            // The RTree of a modified zone indexes its old outline
+            if( m_incrementalItems.count( zone->m_Uuid ) || zone->GetIsRuleArea() )
+                m_board->m_CopperZoneRTrees.erase( zone );
+
+            if( !zone->GetIsRuleArea() && !m_board->m_CopperZoneRTrees.count( zone ) )
+            {
+                m_board->m_CopperZoneRTrees[ zone ] = std::make_unique<DRC_RTREE>();
 
-        footprint->BuildPolyCourtyards();
+                for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+                {
+                    if( IsCopperLayer( layer ) )
+                        m_board->m_CopperZoneRTrees[ zone ]->Insert( zone, layer );
+                }
+            }
+        }
+        else if( item->Type() == PCB_FOOTPRINT_T )
+        {
+            const_cast<FOOTPRINT*>( static_cast<const FOOTPRINT*>( item ) )->BuildPolyCourtyards();
+        }
     }
 
-    int zoneCount = copperZones.size();
+    m_incremental = true;
 
-    for( int ii = 0; ii < zoneCount; ++ii )
+    runTestProviders();
+
+    m_incremental = false;
+    m_incrementalItems.clear();
+    m_incrementalScope.clear();
+}
+
+
+void DRC_ENGINE::initErrorLimits()
+{
+    for( int ii = DRCE_FIRST; ii < DRCE_LAST; ++ii )
     {
-        ZONE* zone = copperZones[ ii ];
+        if( m_designSettings->Ignore( ii ) )
+            m_errorLimits[ ii ] = 0;
+        else
+            m_errorLimits[ ii ] = INT_MAX;
+    }
+}
+
 
-        if( ( ii % delta ) == 0 || ii == zoneCount -  1 )
+bool DRC_ENGINE::IsIncrementallyTested( int aErrorCode ) const
+{
+    for( const DRC_TEST_PROVIDER* provider : m_testProviders )
+    {
+        if( provider->IsEnabled() && provider->SupportsIncrementalTests()
+                && provider->GetErrorCodes().count( aErrorCode ) )
         {
-            if( !ReportProgress( (double) ii / (double) zoneCount ) )
-                return;
+            return true;
         }
+    }
+
+    return false;
+}
 
-        m_board->m_CopperZoneRTrees[ zone ] = std::make_unique<DRC_RTREE>();
 
-        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+bool DRC_ENGINE::isProviderActive( const DRC_TEST_PROVIDER* aProvider ) const
+{
+    if( !aProvider->IsEnabled() )
+        return false;
+
+    return !m_incremental || aProvider->SupportsIncrementalTests();
+}
+
+
+void DRC_ENGINE::runTestProviders()
+{
+    // The board can't change while the providers run, so rule resolutions can also be
+    // memoized for the items themselves.
+    m_cacheItemConstraints = true;
+
+    if( m_concurrentTestProviders )
+    {
+        runTestProvidersConcurrently();
+    }
+    else
+    {
+        for( DRC_TEST_PROVIDER* provider : m_testProviders )
         {
-            if( IsCopperLayer( layer ) )
-                m_board->m_CopperZoneRTrees[ zone ]->Insert( zone, layer );
+            if( !isProviderActive( provider ) )
+                continue;
+
+            drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+
+            ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
+
+            if( !provider->Run() )
+                break;
         }
     }
 
+    m_cacheItemConstraints = false;
+    clearConstraintCache();
+}
+
+
+void DRC_ENGINE::runTestProvidersConcurrently()
+{
+    std::vector<DRC_TEST_PROVIDER*> providers;
+
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
     {
-        if( !provider->IsEnabled() )
-            continue;
+        if( isProviderActive( provider ) )
+            providers.push_back( provider );
+    }
+
+    std::vector<DRC_DEFERRED_REPORTS> deferred( providers.size() );
+    std::vector<size_t>               concurrent;
+    std::vector<size_t>               serial;
+
+    for( size_t ii = 0; ii < providers.size(); ++ii )
+    {
+        if( providers[ii]->IsThreadSafe() )
+            concurrent.push_back( ii );
+        else
+            serial.push_back( ii );
+    }
+
+    auto runProvider =
+            [&]( size_t aIndex, bool aOnWorkerThread )
+            {
+                DRC_TEST_PROVIDER*    provider = providers[ aIndex ];
+                DRC_DEFERRED_REPORTS& reports = deferred[ aIndex ];
+
+                reports.m_onWorkerThread = aOnWorkerThread;
+                s_deferredReports = &reports;
+
+                drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+
+                ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
+
+                reports.m_ran = true;
+                reports.m_completed = provider->Run();
+
+                s_deferredReports = nullptr;
+                return reports.m_completed;
+            };
+
+    std::atomic<size_t> nextItem( 0 );
+
+    auto run_lambda =
+            [&]( bool aOnWorkerThread ) -> size_t
+            {
+                size_t num = 0;
+
+                for( size_t i = nextItem++; i < concurrent.size(); i = nextItem++ )
+                {
+                    if( m_progressReporter && m_progressReporter->IsCancelled() )
+                        break;
+
+                    if( !runProvider( concurrent[i], aOnWorkerThread ) )
+                        break;
+
+                    num++;
+                }
+
+                return num;
+            };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   concurrent.size() );
+
+    if( parallelThreadCount <= 1 )
+    {
+        run_lambda( false );
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-        drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, run_lambda, true );
 
-        ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            // Here we balance returns with a 100ms timeout to allow UI updating
+            std::future_status status;
+            do
+            {
+                if( m_progressReporter )
+                    m_progressReporter->KeepRefreshing();
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+        }
+    }
+
+    bool cancelled = std::any_of( deferred.begin(), deferred.end(),
+                                  []( const DRC_DEFERRED_REPORTS& reports )
+                                  {
+                                      return reports.m_ran && !reports.m_completed;
+                                  } );
 
-        if( !provider->Run() )
+    // Providers which modify the board (connectivity, courtyards, item flags, etc.) can't be
+    // run alongside the others, so they get the board to themselves afterwards.
+    for( size_t ii : serial )
+    {
+        if( cancelled || !runProvider( ii, false ) )
+            break;
+    }
+
+    // Now replay the reports in provider order, exactly as a serial run would have made them.
+    for( DRC_DEFERRED_REPORTS& reports : deferred )
+    {
+        if( !reports.m_ran )
+            break;
+
+        for( const DRC_DEFERRED_REPORTS::ENTRY& entry : reports.m_entries )
+        {
+            if( entry.m_item )
+                ReportViolation( entry.m_item, entry.m_pos );
+            else
+                ReportAux( entry.m_aux );
+        }
+
+        if( !reports.m_completed )
             break;
     }
 }
@@ -780,6 +1308,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
 
     const DRC_CONSTRAINT* constraintRef = nullptr;
     bool                  implicit = false;
+    wxString              source;   // Local as EvalRules() may be called from several threads
 
     // Local overrides take precedence over everything *except* board min clearance
     if( aConstraintId == CLEARANCE_CONSTRAINT )
@@ -789,7 +1318,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
 
         if( ac && !b_is_non_copper && ac->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideA = ac->GetLocalClearanceOverrides( &m_msg );
+            overrideA = ac->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -799,7 +1328,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
 
         if( bc && !a_is_non_copper && bc->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideB = bc->GetLocalClearanceOverrides( &m_msg );
+            overrideB = bc->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -820,7 +1349,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
                                           EscapeHTML( MessageTextFromValue( UNITS, override ) ) ) )
             }
 
-            DRC_CONSTRAINT constraint( aConstraintId, m_msg );
+            DRC_CONSTRAINT constraint( aConstraintId, source );
             constraint.m_Value.SetMin( override );
             return constraint;
         }
@@ -1019,9 +1548,11 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
                 }
             };
 
-    if( m_constraintMap.count( aConstraintId ) )
+    auto ruleIt = m_constraintMap.find( aConstraintId );
+
+    if( ruleIt != m_constraintMap.end() )
     {
-        std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ aConstraintId ];
+        std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = ruleIt->second;
 
         if( aReporter )
         {
@@ -1033,11 +1564,45 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
         }
         else
         {
-            // Last matching rule wins, so process in reverse order and quit when match found
-            for( int ii = (int) ruleset->size() - 1; ii >= 0; --ii )
+            CONSTRAINT_CACHE_KEY key;
+            bool                 cacheable = makeConstraintCacheKey( aConstraintId, a, b, aLayer,
+                                                                     key );
+            bool                 cached = false;
+
+            if( cacheable )
             {
-                if( processConstraint( ruleset->at( ii ) ) )
-                    break;
+                std::lock_guard<std::mutex> lock( m_constraintCacheMutex );
+
+                if( m_constraintCacheTimeStamp != m_board->GetTimeStamp() )
+                {
+                    m_constraintCache.clear();
+                    m_constraintCacheTimeStamp = m_board->GetTimeStamp();
+                }
+
+                auto cacheIt = m_constraintCache.find( key );
+
+                if( cacheIt != m_constraintCache.end() )
+                {
+                    constraintRef = cacheIt->second.m_constraint;
+                    implicit = cacheIt->second.m_implicit;
+                    cached = true;
+                }
+            }
+
+            if( !cached )
+            {
+                // Last matching rule wins, so process in reverse order and quit when match found
+                for( int ii = (int) ruleset->size() - 1; ii >= 0; --ii )
+                {
+                    if( processConstraint( ruleset->at( ii ) ) )
+                        break;
+                }
+
+                if( cacheable )
+                {
+                    std::lock_guard<std::mutex> lock( m_constraintCacheMutex );
+                    m_constraintCache[ key ] = { constraintRef, implicit };
+                }
             }
         }
     }
@@ -1062,7 +1627,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
                                       EscapeHTML( MessageTextFromValue( UNITS, localA ) ) ) )
 
             if( localA > clearance )
-                clearance = ac->GetLocalClearance( &m_msg );
+                clearance = ac->GetLocalClearance( &source );
         }
 
         if( localB > 0 )
@@ -1073,19 +1638,18 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
                                       EscapeHTML( MessageTextFromValue( UNITS, localB ) ) ) )
 
             if( localB > clearance )
-                clearance = bc->GetLocalClearance( &m_msg );
+                clearance = bc->GetLocalClearance( &source );
         }
 
         if( localA > global || localB > global )
         {
-            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, m_msg );
+            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, source );
             constraint.m_Value.SetMin( clearance );
             return constraint;
         }
     }
 
-    static DRC_CONSTRAINT nullConstraint( NULL_CONSTRAINT );
-    nullConstraint.m_DisallowFlags = 0;
+    static const DRC_CONSTRAINT nullConstraint( NULL_CONSTRAINT );
 
     return constraintRef ? *constraintRef : nullConstraint;
 
@@ -1094,6 +1658,95 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintId, const BOAR
 }
 
 
+bool DRC_ENGINE::CONSTRAINT_CACHE_KEY::operator==( const CONSTRAINT_CACHE_KEY& aOther ) const
+{
+    if( m_constraintId != aOther.m_constraintId || m_layer != aOther.m_layer )
+        return false;
+
+    for( int ii = 0; ii < 2; ++ii )
+    {
+        if( m_item[ii] != aOther.m_item[ii]
+                || m_type[ii] != aOther.m_type[ii]
+                || m_viaType[ii] != aOther.m_viaType[ii]
+                || m_itemLayer[ii] != aOther.m_itemLayer[ii]
+                || m_nonCopper[ii] != aOther.m_nonCopper[ii]
+                || m_netclass[ii] != aOther.m_netclass[ii] )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::size_t DRC_ENGINE::CONSTRAINT_CACHE_KEY_HASH::operator()(
+        const CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    std::size_t seed = hash_val( (int) aKey.m_constraintId, (int) aKey.m_layer );
+
+    for( int ii = 0; ii < 2; ++ii )
+    {
+        hash_combine( seed, aKey.m_item[ii], aKey.m_type[ii], aKey.m_viaType[ii],
+                      aKey.m_itemLayer[ii], aKey.m_nonCopper[ii], aKey.m_netclass[ii] );
+    }
+
+    return seed;
+}
+
+
+bool DRC_ENGINE::makeConstraintCacheKey( DRC_CONSTRAINT_T aConstraintId, const BOARD_ITEM* a,
+                                         const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
+                                         CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    auto classIt = m_classBasedConstraints.find( aConstraintId );
+    bool classBased = classIt != m_classBasedConstraints.end() && classIt->second;
+
+    // The disallow test toggles flags on the items it queries, so its results can't even be
+    // cached per item.
+    if( aConstraintId == DISALLOW_CONSTRAINT || ( !classBased && !m_cacheItemConstraints ) )
+        return false;
+
+    aKey.m_constraintId = aConstraintId;
+    aKey.m_layer = aLayer;
+
+    const BOARD_ITEM* items[2] = { a, b };
+
+    for( int ii = 0; ii < 2; ++ii )
+    {
+        const BOARD_ITEM* item = items[ii];
+
+        aKey.m_item[ii] = classBased ? nullptr : item;
+        aKey.m_type[ii] = item ? (int) item->Type() : (int) TYPE_NOT_INIT;
+        aKey.m_viaType[ii] = -1;
+        aKey.m_itemLayer[ii] = item ? (int) item->GetLayer() : (int) UNDEFINED_LAYER;
+        aKey.m_nonCopper[ii] = item && ( !item->IsOnCopperLayer()
+                                         || isKeepoutZone( item, false ) );
+        aKey.m_netclass[ii] = wxEmptyString;
+
+        if( item && item->Type() == PCB_VIA_T )
+            aKey.m_viaType[ii] = (int) static_cast<const PCB_VIA*>( item )->GetViaType();
+
+        if( item && item->IsConnected() )
+        {
+            const BOARD_CONNECTED_ITEM* citem = static_cast<const BOARD_CONNECTED_ITEM*>( item );
+            aKey.m_netclass[ii] = citem->GetNetClassName();
+        }
+    }
+
+    return true;
+}
+
+
+void DRC_ENGINE::clearConstraintCache()
+{
+    std::lock_guard<std::mutex> lock( m_constraintCacheMutex );
+
+    m_constraintCache.clear();
+    m_constraintCacheTimeStamp = -1;
+}
+
+
 bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 {
     assert( error_code >= 0 && error_code <= DRCE_LAST );
@@ -1103,6 +1756,21 @@ bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 
 void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, const wxPoint& aPos )
 {
+    if( s_deferredReports )
+    {
+        s_deferredReports->m_entries.push_back( { aItem, aPos, wxEmptyString } );
+        return;
+    }
+
+    // Violations between items which weren't re-tested are still represented by the markers
+    // of the previous run
+    if( m_incremental
+            && !m_incrementalItems.count( aItem->GetMainItemID() )
+            && !m_incrementalItems.count( aItem->GetAuxItemID() ) )
+    {
+        return;
+    }
+
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
 
     if( m_violationHandler )
@@ -1136,6 +1804,12 @@ void DRC_ENGINE::ReportAux ( const wxString& aStr )
     if( !m_reporter )
         return;
 
+    if( s_deferredReports )
+    {
+        s_deferredReports->m_entries.push_back( { nullptr, wxPoint(), aStr } );
+        return;
+    }
+
     m_reporter->Report( aStr, RPT_SEVERITY_INFO );
 }
 
@@ -1146,6 +1820,11 @@ bool DRC_ENGINE::ReportProgress( double aProgress )
         return true;
 
     m_progressReporter->SetCurrentProgress( aProgress );
+
+    // KeepRefreshing() must only be called from the main thread
+    if( s_deferredReports && s_deferredReports->m_onWorkerThread )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -1156,6 +1835,11 @@ bool DRC_ENGINE::ReportPhase( const wxString& aMessage )
         return true;
 
     m_progressReporter->AdvancePhase( aMessage );
+
+    // KeepRefreshing() must only be called from the main thread
+    if( s_deferredReports && s_deferredReports->m_onWorkerThread )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
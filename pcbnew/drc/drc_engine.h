@@ -25,10 +25,14 @@
 #define DRC_ENGINE_H
 
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <geometry/shape.h>
+#include <kiid.h>
 
 #include <drc/drc_rule.h>
 
@@ -143,6 +147,38 @@ public:
      */
     void RunTests( EDA_UNITS aUnits,  bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * Run the DRC tests which support it on the given (added or modified) items and on the
+     * items within clearance range of them.
+     *
+     * Only violations involving at least one of \a aItems are reported, so the violations of a
+     * previous run which don't involve them remain valid.
+     */
+    void RunIncrementalTests( EDA_UNITS aUnits, const std::vector<BOARD_ITEM*>& aItems );
+
+    /**
+     * @return true if \a aItem is to be tested (ie: it's within the scope of the incremental
+     *         tests being run, or a full DRC is being run).
+     */
+    bool IsInTestScope( const BOARD_ITEM* aItem ) const
+    {
+        return !m_incremental || m_incrementalScope.count( aItem );
+    }
+
+    /**
+     * @return true if violations with the error code \a aErrorCode are reported by an enabled
+     *         test provider which is run by RunIncrementalTests().
+     */
+    bool IsIncrementallyTested( int aErrorCode ) const;
+
+    /**
+     * Run thread-safe test providers concurrently.  Violations are buffered per provider and
+     * reported in provider order once all providers have finished, so the results match those
+     * of a serial run.
+     */
+    void SetConcurrentTestProviders( bool aEnable ) { m_concurrentTestProviders = aEnable; }
+    bool GetConcurrentTestProviders() const { return m_concurrentTestProviders; }
+
 
     bool IsErrorLimitExceeded( int error_code );
 
@@ -158,6 +194,12 @@ public:
 
     bool RulesValid() { return m_rulesValid; }
 
+    /**
+     * Return a hash of the compiled rules (including the implicit netclass rules).  Used by
+     * clients which cache results derived from the rules.
+     */
+    size_t GetRulesHash() const { return m_rulesHash; }
+
     void ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, const wxPoint& aPos );
     bool ReportProgress( double aProgress );
     bool ReportPhase( const wxString& aMessage );
@@ -208,9 +250,69 @@ private:
         DRC_CONSTRAINT       constraint;
     };
 
+    /**
+     * Key of a memoized rule resolution.
+     *
+     * When every condition of a constraint type depends only on the item type, via type, layer
+     * and netclass of the items, items sharing those attributes resolve to the same rule and
+     * share a cache entry (m_item is nullptr).  Otherwise the items themselves are the key,
+     * which is only safe while the board is not being edited (ie: during RunTests()).
+     */
+    struct CONSTRAINT_CACHE_KEY
+    {
+        DRC_CONSTRAINT_T  m_constraintId;
+        PCB_LAYER_ID      m_layer;
+        const BOARD_ITEM* m_item[2];
+        int               m_type[2];
+        int               m_viaType[2];
+        int               m_itemLayer[2];
+        bool              m_nonCopper[2];
+        wxString          m_netclass[2];
+
+        bool operator==( const CONSTRAINT_CACHE_KEY& aOther ) const;
+    };
+
+    struct CONSTRAINT_CACHE_KEY_HASH
+    {
+        std::size_t operator()( const CONSTRAINT_CACHE_KEY& aKey ) const;
+    };
+
+    struct CONSTRAINT_CACHE_ENTRY
+    {
+        const DRC_CONSTRAINT* m_constraint;
+        bool                  m_implicit;
+    };
+
+    /**
+     * Fill in the cache key for a rule resolution.
+     *
+     * @return false if the resolution can't be cached.
+     */
+    bool makeConstraintCacheKey( DRC_CONSTRAINT_T aConstraintId, const BOARD_ITEM* a,
+                                 const BOARD_ITEM* b, PCB_LAYER_ID aLayer,
+                                 CONSTRAINT_CACHE_KEY& aKey ) const;
+
+    void clearConstraintCache();
+
     void loadImplicitRules();
     DRC_RULE* createImplicitRule( const wxString& name );
 
+    /**
+     * Run the enabled test providers, the thread-safe ones concurrently on a pool of worker
+     * threads and the rest serially on the calling thread.
+     */
+    void runTestProvidersConcurrently();
+
+    /**
+     * Run the enabled test providers (those supporting incremental tests only if we're running
+     * incremental tests).
+     */
+    void runTestProviders();
+
+    bool isProviderActive( const DRC_TEST_PROVIDER* aProvider ) const;
+
+    void initErrorLimits();
+
 protected:
     BOARD_DESIGN_SETTINGS*           m_designSettings;
     BOARD*                           m_board;
@@ -219,21 +321,36 @@ protected:
 
     std::vector<DRC_RULE*>           m_rules;
     bool                             m_rulesValid;
+    size_t                           m_rulesHash;
     std::vector<DRC_TEST_PROVIDER*>  m_testProviders;
 
     EDA_UNITS                        m_userUnits;
     std::vector<int>                 m_errorLimits;
     bool                             m_reportAllTrackErrors;
     bool                             m_testFootprints;
+    bool                             m_concurrentTestProviders;
+
+    bool                                  m_incremental;
+    std::set<KIID>                        m_incrementalItems;   // items being re-tested
+    std::unordered_set<const BOARD_ITEM*> m_incrementalScope;   // ... and their neighbourhood
 
     // constraint -> rule -> provider
     std::unordered_map<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> m_constraintMap;
 
+    // Constraint types whose conditions only depend on the attributes of a CONSTRAINT_CACHE_KEY
+    std::unordered_map<DRC_CONSTRAINT_T, bool> m_classBasedConstraints;
+
+    // Memoized EvalRules() results; invalidated by the board timestamp
+    std::unordered_map<CONSTRAINT_CACHE_KEY, CONSTRAINT_CACHE_ENTRY,
+                       CONSTRAINT_CACHE_KEY_HASH> m_constraintCache;
+    std::mutex                       m_constraintCacheMutex;
+    int                              m_constraintCacheTimeStamp;
+    bool                             m_cacheItemConstraints;
+
     DRC_VIOLATION_HANDLER            m_violationHandler;
     REPORTER*                        m_reporter;
     PROGRESS_REPORTER*               m_progressReporter;
 
-    wxString m_msg;  // Allocating strings gets expensive enough to want to avoid it
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
 };
 
@@ -28,18 +28,30 @@
 #include <eda_rect.h>
 #include <board_item.h>
 #include <fp_text.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <unordered_set>
 #include <set>
 #include <vector>
 
-#include <geometry/rtree.h>
 #include <geometry/shape.h>
 #include <math/vector2d.h>
 
 /**
  * Implement an R-tree for fast spatial and layer indexing of connectable items.
  * Non-owning.
+ *
+ * The tree is static: items are appended to a contiguous per-layer arena by Insert(), and the
+ * first query after a batch of insertions bulk-loads (Hilbert-packs) each layer into a flat
+ * array of node boxes.  Insertions must therefore not be made concurrently with queries, but
+ * any number of threads may query the tree at the same time.
  */
 class DRC_RTREE
 {
@@ -48,36 +60,61 @@ public:
 
     struct ITEM_WITH_SHAPE
     {
-        ITEM_WITH_SHAPE( BOARD_ITEM *aParent, SHAPE* aShape,
-                         std::shared_ptr<SHAPE> aParentShape = nullptr ) :
+        ITEM_WITH_SHAPE( BOARD_ITEM *aParent, SHAPE* aShape ) :
             parent ( aParent ),
-            shape ( aShape ),
-            parentShape( aParentShape )
+            shape ( aShape )
         {};
 
         BOARD_ITEM* parent;
-        SHAPE* shape;
-        std::shared_ptr<SHAPE> parentShape;
+        SHAPE*      shape;
     };
 
 private:
 
-    using drc_rtree = RTree<ITEM_WITH_SHAPE*, int, 2, double>;
+    struct NODE_BOX
+    {
+        int m_minX;
+        int m_minY;
+        int m_maxX;
+        int m_maxY;
 
-public:
+        bool Intersects( const NODE_BOX& aOther ) const
+        {
+            return m_minX <= aOther.m_maxX && aOther.m_minX <= m_maxX
+                    && m_minY <= aOther.m_maxY && aOther.m_minY <= m_maxY;
+        }
+
+        void Merge( const NODE_BOX& aOther )
+        {
+            m_minX = std::min( m_minX, aOther.m_minX );
+            m_minY = std::min( m_minY, aOther.m_minY );
+            m_maxX = std::max( m_maxX, aOther.m_maxX );
+            m_maxY = std::max( m_maxY, aOther.m_maxY );
+        }
+    };
 
-    DRC_RTREE()
+    /**
+     * The items on a single layer.  m_boxes holds the item boxes followed by the boxes of each
+     * level of nodes, up to the root.  The children of node \a n of a level are the entries
+     * [ n * NODE_SIZE, ( n + 1 ) * NODE_SIZE ) of the level below.
+     */
+    struct PACKED_LAYER
     {
-        for( int layer : LSET::AllLayersMask().Seq() )
-            m_tree[layer] = new drc_rtree();
+        std::vector<ITEM_WITH_SHAPE> m_items;
+        std::vector<NODE_BOX>        m_boxes;
+        std::vector<size_t>          m_levelStarts;
+        std::vector<size_t>          m_levelSizes;
+    };
 
-        m_count = 0;
-    }
+    static constexpr size_t NODE_SIZE = 16;
+    static constexpr size_t MAX_DEPTH = 12;
+
+public:
 
-    ~DRC_RTREE()
+    DRC_RTREE() :
+        m_count( 0 ),
+        m_packed( true )
     {
-        for( auto tree : m_tree )
-            delete tree;
     }
 
     /**
@@ -90,28 +127,40 @@ public:
         if( aItem->Type() == PCB_FP_TEXT_T && !static_cast<FP_TEXT*>( aItem )->IsVisible() )
             return;
 
-        std::vector<SHAPE*> subshapes;
+        std::vector<SHAPE*>    subshapes;
         std::shared_ptr<SHAPE> shape = aItem->GetEffectiveShape( ToLAYER_ID( aLayer ) );
-        subshapes.clear();
+        PACKED_LAYER&          layer = m_layers[aLayer];
 
         if( shape->HasIndexableSubshapes() )
             shape->GetIndexableSubshapes( subshapes );
         else
             subshapes.push_back( shape.get() );
 
+        if( !layer.m_levelStarts.empty() )
+        {
+            // Drop the node levels, which follow the item boxes; the layer will be re-packed
+            // before the next query
+            layer.m_boxes.resize( layer.m_items.size() );
+            layer.m_levelStarts.clear();
+            layer.m_levelSizes.clear();
+        }
+
         for( SHAPE* subshape : subshapes )
         {
             BOX2I bbox = subshape->BBox();
 
             bbox.Inflate( aWorstClearance );
 
-            const int        mmin[2] = { bbox.GetX(), bbox.GetY() };
-            const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
-            ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( aItem, subshape, shape );
-
-            m_tree[aLayer]->Insert( mmin, mmax, itemShape );
+            layer.m_items.emplace_back( aItem, subshape );
+            layer.m_boxes.push_back( { bbox.GetX(), bbox.GetY(), bbox.GetRight(),
+                                       bbox.GetBottom() } );
             m_count++;
         }
+
+        // The subshapes are owned by the parent shape; keep it alive with the tree
+        m_shapes.push_back( std::move( shape ) );
+
+        m_packed.store( false, std::memory_order_release );
     }
 
     /**
@@ -119,10 +168,17 @@ public:
      */
     void clear()
     {
-        for( auto tree : m_tree )
-            tree->RemoveAll();
+        for( PACKED_LAYER& layer : m_layers )
+        {
+            layer.m_items.clear();
+            layer.m_boxes.clear();
+            layer.m_levelStarts.clear();
+            layer.m_levelSizes.clear();
+        }
 
+        m_shapes.clear();
         m_count = 0;
+        m_packed.store( true, std::memory_order_release );
     }
 
     bool CheckColliding( SHAPE* aRefShape, PCB_LAYER_ID aTargetLayer, int aClearance = 0,
@@ -153,7 +209,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count > 0;
     }
 
@@ -225,7 +281,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count;
     }
 
@@ -271,7 +327,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aLayer]->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         if( collision )
         {
@@ -308,7 +364,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aLayer]->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         return collision;
     }
@@ -362,7 +418,7 @@ public:
                             return true;
                         };
 
-                this->m_tree[targetLayer]->Search( min, max, visit );
+                search( targetLayer, min, max, visit );
             };
         }
 
@@ -417,8 +473,6 @@ public:
         return m_count == 0;
     }
 
-    using iterator = typename drc_rtree::Iterator;
-
     /**
      * The DRC_LAYER struct provides a layer-specific auto-range iterator to the RTree.  Using
      * this struct, one can write lines like:
@@ -429,52 +483,284 @@ public:
      */
     struct DRC_LAYER
     {
-        DRC_LAYER( drc_rtree* aTree ) : layer_tree( aTree )
-        {
-            m_rect = { { INT_MIN, INT_MIN }, { INT_MAX, INT_MAX } };
-        };
+        DRC_LAYER( const PACKED_LAYER& aLayer ) :
+            m_rect( { INT_MIN, INT_MIN, INT_MAX, INT_MAX } ),
+            m_layer( aLayer )
+        {};
 
-        DRC_LAYER( drc_rtree* aTree, const EDA_RECT aRect ) : layer_tree( aTree )
+        DRC_LAYER( const PACKED_LAYER& aLayer, const EDA_RECT& aRect ) :
+            m_rect( { aRect.GetX(), aRect.GetY(), aRect.GetRight(), aRect.GetBottom() } ),
+            m_layer( aLayer )
+        {};
+
+        class iterator
         {
-            m_rect = { { aRect.GetX(), aRect.GetY() },
-                       { aRect.GetRight(), aRect.GetBottom() } };
-        };
+        public:
+            iterator( const DRC_LAYER& aRange, size_t aIndex ) :
+                m_range( aRange ),
+                m_index( aIndex )
+            {
+                skipFiltered();
+            }
+
+            ITEM_WITH_SHAPE* operator*() const
+            {
+                return const_cast<ITEM_WITH_SHAPE*>( &m_range.m_layer.m_items[m_index] );
+            }
+
+            iterator& operator++()
+            {
+                ++m_index;
+                skipFiltered();
+                return *this;
+            }
+
+            bool operator!=( const iterator& aOther ) const { return m_index != aOther.m_index; }
+            bool operator==( const iterator& aOther ) const { return m_index == aOther.m_index; }
 
-        drc_rtree::Rect m_rect;
-        drc_rtree*      layer_tree;
+        private:
+            void skipFiltered()
+            {
+                const std::vector<NODE_BOX>& boxes = m_range.m_layer.m_boxes;
 
-        iterator begin()
+                while( m_index < m_range.m_layer.m_items.size()
+                        && !boxes[m_index].Intersects( m_range.m_rect ) )
+                {
+                    ++m_index;
+                }
+            }
+
+            const DRC_LAYER& m_range;
+            size_t           m_index;
+        };
+
+        iterator begin() const
         {
-            return layer_tree->begin( m_rect );
+            return iterator( *this, 0 );
         }
 
-        iterator end()
+        iterator end() const
         {
-            return layer_tree->end( m_rect );
+            return iterator( *this, m_layer.m_items.size() );
         }
+
+        NODE_BOX            m_rect;
+        const PACKED_LAYER& m_layer;
     };
 
     DRC_LAYER OnLayer( PCB_LAYER_ID aLayer ) const
     {
-        return DRC_LAYER( m_tree[int( aLayer )] );
+        ensurePacked();
+        return DRC_LAYER( m_layers[int( aLayer )] );
     }
 
     DRC_LAYER Overlapping( PCB_LAYER_ID aLayer, const wxPoint& aPoint, int aAccuracy = 0 ) const
     {
         EDA_RECT rect( aPoint, wxSize( 0, 0 ) );
         rect.Inflate( aAccuracy );
-        return DRC_LAYER( m_tree[int( aLayer )], rect );
+
+        ensurePacked();
+        return DRC_LAYER( m_layers[int( aLayer )], rect );
     }
 
     DRC_LAYER Overlapping( PCB_LAYER_ID aLayer, const EDA_RECT& aRect ) const
     {
-        return DRC_LAYER( m_tree[int( aLayer )], aRect );
+        ensurePacked();
+        return DRC_LAYER( m_layers[int( aLayer )], aRect );
     }
 
 
 private:
-    drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
-    size_t      m_count;
+    /**
+     * Walk the packed nodes of a layer, calling \a aVisitor for each item whose (inflated)
+     * bounding box overlaps [ \a aMin, \a aMax ].  The walk stops early if the visitor returns
+     * false.
+     */
+    template <class VISITOR>
+    void search( PCB_LAYER_ID aLayer, const int aMin[2], const int aMax[2],
+                 VISITOR& aVisitor ) const
+    {
+        ensurePacked();
+
+        const PACKED_LAYER& layer = m_layers[int( aLayer )];
+
+        if( layer.m_items.empty() )
+            return;
+
+        const NODE_BOX query = { aMin[0], aMin[1], aMax[0], aMax[1] };
+
+        // Each stack entry is a ( level, node ) pair; a depth-first walk never holds more
+        // than NODE_SIZE entries per level.
+        std::pair<size_t, size_t> stack[NODE_SIZE * MAX_DEPTH];
+        size_t                    top = 0;
+
+        stack[top++] = { layer.m_levelStarts.size() - 1, 0 };
+
+        while( top > 0 )
+        {
+            const size_t level = stack[top - 1].first;
+            const size_t node = stack[top - 1].second;
+            top--;
+
+            const size_t first = node * NODE_SIZE;
+            const size_t last = std::min( first + NODE_SIZE, layer.m_levelSizes[level - 1] );
+            const size_t base = layer.m_levelStarts[level - 1];
+
+            for( size_t child = first; child < last; ++child )
+            {
+                if( !layer.m_boxes[base + child].Intersects( query ) )
+                    continue;
+
+                if( level == 1 )
+                {
+                    ITEM_WITH_SHAPE* item = const_cast<ITEM_WITH_SHAPE*>( &layer.m_items[child] );
+
+                    if( !aVisitor( item ) )
+                        return;
+                }
+                else
+                {
+                    stack[top++] = { level - 1, child };
+                }
+            }
+        }
+    }
+
+    /**
+     * Bulk-load any layers which have been modified since the last query.  Safe to call from
+     * several threads at once.
+     */
+    void ensurePacked() const
+    {
+        if( m_packed.load( std::memory_order_acquire ) )
+            return;
+
+        std::lock_guard<std::mutex> lock( m_packMutex );
+
+        if( m_packed.load( std::memory_order_relaxed ) )
+            return;
+
+        for( const PACKED_LAYER& layer : m_layers )
+        {
+            if( !layer.m_items.empty() && layer.m_levelStarts.empty() )
+                packLayer( const_cast<PACKED_LAYER&>( layer ) );
+        }
+
+        m_packed.store( true, std::memory_order_release );
+    }
+
+    /**
+     * Position of a point along a Hilbert curve covering a 65536 x 65536 grid.
+     */
+    static uint64_t hilbertIndex( uint32_t aX, uint32_t aY )
+    {
+        const uint32_t n = 1 << 16;
+        uint64_t       d = 0;
+
+        for( uint32_t s = n / 2; s > 0; s /= 2 )
+        {
+            uint32_t rx = ( aX & s ) > 0;
+            uint32_t ry = ( aY & s ) > 0;
+
+            d += uint64_t( s ) * s * ( ( 3 * rx ) ^ ry );
+
+            if( ry == 0 )
+            {
+                if( rx == 1 )
+                {
+                    aX = n - 1 - aX;
+                    aY = n - 1 - aY;
+                }
+
+                std::swap( aX, aY );
+            }
+        }
+
+        return d;
+    }
+
+    /**
+     * Sort the items of a layer along a Hilbert curve and build the node levels above them.
+     */
+    static void packLayer( PACKED_LAYER& aLayer )
+    {
+        const size_t count = aLayer.m_items.size();
+        NODE_BOX     extents = aLayer.m_boxes[0];
+
+        for( size_t ii = 1; ii < count; ++ii )
+            extents.Merge( aLayer.m_boxes[ii] );
+
+        const double width = std::max( 1.0, double( extents.m_maxX ) - extents.m_minX );
+        const double height = std::max( 1.0, double( extents.m_maxY ) - extents.m_minY );
+
+        std::vector<uint64_t> keys( count );
+
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            const NODE_BOX& box = aLayer.m_boxes[ii];
+            double          cx = ( double( box.m_minX ) + box.m_maxX ) / 2.0 - extents.m_minX;
+            double          cy = ( double( box.m_minY ) + box.m_maxY ) / 2.0 - extents.m_minY;
+
+            keys[ii] = hilbertIndex( uint32_t( cx / width * 65535.0 ),
+                                     uint32_t( cy / height * 65535.0 ) );
+        }
+
+        std::vector<size_t> order( count );
+        std::iota( order.begin(), order.end(), 0 );
+        std::sort( order.begin(), order.end(),
+                   [&]( size_t a, size_t b )
+                   {
+                       return keys[a] < keys[b];
+                   } );
+
+        std::vector<ITEM_WITH_SHAPE> items;
+        std::vector<NODE_BOX>        boxes;
+
+        items.reserve( count );
+        boxes.reserve( count + count / ( NODE_SIZE - 1 ) + 1 );
+
+        for( size_t idx : order )
+        {
+            items.push_back( aLayer.m_items[idx] );
+            boxes.push_back( aLayer.m_boxes[idx] );
+        }
+
+        aLayer.m_levelStarts.assign( 1, 0 );
+        aLayer.m_levelSizes.assign( 1, count );
+
+        // Build each level from the one below until a single root node remains
+        while( aLayer.m_levelSizes.back() > 1 || aLayer.m_levelStarts.size() == 1 )
+        {
+            const size_t childStart = aLayer.m_levelStarts.back();
+            const size_t childCount = aLayer.m_levelSizes.back();
+            const size_t nodeCount = ( childCount + NODE_SIZE - 1 ) / NODE_SIZE;
+
+            aLayer.m_levelStarts.push_back( boxes.size() );
+            aLayer.m_levelSizes.push_back( nodeCount );
+
+            for( size_t node = 0; node < nodeCount; ++node )
+            {
+                const size_t first = childStart + node * NODE_SIZE;
+                const size_t last = std::min( first + NODE_SIZE, childStart + childCount );
+                NODE_BOX     box = boxes[first];
+
+                for( size_t child = first + 1; child < last; ++child )
+                    box.Merge( boxes[child] );
+
+                boxes.push_back( box );
+            }
+        }
+
+        aLayer.m_items = std::move( items );
+        aLayer.m_boxes = std::move( boxes );
+    }
+
+    PACKED_LAYER                        m_layers[PCB_LAYER_ID_COUNT];
+    std::vector<std::shared_ptr<SHAPE>> m_shapes;
+    size_t                              m_count;
+
+    mutable std::atomic<bool>           m_packed;
+    mutable std::mutex                  m_packMutex;
 };
 
 
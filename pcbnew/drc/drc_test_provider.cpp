@@ -21,6 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 #include <drc/drc_engine.h>
 #include <drc/drc_item.h>
 #include <drc/drc_test_provider.h>
@@ -49,6 +53,29 @@ DRC_TEST_PROVIDER::DRC_TEST_PROVIDER() :
 }
 
 
+void DRC_TEST_PROVIDER::SetDRCEngine( DRC_ENGINE *engine )
+{
+    m_drcEngine = engine;
+    m_stats.clear();
+
+    // Build the item type lists up front; they must not be modified once providers start
+    // running (potentially on several threads).
+    if( s_allBasicItems.size() == 0 )
+    {
+        for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
+        {
+            if( i != PCB_FOOTPRINT_T && i != PCB_GROUP_T )
+            {
+                s_allBasicItems.push_back( (KICAD_T) i );
+
+                if( i != PCB_ZONE_T && i != PCB_FP_ZONE_T )
+                    s_allBasicItemsButZones.push_back( (KICAD_T) i );
+            }
+        }
+    }
+}
+
+
 const wxString DRC_TEST_PROVIDER::GetName() const { return "<no name test>"; }
 const wxString DRC_TEST_PROVIDER::GetDescription() const { return ""; }
 
@@ -143,20 +170,6 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     std::bitset<MAX_STRUCT_TYPE_ID> typeMask;
     int n = 0;
 
-    if( s_allBasicItems.size() == 0 )
-    {
-        for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
-        {
-            if( i != PCB_FOOTPRINT_T && i != PCB_GROUP_T )
-            {
-                s_allBasicItems.push_back( (KICAD_T) i );
-
-                if( i != PCB_ZONE_T && i != PCB_FP_ZONE_T )
-                    s_allBasicItemsButZones.push_back( (KICAD_T) i );
-            }
-        }
-    }
-
     if( aTypes.size() == 0 )
     {
         for( int i = 0; i < MAX_STRUCT_TYPE_ID; i++ )
@@ -170,6 +183,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
     for( PCB_TRACK* item : brd->Tracks() )
     {
+        if( !m_drcEngine->IsInTestScope( item ) )
+            continue;
+
         if( (item->GetLayerSet() & aLayers).any() )
         {
             if( typeMask[ PCB_TRACE_T ] && item->Type() == PCB_TRACE_T )
@@ -192,6 +208,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
     for( BOARD_ITEM* item : brd->Drawings() )
     {
+        if( !m_drcEngine->IsInTestScope( item ) )
+            continue;
+
         if( (item->GetLayerSet() & aLayers).any() )
         {
             if( typeMask[PCB_DIMENSION_T] && BaseType( item->Type() ) == PCB_DIMENSION_T )
@@ -229,6 +248,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     {
         for( ZONE* item : brd->Zones() )
         {
+            if( !m_drcEngine->IsInTestScope( item ) )
+                continue;
+
             if( ( item->GetLayerSet() & aLayers ).any() )
             {
                 if( !aFunc( item ) )
@@ -243,7 +265,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
     {
         if( typeMask[ PCB_FP_TEXT_T ] )
         {
-            if( ( footprint->Reference().GetLayerSet() & aLayers ).any() )
+            if( m_drcEngine->IsInTestScope( &footprint->Reference() )
+                    && ( footprint->Reference().GetLayerSet() & aLayers ).any() )
             {
                 if( !aFunc( &footprint->Reference() ) )
                     return n;
@@ -251,7 +274,8 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
                 n++;
             }
 
-            if( ( footprint->Value().GetLayerSet() & aLayers ).any() )
+            if( m_drcEngine->IsInTestScope( &footprint->Value() )
+                    && ( footprint->Value().GetLayerSet() & aLayers ).any() )
             {
                 if( !aFunc( &footprint->Value() ) )
                     return n;
@@ -264,6 +288,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             for( PAD* pad : footprint->Pads() )
             {
+                if( !m_drcEngine->IsInTestScope( pad ) )
+                    continue;
+
                 // Careful: if a pad has a hole then it pierces all layers
                 if( ( pad->GetDrillSizeX() > 0 && pad->GetDrillSizeY() > 0 )
                         || ( pad->GetLayerSet() & aLayers ).any() )
@@ -278,6 +305,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 
         for( BOARD_ITEM* dwg : footprint->GraphicalItems() )
         {
+            if( !m_drcEngine->IsInTestScope( dwg ) )
+                continue;
+
             if( (dwg->GetLayerSet() & aLayers).any() )
             {
                 if( typeMask[ PCB_FP_TEXT_T ] && dwg->Type() == PCB_FP_TEXT_T )
@@ -301,6 +331,9 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
         {
             for( ZONE* zone : footprint->Zones() )
             {
+                if( !m_drcEngine->IsInTestScope( zone ) )
+                    continue;
+
                 if( (zone->GetLayerSet() & aLayers).any() )
                 {
                     if( !aFunc( zone ) )
@@ -311,7 +344,7 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
             }
         }
 
-        if( typeMask[ PCB_FOOTPRINT_T ] )
+        if( typeMask[ PCB_FOOTPRINT_T ] && m_drcEngine->IsInTestScope( footprint ) )
         {
             if( !aFunc( footprint ) )
                 return n;
@@ -324,6 +357,92 @@ int DRC_TEST_PROVIDER::forEachGeometryItem( const std::vector<KICAD_T>& aTypes,
 }
 
 
+bool DRC_TEST_PROVIDER::forEachIndexInParallel( size_t aCount,
+                                                const std::function<void( size_t,
+                                                                          VIOLATION_LIST& )>& aFunc )
+{
+    const size_t chunkSize = 64;
+    const size_t chunkCount = ( aCount + chunkSize - 1 ) / chunkSize;
+
+    std::vector<VIOLATION_LIST> violations( chunkCount );
+    std::atomic<size_t>         nextChunk( 0 );
+    std::atomic<size_t>         done( 0 );
+    std::atomic<bool>           cancelled( false );
+
+    auto updateProgress =
+            [&]()
+            {
+                if( !cancelled && !m_drcEngine->ReportProgress( (double) done / (double) aCount ) )
+                    cancelled = true;
+            };
+
+    auto test_lambda =
+            [&]( bool aReportProgress ) -> size_t
+            {
+                size_t num = 0;
+
+                for( size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++ )
+                {
+                    size_t first = chunk * chunkSize;
+                    size_t last = std::min( aCount, first + chunkSize );
+
+                    for( size_t ii = first; ii < last; ++ii )
+                        aFunc( ii, violations[ chunk ] );
+
+                    done += last - first;
+                    num++;
+
+                    if( aReportProgress )
+                        updateProgress();
+
+                    // Every chunk handed out is finished, so the completed chunks are always
+                    // [0, nextChunk).
+                    if( cancelled )
+                        break;
+                }
+
+                return num;
+            };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   chunkCount );
+
+    if( parallelThreadCount <= 1 )
+    {
+        test_lambda( true );
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, test_lambda, false );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            // Here we balance returns with a 100ms timeout to allow UI updating
+            std::future_status status;
+            do
+            {
+                updateProgress();
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+        }
+    }
+
+    size_t completedChunks = std::min( nextChunk.load(), chunkCount );
+
+    for( size_t chunk = 0; chunk < completedChunks; ++chunk )
+    {
+        for( std::pair<std::shared_ptr<DRC_ITEM>, wxPoint>& violation : violations[ chunk ] )
+            reportViolation( violation.first, violation.second );
+    }
+
+    return !cancelled;
+}
+
+
 bool DRC_TEST_PROVIDER::isInvisibleText( const BOARD_ITEM* aItem ) const
 {
 
@@ -75,11 +75,7 @@ public:
     DRC_TEST_PROVIDER ();
     virtual ~DRC_TEST_PROVIDER() = default;
 
-    void SetDRCEngine( DRC_ENGINE *engine )
-    {
-        m_drcEngine = engine;
-        m_stats.clear();
-    }
+    void SetDRCEngine( DRC_ENGINE *engine );
 
     /**
      * Run this provider against the given PCB with configured options (if any).
@@ -98,6 +94,35 @@ public:
         return m_isRuleDriven;
     }
 
+    /**
+     * @return true if the provider only reads the board (and its own members), and can therefore
+     *         be run concurrently with other thread-safe providers.
+     */
+    virtual bool IsThreadSafe() const
+    {
+        return m_isThreadSafe;
+    }
+
+    /**
+     * @return true if the provider only tests items against the items within clearance range
+     *         of them (and skips the items outside of the DRC_ENGINE's test scope), and can
+     *         therefore be used for incremental tests.
+     */
+    virtual bool SupportsIncrementalTests() const
+    {
+        return m_supportsIncrementalTests;
+    }
+
+    /**
+     * @return the error codes of the violations this provider reports.  Only filled in by the
+     *         providers which support incremental tests, for which it tells which markers an
+     *         incremental run replaces.
+     */
+    const std::set<int>& GetErrorCodes() const
+    {
+        return m_errorCodes;
+    }
+
     bool IsEnabled() const
     {
         return m_enabled;
@@ -109,9 +134,24 @@ public:
     }
 
 protected:
+    typedef std::vector<std::pair<std::shared_ptr<DRC_ITEM>, wxPoint>> VIOLATION_LIST;
+
     int forEachGeometryItem( const std::vector<KICAD_T>& aTypes, LSET aLayers,
                              const std::function<bool(BOARD_ITEM*)>& aFunc );
 
+    /**
+     * Call \a aFunc for each index in [0, aCount) from a pool of worker threads.
+     *
+     * Indices are handed out to the workers in chunks.  \a aFunc must not call reportViolation()
+     * but should add its violations to the supplied list instead; the lists are reported in
+     * chunk (and therefore index) order once all the workers are done, which gives the same
+     * results as a serial loop.
+     *
+     * @return false if the DRC was cancelled.
+     */
+    bool forEachIndexInParallel( size_t aCount,
+                                 const std::function<void( size_t, VIOLATION_LIST& )>& aFunc );
+
     virtual void reportAux( wxString fmt, ... );
     virtual void reportViolation( std::shared_ptr<DRC_ITEM>& item, const wxPoint& aMarkerPos );
     virtual bool reportProgress( int aCount, int aSize, int aDelta );
@@ -131,6 +171,9 @@ protected:
     DRC_ENGINE* m_drcEngine;
     std::unordered_map<const DRC_RULE*, int> m_stats;
     bool        m_isRuleDriven = true;
+    bool        m_isThreadSafe = false;
+    bool        m_supportsIncrementalTests = false;
+    std::set<int> m_errorCodes;
     bool        m_enabled = true;
 
     wxString    m_msg;  // Allocating strings gets expensive enough to want to avoid it
@@ -44,6 +44,9 @@ class DRC_TEST_PROVIDER_ANNULAR_WIDTH : public DRC_TEST_PROVIDER
 public:
     DRC_TEST_PROVIDER_ANNULAR_WIDTH()
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_ANNULAR_WIDTH };
     }
 
     virtual ~DRC_TEST_PROVIDER_ANNULAR_WIDTH()
@@ -154,6 +157,9 @@ bool DRC_TEST_PROVIDER_ANNULAR_WIDTH::Run()
         if( !reportProgress( ii++, board->Tracks().size(), delta ) )
             break;
 
+        if( !m_drcEngine->IsInTestScope( item ) )
+            continue;
+
         if( !checkAnnularWidth( item ) )
             return false;   // DRC cancelled
     }
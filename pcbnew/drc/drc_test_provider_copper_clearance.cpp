@@ -58,6 +58,10 @@ public:
             DRC_TEST_PROVIDER_CLEARANCE_BASE(),
             m_drcEpsilon( 0 )
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_CLEARANCE, DRCE_HOLE_CLEARANCE, DRCE_SHORTING_ITEMS,
+                         DRCE_TRACKS_CROSSING, DRCE_ZONES_INTERSECT };
     }
 
     virtual ~DRC_TEST_PROVIDER_COPPER_CLEARANCE()
@@ -82,17 +86,19 @@ public:
 
 private:
     bool testTrackAgainstItem( PCB_TRACK* track, SHAPE* trackShape, PCB_LAYER_ID layer,
-                               BOARD_ITEM* other );
+                               BOARD_ITEM* other, VIOLATION_LIST& aViolations );
 
     void testTrackClearances();
 
-    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other );
+    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other,
+                             VIOLATION_LIST& aViolations );
 
     void testPadClearances();
 
     void testZones();
 
-    void testItemAgainstZones( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer );
+    void testItemAgainstZones( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer,
+                               VIOLATION_LIST& aViolations );
 
 private:
     DRC_RTREE          m_copperTree;
@@ -125,7 +131,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
     for( ZONE* zone : m_board->Zones() )
     {
-        if( !zone->GetIsRuleArea() )
+        if( !zone->GetIsRuleArea() && m_drcEngine->IsInTestScope( zone ) )
         {
             m_zones.push_back( zone );
             m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
@@ -139,7 +145,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
         for( ZONE* zone : footprint->Zones() )
         {
-            if( !zone->GetIsRuleArea() )
+            if( !zone->GetIsRuleArea() && m_drcEngine->IsInTestScope( zone ) )
             {
                 m_zones.push_back( zone );
                 m_largestClearance = std::max( m_largestClearance, zone->GetLocalClearance() );
@@ -257,7 +263,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track, SHAPE* trackShape,
                                                                PCB_LAYER_ID layer,
-                                                               BOARD_ITEM* other )
+                                                               BOARD_ITEM* other,
+                                                               VIOLATION_LIST& aViolations )
 {
     bool           testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool           testHoles = !m_drcEngine->IsErrorLimitExceeded( DRCE_HOLE_CLEARANCE );
@@ -265,6 +272,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
     int            clearance = -1;
     int            actual;
     VECTOR2I       pos;
+    wxString       msg;
 
     if( other->Type() == PCB_PAD_T )
     {
@@ -294,7 +302,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
                 drcItem->SetItems( track, other );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drcItem, (wxPoint) intersection.get() );
+                aViolations.emplace_back( drcItem, (wxPoint) intersection.get() );
 
                 return m_drcEngine->GetReportAllTrackErrors();
             }
@@ -306,16 +314,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-            m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), clearance ),
-                          MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), clearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
             drce->SetItems( track, other );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, (wxPoint) pos );
+            aViolations.emplace_back( drce, (wxPoint) pos );
 
             if( !m_drcEngine->GetReportAllTrackErrors() )
                 return false;
@@ -354,16 +362,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
-                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), clearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), clearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( track, other );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, (wxPoint) pos );
+                aViolations.emplace_back( drce, (wxPoint) pos );
 
                 if( !m_drcEngine->GetReportAllTrackErrors() )
                     return false;
@@ -376,8 +384,11 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem,
-                                                               PCB_LAYER_ID aLayer )
+                                                               PCB_LAYER_ID aLayer,
+                                                               VIOLATION_LIST& aViolations )
 {
+    wxString msg;
+
     for( ZONE* zone : m_zones )
     {
         if( m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE ) )
@@ -402,7 +413,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem
 
             int                    actual;
             VECTOR2I               pos;
-            DRC_RTREE*             zoneTree = m_board->m_CopperZoneRTrees[ zone ].get();
+            DRC_RTREE*             zoneTree = m_board->m_CopperZoneRTrees.at( zone ).get();
             EDA_RECT               itemBBox = aItem->GetBoundingBox();
             std::shared_ptr<SHAPE> itemShape = aItem->GetEffectiveShape( aLayer );
 
@@ -432,16 +443,16 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), clearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), clearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( aItem, zone );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, (wxPoint) pos );
+                aViolations.emplace_back( drce, (wxPoint) pos );
             }
         }
     }
@@ -450,71 +461,73 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
 {
-    // This is the number of tests between 2 calls to the progress bar
-    const int delta = 100;
-    int       ii = 0;
-
-    reportAux( "Testing %d tracks & vias...", m_board->Tracks().size() );
-
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, int> checkedPairs;
+    std::vector<PCB_TRACK*>                       tracks;
+    std::unordered_map<const BOARD_ITEM*, size_t> trackIndices;
 
     for( PCB_TRACK* track : m_board->Tracks() )
     {
-        if( !reportProgress( ii++, m_board->Tracks().size(), delta ) )
-            break;
-
-        for( PCB_LAYER_ID layer : track->GetLayerSet().Seq() )
+        if( m_drcEngine->IsInTestScope( track ) )
         {
-            std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
+            trackIndices[ track ] = tracks.size();
+            tracks.push_back( track );
+        }
+    }
 
-            m_copperTree.QueryColliding( track, layer, layer,
-                    // Filter:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        // It would really be better to know what particular nets a nettie
-                        // should allow, but for now it is what it is.
-                        if( DRC_ENGINE::IsNetTie( other ) )
-                            return false;
+    reportAux( "Testing %d tracks & vias...", tracks.size() );
+
+    forEachIndexInParallel( tracks.size(),
+            [&]( size_t aIndex, VIOLATION_LIST& aViolations )
+            {
+                PCB_TRACK* track = tracks[ aIndex ];
+
+                // Items this track has already been tested against (on any layer)
+                std::unordered_set<BOARD_ITEM*> checkedItems;
 
-                        auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
+                for( PCB_LAYER_ID layer : track->GetLayerSet().Seq() )
+                {
+                    std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
 
-                        if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
-                            return false;
+                    m_copperTree.QueryColliding( track, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                // It would really be better to know what particular nets a
+                                // nettie should allow, but for now it is what it is.
+                                if( DRC_ENGINE::IsNetTie( other ) )
+                                    return false;
 
-                        BOARD_ITEM* a = track;
-                        BOARD_ITEM* b = other;
+                                auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
 
-                        // store canonical order so we don't collide in both directions
-                        // (a:b and b:a)
-                        if( static_cast<void*>( a ) > static_cast<void*>( b ) )
-                            std::swap( a, b );
+                                if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
+                                    return false;
 
-                        if( checkedPairs.count( { a, b } ) )
-                        {
-                            return false;
-                        }
-                        else
-                        {
-                            checkedPairs[ { a, b } ] = 1;
-                            return true;
-                        }
-                    },
-                    // Visitor:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        return testTrackAgainstItem( track, trackShape.get(), layer, other );
-                    },
-                    m_largestClearance );
+                                // Track:track pairs are tested by whichever track comes first so
+                                // we don't collide in both directions (a:b and b:a)
+                                auto otherIndex = trackIndices.find( other );
 
-            testItemAgainstZones( track, layer );
-        }
-    }
+                                if( otherIndex != trackIndices.end() && otherIndex->second < aIndex )
+                                    return false;
+
+                                return checkedItems.insert( other ).second;
+                            },
+                            // Visitor:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                return testTrackAgainstItem( track, trackShape.get(), layer, other,
+                                                             aViolations );
+                            },
+                            m_largestClearance );
+
+                    testItemAgainstZones( track, layer, aViolations );
+                }
+            } );
 }
 
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* padShape,
                                                              PCB_LAYER_ID layer,
-                                                             BOARD_ITEM* other )
+                                                             BOARD_ITEM* other,
+                                                             VIOLATION_LIST& aViolations )
 {
     bool testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool testShorting = !m_drcEngine->IsErrorLimitExceeded( DRCE_SHORTING_ITEMS );
@@ -552,6 +565,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
     int                    clearance;
     int                    actual;
     VECTOR2I               pos;
+    wxString               msg;
 
     if( other->Type() == PCB_PAD_T )
     {
@@ -567,14 +581,14 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_SHORTING_ITEMS );
 
-                m_msg.Printf( _( "(nets %s and %s)" ),
-                              pad->GetNetname(),
-                              otherPad->GetNetname() );
+                msg.Printf( _( "(nets %s and %s)" ),
+                            pad->GetNetname(),
+                            otherPad->GetNetname() );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( pad, otherPad );
 
-                reportViolation( drce, otherPad->GetPosition() );
+                aViolations.emplace_back( drce, otherPad->GetPosition() );
             }
 
             return true;
@@ -591,16 +605,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
-                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), clearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), clearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( pad, other );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, (wxPoint) pos );
+                aViolations.emplace_back( drce, (wxPoint) pos );
             }
         }
 
@@ -615,16 +629,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
 
-                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), clearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), clearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( pad, other );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, (wxPoint) pos );
+                aViolations.emplace_back( drce, (wxPoint) pos );
             }
         }
 
@@ -647,16 +661,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
 
-            m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), clearance ),
-                          MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), clearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
             drce->SetItems( pad, other );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, (wxPoint) pos );
+            aViolations.emplace_back( drce, (wxPoint) pos );
         }
     }
 
@@ -666,62 +680,59 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
 {
-    const int delta = 50;  // This is the number of tests between 2 calls to the progress bar
-
-    size_t count = 0;
-
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-        count += footprint->Pads().size();
-
-    reportAux( "Testing %d pads...", count );
-
-    int ii = 0;
-    std::map< std::pair<BOARD_ITEM*, BOARD_ITEM*>, int> checkedPairs;
+    std::vector<PAD*>                             pads;
+    std::unordered_map<const BOARD_ITEM*, size_t> padIndices;
 
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
         for( PAD* pad : footprint->Pads() )
         {
-            if( !reportProgress( ii++, count, delta ) )
-                break;
+            if( m_drcEngine->IsInTestScope( pad ) )
+            {
+                padIndices[ pad ] = pads.size();
+                pads.push_back( pad );
+            }
+        }
+    }
+
+    reportAux( "Testing %d pads...", pads.size() );
 
-            for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
+    forEachIndexInParallel( pads.size(),
+            [&]( size_t aIndex, VIOLATION_LIST& aViolations )
             {
-                std::shared_ptr<SHAPE> padShape = DRC_ENGINE::GetShape( pad, layer );
+                PAD* pad = pads[ aIndex ];
 
-                m_copperTree.QueryColliding( pad, layer, layer,
-                        // Filter:
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            BOARD_ITEM* a = pad;
-                            BOARD_ITEM* b = other;
+                // Items this pad has already been tested against (on any layer)
+                std::unordered_set<BOARD_ITEM*> checkedItems;
 
-                            // store canonical order so we don't collide in both directions
-                            // (a:b and b:a)
-                            if( static_cast<void*>( a ) > static_cast<void*>( b ) )
-                                std::swap( a, b );
+                for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
+                {
+                    std::shared_ptr<SHAPE> padShape = DRC_ENGINE::GetShape( pad, layer );
 
-                            if( checkedPairs.count( { a, b } ) )
+                    m_copperTree.QueryColliding( pad, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
                             {
-                                return false;
-                            }
-                            else
+                                // Pad:pad pairs are tested by whichever pad comes first so we
+                                // don't collide in both directions (a:b and b:a)
+                                auto otherIndex = padIndices.find( other );
+
+                                if( otherIndex != padIndices.end() && otherIndex->second < aIndex )
+                                    return false;
+
+                                return checkedItems.insert( other ).second;
+                            },
+                            // Visitor
+                            [&]( BOARD_ITEM* other ) -> bool
                             {
-                                checkedPairs[ { a, b } ] = 1;
-                                return true;
-                            }
-                        },
-                        // Visitor
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            return testPadAgainstItem( pad, padShape.get(), layer, other );
-                        },
-                        m_largestClearance );
+                                return testPadAgainstItem( pad, padShape.get(), layer, other,
+                                                           aViolations );
+                            },
+                            m_largestClearance );
 
-                testItemAgainstZones( pad, layer );
-            }
-        }
-    }
+                    testItemAgainstZones( pad, layer, aViolations );
+                }
+            } );
 }
 
 
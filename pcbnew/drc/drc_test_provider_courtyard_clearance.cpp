@@ -45,6 +45,9 @@ public:
     DRC_TEST_PROVIDER_COURTYARD_CLEARANCE ()
     {
         m_isRuleDriven = false;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_MALFORMED_COURTYARD, DRCE_MISSING_COURTYARD,
+                         DRCE_OVERLAPPING_FOOTPRINTS };
     }
 
     virtual ~DRC_TEST_PROVIDER_COURTYARD_CLEARANCE ()
@@ -103,6 +106,9 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testFootprintCourtyardDefinitions()
         if( !reportProgress( ii++, m_board->Footprints().size(), delta ) )
             return false;   // DRC cancelled
 
+        if( !m_drcEngine->IsInTestScope( footprint ) )
+            continue;
+
         if( ( footprint->GetFlags() & MALFORMED_COURTYARDS ) != 0 )
         {
             if( m_drcEngine->IsErrorLimitExceeded( DRCE_MALFORMED_COURTYARD) )
@@ -165,6 +171,9 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
         const SHAPE_POLY_SET& footprintFront = footprint->GetPolyCourtyardFront();
         const SHAPE_POLY_SET& footprintBack = footprint->GetPolyCourtyardBack();
 
+        if( !m_drcEngine->IsInTestScope( footprint ) )
+            continue;
+
         if( footprintFront.OutlineCount() == 0 && footprintBack.OutlineCount() == 0 )
             continue; // No courtyards defined
 
@@ -184,6 +193,9 @@ bool DRC_TEST_PROVIDER_COURTYARD_CLEARANCE::testCourtyardClearances()
             int                   actual;
             VECTOR2I              pos;
 
+            if( !m_drcEngine->IsInTestScope( test ) )
+                continue;
+
             if( footprintFront.OutlineCount() > 0 && testFront.OutlineCount() > 0
                     && frontBBox.Intersects( testFront.BBoxFromCaches() ) )
             {
@@ -41,6 +41,8 @@ class DRC_TEST_PROVIDER_DISALLOW : public DRC_TEST_PROVIDER
 public:
     DRC_TEST_PROVIDER_DISALLOW()
     {
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_ALLOWED_ITEMS, DRCE_TEXT_ON_EDGECUTS };
     }
 
     virtual ~DRC_TEST_PROVIDER_DISALLOW()
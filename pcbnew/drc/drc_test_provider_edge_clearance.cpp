@@ -50,6 +50,9 @@ public:
     DRC_TEST_PROVIDER_EDGE_CLEARANCE () :
             DRC_TEST_PROVIDER_CLEARANCE_BASE()
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_COPPER_EDGE_CLEARANCE, DRCE_SILK_MASK_CLEARANCE };
     }
 
     virtual ~DRC_TEST_PROVIDER_EDGE_CLEARANCE()
@@ -176,7 +179,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                 else if( shape->GetShape() == SHAPE_T::POLY )
                 {
                     // Same for polygons
-                    SHAPE_LINE_CHAIN poly = shape->GetPolyShape().Outline( 0 );
+                    SHAPE_LINE_CHAIN poly = shape->GetPolyShape().COutline( 0 );
 
                     for( size_t ii = 0; ii < poly.GetSegmentCount(); ++ii )
                     {
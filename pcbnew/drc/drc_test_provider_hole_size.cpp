@@ -43,6 +43,9 @@ public:
     DRC_TEST_PROVIDER_HOLE_SIZE() :
         m_board( nullptr )
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_DRILL_OUT_OF_RANGE, DRCE_MICROVIA_DRILL_OUT_OF_RANGE };
     }
 
     virtual ~DRC_TEST_PROVIDER_HOLE_SIZE()
@@ -92,7 +95,8 @@ bool DRC_TEST_PROVIDER_HOLE_SIZE::Run()
                 if( m_drcEngine->IsErrorLimitExceeded( DRCE_DRILL_OUT_OF_RANGE ) )
                     break;
 
-                checkPad( pad );
+                if( m_drcEngine->IsInTestScope( pad ) )
+                    checkPad( pad );
             }
         }
     }
@@ -115,7 +119,7 @@ bool DRC_TEST_PROVIDER_HOLE_SIZE::Run()
 
         for( PCB_TRACK* track : m_board->Tracks() )
         {
-            if( track->Type() == PCB_VIA_T )
+            if( track->Type() == PCB_VIA_T && m_drcEngine->IsInTestScope( track ) )
                 vias.push_back( static_cast<PCB_VIA*>( track ) );
         }
 
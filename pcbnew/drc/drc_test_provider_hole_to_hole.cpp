@@ -50,6 +50,9 @@ public:
         DRC_TEST_PROVIDER_CLEARANCE_BASE(),
         m_board( nullptr )
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_DRILLED_HOLES_COLOCATED, DRCE_DRILLED_HOLES_TOO_CLOSE };
     }
 
     virtual ~DRC_TEST_PROVIDER_HOLE_TO_HOLE()
@@ -178,7 +181,7 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
 
     for( PCB_TRACK* track : m_board->Tracks() )
     {
-        if( track->Type() != PCB_VIA_T )
+        if( track->Type() != PCB_VIA_T || !m_drcEngine->IsInTestScope( track ) )
             continue;
 
         PCB_VIA* via = static_cast<PCB_VIA*>( track );
@@ -231,6 +234,9 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
             if( !reportProgress( ii++, count, delta ) )
                 return false;   // DRC cancelled
 
+            if( !m_drcEngine->IsInTestScope( pad ) )
+                continue;
+
             // We only care about drilled (ie: round) holes
             if( pad->GetDrillSize().x && pad->GetDrillSize().x == pad->GetDrillSize().y )
             {
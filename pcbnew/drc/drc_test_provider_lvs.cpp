@@ -50,6 +50,7 @@ public:
     DRC_TEST_PROVIDER_LVS()
     {
         m_isRuleDriven = false;
+        m_isThreadSafe = true;
     }
 
     virtual ~DRC_TEST_PROVIDER_LVS()
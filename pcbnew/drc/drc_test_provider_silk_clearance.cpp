@@ -50,6 +50,9 @@ public:
         m_board( nullptr ),
         m_largestClearance( 0 )
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_OVERLAPPING_SILK };
     }
 
     virtual ~DRC_TEST_PROVIDER_SILK_CLEARANCE()
@@ -47,6 +47,9 @@ public:
             m_board( nullptr ),
             m_largestClearance( 0 )
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_SILK_MASK_CLEARANCE };
     }
 
     virtual ~DRC_TEST_PROVIDER_SILK_TO_MASK()
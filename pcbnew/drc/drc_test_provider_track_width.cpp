@@ -40,6 +40,9 @@ class DRC_TEST_PROVIDER_TRACK_WIDTH : public DRC_TEST_PROVIDER
 public:
     DRC_TEST_PROVIDER_TRACK_WIDTH()
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_TRACK_WIDTH };
     }
 
     virtual ~DRC_TEST_PROVIDER_TRACK_WIDTH()
@@ -161,6 +164,9 @@ bool DRC_TEST_PROVIDER_TRACK_WIDTH::Run()
         if( !reportProgress( ii++, m_drcEngine->GetBoard()->Tracks().size(), delta ) )
             break;
 
+        if( !m_drcEngine->IsInTestScope( item ) )
+            continue;
+
         if( !checkTrackWidth( item ) )
             break;
     }
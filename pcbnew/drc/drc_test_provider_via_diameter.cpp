@@ -39,6 +39,9 @@ class DRC_TEST_PROVIDER_VIA_DIAMETER : public DRC_TEST_PROVIDER
 public:
     DRC_TEST_PROVIDER_VIA_DIAMETER()
     {
+        m_isThreadSafe = true;
+        m_supportsIncrementalTests = true;
+        m_errorCodes = { DRCE_VIA_DIAMETER };
     }
 
     virtual ~DRC_TEST_PROVIDER_VIA_DIAMETER()
@@ -150,6 +153,9 @@ bool DRC_TEST_PROVIDER_VIA_DIAMETER::Run()
         if( !reportProgress( ii++, m_drcEngine->GetBoard()->Tracks().size(), delta ) )
             break;
 
+        if( !m_drcEngine->IsInTestScope( item ) )
+            continue;
+
         if( !checkViaDiameter( item ) )
             break;
     }
@@ -218,17 +218,14 @@ static void insideCourtyard( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( !footprint )
                     return false;
 
-                std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
                 std::pair<BOARD_ITEM*, BOARD_ITEM*> key( footprint, item );
-                auto                                i = board->m_InsideCourtyardCache.find( key );
 
-                if( i != board->m_InsideCourtyardCache.end() )
-                    return i->second;
-
-                bool res = insideFootprintCourtyard( item, itemBBox, shape, context, footprint );
-
-                board->m_InsideCourtyardCache[ key ] = res;
-                return res;
+                return board->m_InsideCourtyardCache.GetOrCompute( key, board->GetTimeStamp(),
+                        [&]()
+                        {
+                            return insideFootprintCourtyard( item, itemBBox, shape, context,
+                                                             footprint );
+                        } );
             };
 
     if( arg->AsString() == "A" )
@@ -299,18 +296,14 @@ static void insideFrontCourtyard( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( !footprint )
                     return false;
 
-                std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
                 std::pair<BOARD_ITEM*, BOARD_ITEM*> key( footprint, item );
-                auto                                i = board->m_InsideFCourtyardCache.find( key );
-
-                if( i != board->m_InsideFCourtyardCache.end() )
-                    return i->second;
 
-                bool res = insideFootprintCourtyard( item, itemBBox, shape, context, footprint,
-                                                        F_Cu );
-
-                board->m_InsideFCourtyardCache[ key ] = res;
-                return res;
+                return board->m_InsideFCourtyardCache.GetOrCompute( key, board->GetTimeStamp(),
+                        [&]()
+                        {
+                            return insideFootprintCourtyard( item, itemBBox, shape, context,
+                                                             footprint, F_Cu );
+                        } );
             };
 
     if( arg->AsString() == "A" )
@@ -380,18 +373,14 @@ static void insideBackCourtyard( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( !footprint )
                     return false;
 
-                std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
                 std::pair<BOARD_ITEM*, BOARD_ITEM*> key( footprint, item );
-                auto                                i = board->m_InsideBCourtyardCache.find( key );
-
-                if( i != board->m_InsideBCourtyardCache.end() )
-                    return i->second;
 
-                bool res = insideFootprintCourtyard( item, itemBBox, shape, context, footprint,
-                                                        B_Cu );
-
-                board->m_InsideBCourtyardCache[ key ] = res;
-                return res;
+                return board->m_InsideBCourtyardCache.GetOrCompute( key, board->GetTimeStamp(),
+                        [&]()
+                        {
+                            return insideFootprintCourtyard( item, itemBBox, shape, context,
+                                                             footprint, B_Cu );
+                        } );
             };
 
     if( arg->AsString() == "A" )
@@ -514,7 +503,7 @@ static void insideArea( LIBEVAL::CONTEXT* aCtx, void* self )
                         }
                         else
                         {
-                            return areaOutline.Collide( &courtyard.Outline( 0 ) );
+                            return areaOutline.Collide( &courtyard.COutline( 0 ) );
                         }
                     }
 
@@ -531,7 +520,7 @@ static void insideArea( LIBEVAL::CONTEXT* aCtx, void* self )
                         }
                         else
                         {
-                            return areaOutline.Collide( &courtyard.Outline( 0 ) );
+                            return areaOutline.Collide( &courtyard.COutline( 0 ) );
                         }
                     }
 
@@ -545,7 +534,11 @@ static void insideArea( LIBEVAL::CONTEXT* aCtx, void* self )
                     if( !zone->IsFilled() )
                         return false;
 
-                    DRC_RTREE* zoneRTree = board->m_CopperZoneRTrees[ zone ].get();
+                    auto       zoneRTreeIt = board->m_CopperZoneRTrees.find( zone );
+                    DRC_RTREE* zoneRTree = nullptr;
+
+                    if( zoneRTreeIt != board->m_CopperZoneRTrees.end() )
+                        zoneRTree = zoneRTreeIt->second.get();
 
                     std::vector<SHAPE*> shapes;
 
@@ -575,17 +568,13 @@ static void insideArea( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( !area || area == item || area->GetParent() == item )
                     return false;
 
-                std::unique_lock<std::mutex>        cacheLock( board->m_CachesMutex );
                 std::pair<BOARD_ITEM*, BOARD_ITEM*> key( area, item );
-                auto                                i = board->m_InsideAreaCache.find( key );
 
-                if( i != board->m_InsideAreaCache.end() )
-                    return i->second;
-
-                bool isInside = itemIsInsideArea( area );
-
-                board->m_InsideAreaCache[ key ] = isInside;
-                return isInside;
+                return board->m_InsideAreaCache.GetOrCompute( key, board->GetTimeStamp(),
+                        [&]()
+                        {
+                            return itemIsInsideArea( area );
+                        } );
             };
 
     if( arg->AsString() == "A" )
@@ -1461,9 +1461,9 @@ void PCB_PAINTER::draw( const PCB_SHAPE* aShape, int aLayer )
 
         if( sketch )
         {
-            for( int ii = 0; ii < shape.Outline( 0 ).SegmentCount(); ++ii )
+            for( int ii = 0; ii < shape.COutline( 0 ).SegmentCount(); ++ii )
             {
-                SEG seg = shape.Outline( 0 ).Segment( ii );
+                SEG seg = shape.COutline( 0 ).CSegment( ii );
                 m_gal->DrawSegment( seg.A, seg.B, thickness );
             }
         }
@@ -1474,9 +1474,9 @@ void PCB_PAINTER::draw( const PCB_SHAPE* aShape, int aLayer )
 
             if( thickness > 0 )
             {
-                for( int ii = 0; ii < shape.Outline( 0 ).SegmentCount(); ++ii )
+                for( int ii = 0; ii < shape.COutline( 0 ).SegmentCount(); ++ii )
                 {
-                    SEG seg = shape.Outline( 0 ).Segment( ii );
+                    SEG seg = shape.COutline( 0 ).CSegment( ii );
                     m_gal->DrawSegment( seg.A, seg.B, thickness );
                 }
             }
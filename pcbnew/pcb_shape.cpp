@@ -96,7 +96,7 @@ const wxPoint PCB_SHAPE::GetFocusPosition() const
     case SHAPE_T::POLY:
         if( !IsFilled() )
         {
-            VECTOR2I pos = GetPolyShape().Outline(0).CPoint(0);
+            VECTOR2I pos = GetPolyShape().COutline( 0 ).CPoint( 0 );
             return wxPoint( pos.x, pos.y );
         }
         break;
@@ -222,7 +222,7 @@ void PCB_SHAPE::Scale( double aScale )
     {
         std::vector<wxPoint> pts;
 
-        for( const VECTOR2I& pt : m_poly.Outline( 0 ).CPoints() )
+        for( const VECTOR2I& pt : m_poly.COutline( 0 ).CPoints() )
         {
             pts.emplace_back( pt );
             scalePt( pts.back() );
@@ -580,7 +580,7 @@ void PCB_SHAPE::GetMsgPanelInfo( EDA_DRAW_FRAME* aFrame, std::vector<MSG_PANEL_I
     case SHAPE_T::POLY:
         aList.emplace_back( shape, _( "Polygon" ) );
 
-        msg.Printf( "%d", GetPolyShape().Outline(0).PointCount() );
+        msg.Printf( "%d", GetPolyShape().COutline( 0 ).PointCount() );
         aList.emplace_back( _( "Points" ), msg );
         break;
 
@@ -1297,7 +1297,7 @@ bool PCB_SHAPE::IsPolyShapeValid() const
     if( GetPolyShape().OutlineCount() == 0 )
         return false;
 
-    const SHAPE_LINE_CHAIN& outline = ( (SHAPE_POLY_SET&)GetPolyShape() ).Outline( 0 );
+    const SHAPE_LINE_CHAIN& outline = GetPolyShape().COutline( 0 );
 
     return outline.PointCount() > 2;
 }
@@ -0,0 +1,157 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+
+#include <cache_index_file.h>
+#include <plugins/kicad/fp_cache_index.h>
+#include <trace_helpers.h>
+#include <wx/log.h>
+
+
+/*
+ * Index file layout, after the header written by CACHE_INDEX_FILE:
+ *
+ *   uint32    number of entries, then for each entry:
+ *     int64     modification time
+ *     int64     size
+ *     string    file name
+ */
+static const char     INDEX_MAGIC[8] = "KIFPIDX";
+static const uint32_t INDEX_VERSION = 2;
+
+
+FP_CACHE_INDEX::FP_CACHE_INDEX( const wxString& aLibraryPath ) :
+        m_libraryPath( aLibraryPath ),
+        m_read( false ),
+        m_dirty( false )
+{
+}
+
+
+void FP_CACHE_INDEX::Read()
+{
+    if( m_read )
+        return;
+
+    m_read = true;
+    m_entries.clear();
+
+    CACHE_INDEX_FILE file( wxT( "footprints" ), INDEX_MAGIC, INDEX_VERSION, m_libraryPath );
+    uint32_t         count;
+
+    if( !file.Load() || !file.Read( count ) )
+        return;
+
+    for( uint32_t ii = 0; ii < count; ++ii )
+    {
+        ENTRY    entry;
+        int64_t  modTime;
+        int64_t  size;
+        wxString fileName;
+
+        if( !file.Read( modTime ) || !file.Read( size ) || !file.ReadString( fileName ) )
+        {
+            wxLogTrace( traceKicadPcbPlugin, wxT( "Footprint index '%s' is truncated." ),
+                        file.GetFilePath() );
+            m_entries.clear();
+            return;
+        }
+
+        entry.m_modTime = modTime;
+        entry.m_size = size;
+        m_entries[fileName] = entry;
+    }
+}
+
+
+void FP_CACHE_INDEX::Write()
+{
+    if( !m_dirty )
+        return;
+
+    m_dirty = false;
+
+    CACHE_INDEX_FILE file( wxT( "footprints" ), INDEX_MAGIC, INDEX_VERSION, m_libraryPath );
+
+    file.Clear();
+    file.Append<uint32_t>( m_entries.size() );
+
+    for( const std::pair<const wxString, ENTRY>& entry : m_entries )
+    {
+        file.Append<int64_t>( entry.second.m_modTime );
+        file.Append<int64_t>( entry.second.m_size );
+        file.AppendString( entry.first );
+    }
+
+    // Not the end of the world: it's just a cache file
+    if( !file.Save() )
+    {
+        wxLogTrace( traceKicadPcbPlugin, wxT( "Cannot write footprint index '%s'." ),
+                    file.GetFilePath() );
+    }
+}
+
+
+const FP_CACHE_INDEX::ENTRY* FP_CACHE_INDEX::Find( const wxString& aFileName ) const
+{
+    auto it = m_entries.find( aFileName );
+
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+
+void FP_CACHE_INDEX::Set( const wxString& aFileName, long long aModTime, long long aSize )
+{
+    auto it = m_entries.find( aFileName );
+
+    if( it != m_entries.end() && it->second.m_modTime == aModTime && it->second.m_size == aSize )
+        return;
+
+    m_entries[aFileName] = { aModTime, aSize };
+    m_dirty = true;
+}
+
+
+void FP_CACHE_INDEX::Remove( const wxString& aFileName )
+{
+    if( m_entries.erase( aFileName ) )
+        m_dirty = true;
+}
+
+
+void FP_CACHE_INDEX::Prune( const std::set<wxString>& aFileNames )
+{
+    for( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( aFileNames.count( it->first ) )
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_entries.erase( it );
+            m_dirty = true;
+        }
+    }
+}
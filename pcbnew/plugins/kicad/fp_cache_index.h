@@ -0,0 +1,90 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef FP_CACHE_INDEX_H
+#define FP_CACHE_INDEX_H
+
+#include <map>
+#include <set>
+
+#include <wx/string.h>
+
+
+/**
+ * A persistent record of the footprint files of one .pretty library which are known to parse.
+ *
+ * Each entry holds the name of a footprint file with the modification time and size it had
+ * when it was last parsed successfully.  The footprint cache of the #PCB_IO plugin enumerates
+ * files which still match their entry without parsing them, and parses them only when the
+ * footprint itself is needed.  Files without a matching entry are parsed straight away, so
+ * only new or changed files are parsed when a library is opened.
+ *
+ * The index is stored in a binary file in the user cache directory (one file per library
+ * path), never in the library itself which may be read only or shared.  It is only a cache:
+ * a missing, stale or damaged index file is simply ignored and rebuilt.
+ */
+class FP_CACHE_INDEX
+{
+public:
+    struct ENTRY
+    {
+        long long m_modTime;
+        long long m_size;
+    };
+
+    FP_CACHE_INDEX( const wxString& aLibraryPath );
+
+    /**
+     * Read the index file of the library, if there is a valid one.  Does nothing after the
+     * first call.
+     */
+    void Read();
+
+    /**
+     * Write the index file back, if the index changed since it was read.  Failures are
+     * silently ignored.
+     */
+    void Write();
+
+    /**
+     * @return the entry of footprint file \a aFileName, or nullptr if there is none.
+     */
+    const ENTRY* Find( const wxString& aFileName ) const;
+
+    void Set( const wxString& aFileName, long long aModTime, long long aSize );
+
+    void Remove( const wxString& aFileName );
+
+    /**
+     * Remove the entries of all the files which are not in \a aFileNames.
+     */
+    void Prune( const std::set<wxString>& aFileNames );
+
+private:
+    wxString                  m_libraryPath;
+    std::map<wxString, ENTRY> m_entries;        ///< Entries by footprint file name
+    bool                      m_read;
+    bool                      m_dirty;
+};
+
+#endif // FP_CACHE_INDEX_H
@@ -22,11 +22,17 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
 #include <advanced_config.h>
 #include <base_units.h>
 #include <board.h>
 #include <board_design_settings.h>
 #include <boost/ptr_container/ptr_map.hpp>
+#include <cache_index_file.h>
 #include <confirm.h>
 #include <convert_basic_shapes_to_polygon.h> // for enum RECT_CHAMFER_POSITIONS definition
 #include <core/arraydim.h>
@@ -43,6 +49,7 @@
 #include <pcb_target.h>
 #include <pcb_text.h>
 #include <pcbnew_settings.h>
+#include <plugins/kicad/fp_cache_index.h>
 #include <plugins/kicad/kicad_plugin.h>
 #include <plugins/kicad/pcb_parser.h>
 #include <trace_helpers.h>
@@ -69,19 +76,42 @@ using namespace PCB_KEYS_T;
 class FP_CACHE_ITEM
 {
     WX_FILENAME                m_filename;
-    std::unique_ptr<FOOTPRINT> m_footprint;
+    std::unique_ptr<FOOTPRINT> m_footprint;     // nullptr until the file has been parsed
+    long long                  m_fileModTime;   // Of the file the footprint was read from
+    long long                  m_fileSize;
 
 public:
-    FP_CACHE_ITEM( FOOTPRINT* aFootprint, const WX_FILENAME& aFileName );
+    FP_CACHE_ITEM( FOOTPRINT* aFootprint, const WX_FILENAME& aFileName,
+                   long long aFileModTime = 0, long long aFileSize = 0 );
 
     const WX_FILENAME& GetFileName() const { return m_filename; }
     const FOOTPRINT* GetFootprint()  const { return m_footprint.get(); }
+
+    void SetFootprint( FOOTPRINT* aFootprint ) { m_footprint.reset( aFootprint ); }
+
+    void SetFileStat( long long aFileModTime, long long aFileSize )
+    {
+        m_fileModTime = aFileModTime;
+        m_fileSize = aFileSize;
+    }
+
+    /**
+     * @return true if the footprint file still has the modification time and size it had when
+     *         this item was read.
+     */
+    bool IsFileUnchanged( long long aFileModTime, long long aFileSize ) const
+    {
+        return m_fileModTime != 0 && m_fileModTime == aFileModTime && m_fileSize == aFileSize;
+    }
 };
 
 
-FP_CACHE_ITEM::FP_CACHE_ITEM( FOOTPRINT* aFootprint, const WX_FILENAME& aFileName ) :
+FP_CACHE_ITEM::FP_CACHE_ITEM( FOOTPRINT* aFootprint, const WX_FILENAME& aFileName,
+                              long long aFileModTime, long long aFileSize ) :
         m_filename( aFileName ),
-        m_footprint( aFootprint )
+        m_footprint( aFootprint ),
+        m_fileModTime( aFileModTime ),
+        m_fileSize( aFileSize )
 { }
 
 
@@ -99,6 +129,7 @@ class FP_CACHE
                                         // m_cache_timestamp against all the files.
     long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
                                         // files.
+    FP_CACHE_INDEX  m_index;            // The files known to parse, from previous sessions.
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -122,8 +153,21 @@ public:
      */
     void Save( FOOTPRINT* aFootprint = nullptr );
 
+    /**
+     * Bring the cache up to date with the library folder.
+     *
+     * Only new and modified footprint files are parsed: footprints already in the cache are
+     * kept if their file is unchanged, and files which still match the library's
+     * #FP_CACHE_INDEX are only parsed when GetFootprint() asks for them.
+     */
     void Load();
 
+    /**
+     * @return the footprint \a aFootprintName, parsing its file if that wasn't done yet, or
+     *         nullptr if there is no such footprint or its file cannot be parsed.
+     */
+    const FOOTPRINT* GetFootprint( const wxString& aFootprintName );
+
     void Remove( const wxString& aFootprintName );
 
     /**
@@ -150,10 +194,38 @@ public:
      * @return true if \a aPath is the same as the cache path.
      */
     bool IsPath( const wxString& aPath ) const;
+
+private:
+    ///< A footprint file to be parsed by parseFiles(), with the outcome
+    struct PARSE_JOB
+    {
+        PARSE_JOB( const WX_FILENAME& aFileName, long long aFileModTime, long long aFileSize ) :
+                m_fileName( aFileName ),
+                m_fileModTime( aFileModTime ),
+                m_fileSize( aFileSize )
+        {}
+
+        WX_FILENAME                m_fileName;
+        long long                  m_fileModTime;
+        long long                  m_fileSize;
+        std::unique_ptr<FOOTPRINT> m_footprint;     // nullptr if the file failed to parse
+        wxString                   m_error;
+    };
+
+    /**
+     * Parse the files of \a aJobs, concurrently if there are enough of them.
+     *
+     * Each thread has a #PCB_PARSER of its own.  Errors are stored in the jobs rather than
+     * thrown, so that one bad file doesn't keep the others from loading.
+     */
+    void parseFiles( std::vector<PARSE_JOB>& aJobs );
+
+    static FOOTPRINT* parseFile( const WX_FILENAME& aFileName, PCB_PARSER* aParser );
 };
 
 
-FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
+FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath ) :
+        m_index( aLibraryPath )
 {
     m_owner = aOwner;
     m_lib_raw_path = aLibraryPath;
@@ -179,11 +251,17 @@ void FP_CACHE::Save( FOOTPRINT* aFootprint )
                                           m_lib_raw_path ) );
     }
 
+    m_index.Read();
+
     for( FOOTPRINT_MAP::iterator it = m_footprints.begin(); it != m_footprints.end(); ++it )
     {
         if( aFootprint && aFootprint != it->second->GetFootprint() )
             continue;
 
+        // Footprints which haven't been parsed yet are still exactly what is in their file
+        if( !it->second->GetFootprint() )
+            continue;
+
         WX_FILENAME fn = it->second->GetFileName();
 
         wxString tempFileName =
@@ -219,9 +297,20 @@ void FP_CACHE::Save( FOOTPRINT* aFootprint )
             THROW_IO_ERROR( msg );
         }
 #endif
+        long long fileModTime;
+        long long fileSize;
+
+        if( CACHE_INDEX_FILE::GetFileStat( fn.GetFullPath(), fileModTime, fileSize ) )
+        {
+            it->second->SetFileStat( fileModTime, fileSize );
+            m_index.Set( fn.GetFullName(), fileModTime, fileSize );
+        }
+
         m_cache_timestamp += fn.GetTimestamp();
     }
 
+    m_index.Write();
+
     m_cache_timestamp += m_lib_path.GetModificationTime().GetValue().GetValue();
 
     // If we've saved the full cache, we clear the dirty flag.
@@ -246,6 +335,13 @@ void FP_CACHE::Load()
 
     wxString fullName;
     wxString fileSpec = wxT( "*." ) + KiCadFootprintFileExtension;
+    wxString cacheError;
+
+    std::set<wxString>     fileNames;
+    std::set<wxString>     fpNames;
+    std::vector<PARSE_JOB> jobs;
+
+    m_index.Read();
 
     // wxFileName construction is egregiously slow.  Construct it once and just swap out
     // the filename thereafter.
@@ -253,39 +349,183 @@ void FP_CACHE::Load()
 
     if( dir.GetFirst( &fullName, fileSpec ) )
     {
-        wxString cacheError;
-
         do
         {
             fn.SetFullName( fullName );
 
-            // Queue I/O errors so only files that fail to parse don't get loaded.
-            try
+            wxString  fpName = fn.GetName();
+            long long fileModTime = 0;
+            long long fileSize = 0;
+
+            CACHE_INDEX_FILE::GetFileStat( fn.GetFullPath(), fileModTime, fileSize );
+            fileNames.insert( fullName );
+            fpNames.insert( fpName );
+
+            FOOTPRINT_MAP::iterator it = m_footprints.find( fpName );
+
+            if( it != m_footprints.end() && it->second->IsFileUnchanged( fileModTime, fileSize ) )
+                continue;
+
+            m_footprints.erase( fpName );
+
+            const FP_CACHE_INDEX::ENTRY* entry = m_index.Find( fullName );
+
+            if( entry && fileModTime != 0 && entry->m_modTime == fileModTime
+                    && entry->m_size == fileSize )
             {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+                // Parsed fine last time and hasn't changed since: parse it when it's needed
+                m_footprints.insert( fpName, new FP_CACHE_ITEM( nullptr, fn, fileModTime,
+                                                                fileSize ) );
+                continue;
+            }
 
-                m_owner->m_parser->SetLineReader( &reader );
+            jobs.emplace_back( fn, fileModTime, fileSize );
+        } while( dir.GetNext( &fullName ) );
 
-                FOOTPRINT* footprint = (FOOTPRINT*) m_owner->m_parser->Parse();
-                wxString   fpName = fn.GetName();
+        m_cache_timestamp = GetTimestamp( m_lib_raw_path );
+    }
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_footprints.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+    // Directory order depends on the file system; report errors in the same order everywhere
+    std::sort( jobs.begin(), jobs.end(),
+               []( const PARSE_JOB& a, const PARSE_JOB& b )
+               {
+                   return a.m_fileName.GetFullName() < b.m_fileName.GetFullName();
+               } );
+
+    parseFiles( jobs );
+
+    for( PARSE_JOB& job : jobs )
+    {
+        wxString fileName = job.m_fileName.GetFullName();
+
+        // Queue I/O errors so only files that fail to parse don't get loaded.
+        if( job.m_footprint )
+        {
+            m_footprints.insert( job.m_fileName.GetName(),
+                                 new FP_CACHE_ITEM( job.m_footprint.release(), job.m_fileName,
+                                                    job.m_fileModTime, job.m_fileSize ) );
+            m_index.Set( fileName, job.m_fileModTime, job.m_fileSize );
+        }
+        else
+        {
+            m_index.Remove( fileName );
+
+            if( !cacheError.IsEmpty() )
+                cacheError += "\n\n";
+
+            cacheError += job.m_error;
+        }
+    }
+
+    // Forget the footprints whose files have gone
+    for( FOOTPRINT_MAP::iterator it = m_footprints.begin(); it != m_footprints.end(); )
+    {
+        if( fpNames.count( it->first ) )
+            ++it;
+        else
+            it = m_footprints.erase( it );
+    }
+
+    m_index.Prune( fileNames );
+    m_index.Write();
+
+    if( !cacheError.IsEmpty() )
+        THROW_IO_ERROR( cacheError );
+}
+
+
+void FP_CACHE::parseFiles( std::vector<PARSE_JOB>& aJobs )
+{
+    // Parsing a footprint file is quick; don't spin up a thread for fewer than 8 of them
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   ( aJobs.size() + 7 ) / 8 );
+
+    std::atomic<size_t> nextJob( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    // Each thread gets a parser of its own; the owner's one is only used from the caller's
+    // thread.
+    auto parse_lambda = [&nextJob, &aJobs]( PCB_PARSER* aParser ) -> size_t
+    {
+        for( size_t i = nextJob++; i < aJobs.size(); i = nextJob++ )
+        {
+            try
+            {
+                aJobs[i].m_footprint.reset( parseFile( aJobs[i].m_fileName, aParser ) );
             }
             catch( const IO_ERROR& ioe )
             {
-                if( !cacheError.IsEmpty() )
-                    cacheError += "\n\n";
-
-                cacheError += ioe.What();
+                aJobs[i].m_error = ioe.What();
             }
-        } while( dir.GetNext( &fullName ) );
+        }
 
-        m_cache_timestamp = GetTimestamp( m_lib_raw_path );
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+    {
+        parse_lambda( m_owner->m_parser );
+    }
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            returns[ii] = std::async( std::launch::async,
+                                      [&parse_lambda]() -> size_t
+                                      {
+                                          PCB_PARSER parser;
+                                          return parse_lambda( &parser );
+                                      } );
+        }
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+}
 
-        if( !cacheError.IsEmpty() )
-            THROW_IO_ERROR( cacheError );
+
+FOOTPRINT* FP_CACHE::parseFile( const WX_FILENAME& aFileName, PCB_PARSER* aParser )
+{
+    FILE_LINE_READER reader( aFileName.GetFullPath() );
+
+    aParser->SetLineReader( &reader );
+
+    FOOTPRINT* footprint = (FOOTPRINT*) aParser->Parse();
+
+    footprint->SetFPID( LIB_ID( wxEmptyString, aFileName.GetName() ) );
+
+    return footprint;
+}
+
+
+const FOOTPRINT* FP_CACHE::GetFootprint( const wxString& aFootprintName )
+{
+    FOOTPRINT_MAP::iterator it = m_footprints.find( aFootprintName );
+
+    if( it == m_footprints.end() )
+        return nullptr;
+
+    if( !it->second->GetFootprint() )
+    {
+        try
+        {
+            it->second->SetFootprint( parseFile( it->second->GetFileName(),
+                                                 m_owner->m_parser ) );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            // The file changed behind our back; the next Load() will report the error
+            wxLogTrace( traceKicadPcbPlugin, wxT( "Cannot load footprint '%s': %s" ),
+                        aFootprintName, ioe.What() );
+
+            m_index.Remove( it->second->GetFileName().GetFullName() );
+            m_footprints.erase( it );
+            m_cache_dirty = true;
+            return nullptr;
+        }
     }
+
+    return it->second->GetFootprint();
 }
 
 
@@ -303,6 +543,7 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
 
     // Remove the footprint from the cache and delete the footprint file from the library.
     wxString fullPath = it->second->GetFileName().GetFullPath();
+    m_index.Remove( it->second->GetFileName().GetFullName() );
     m_footprints.erase( aFootprintName );
     wxRemoveFile( fullPath );
 }
@@ -2074,7 +2315,7 @@ void PCB_IO::format( const ZONE* aZone, int aNestLevel ) const
 
     if( aZone->GetNumCorners() )
     {
-        SHAPE_POLY_SET::POLYGON poly = aZone->Outline()->Polygon(0);
+        SHAPE_POLY_SET::POLYGON poly = aZone->Outline()->CPolygon( 0 );
 
         for( auto& chain : poly )
         {
@@ -2243,7 +2484,7 @@ PCB_IO::~PCB_IO()
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties,
                      PROJECT* aProject, PROGRESS_REPORTER* aProgressReporter )
 {
-    FILE_LINE_READER reader( aFileName );
+    MMAP_LINE_READER reader( aFileName );
 
     unsigned lineCount = 0;
 
@@ -2319,13 +2560,18 @@ void PCB_IO::init( const PROPERTIES* aProperties )
 
 void PCB_IO::validateCache( const wxString& aLibraryPath, bool checkModified )
 {
-    if( !m_cache || !m_cache->IsPath( aLibraryPath ) || ( checkModified && m_cache->IsModified() ) )
+    if( !m_cache || !m_cache->IsPath( aLibraryPath ) )
     {
         // a spectacular episode in memory management:
         delete m_cache;
         m_cache = new FP_CACHE( this, aLibraryPath );
         m_cache->Load();
     }
+    else if( checkModified && m_cache->IsModified() )
+    {
+        // Only the new and modified footprint files get parsed again
+        m_cache->Load();
+    }
 }
 
 
@@ -2376,13 +2622,7 @@ const FOOTPRINT* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    FOOTPRINT_MAP& footprints = m_cache->GetFootprints();
-    FOOTPRINT_MAP::const_iterator it = footprints.find( aFootprintName );
-
-    if( it == footprints.end() )
-        return nullptr;
-
-    return it->second->GetFootprint();
+    return m_cache->GetFootprint( aFootprintName );
 }
 
 
@@ -164,11 +164,16 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
-    char* tmp;
+    char*  tmp;
+    double fval;
+
+    // Quick, and exactly what strtod() gives, for the plain decimals we write ourselves
+    if( ParseDecimalDouble( CurText(), fval ) )
+        return fval;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    fval = strtod( CurText(), &tmp );
 
     if( errno )
     {
@@ -200,29 +205,32 @@ int PCB_PARSER::parseBoardUnits()
     // to confirm or experiment.  Use a similar strategy in both places, here
     // and in the test program. Make that program with:
     // $ make test-nm-biu-to-ascii-mm-round-tripping
-    auto retval = parseDouble() * IU_PER_MM;
 
     // N.B. we currently represent board units as integers.  Any values that are
     // larger or smaller than those board units represent undefined behavior for
     // the system.  We limit values to the largest that is visible on the screen
     // This is the diagonal distance of the full screen ~1.5m
-    double int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
+    double    int_limit = std::numeric_limits<int>::max() * 0.7071; // 0.7071 = roughly 1/sqrt(2)
+    long long biu;
+
+    // Values with no more than nanometer resolution (all the ones we write) convert exactly,
+    // with no need to go through a double
+    if( ParseDecimalFixed( CurText(), (long long) IU_PER_MM, biu ) && std::abs( biu ) <= int_limit )
+        return (int) biu;
+
+    auto retval = parseDouble() * IU_PER_MM;
+
+    // Use here #KiROUND, not EKIROUND (see comments about them) when having a function as
+    // argument, because it will be called twice with #KIROUND.
     return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
 }
 
 
 int PCB_PARSER::parseBoardUnits( const char* aExpected )
 {
-    auto retval = parseDouble( aExpected ) * IU_PER_MM;
+    NeedNUMBER( aExpected );
 
-    // N.B. we currently represent board units as integers.  Any values that are
-    // larger or smaller than those board units represent undefined behavior for
-    // the system.  We limit values to the largest that is visible on the screen
-    double int_limit = std::numeric_limits<int>::max() * 0.7071;
-
-    // Use here #KiROUND, not EKIROUND (see comments about them) when having a function as
-    // argument, because it will be called twice with #KIROUND.
-    return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
+    return parseBoardUnits();
 }
 
 
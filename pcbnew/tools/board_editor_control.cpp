@@ -47,6 +47,7 @@
 #include <dialogs/dialog_page_settings.h>
 #include <dialogs/dialog_update_pcb.h>
 #include <functional>
+#include <geometry/poly_boolean_builder.h>
 #include <kiface_i.h>
 #include <kiway.h>
 #include <memory>
@@ -1290,13 +1291,12 @@ static bool mergeZones( BOARD_COMMIT& aCommit, std::vector<ZONE*>& aOriginZones,
 {
     aCommit.Modify( aOriginZones[0] );
 
-    for( unsigned int i = 1; i < aOriginZones.size(); i++ )
-    {
-        aOriginZones[0]->Outline()->BooleanAdd( *aOriginZones[i]->Outline(),
-                                                SHAPE_POLY_SET::PM_FAST );
-    }
+    POLY_BOOLEAN_BUILDER merged;
+
+    for( ZONE* zone : aOriginZones )
+        merged.AddSubject( *zone->Outline() );
 
-    aOriginZones[0]->Outline()->Simplify( SHAPE_POLY_SET::PM_FAST );
+    merged.Union( *aOriginZones[0]->Outline(), SHAPE_POLY_SET::PM_FAST );
 
     // We should have one polygon with hole
     // We can have 2 polygons with hole, if the 2 initial polygons have only one common corner
@@ -1317,7 +1317,8 @@ static bool mergeZones( BOARD_COMMIT& aCommit, std::vector<ZONE*>& aOriginZones,
 
     aOriginZones[0]->SetLocalFlags( 1 );
     aOriginZones[0]->HatchBorder();
-    aOriginZones[0]->CacheTriangulation();
+    // Merged zones can be huge and we're on the UI thread here, so use all the cores
+    aOriginZones[0]->CacheTriangulation( UNDEFINED_LAYER, true );
 
     return true;
 }
@@ -34,7 +34,10 @@
 #include <board_design_settings.h>
 #include <widgets/progress_reporter.h>
 #include <drc/drc_engine.h>
+#include <drc/drc_item.h>
 #include <drc/drc_results_provider.h>
+#include <footprint.h>
+#include <pcb_marker.h>
 #include <netlist_reader/pcb_netlist.h>
 
 DRC_TOOL::DRC_TOOL() :
@@ -213,6 +216,84 @@ void DRC_TOOL::RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones
 }
 
 
+void DRC_TOOL::RunIncrementalTests( const std::vector<BOARD_ITEM*>& aItems,
+                                    const std::set<KIID>& aRemovedItems )
+{
+    // Note that this also keeps us from re-entering when the marker changes are committed.
+    if( m_drcRunning || !m_drcEngine || !m_drcEngine->RulesValid() )
+        return;
+
+    if( aItems.empty() && aRemovedItems.empty() )
+        return;
+
+    BOARD_COMMIT   commit( m_editFrame );
+    std::set<KIID> dirtyItems = aRemovedItems;
+
+    for( BOARD_ITEM* item : aItems )
+    {
+        dirtyItems.insert( item->m_Uuid );
+
+        if( item->Type() == PCB_FOOTPRINT_T )
+        {
+            static_cast<FOOTPRINT*>( item )->RunOnChildren(
+                    [&]( BOARD_ITEM* child )
+                    {
+                        dirtyItems.insert( child->m_Uuid );
+                    } );
+        }
+    }
+
+    // Serialized markers, see PCB_MARKER::Serialize()
+    std::set<wxString> exclusions;
+
+    m_drcRunning = true;
+
+    for( PCB_MARKER* marker : m_pcb->Markers() )
+    {
+        std::shared_ptr<RC_ITEM> rcItem = marker->GetRCItem();
+
+        if( !dirtyItems.count( rcItem->GetMainItemID() )
+                && !dirtyItems.count( rcItem->GetAuxItemID() ) )
+        {
+            continue;
+        }
+
+        // Keep the markers of tests which won't be re-run.  This goes by error code rather than
+        // by test, as the markers loaded from the board file don't know their test.
+        if( !m_drcEngine->IsIncrementallyTested( rcItem->GetErrorCode() ) )
+            continue;
+
+        if( marker->IsExcluded() )
+            exclusions.insert( marker->Serialize() );
+
+        commit.Remove( marker );
+    }
+
+    m_drcEngine->SetViolationHandler(
+            [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+            {
+                PCB_MARKER* marker = new PCB_MARKER( aItem, aPos );
+
+                // The same violation as an excluded marker replaced here, as matched by
+                // BOARD::ResolveDRCExclusions()
+                if( exclusions.count( marker->Serialize() ) )
+                    marker->SetExcluded( true );
+
+                commit.Add( marker );
+            } );
+
+    m_drcEngine->RunIncrementalTests( m_editFrame->GetUserUnits(), aItems );
+
+    m_drcEngine->ClearViolationHandler();
+
+    commit.Push( _( "DRC" ), false );
+
+    m_drcRunning = false;
+
+    updatePointers();
+}
+
+
 void DRC_TOOL::updatePointers()
 {
     // update my pointers, m_editFrame is the only unchangeable one
@@ -30,7 +30,9 @@
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 #include <memory>
+#include <set>
 #include <vector>
+#include <kiid.h>
 #include <tools/pcb_tool_base.h>
 
 
@@ -94,6 +96,16 @@ public:
     void RunTests( PROGRESS_REPORTER* aProgressReporter, bool aRefillZones,
                    bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * Re-test the items added or modified by a commit (and their neighbourhood), and update the
+     * markers involving them or the items removed by the commit.
+     *
+     * Markers produced by board-level tests (connectivity, schematic parity, etc.) are left
+     * alone; they're only updated by a full DRC run.
+     */
+    void RunIncrementalTests( const std::vector<BOARD_ITEM*>& aItems,
+                              const std::set<KIID>& aRemovedItems );
+
     int PrevMarker( const TOOL_EVENT& aEvent );
     int NextMarker( const TOOL_EVENT& aEvent );
     int ExcludeMarker( const TOOL_EVENT& aEvent );
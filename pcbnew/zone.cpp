@@ -25,6 +25,7 @@
 
 #include <bitmaps.h>
 #include <geometry/geometry_utils.h>
+#include <geometry/poly_boolean_builder.h>
 #include <geometry/shape_null.h>
 #include <core/mirror.h>
 #include <advanced_config.h>
@@ -71,6 +72,7 @@ ZONE::ZONE( BOARD_ITEM_CONTAINER* aParent, bool aInFP ) :
     SetLocalFlags( 0 );                 // flags temporary used in zone calculations
     m_Poly = new SHAPE_POLY_SET();      // Outlines
     m_fillVersion = 5;                  // set the "old" way to build filled polygon areas (< 6.0.x)
+    m_fillInputsHash = 0;
     m_islandRemovalMode = ISLAND_REMOVAL_MODE::ALWAYS;
     aParent->GetZoneSettings().ExportSetting( *this );
 
@@ -135,6 +137,7 @@ void ZONE::InitDataFromSrcInCopyCtor( const ZONE& aZone )
     m_ZoneClearance           = aZone.m_ZoneClearance;     // clearance value
     m_ZoneMinThickness        = aZone.m_ZoneMinThickness;
     m_fillVersion             = aZone.m_fillVersion;
+    m_fillInputsHash          = aZone.m_fillInputsHash;
     m_islandRemovalMode       = aZone.m_islandRemovalMode;
     m_minIslandArea           = aZone.m_minIslandArea;
 
@@ -204,6 +207,7 @@ bool ZONE::UnFill()
 
     m_isFilled = false;
     m_fillFlags.clear();
+    m_fillInputsHash = 0;
 
     return change;
 }
@@ -526,7 +530,7 @@ bool ZONE::HitTestCutout( const VECTOR2I& aRefPos, int* aOutlineIdx, int* aHoleI
     {
         for( int j = 0; j < m_Poly->HoleCount( i ); j++ )
         {
-            if( m_Poly->Hole( i, j ).PointInside( aRefPos ) )
+            if( m_Poly->CHole( i, j ).PointInside( aRefPos ) )
             {
                 if( aOutlineIdx )
                     *aOutlineIdx = i;
@@ -1105,17 +1109,17 @@ void ZONE::SwapData( BOARD_ITEM* aImage )
 }
 
 
-void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer )
+void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer, bool aParallel )
 {
     if( aLayer == UNDEFINED_LAYER )
     {
         for( std::pair<const PCB_LAYER_ID, SHAPE_POLY_SET>& pair : m_FilledPolysList )
-            pair.second.CacheTriangulation();
+            pair.second.CacheTriangulation( true, aParallel );
     }
     else
     {
         if( m_FilledPolysList.count( aLayer ) )
-            m_FilledPolysList[ aLayer ].CacheTriangulation();
+            m_FilledPolysList[ aLayer ].CacheTriangulation( true, aParallel );
     }
 }
 
@@ -1226,8 +1230,17 @@ bool ZONE::BuildSmoothedPoly( SHAPE_POLY_SET& aSmoothedPoly, PCB_LAYER_ID aLayer
         maxExtents = &withFillets;
     }
 
-    for( ZONE* zone : interactingZones )
-        aSmoothedPoly.BooleanAdd( *zone->Outline(), SHAPE_POLY_SET::PM_FAST );
+    if( !interactingZones.empty() )
+    {
+        POLY_BOOLEAN_BUILDER merged;
+
+        merged.AddSubject( aSmoothedPoly );
+
+        for( ZONE* zone : interactingZones )
+            merged.AddSubject( *zone->Outline() );
+
+        merged.Union( aSmoothedPoly, SHAPE_POLY_SET::PM_FAST );
+    }
 
     if( aBoardOutline )
     {
@@ -1263,10 +1276,10 @@ double ZONE::CalculateFilledArea()
 
         for( int i = 0; i < poly.OutlineCount(); i++ )
         {
-            m_area += poly.Outline( i ).Area();
+            m_area += poly.COutline( i ).Area();
 
             for( int j = 0; j < poly.HoleCount( i ); j++ )
-                m_area -= poly.Hole( i, j ).Area();
+                m_area -= poly.CHole( i, j ).Area();
         }
     }
 
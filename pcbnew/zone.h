@@ -642,8 +642,11 @@ public:
     /**
      * Create a list of triangles that "fill" the solid areas used for instance to draw
      * these solid areas on OpenGL.
+     *
+     * @param aParallel set to spread the work over several threads (see
+     *                  SHAPE_POLY_SET::CacheTriangulation()).
      */
-    void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER );
+    void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER, bool aParallel = false );
 
     /**
      * Set the list of filled polygons.
@@ -693,6 +696,13 @@ public:
     int GetFillVersion() const { return m_fillVersion; }
     void SetFillVersion( int aVersion ) { m_fillVersion = aVersion; }
 
+    /**
+     * A hash of the inputs the current fill was computed from (see ZONE_FILLER), or 0 if not
+     * known.  Used to skip refilling zones which are already up to date.
+     */
+    size_t GetFillInputsHash() const { return m_fillInputsHash; }
+    void SetFillInputsHash( size_t aHash ) { m_fillInputsHash = aHash; }
+
     /**
      * Remove a cutout from the zone.
      *
@@ -925,6 +935,9 @@ protected:
     /// A hash value used in zone filling calculations to see if the filled areas are up to date
     std::map<PCB_LAYER_ID, MD5_HASH>       m_filledPolysHash;
 
+    /// A hash of the items and settings the fill was computed from
+    size_t                                 m_fillInputsHash;
+
     ZONE_BORDER_DISPLAY_STYLE m_borderStyle;       // border display style, see enum above
     int                       m_borderHatchPitch;  // for DIAGONAL_EDGE, distance between 2 lines
     std::vector<SEG>          m_borderHatchLines;  // hatch lines
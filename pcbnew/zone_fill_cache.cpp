@@ -0,0 +1,363 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <wx/filename.h>
+
+#include <build_version.h>
+#include <zone.h>
+#include "zone_fill_cache.h"
+
+
+// Bump this when the file layout (or the way fill inputs are hashed) changes
+static const uint32_t s_formatVersion = 2;
+static const char     s_magic[] = "KICAD_ZONE_FILL_CACHE";
+
+
+namespace
+{
+
+/**
+ * Minimal binary writer/reader for the cache file.  Values are written in the host's byte
+ * order; the cache is a local, disposable file.
+ */
+class CACHE_WRITER
+{
+public:
+    CACHE_WRITER( std::ostream& aStream ) : m_stream( aStream ) {}
+
+    void Int( int32_t aValue )   { write( aValue ); }
+    void UInt( uint32_t aValue ) { write( aValue ); }
+    void Hash( uint64_t aValue ) { write( aValue ); }
+
+    void String( const std::string& aValue )
+    {
+        UInt( aValue.size() );
+        m_stream.write( aValue.data(), aValue.size() );
+    }
+
+private:
+    template <typename T>
+    void write( T aValue )
+    {
+        m_stream.write( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+    }
+
+    std::ostream& m_stream;
+};
+
+
+class CACHE_READER
+{
+public:
+    CACHE_READER( std::istream& aStream ) : m_stream( aStream ) {}
+
+    bool Int( int32_t& aValue )   { return read( aValue ); }
+    bool UInt( uint32_t& aValue ) { return read( aValue ); }
+    bool Hash( uint64_t& aValue ) { return read( aValue ); }
+
+    bool String( std::string& aValue )
+    {
+        uint32_t size;
+
+        // Nothing we write comes anywhere near this; it's a corrupt file
+        if( !UInt( size ) || size > 4096 )
+            return false;
+
+        aValue.resize( size );
+        return size == 0 || bool( m_stream.read( &aValue[0], size ) );
+    }
+
+private:
+    template <typename T>
+    bool read( T& aValue )
+    {
+        return bool( m_stream.read( reinterpret_cast<char*>( &aValue ), sizeof( T ) ) );
+    }
+
+    std::istream& m_stream;
+};
+
+} // anonymous namespace
+
+
+wxString ZONE_FILL_CACHE::CacheFileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+
+    fn.SetFullName( fn.GetName() + wxT( "-zone-fill-cache" ) );
+    return fn.GetFullPath();
+}
+
+
+bool ZONE_FILL_CACHE::Load( const wxString& aFileName )
+{
+    m_entries.clear();
+
+    std::ifstream stream( aFileName.fn_str(), std::ios::binary );
+
+    if( !stream )
+        return false;
+
+    CACHE_READER reader( stream );
+    std::string  magic;
+    std::string  buildVersion;
+    uint32_t     formatVersion;
+    uint32_t     entryCount;
+
+    if( !reader.String( magic ) || magic != s_magic
+            || !reader.UInt( formatVersion ) || formatVersion != s_formatVersion
+            || !reader.String( buildVersion ) || buildVersion != GetBuildVersion().ToStdString()
+            || !reader.UInt( entryCount ) )
+    {
+        return false;
+    }
+
+    for( uint32_t ii = 0; ii < entryCount; ++ii )
+    {
+        std::string uuid;
+        uint64_t    inputsHash;
+        int32_t     fillVersion;
+        uint32_t    layerCount;
+
+        if( !reader.String( uuid ) || !reader.Hash( inputsHash ) || !reader.Int( fillVersion )
+                || !reader.UInt( layerCount ) || layerCount > PCB_LAYER_ID_COUNT )
+        {
+            m_entries.clear();
+            return false;
+        }
+
+        ENTRY& entry = m_entries[ KIID( wxString( uuid ) ) ];
+
+        entry.m_inputsHash = inputsHash;
+        entry.m_fillVersion = fillVersion;
+
+        for( uint32_t jj = 0; jj < layerCount; ++jj )
+        {
+            int32_t  layer;
+            uint32_t islandCount;
+            uint32_t polygonCount;
+
+            if( !reader.Int( layer ) || layer < 0 || layer >= PCB_LAYER_ID_COUNT
+                    || !reader.UInt( islandCount ) )
+            {
+                m_entries.clear();
+                return false;
+            }
+
+            LAYER_FILL& layerFill = entry.m_layers[ ToLAYER_ID( layer ) ];
+
+            for( uint32_t kk = 0; kk < islandCount; ++kk )
+            {
+                int32_t island;
+
+                if( !reader.Int( island ) )
+                {
+                    m_entries.clear();
+                    return false;
+                }
+
+                layerFill.m_islands.insert( island );
+            }
+
+            if( !reader.UInt( polygonCount ) )
+            {
+                m_entries.clear();
+                return false;
+            }
+
+            for( uint32_t poly = 0; poly < polygonCount; ++poly )
+            {
+                uint32_t contourCount;
+
+                if( !reader.UInt( contourCount ) || contourCount == 0 )
+                {
+                    m_entries.clear();
+                    return false;
+                }
+
+                int outline = -1;
+
+                for( uint32_t contour = 0; contour < contourCount; ++contour )
+                {
+                    SHAPE_LINE_CHAIN chain;
+                    uint32_t         pointCount;
+
+                    if( !reader.UInt( pointCount ) )
+                    {
+                        m_entries.clear();
+                        return false;
+                    }
+
+                    for( uint32_t pt = 0; pt < pointCount; ++pt )
+                    {
+                        int32_t x, y;
+
+                        if( !reader.Int( x ) || !reader.Int( y ) )
+                        {
+                            m_entries.clear();
+                            return false;
+                        }
+
+                        chain.Append( x, y );
+                    }
+
+                    chain.SetClosed( true );
+
+                    if( contour == 0 )
+                        outline = layerFill.m_fill.AddOutline( chain );
+                    else
+                        layerFill.m_fill.AddHole( chain, outline );
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool ZONE_FILL_CACHE::Save( const wxString& aFileName ) const
+{
+    std::ofstream stream( aFileName.fn_str(), std::ios::binary | std::ios::trunc );
+
+    if( !stream )
+        return false;
+
+    CACHE_WRITER writer( stream );
+
+    writer.String( s_magic );
+    writer.UInt( s_formatVersion );
+    writer.String( GetBuildVersion().ToStdString() );
+    writer.UInt( m_entries.size() );
+
+    for( const std::pair<const KIID, ENTRY>& pair : m_entries )
+    {
+        const ENTRY& entry = pair.second;
+
+        writer.String( pair.first.AsString().ToStdString() );
+        writer.Hash( entry.m_inputsHash );
+        writer.Int( entry.m_fillVersion );
+        writer.UInt( entry.m_layers.size() );
+
+        for( const std::pair<const PCB_LAYER_ID, LAYER_FILL>& layer : entry.m_layers )
+        {
+            const SHAPE_POLY_SET& fill = layer.second.m_fill;
+
+            writer.Int( layer.first );
+            writer.UInt( layer.second.m_islands.size() );
+
+            for( int island : layer.second.m_islands )
+                writer.Int( island );
+
+            writer.UInt( fill.OutlineCount() );
+
+            for( int ii = 0; ii < fill.OutlineCount(); ++ii )
+            {
+                const SHAPE_POLY_SET::POLYGON& polygon = fill.CPolygon( ii );
+
+                writer.UInt( polygon.size() );
+
+                for( const SHAPE_LINE_CHAIN& chain : polygon )
+                {
+                    writer.UInt( chain.PointCount() );
+
+                    for( int pt = 0; pt < chain.PointCount(); ++pt )
+                    {
+                        writer.Int( chain.CPoint( pt ).x );
+                        writer.Int( chain.CPoint( pt ).y );
+                    }
+                }
+            }
+        }
+    }
+
+    return bool( stream );
+}
+
+
+void ZONE_FILL_CACHE::Store( const ZONE* aZone )
+{
+    if( !aZone->IsFilled() || aZone->GetFillInputsHash() == 0 )
+    {
+        m_entries.erase( aZone->m_Uuid );
+        return;
+    }
+
+    ENTRY& entry = m_entries[ aZone->m_Uuid ];
+
+    entry.m_inputsHash = aZone->GetFillInputsHash();
+    entry.m_fillVersion = aZone->GetFillVersion();
+    entry.m_layers.clear();
+
+    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+    {
+        LAYER_FILL& layerFill = entry.m_layers[ layer ];
+
+        layerFill.m_fill = aZone->GetFilledPolysList( layer );
+
+        for( int ii = 0; ii < layerFill.m_fill.OutlineCount(); ++ii )
+        {
+            if( aZone->IsIsland( layer, ii ) )
+                layerFill.m_islands.insert( ii );
+        }
+    }
+}
+
+
+bool ZONE_FILL_CACHE::Restore( ZONE* aZone, size_t aInputsHash ) const
+{
+    auto it = m_entries.find( aZone->m_Uuid );
+
+    if( it == m_entries.end() || aInputsHash == 0 || it->second.m_inputsHash != aInputsHash )
+        return false;
+
+    const ENTRY& entry = it->second;
+
+    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+    {
+        if( !entry.m_layers.count( layer ) )
+            return false;
+    }
+
+    aZone->UnFill();
+
+    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+    {
+        const LAYER_FILL& layerFill = entry.m_layers.at( layer );
+
+        aZone->SetFilledPolysList( layer, layerFill.m_fill );
+
+        for( int island : layerFill.m_islands )
+            aZone->SetIsIsland( layer, island );
+    }
+
+    aZone->SetFillVersion( entry.m_fillVersion );
+    aZone->SetIsFilled( true );
+    aZone->SetFillInputsHash( aInputsHash );
+    aZone->CalculateFilledArea();
+
+    return true;
+}
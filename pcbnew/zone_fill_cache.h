@@ -0,0 +1,100 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_FILL_CACHE_H
+#define ZONE_FILL_CACHE_H
+
+#include <map>
+#include <set>
+
+#include <kiid.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/shape_poly_set.h>
+
+class ZONE;
+
+
+/**
+ * A cache of zone fills, keyed by zone and by the hash of the inputs each fill was computed
+ * from (see ZONE::GetFillInputsHash()), which is saved alongside the board file.
+ *
+ * A cached fill is only ever used for a zone whose current inputs hash to the same value, so
+ * a stale cache costs a refill but can't produce a wrong one.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    /**
+     * @return the name of the cache file for the given board file.
+     */
+    static wxString CacheFileName( const wxString& aBoardFileName );
+
+    /**
+     * Read a cache file.  A missing, unreadable or out-of-date file just leaves the cache
+     * empty.
+     *
+     * @return true if the file was read.
+     */
+    bool Load( const wxString& aFileName );
+
+    /**
+     * Write the cache to a file.
+     *
+     * @return true if the file was written.
+     */
+    bool Save( const wxString& aFileName ) const;
+
+    /**
+     * Record the current fill of \a aZone (if it has a known inputs hash).
+     */
+    void Store( const ZONE* aZone );
+
+    /**
+     * Replace the fill of \a aZone by the cached one if it was computed from inputs hashing
+     * to \a aInputsHash.
+     *
+     * @return true if the zone's fill was restored from the cache.
+     */
+    bool Restore( ZONE* aZone, size_t aInputsHash ) const;
+
+    void Clear() { m_entries.clear(); }
+
+    bool IsEmpty() const { return m_entries.empty(); }
+
+private:
+    struct LAYER_FILL
+    {
+        SHAPE_POLY_SET m_fill;
+        std::set<int>  m_islands;
+    };
+
+    struct ENTRY
+    {
+        size_t                              m_inputsHash;
+        int                                 m_fillVersion;
+        std::map<PCB_LAYER_ID, LAYER_FILL>  m_layers;
+    };
+
+    std::map<KIID, ENTRY> m_entries;
+};
+
+#endif    // ZONE_FILL_CACHE_H
@@ -41,11 +41,15 @@
 #include <board_commit.h>
 #include <widgets/progress_reporter.h>
 #include <geometry/shape_poly_set.h>
+#include <geometry/poly_boolean_builder.h>
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
 #include <convert_to_biu.h>
 #include <math/util.h>      // for KiROUND
+#include <hash_eda.h>
+#include <drc/drc_engine.h>
+#include "zone_fill_cache.h"
 #include "zone_filler.h"
 
 static const double s_RoundPadThermalSpokeAngle = 450;      // in deci-degrees
@@ -61,6 +65,7 @@ ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
 {
     // To enable add "DebugZoneFiller=1" to kicad_advanced settings file.
     m_debugZoneFiller = ADVANCED_CFG::GetCfg().m_DebugZoneFiller;
+    m_incrementalFill = ADVANCED_CFG::GetCfg().m_IncrementalZoneFill;
 }
 
 
@@ -84,6 +89,234 @@ void ZONE_FILLER::SetProgressReporter( PROGRESS_REPORTER* aReporter )
 }
 
 
+/**
+ * Add every point of \a aPolySet, holes included, to \a aHash.
+ */
+static void hashPolySet( size_t& aHash, const SHAPE_POLY_SET& aPolySet )
+{
+    hash_combine( aHash, aPolySet.OutlineCount(), aPolySet.TotalVertices() );
+
+    for( auto it = aPolySet.CIterateWithHoles(); it; it++ )
+        hash_combine( aHash, it->x, it->y );
+}
+
+
+/**
+ * Add the full geometry of \a aShape to \a aHash.
+ */
+static void hashShape( size_t& aHash, const PCB_SHAPE* aShape )
+{
+    hash_combine( aHash, (int) aShape->GetShape(), aShape->GetStart().x, aShape->GetStart().y,
+                  aShape->GetEnd().x, aShape->GetEnd().y, aShape->GetWidth(),
+                  aShape->GetAngle(), aShape->IsFilled() );
+
+    switch( aShape->GetShape() )
+    {
+    case SHAPE_T::BEZIER:
+        hash_combine( aHash, aShape->GetBezierC1().x, aShape->GetBezierC1().y,
+                      aShape->GetBezierC2().x, aShape->GetBezierC2().y );
+        break;
+
+    case SHAPE_T::POLY:
+        hashPolySet( aHash, aShape->GetPolyShape() );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+size_t ZONE_FILLER::FillDependencyHash( const BOARD_ITEM* aItem )
+{
+    size_t hash = hash_val( (int) aItem->Type() );
+
+    hash_combine( hash, std::hash<BASE_SET>()( aItem->GetLayerSet() ) );
+
+    if( aItem->IsConnected() )
+    {
+        const BOARD_CONNECTED_ITEM* item = static_cast<const BOARD_CONNECTED_ITEM*>( aItem );
+
+        hash_combine( hash, item->GetNetCode(), item->GetNetClassName().ToStdString() );
+    }
+
+    switch( aItem->Type() )
+    {
+    case PCB_VIA_T:
+    {
+        const PCB_VIA* via = static_cast<const PCB_VIA*>( aItem );
+
+        hash_combine( hash, via->GetDrillValue(), (int) via->GetViaType(),
+                      via->GetRemoveUnconnected(), via->GetKeepTopBottom() );
+    }
+        KI_FALLTHROUGH;
+
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    {
+        const PCB_TRACK* track = static_cast<const PCB_TRACK*>( aItem );
+
+        hash_combine( hash, track->GetStart().x, track->GetStart().y, track->GetEnd().x,
+                      track->GetEnd().y, track->GetWidth() );
+
+        if( track->Type() == PCB_ARC_T )
+        {
+            const PCB_ARC* arc = static_cast<const PCB_ARC*>( track );
+
+            hash_combine( hash, arc->GetMid().x, arc->GetMid().y );
+        }
+    }
+        break;
+
+    case PCB_PAD_T:
+    {
+        const PAD* pad = static_cast<const PAD*>( aItem );
+
+        hash_combine( hash, hash_fp_item( pad, HASH_POS | HASH_ROT | HASH_LAYER | HASH_NET ) );
+        hash_combine( hash, pad->GetDrillSize().x, pad->GetDrillSize().y,
+                      (int) pad->GetAttribute(), pad->GetLocalClearance(),
+                      (int) pad->GetEffectiveZoneConnection(), pad->GetThermalGap(),
+                      pad->GetThermalSpokeWidth() );
+        hash_combine( hash, pad->GetRoundRectRadiusRatio(), pad->GetChamferRectRatio(),
+                      pad->GetChamferPositions(), (int) pad->GetAnchorPadShape(),
+                      (int) pad->GetCustomShapeInZoneOpt(), pad->GetRemoveUnconnected(),
+                      pad->GetKeepTopBottom() );
+
+        // Custom pad primitives, in pad coordinates
+        for( const std::shared_ptr<PCB_SHAPE>& primitive : pad->GetPrimitives() )
+            hashShape( hash, primitive.get() );
+    }
+        break;
+
+    case PCB_SHAPE_T:
+    case PCB_FP_SHAPE_T:
+        hashShape( hash, static_cast<const PCB_SHAPE*>( aItem ) );
+        break;
+
+    case PCB_TEXT_T:
+    case PCB_FP_TEXT_T:
+    {
+        const EDA_TEXT* text = dynamic_cast<const EDA_TEXT*>( aItem );
+
+        if( text )
+        {
+            hash_combine( hash, text->GetShownText().ToStdString(), text->IsVisible(),
+                          text->GetTextThickness(), text->GetTextAngle() );
+            hash_combine( hash, text->GetTextPos().x, text->GetTextPos().y,
+                          text->GetTextWidth(), text->GetTextHeight(),
+                          (int) text->GetHorizJustify(), (int) text->GetVertJustify() );
+            hash_combine( hash, text->IsItalic(), text->IsBold(), text->IsMirrored(),
+                          text->IsMultilineAllowed() );
+        }
+    }
+        break;
+
+    case PCB_ZONE_T:
+    case PCB_FP_ZONE_T:
+    {
+        const ZONE* zone = static_cast<const ZONE*>( aItem );
+
+        hash_combine( hash, zone->GetPriority(), zone->GetIsRuleArea(),
+                      zone->GetDoNotAllowCopperPour(), zone->GetLocalClearance(),
+                      zone->GetMinThickness() );
+        hashPolySet( hash, *zone->Outline() );
+    }
+        break;
+
+    default:
+    {
+        // Nothing else is knocked out of fills; the bounding box will do
+        EDA_RECT bbox = aItem->GetBoundingBox();
+
+        hash_combine( hash, bbox.GetX(), bbox.GetY(), bbox.GetWidth(), bbox.GetHeight() );
+    }
+        break;
+    }
+
+    return hash;
+}
+
+
+void ZONE_FILLER::collectFillDependencies( std::vector<FILL_DEPENDENCY>& aDependencies )
+{
+    auto add =
+            [&]( BOARD_ITEM* aItem )
+            {
+                EDA_RECT bbox;
+                LSET     layers = aItem->GetLayerSet();
+
+                if( aItem->Type() == PCB_ZONE_T || aItem->Type() == PCB_FP_ZONE_T )
+                    bbox = static_cast<ZONE*>( aItem )->GetCachedBoundingBox();
+                else
+                    bbox = aItem->GetBoundingBox();
+
+                // Holes are knocked out of zones on all copper layers
+                if( aItem->Type() == PCB_VIA_T || aItem->Type() == PCB_PAD_T )
+                    layers |= LSET::AllCuMask();
+
+                aDependencies.push_back( { bbox, layers, FillDependencyHash( aItem ) } );
+            };
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        add( track );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        add( item );
+
+    for( ZONE* zone : m_board->Zones() )
+        add( zone );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        add( &footprint->Reference() );
+        add( &footprint->Value() );
+
+        for( PAD* pad : footprint->Pads() )
+            add( pad );
+
+        for( BOARD_ITEM* item : footprint->GraphicalItems() )
+            add( item );
+
+        for( ZONE* zone : footprint->Zones() )
+            add( zone );
+    }
+}
+
+
+size_t ZONE_FILLER::computeFillInputsHash( const ZONE* aZone,
+                                           const std::vector<FILL_DEPENDENCY>& aDependencies,
+                                           size_t aBoardHash ) const
+{
+    size_t hash = aBoardHash;
+
+    // The zone's own settings
+    hash_combine( hash, aZone->GetNetCode(), aZone->GetPriority(), aZone->GetLocalClearance(),
+                  aZone->GetMinThickness(), (int) aZone->GetPadConnection(),
+                  aZone->GetThermalReliefGap(), aZone->GetThermalReliefSpokeWidth() );
+    hash_combine( hash, (int) aZone->GetFillMode(), aZone->GetHatchThickness(),
+                  aZone->GetHatchGap(), aZone->GetHatchOrientation(),
+                  aZone->GetHatchSmoothingLevel(), aZone->GetHatchSmoothingValue(),
+                  aZone->GetHatchHoleMinArea(), aZone->GetHatchBorderAlgorithm() );
+    hash_combine( hash, (int) aZone->GetIslandRemovalMode(), aZone->GetMinIslandArea(),
+                  aZone->GetCornerSmoothingType(), aZone->GetCornerRadius(),
+                  std::hash<BASE_SET>()( aZone->GetLayerSet() ) );
+
+    // Everything within clearance (or thermal relief) range of it
+    EDA_RECT region = aZone->GetCachedBoundingBox();
+    region.Inflate( m_worstClearance + aZone->GetThermalReliefGap() );
+
+    LSET layers = aZone->GetLayerSet();
+
+    for( const FILL_DEPENDENCY& dependency : aDependencies )
+    {
+        if( ( dependency.m_layers & layers ).any() && region.Intersects( dependency.m_bbox ) )
+            hash_combine( hash, dependency.m_hash );
+    }
+
+    return hash;
+}
+
+
 bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aParent )
 {
     std::vector<std::pair<ZONE*, PCB_LAYER_ID>> toFill;
@@ -149,6 +382,125 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
                    return lhs->GetPriority() > rhs->GetPriority();
                } );
 
+    auto knocks_out =
+            [&]( ZONE* aZone, PCB_LAYER_ID aLayer, ZONE* aOtherZone ) -> bool
+            {
+                // Even if keepouts exclude copper pours the exclusion is by outline, not by
+                // filled area, so we're good-to-go here too.
+                if( aOtherZone->GetIsRuleArea() )
+                    return false;
+
+                // If the zones share no common layers
+                if( !aOtherZone->GetLayerSet().test( aLayer ) )
+                    return false;
+
+                if( aOtherZone->GetPriority() <= aZone->GetPriority() )
+                    return false;
+
+                // Same-net zones always use outline to produce predictable results
+                if( aOtherZone->GetNetCode() == aZone->GetNetCode() )
+                    return false;
+
+                // A higher priority zone whose fill is knocked out of ours if we intersect.
+                EDA_RECT inflatedBBox = aZone->GetCachedBoundingBox();
+                inflatedBBox.Inflate( m_worstClearance );
+
+                return inflatedBBox.Intersects( aOtherZone->GetCachedBoundingBox() );
+            };
+
+    std::map<ZONE*, size_t> fillInputsHashes;
+    ZONE_FILL_CACHE         fillCache;
+    wxString                cacheFileName;
+    bool                    fillsChanged = true;
+
+    if( !m_board->GetFileName().IsEmpty() )
+        cacheFileName = ZONE_FILL_CACHE::CacheFileName( m_board->GetFileName() );
+
+    if( m_incrementalFill && !aCheck )
+    {
+        std::vector<FILL_DEPENDENCY> dependencies;
+        std::set<ZONE*>              refilled;
+        std::set<ZONE*>              changed;      // Refilled or restored from the cache
+        bool                         cacheLoaded = false;
+
+        collectFillDependencies( dependencies );
+
+        size_t boardHash = hash_val( m_worstClearance, bds.m_ZoneFillVersion,
+                                     m_brdOutlinesValid, m_boardOutline.TotalVertices() );
+
+        if( bds.m_DRCEngine )
+            hash_combine( boardHash, bds.m_DRCEngine->GetRulesHash() );
+
+        for( auto it = m_boardOutline.CIterateWithHoles(); it; it++ )
+            hash_combine( boardHash, it->x, it->y );
+
+        // aZones is sorted by priority, so the refill state of every zone which might knock
+        // out a given zone is known by the time we get to it.  A fill restored from the cache
+        // may come from another outline, so it knocks out lower priority zones just as a
+        // refill does.
+        for( ZONE* zone : aZones )
+        {
+            if( zone->GetIsRuleArea() )
+                continue;
+
+            size_t hash = computeFillInputsHash( zone, dependencies, boardHash );
+            bool   knockedOut = false;
+
+            for( ZONE* otherZone : changed )
+            {
+                for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+                    knockedOut |= knocks_out( zone, layer, otherZone );
+            }
+
+            fillInputsHashes[ zone ] = hash;
+
+            if( knockedOut )
+            {
+                refilled.insert( zone );
+                changed.insert( zone );
+                continue;
+            }
+
+            if( zone->IsFilled() && hash == zone->GetFillInputsHash()
+                    && zone->GetFillVersion() == bds.m_ZoneFillVersion )
+            {
+                continue;
+            }
+
+            // Not up to date; see if a fill from the same inputs is in the cache file
+            if( !cacheLoaded && !cacheFileName.IsEmpty() )
+            {
+                fillCache.Load( cacheFileName );
+                cacheLoaded = true;
+            }
+
+            if( m_commit )
+                m_commit->Modify( zone );
+
+            // (The fill version is part of the hash, so a match is from the same version.)
+            if( fillCache.Restore( zone, hash ) )
+            {
+                zone->CacheTriangulation();
+                changed.insert( zone );
+                continue;
+            }
+
+            refilled.insert( zone );
+            changed.insert( zone );
+        }
+
+        fillsChanged = !changed.empty();
+
+        // Keep the existing fills of zones which are already up to date
+        aZones.erase( std::remove_if( aZones.begin(), aZones.end(),
+                                      [&]( ZONE* zone )
+                                      {
+                                          return !zone->GetIsRuleArea()
+                                                      && !refilled.count( zone );
+                                      } ),
+                      aZones.end() );
+    }
+
     for( ZONE* zone : aZones )
     {
         // Rule areas are not filled
@@ -177,6 +529,13 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         zone->SetFillVersion( bds.m_ZoneFillVersion );
     }
 
+    LSET fillLayers;
+
+    for( const std::pair<ZONE*, PCB_LAYER_ID>& fillItem : toFill )
+        fillLayers.set( fillItem.second );
+
+    buildKnockoutIndex( fillLayers );
+
     size_t cores = std::thread::hardware_concurrency();
     std::atomic<size_t> nextItem;
 
@@ -190,28 +549,9 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
                 if( aOtherZone->GetFillFlag( aLayer ) )
                     return false;
 
-                // Even if keepouts exclude copper pours the exclusion is by outline, not by
-                // filled area, so we're good-to-go here too.
-                if( aOtherZone->GetIsRuleArea() )
-                    return false;
-
-                // If the zones share no common layers
-                if( !aOtherZone->GetLayerSet().test( aLayer ) )
-                    return false;
-
-                if( aOtherZone->GetPriority() <= aZone->GetPriority() )
-                    return false;
-
-                // Same-net zones always use outline to produce predictable results
-                if( aOtherZone->GetNetCode() == aZone->GetNetCode() )
-                    return false;
-
                 // A higher priority zone is found: if we intersect and it's not filled yet
                 // then we have to wait.
-                EDA_RECT inflatedBBox = aZone->GetCachedBoundingBox();
-                inflatedBBox.Inflate( m_worstClearance );
-
-                return inflatedBBox.Intersects( aOtherZone->GetCachedBoundingBox() );
+                return knocks_out( aZone, aLayer, aOtherZone );
             };
 
     auto fill_lambda =
@@ -399,6 +739,31 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         }
     }
 
+    // Record what the new fills were computed from so that they can be skipped next time if
+    // nothing has changed
+    for( ZONE* zone : aZones )
+    {
+        if( fillInputsHashes.count( zone ) )
+            zone->SetFillInputsHash( fillInputsHashes.at( zone ) );
+    }
+
+    // Save the fills so that they needn't be recomputed in the next session
+    if( m_incrementalFill && !aCheck && fillsChanged && !cacheFileName.IsEmpty() )
+    {
+        fillCache.Clear();
+
+        for( ZONE* zone : m_board->Zones() )
+            fillCache.Store( zone );
+
+        for( FOOTPRINT* footprint : m_board->Footprints() )
+        {
+            for( ZONE* zone : footprint->Zones() )
+                fillCache.Store( zone );
+        }
+
+        fillCache.Save( cacheFileName );
+    }
+
     if( aCheck )
     {
         bool outOfDate = false;
@@ -648,6 +1013,74 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer
 }
 
 
+/**
+ * Index the items which may be knocked out of the fills, by layer and bounding box.
+ */
+void ZONE_FILLER::buildKnockoutIndex( const LSET& aLayers )
+{
+    m_knockoutIndex.clear();
+
+    for( PCB_LAYER_ID layer : aLayers.Seq() )
+        m_knockoutIndex[ layer ] = std::make_unique<KNOCKOUT_TREE>();
+
+    auto insert =
+            [&]( BOARD_ITEM* aItem, const EDA_RECT& aBBox, const LSET& aItemLayers )
+            {
+                const int mmin[2] = { aBBox.GetX(), aBBox.GetY() };
+                const int mmax[2] = { aBBox.GetRight(), aBBox.GetBottom() };
+
+                for( PCB_LAYER_ID layer : ( aItemLayers & aLayers ).Seq() )
+                    m_knockoutIndex[ layer ]->Insert( mmin, mmax, aItem );
+            };
+
+    // Items on the Edge_Cuts or Margin layers are knocked out of every layer
+    auto insertGraphic =
+            [&]( BOARD_ITEM* aItem )
+            {
+                if( aItem->IsOnLayer( Edge_Cuts ) || aItem->IsOnLayer( Margin ) )
+                    insert( aItem, aItem->GetBoundingBox(), aLayers );
+                else
+                    insert( aItem, aItem->GetBoundingBox(), aItem->GetLayerSet() );
+            };
+
+    auto insertZone =
+            [&]( ZONE* aZone )
+            {
+                insert( aZone, aZone->GetCachedBoundingBox(), aZone->GetLayerSet() );
+            };
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            // Holes are knocked out of layers the pad isn't flashed on too
+            if( pad->GetDrillSize().x > 0 || pad->GetDrillSize().y > 0 )
+                insert( pad, pad->GetBoundingBox(), aLayers );
+            else
+                insert( pad, pad->GetBoundingBox(), pad->GetLayerSet() );
+        }
+
+        insertGraphic( &footprint->Reference() );
+        insertGraphic( &footprint->Value() );
+
+        for( BOARD_ITEM* item : footprint->GraphicalItems() )
+            insertGraphic( item );
+
+        for( ZONE* zone : footprint->Zones() )
+            insertZone( zone );
+    }
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        insert( track, track->GetBoundingBox(), track->GetLayerSet() );
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        insertGraphic( item );
+
+    for( ZONE* zone : m_board->Zones() )
+        insertZone( zone );
+}
+
+
 /**
  * Removes clearance from the shape for copper items which share the zone's layer but are
  * not connected to it.
@@ -723,22 +1156,6 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        for( PAD* pad : footprint->Pads() )
-        {
-            if( checkForCancel( m_progressReporter ) )
-                return;
-
-            if( pad->GetNetCode() != aZone->GetNetCode()
-                    || pad->GetNetCode() <= 0
-                    || aZone->GetPadConnection( pad ) == ZONE_CONNECTION::NONE )
-            {
-                knockoutPadClearance( pad );
-            }
-        }
-    }
-
     // Add non-connected track clearances
     //
     auto knockoutTrackClearance =
@@ -785,20 +1202,6 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( PCB_TRACK* track : m_board->Tracks() )
-    {
-        if( !track->IsOnLayer( aLayer ) )
-            continue;
-
-        if( track->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
-            continue;
-
-        if( checkForCancel( m_progressReporter ) )
-            return;
-
-        knockoutTrackClearance( track );
-    }
-
     // Add graphic item clearances.  They are by definition unconnected, and have no clearance
     // definitions of their own.
     //
@@ -831,47 +1234,6 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        bool skipFootprint = false;
-
-        knockoutGraphicClearance( &footprint->Reference() );
-        knockoutGraphicClearance( &footprint->Value() );
-
-        // Don't knock out holes in zones that share a net
-        // with a nettie footprint
-        if( footprint->IsNetTie() )
-        {
-            for( PAD* pad : footprint->Pads() )
-            {
-                if( aZone->GetNetCode() == pad->GetNetCode() )
-                {
-                    skipFootprint = true;
-                    break;
-                }
-            }
-        }
-
-        if( skipFootprint )
-            continue;
-
-        for( BOARD_ITEM* item : footprint->GraphicalItems() )
-        {
-            if( checkForCancel( m_progressReporter ) )
-                return;
-
-            knockoutGraphicClearance( item );
-        }
-    }
-
-    for( BOARD_ITEM* item : m_board->Drawings() )
-    {
-        if( checkForCancel( m_progressReporter ) )
-            return;
-
-        knockoutGraphicClearance( item );
-    }
-
     // Add non-connected zone clearances
     //
     auto knockoutZoneClearance =
@@ -911,28 +1273,95 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( ZONE* otherZone : m_board->Zones() )
+    // Don't knock out holes in zones that share a net with a nettie footprint
+    std::map<FOOTPRINT*, bool> netTieFootprints;
+
+    auto isSkippedNetTie =
+            [&]( FOOTPRINT* aFootprint ) -> bool
+            {
+                if( !aFootprint->IsNetTie() )
+                    return false;
+
+                auto it = netTieFootprints.find( aFootprint );
+
+                if( it != netTieFootprints.end() )
+                    return it->second;
+
+                bool skip = false;
+
+                for( PAD* pad : aFootprint->Pads() )
+                {
+                    if( aZone->GetNetCode() == pad->GetNetCode() )
+                    {
+                        skip = true;
+                        break;
+                    }
+                }
+
+                netTieFootprints[ aFootprint ] = skip;
+                return skip;
+            };
+
+    // Only visit the items which overlap the zone, courtesy of the knockout index
+    auto indexIt = m_knockoutIndex.find( aLayer );
+
+    wxCHECK( indexIt != m_knockoutIndex.end(), /* void */ );
+
+    std::vector<BOARD_ITEM*> candidates;
+
+    auto collect =
+            [&]( BOARD_ITEM* aItem ) -> bool
+            {
+                candidates.push_back( aItem );
+                return true;
+            };
+
+    const int mmin[2] = { zone_boundingbox.GetX(), zone_boundingbox.GetY() };
+    const int mmax[2] = { zone_boundingbox.GetRight(), zone_boundingbox.GetBottom() };
+
+    indexIt->second->Search( mmin, mmax, collect );
+
+    for( BOARD_ITEM* item : candidates )
     {
         if( checkForCancel( m_progressReporter ) )
             return;
 
-        if( otherZone->GetNetCode() != aZone->GetNetCode()
-                && otherZone->GetPriority() > aZone->GetPriority() )
+        switch( item->Type() )
         {
-            knockoutZoneClearance( otherZone );
+        case PCB_PAD_T:
+        {
+            PAD* pad = static_cast<PAD*>( item );
+
+            if( pad->GetNetCode() != aZone->GetNetCode()
+                    || pad->GetNetCode() <= 0
+                    || aZone->GetPadConnection( pad ) == ZONE_CONNECTION::NONE )
+            {
+                knockoutPadClearance( pad );
+            }
+
+            break;
         }
-        else if( otherZone->GetIsRuleArea() && otherZone->GetDoNotAllowCopperPour() )
+
+        case PCB_TRACE_T:
+        case PCB_ARC_T:
+        case PCB_VIA_T:
         {
-            knockoutZoneClearance( otherZone );
+            PCB_TRACK* track = static_cast<PCB_TRACK*>( item );
+
+            if( track->GetNetCode() == aZone->GetNetCode()  && ( aZone->GetNetCode() != 0) )
+                break;
+
+            knockoutTrackClearance( track );
+            break;
         }
-    }
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        for( ZONE* otherZone : footprint->Zones() )
+        case PCB_ZONE_T:
+        case PCB_FP_ZONE_T:
         {
-            if( checkForCancel( m_progressReporter ) )
-                return;
+            ZONE* otherZone = static_cast<ZONE*>( item );
+
+            if( otherZone == aZone )
+                break;
 
             if( otherZone->GetNetCode() != aZone->GetNetCode()
                     && otherZone->GetPriority() > aZone->GetPriority() )
@@ -943,6 +1372,30 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
             {
                 knockoutZoneClearance( otherZone );
             }
+
+            break;
+        }
+
+        case PCB_FP_TEXT_T:
+            // References and values are knocked out even for net-ties
+            if( static_cast<FP_TEXT*>( item )->GetType() != FP_TEXT::TEXT_is_DIVERS )
+            {
+                knockoutGraphicClearance( item );
+                break;
+            }
+
+            KI_FALLTHROUGH;
+
+        default:
+        {
+            FOOTPRINT* parentFootprint = dynamic_cast<FOOTPRINT*>( item->GetParent() );
+
+            if( parentFootprint && isSkippedNetTie( parentFootprint ) )
+                break;
+
+            knockoutGraphicClearance( item );
+            break;
+        }
         }
     }
 
@@ -957,6 +1410,9 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
 void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID aLayer,
                                                SHAPE_POLY_SET& aRawFill )
 {
+    // Knock all the zones out in a single pass rather than one boolean op each
+    POLY_BOOLEAN_BUILDER knockouts;
+
     auto knockoutZoneOutline =
             [&]( ZONE* aKnockout )
             {
@@ -965,9 +1421,7 @@ void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID a
                     return;
 
                 if( aKnockout->GetCachedBoundingBox().Intersects( aZone->GetCachedBoundingBox() ) )
-                {
-                    aRawFill.BooleanSubtract( *aKnockout->Outline(), SHAPE_POLY_SET::PM_FAST );
-                }
+                    knockouts.AddClip( *aKnockout->Outline() );
             };
 
     for( ZONE* otherZone : m_board->Zones() )
@@ -990,6 +1444,12 @@ void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID a
             }
         }
     }
+
+    if( !knockouts.IsEmpty() )
+    {
+        knockouts.AddSubject( aRawFill );
+        knockouts.Subtract( aRawFill, SHAPE_POLY_SET::PM_FAST );
+    }
 }
 
 
@@ -1593,7 +2053,7 @@ bool ZONE_FILLER::addHatchFillTypeOnZone( const ZONE* aZone, PCB_LAYER_ID aLayer
     // It happens for holes near the zone outline
     for( int ii = 0; ii < holes.OutlineCount(); )
     {
-        double area = holes.Outline( ii ).Area();
+        double area = holes.COutline( ii ).Area();
 
         if( area < minimal_hole_area ) // The current hole is too small: remove it
             holes.DeletePolygon( ii );
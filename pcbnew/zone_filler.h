@@ -26,8 +26,11 @@
 #ifndef __ZONE_FILLER_H
 #define __ZONE_FILLER_H
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <zone.h>
+#include <geometry/rtree.h>
 
 class WX_PROGRESS_REPORTER;
 class BOARD;
@@ -55,8 +58,44 @@ public:
 
     bool IsDebug() const { return m_debugZoneFiller; }
 
+    /**
+     * Hash the properties of \a aItem which can affect the fills of the zones around it,
+     * down to every point of its outline.  Zones are only refilled when the hash of one of
+     * the items around them changes.
+     */
+    static size_t FillDependencyHash( const BOARD_ITEM* aItem );
+
 private:
 
+    /**
+     * An item which zone fills may depend on, with the hash of its fill-relevant properties.
+     */
+    struct FILL_DEPENDENCY
+    {
+        EDA_RECT m_bbox;
+        LSET     m_layers;
+        size_t   m_hash;
+    };
+
+    /**
+     * Collect the board items which can affect zone fills.
+     */
+    void collectFillDependencies( std::vector<FILL_DEPENDENCY>& aDependencies );
+
+    /**
+     * Hash everything the fill of \a aZone depends on: its own outline and settings, and the
+     * items (including other zones) within clearance range of it.
+     */
+    size_t computeFillInputsHash( const ZONE* aZone,
+                                  const std::vector<FILL_DEPENDENCY>& aDependencies,
+                                  size_t aBoardHash ) const;
+
+    /**
+     * Build a spatial index, for each of \a aLayers, of the items which may need to be knocked
+     * out of zone fills on that layer.  The index is shared read-only by the fill workers.
+     */
+    void buildKnockoutIndex( const LSET& aLayers );
+
     void addKnockout( PAD* aPad, PCB_LAYER_ID aLayer, int aGap, SHAPE_POLY_SET& aHoles );
 
     void addKnockout( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer, int aGap, bool aIgnoreLineWidth,
@@ -130,7 +169,12 @@ private:
     int                   m_maxError;
     int                   m_worstClearance;
 
+    typedef RTree<BOARD_ITEM*, int, 2, double> KNOCKOUT_TREE;
+
+    std::map<PCB_LAYER_ID, std::unique_ptr<KNOCKOUT_TREE>> m_knockoutIndex;
+
     bool                  m_debugZoneFiller;
+    bool                  m_incrementalFill;    // skip zones whose fill inputs are unchanged
 };
 
 #endif
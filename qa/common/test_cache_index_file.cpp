@@ -0,0 +1,245 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for CACHE_INDEX_FILE
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cstdint>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include <macros.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <cache_index_file.h>
+
+
+static const char     TEST_MAGIC[8] = "KIQAIDX";
+static const uint32_t TEST_VERSION = 3;
+
+
+struct CACHE_INDEX_FILE_FIXTURE
+{
+    CACHE_INDEX_FILE_FIXTURE()
+    {
+        // A library path of its own, so that no index from an earlier run applies
+        m_libPath = wxFileName::CreateTempFileName( wxT( "qa_cache_index" ) );
+    }
+
+    ~CACHE_INDEX_FILE_FIXTURE()
+    {
+        wxRemoveFile( index().GetFilePath() );
+        wxRemoveFile( m_libPath );
+    }
+
+    CACHE_INDEX_FILE index( uint32_t aVersion = TEST_VERSION ) const
+    {
+        return CACHE_INDEX_FILE( wxT( "qa" ), TEST_MAGIC, aVersion, m_libPath );
+    }
+
+    /**
+     * Save an index file holding a few values and strings after the header.
+     */
+    void saveIndex()
+    {
+        CACHE_INDEX_FILE file = index();
+
+        file.Clear();
+        file.Append<uint32_t>( 2 );
+        file.AppendString( wxT( "R_0603" ) );
+        file.AppendString( wxString::FromUTF8( "\xce\xa9 \xc2\xb5" ) );
+        file.Append<int64_t>( -1234567890123LL );
+        file.AppendString( wxEmptyString );
+
+        BOOST_REQUIRE( file.Save() );
+    }
+
+    std::string readIndexFile() const
+    {
+        wxFFile file( index().GetFilePath(), wxT( "rb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+
+        std::string contents( file.Length(), '\0' );
+
+        BOOST_REQUIRE( file.Read( &contents[0], contents.size() ) == contents.size() );
+        return contents;
+    }
+
+    void writeIndexFile( const std::string& aContents ) const
+    {
+        wxFFile file( index().GetFilePath(), wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aContents.data(), aContents.size() ) == aContents.size() );
+    }
+
+    wxString m_libPath;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( CacheIndexFile, CACHE_INDEX_FILE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    saveIndex();
+
+    CACHE_INDEX_FILE file = index();
+    uint32_t         count;
+    int64_t          value;
+    wxString         str;
+
+    BOOST_REQUIRE( file.Load() );
+
+    BOOST_CHECK( file.Read( count ) );
+    BOOST_CHECK_EQUAL( count, 2 );
+
+    BOOST_CHECK( file.ReadString( str ) );
+    BOOST_CHECK_EQUAL( str, wxT( "R_0603" ) );
+
+    BOOST_CHECK( file.ReadString( str ) );
+    BOOST_CHECK_EQUAL( str, wxString::FromUTF8( "\xce\xa9 \xc2\xb5" ) );
+
+    BOOST_CHECK( file.Read( value ) );
+    BOOST_CHECK_EQUAL( value, -1234567890123LL );
+
+    BOOST_CHECK( file.ReadString( str ) );
+    BOOST_CHECK( str.IsEmpty() );
+
+    // Nothing left
+    uint8_t byte;
+
+    BOOST_CHECK( !file.Read( byte ) );
+    BOOST_CHECK( !file.ReadString( str ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    BOOST_CHECK( !index().Load() );
+}
+
+
+BOOST_AUTO_TEST_CASE( HeaderMismatch )
+{
+    saveIndex();
+
+    BOOST_CHECK( !index( TEST_VERSION + 1 ).Load() );
+    BOOST_CHECK( !CACHE_INDEX_FILE( wxT( "qa" ), "KIXXIDX", TEST_VERSION, m_libPath ).Load() );
+
+    // The index of another library, found under the name of this one
+    CACHE_INDEX_FILE other( wxT( "qa" ), TEST_MAGIC, TEST_VERSION, m_libPath + wxT( "x" ) );
+
+    other.Clear();
+    other.Append<uint32_t>( 2 );
+    BOOST_REQUIRE( other.Save() );
+    BOOST_REQUIRE( wxRenameFile( other.GetFilePath(), index().GetFilePath(), true ) );
+
+    BOOST_CHECK( !index().Load() );
+}
+
+
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    saveIndex();
+
+    std::string contents = readIndexFile();
+
+    // Within the header, the file is rejected at once
+    writeIndexFile( contents.substr( 0, 10 ) );
+    BOOST_CHECK( !index().Load() );
+
+    // Within a string after the header, that string cannot be read
+    size_t headerSize = 8 + 4 + 4 + std::string( TO_UTF8( m_libPath ) ).size();
+
+    writeIndexFile( contents.substr( 0, headerSize + 4 + 4 + 3 ) );
+
+    CACHE_INDEX_FILE file = index();
+    uint32_t         count;
+    wxString         str;
+
+    BOOST_REQUIRE( file.Load() );
+    BOOST_CHECK( file.Read( count ) );
+    BOOST_CHECK( !file.ReadString( str ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( FileStat )
+{
+    long long modTime;
+    long long size;
+
+    {
+        wxFFile file( m_libPath, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.Write( "12345", 5 ) == 5 );
+    }
+
+    BOOST_CHECK( CACHE_INDEX_FILE::GetFileStat( m_libPath, modTime, size ) );
+    BOOST_CHECK_EQUAL( size, 5 );
+    BOOST_CHECK_EQUAL( modTime / 1000000000LL,
+                       wxFileName( m_libPath ).GetModificationTime().GetTicks() );
+
+    BOOST_CHECK( !CACHE_INDEX_FILE::GetFileStat( m_libPath + wxT( "x" ), modTime, size ) );
+}
+
+
+#ifdef __linux__
+/**
+ * Two saves within the same second must not look alike.
+ */
+BOOST_AUTO_TEST_CASE( SubSecondModTime )
+{
+    long long firstModTime;
+    long long secondModTime;
+    long long size;
+
+    struct timespec times[2] = { { 1600000000, 0 }, { 1600000000, 0 } };
+
+    BOOST_REQUIRE( utimensat( AT_FDCWD, TO_UTF8( m_libPath ), times, 0 ) == 0 );
+    BOOST_REQUIRE( CACHE_INDEX_FILE::GetFileStat( m_libPath, firstModTime, size ) );
+
+    times[1].tv_nsec = 500000000;
+
+    BOOST_REQUIRE( utimensat( AT_FDCWD, TO_UTF8( m_libPath ), times, 0 ) == 0 );
+    BOOST_REQUIRE( CACHE_INDEX_FILE::GetFileStat( m_libPath, secondModTime, size ) );
+
+    BOOST_CHECK_EQUAL( firstModTime / 1000000000LL, secondModTime / 1000000000LL );
+    BOOST_CHECK_NE( firstModTime, secondModTime );
+}
+#endif
+
+
+BOOST_AUTO_TEST_SUITE_END()
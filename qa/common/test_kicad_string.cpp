@@ -31,6 +31,9 @@
 // Code under test
 #include <kicad_string.h>
 
+#include <cmath>
+#include <math/util.h>
+
 /**
  * Declare the test suite
  */
@@ -107,4 +110,84 @@ BOOST_AUTO_TEST_CASE( NaturalNumberCompare )
     }
 }
 
+
+/**
+ * Test #ParseDecimalFixed against the strtod() based conversion it replaces in the
+ * s-expression parsers.
+ */
+BOOST_AUTO_TEST_CASE( DecimalFixed )
+{
+    const std::vector<std::string> cases = {
+        "0", "-0", "1", "-1", "+2", "1.", ".5", "-.5", "1.27", "-1.27", "0.000001", "2.540000",
+        "100.000000", "1234.567891", "-1518.500249", "0.1", "0.2", "0.3", "0.7", "1e-3"
+    };
+
+    for( const std::string& c : cases )
+    {
+        long long value = 0;
+        int       expected = KiROUND( strtod( c.c_str(), nullptr ) * 1e6 );
+
+        if( ParseDecimalFixed( c.c_str(), 1000000, value ) )
+            BOOST_CHECK_MESSAGE( value == expected, c + " converted wrongly" );
+        else
+            BOOST_CHECK_MESSAGE( c == "1e-3", c + " not converted" );
+    }
+
+    const std::vector<std::string> rejected = {
+        "", "-", ".", "1e5", "1,5", "1.2.3", "abc", "1 ", "0.0000005", "123456789012345678901"
+    };
+
+    for( const std::string& c : rejected )
+    {
+        long long value = 42;
+
+        BOOST_CHECK_MESSAGE( !ParseDecimalFixed( c.c_str(), 1000000, value ), c + " accepted" );
+        BOOST_CHECK_EQUAL( value, 42 );
+    }
+
+    // Every value Pcbnew can write must come back exactly
+    for( int nm = -2000000; nm <= 2000000; nm += 7 )
+    {
+        std::string text = Double2Str( nm / 1e6 );
+        long long   value = 0;
+
+        BOOST_REQUIRE_MESSAGE( ParseDecimalFixed( text.c_str(), 1000000, value ), text );
+        BOOST_REQUIRE_EQUAL( value, KiROUND( strtod( text.c_str(), nullptr ) * 1e6 ) );
+    }
+}
+
+/**
+ * Test that #ParseDecimalDouble gives exactly what strtod() gives.
+ */
+BOOST_AUTO_TEST_CASE( DecimalDouble )
+{
+    const std::vector<std::string> cases = {
+        "0", "-0", "1", "0.1", "0.2", "0.3", "-45.5", "3.14159265358979", "90.0000000001",
+        "123456789012345678", "9007199254740993", "0.0000000000000000000001", "1e5", "inf"
+    };
+
+    for( const std::string& c : cases )
+    {
+        double value = 0.0;
+
+        if( ParseDecimalDouble( c.c_str(), value ) )
+        {
+            double expected = strtod( c.c_str(), nullptr );
+
+            BOOST_CHECK_MESSAGE( value == expected
+                                         && std::signbit( value ) == std::signbit( expected ),
+                                 c + " converted wrongly" );
+        }
+    }
+
+    for( int ii = -100000; ii <= 100000; ii += 3 )
+    {
+        std::string text = Double2Str( ii / 1000.0 );
+        double      value = 0.0;
+
+        BOOST_REQUIRE_MESSAGE( ParseDecimalDouble( text.c_str(), value ), text );
+        BOOST_REQUIRE_EQUAL( value, strtod( text.c_str(), nullptr ) );
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,199 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for MMAP_LINE_READER
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <richio.h>
+
+
+struct MMAP_READER_FIXTURE
+{
+    MMAP_READER_FIXTURE() :
+            m_fileName( wxFileName::CreateTempFileName( wxT( "qa_richio" ) ) )
+    {
+    }
+
+    ~MMAP_READER_FIXTURE()
+    {
+        wxRemoveFile( m_fileName );
+    }
+
+    void writeFile( const std::string& aContents )
+    {
+        wxFFile file( m_fileName, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aContents.data(), aContents.size() ) == aContents.size() );
+    }
+
+    /**
+     * @return all the lines left in \a aReader, as returned by it.
+     */
+    static std::vector<std::string> readLines( LINE_READER& aReader )
+    {
+        std::vector<std::string> lines;
+
+        while( aReader.ReadLine() )
+        {
+            BOOST_CHECK_EQUAL( aReader.Length(), strlen( aReader.Line() ) );
+            lines.emplace_back( aReader.Line(), aReader.Length() );
+        }
+
+        return lines;
+    }
+
+    /**
+     * Read the file with a MMAP_LINE_READER and check it sees the lines \a aExpected, which
+     * must also be what FILE_LINE_READER sees.
+     */
+    void checkLines( const std::vector<std::string>& aExpected )
+    {
+        MMAP_LINE_READER mmapReader( m_fileName );
+        FILE_LINE_READER fileReader( m_fileName );
+
+        std::vector<std::string> lines = readLines( mmapReader );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(),
+                                       aExpected.begin(), aExpected.end() );
+
+        std::vector<std::string> fileLines = readLines( fileReader );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(),
+                                       fileLines.begin(), fileLines.end() );
+
+        // Reading past the end keeps returning nothing
+        BOOST_CHECK( mmapReader.ReadLine() == nullptr );
+        BOOST_CHECK_EQUAL( mmapReader.Length(), 0 );
+    }
+
+    wxString m_fileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( MmapLineReader, MMAP_READER_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( EmptyFile )
+{
+    writeFile( "" );
+
+    MMAP_LINE_READER reader( m_fileName );
+
+    BOOST_CHECK( reader.ReadLine() == nullptr );
+    BOOST_CHECK_EQUAL( reader.Length(), 0 );
+    BOOST_CHECK_EQUAL( reader.LineNumber(), 1 );
+
+    checkLines( {} );
+}
+
+
+BOOST_AUTO_TEST_CASE( NoTrailingNewline )
+{
+    writeFile( "first\nsecond\nlast" );
+    checkLines( { "first\n", "second\n", "last" } );
+
+    writeFile( "x" );
+    checkLines( { "x" } );
+}
+
+
+BOOST_AUTO_TEST_CASE( CrLfLineEndings )
+{
+    writeFile( "first\r\nsecond\r\n\r\nlast\r\n" );
+    checkLines( { "first\r\n", "second\r\n", "\r\n", "last\r\n" } );
+}
+
+
+/**
+ * The characters borrowed to end a line must be given back when rewinding halfway.
+ */
+BOOST_AUTO_TEST_CASE( RewindAfterPartialRead )
+{
+    writeFile( "first\nsecond\nthird" );
+
+    MMAP_LINE_READER reader( m_fileName, 10 );
+
+    BOOST_REQUIRE( reader.ReadLine() );
+    BOOST_CHECK_EQUAL( std::string( reader.Line() ), "first\n" );
+    BOOST_CHECK_EQUAL( reader.LineNumber(), 11 );
+
+    BOOST_REQUIRE( reader.ReadLine() );
+    BOOST_CHECK_EQUAL( std::string( reader.Line() ), "second\n" );
+
+    reader.Rewind();
+    BOOST_CHECK_EQUAL( reader.LineNumber(), 0 );
+
+    std::vector<std::string> lines = readLines( reader );
+    std::vector<std::string> expected = { "first\n", "second\n", "third" };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(), expected.begin(),
+                                   expected.end() );
+    BOOST_CHECK_EQUAL( reader.LineNumber(), 4 );
+
+    // And once more from the very end
+    reader.Rewind();
+    lines = readLines( reader );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(), expected.begin(),
+                                   expected.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( MaxLineLength )
+{
+    writeFile( "12345\n1234567\n" );
+
+    {
+        MMAP_LINE_READER reader( m_fileName, 0, 6 );
+
+        // The line terminator counts towards the length
+        BOOST_REQUIRE( reader.ReadLine() );
+        BOOST_CHECK_EQUAL( std::string( reader.Line() ), "12345\n" );
+
+        BOOST_CHECK_THROW( reader.ReadLine(), IO_ERROR );
+    }
+
+    // The same goes for a last line without a terminator
+    writeFile( "1234567" );
+
+    MMAP_LINE_READER lastLineReader( m_fileName, 0, 6 );
+
+    BOOST_CHECK_THROW( lastLineReader.ReadLine(), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
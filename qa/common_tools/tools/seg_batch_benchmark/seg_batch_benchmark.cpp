@@ -0,0 +1,209 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <wx/wx.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+using CLOCK = std::chrono::steady_clock;
+using TIME_PT = std::chrono::time_point<CLOCK>;
+
+
+/**
+ * Benchmark data: a closed, finely segmented outline (like a zone or a round pad converted
+ * to a polygon) and a set of short query segments (like track segments) inside it.
+ */
+struct BENCH_DATA
+{
+    SHAPE_LINE_CHAIN outline;
+    std::vector<SEG> queries;
+    int              clearance;
+};
+
+
+static BENCH_DATA makeBenchData( int aSegments, int aQueries )
+{
+    const int  radius = 10000000;
+    BENCH_DATA data;
+
+    for( int i = 0; i < aSegments; i++ )
+    {
+        double angle = 2.0 * M_PI * i / aSegments;
+
+        // Wobble the radius a bit so the outline isn't perfectly regular
+        double r = radius * ( 1.0 + 0.05 * sin( 7 * angle ) );
+
+        data.outline.Append( KiROUND( r * cos( angle ) ), KiROUND( r * sin( angle ) ) );
+    }
+
+    data.outline.SetClosed( true );
+
+    std::mt19937                       rng( 1 );
+    std::uniform_int_distribution<int> coord( -radius, radius );
+    std::uniform_int_distribution<int> length( -radius / 20, radius / 20 );
+
+    for( int i = 0; i < aQueries; i++ )
+    {
+        VECTOR2I a( coord( rng ), coord( rng ) );
+
+        data.queries.emplace_back( a, a + VECTOR2I( length( rng ), length( rng ) ) );
+    }
+
+    data.clearance = radius / 100;
+
+    return data;
+}
+
+
+/**
+ * Test each query against each outline segment in turn, as the collision code used to.
+ */
+static int benchPairwise( const BENCH_DATA& aData )
+{
+    int collisions = 0;
+
+    for( const SEG& query : aData.queries )
+    {
+        for( int s = 0; s < aData.outline.SegmentCount(); s++ )
+        {
+            if( aData.outline.CSegment( s ).Collide( query, aData.clearance ) )
+            {
+                collisions++;
+                break;
+            }
+        }
+    }
+
+    return collisions;
+}
+
+
+static int benchBatch( const BENCH_DATA& aData, SEG_BATCH::KERNEL aKernel )
+{
+    SEG_BATCH batch( aData.outline );
+    int       collisions = 0;
+
+    batch.SetKernel( aKernel );
+
+    for( const SEG& query : aData.queries )
+    {
+        if( batch.Collide( query, aData.clearance ) )
+            collisions++;
+    }
+
+    return collisions;
+}
+
+
+int seg_batch_benchmark_func( int argc, char* argv[] )
+{
+    auto& os = std::cout;
+
+    if( argc < 3 )
+    {
+        os << "Usage: " << argv[0] << " <SEGMENTS> <QUERIES>\n\n";
+        os << "Compares pairwise segment collisions with each SEG_BATCH kernel.\n";
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long segments = 0;
+    long queries = 0;
+
+    if( !wxString( argv[1] ).ToLong( &segments ) || !wxString( argv[2] ).ToLong( &queries )
+            || segments < 3 || queries < 1 )
+    {
+        os << "Invalid segment or query count" << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    BENCH_DATA data = makeBenchData( segments, queries );
+
+    os << "SEG_BATCH Bench Mark Util" << std::endl;
+    os << "  Outline segments: " << (int) segments << std::endl;
+    os << "  Queries:          " << (int) queries << std::endl;
+    os << "  Best kernel:      " << SEG_BATCH::KernelName( SEG_BATCH::BestKernel() ) << std::endl;
+    os << std::endl;
+
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    TIME_PT start = CLOCK::now();
+    int     expected = benchPairwise( data );
+    TIME_PT end = CLOCK::now();
+
+    long long baseUs = duration_cast<microseconds>( end - start ).count();
+
+    os << wxString::Format( "%-12s %d collisions in %lld us", "pairwise", expected, baseUs )
+       << std::endl;
+
+    bool ok = true;
+
+    for( SEG_BATCH::KERNEL kernel : { SEG_BATCH::KERNEL::SCALAR, SEG_BATCH::KERNEL::SSE4,
+                                      SEG_BATCH::KERNEL::AVX2 } )
+    {
+        if( !SEG_BATCH::IsSupported( kernel ) )
+        {
+            os << wxString::Format( "%-12s not supported", SEG_BATCH::KernelName( kernel ) )
+               << std::endl;
+            continue;
+        }
+
+        start = CLOCK::now();
+        int collisions = benchBatch( data, kernel );
+        end = CLOCK::now();
+
+        long long us = duration_cast<microseconds>( end - start ).count();
+
+        os << wxString::Format( "%-12s %d collisions in %lld us (%.1fx)",
+                                SEG_BATCH::KernelName( kernel ), collisions, us,
+                                (double) baseUs / std::max( us, 1LL ) )
+           << std::endl;
+
+        ok &= ( collisions == expected );
+    }
+
+    if( !ok )
+    {
+        os << "Batched results differ from pairwise ones!" << std::endl;
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "seg_batch_benchmark",
+        "Benchmark batched segment collision kernels",
+        seg_batch_benchmark_func,
+} );
@@ -0,0 +1,179 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SCH_SEXPR_LIB_INDEX
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cache_index_file.h>
+#include <lib_symbol.h>
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <sch_plugins/kicad/sch_sexpr_lib_index.h>
+
+
+struct SCH_SEXPR_LIB_INDEX_FIXTURE
+{
+    SCH_SEXPR_LIB_INDEX_FIXTURE() :
+            m_root( wxT( "R" ) ),
+            m_derived( wxT( "R_Small" ), &m_root ),
+            m_power( wxT( "GND" ) )
+    {
+        // A library path of its own, so that no index from an earlier run applies.  The
+        // index never parses the library, so any contents will do.
+        m_libPath = wxFileName::CreateTempFileName( wxT( "qa_sym_index" ) );
+        writeLibrary( "(kicad_symbol_lib)\n" );
+
+        m_root.SetDescription( wxT( "Resistor" ) );
+        m_root.SetKeyWords( wxT( "R res" ) );
+        m_root.GetFootprintField().SetText( wxT( "Resistor_SMD:R_0603" ) );
+        m_root.SetUnitCount( 2 );
+
+        m_power.SetPower();
+
+        m_symbols[m_root.GetName()] = &m_root;
+        m_symbols[m_derived.GetName()] = &m_derived;
+        m_symbols[m_power.GetName()] = &m_power;
+    }
+
+    ~SCH_SEXPR_LIB_INDEX_FIXTURE()
+    {
+        // Only the kind of index and the library path make the index file name
+        CACHE_INDEX_FILE indexFile( wxT( "symbols" ), "KISYIDX", 2, m_libPath );
+
+        wxRemoveFile( indexFile.GetFilePath() );
+        wxRemoveFile( m_libPath );
+    }
+
+    void writeLibrary( const std::string& aContents )
+    {
+        wxFFile file( m_libPath, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aContents.data(), aContents.size() ) == aContents.size() );
+    }
+
+    void setLibraryModTime( const wxDateTime& aTime )
+    {
+        BOOST_REQUIRE( wxFileName( m_libPath ).SetTimes( nullptr, &aTime, nullptr ) );
+    }
+
+    /**
+     * Write the index of the library as it is now.
+     */
+    void writeIndex()
+    {
+        long long modTime;
+        long long size;
+
+        BOOST_REQUIRE( CACHE_INDEX_FILE::GetFileStat( m_libPath, modTime, size ) );
+        SCH_SEXPR_LIB_INDEX( m_libPath ).Write( m_symbols, modTime, size );
+    }
+
+    wxString       m_libPath;
+    LIB_SYMBOL     m_root;
+    LIB_SYMBOL     m_derived;
+    LIB_SYMBOL     m_power;
+    LIB_SYMBOL_MAP m_symbols;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchSexprLibIndex, SCH_SEXPR_LIB_INDEX_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    BOOST_CHECK( !SCH_SEXPR_LIB_INDEX( m_libPath ).Read() );
+
+    writeIndex();
+
+    SCH_SEXPR_LIB_INDEX index( m_libPath );
+
+    BOOST_REQUIRE( index.Read() );
+    BOOST_REQUIRE_EQUAL( index.GetSymbols().size(), m_symbols.size() );
+
+    // In the order of the symbol map
+    auto it = m_symbols.begin();
+
+    for( const LIB_SYMBOL_INFO& info : index.GetSymbols() )
+    {
+        LIB_SYMBOL_INFO expected( *( it++ )->second );
+
+        BOOST_TEST_CONTEXT( "Symbol " << expected.m_name )
+        {
+            BOOST_CHECK_EQUAL( info.m_name, expected.m_name );
+            BOOST_CHECK_EQUAL( info.m_parentName, expected.m_parentName );
+            BOOST_CHECK_EQUAL( info.m_description, expected.m_description );
+            BOOST_CHECK_EQUAL( info.m_keywords, expected.m_keywords );
+            BOOST_CHECK_EQUAL( info.m_footprint, expected.m_footprint );
+            BOOST_CHECK_EQUAL( info.m_unitCount, expected.m_unitCount );
+            BOOST_CHECK_EQUAL( info.m_pinCount, expected.m_pinCount );
+            BOOST_CHECK_EQUAL( info.m_isPower, expected.m_isPower );
+        }
+    }
+}
+
+
+/**
+ * An index written for the library as it was is rejected once the library file has another
+ * modification time or size.
+ */
+BOOST_AUTO_TEST_CASE( StaleLibrary )
+{
+    wxDateTime modTime = wxDateTime::Now() - wxTimeSpan::Hour();
+
+    setLibraryModTime( modTime );
+    writeIndex();
+    BOOST_REQUIRE( SCH_SEXPR_LIB_INDEX( m_libPath ).Read() );
+
+    // Same contents, later modification time
+    setLibraryModTime( modTime + wxTimeSpan::Minute() );
+    BOOST_CHECK( !SCH_SEXPR_LIB_INDEX( m_libPath ).Read() );
+
+    // Same modification time, other size
+    writeLibrary( "(kicad_symbol_lib (version 20211014))\n" );
+    setLibraryModTime( modTime );
+    BOOST_CHECK( !SCH_SEXPR_LIB_INDEX( m_libPath ).Read() );
+
+    // Written again for the library as it is now
+    writeIndex();
+
+    SCH_SEXPR_LIB_INDEX index( m_libPath );
+
+    BOOST_CHECK( index.Read() );
+    BOOST_CHECK_EQUAL( index.GetSymbols().size(), m_symbols.size() );
+
+    // A library which is gone has no index
+    BOOST_REQUIRE( wxRemoveFile( m_libPath ) );
+    BOOST_CHECK( !SCH_SEXPR_LIB_INDEX( m_libPath ).Read() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
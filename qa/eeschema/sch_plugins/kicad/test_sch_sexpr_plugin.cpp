@@ -0,0 +1,377 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the on demand parsing of large symbol libraries by SCH_SEXPR_PLUGIN
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <string>
+
+#include <cache_index_file.h>
+#include <lib_pin.h>
+#include <lib_symbol.h>
+#include <locale_io.h>
+#include <properties.h>
+#include <richio.h>
+#include <sch_file_versions.h>
+#include <symbol_lib_table.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+// Code under test
+#include <sch_plugins/kicad/sch_sexpr_parser.h>
+#include <sch_plugins/kicad/sch_sexpr_plugin.h>
+
+
+/// The size from which libraries are parsed on demand, see LAZY_LOAD_MIN_FILE_SIZE.
+static const size_t LAZY_LOAD_SIZE = 1024 * 1024;
+
+
+struct SCH_SEXPR_LAZY_LOAD_FIXTURE
+{
+    SCH_SEXPR_LAZY_LOAD_FIXTURE()
+    {
+        // A library path of its own, so that no symbol index from an earlier run applies
+        m_libPath = wxFileName::CreateTempFileName( wxT( "qa_sym_lib" ) );
+    }
+
+    ~SCH_SEXPR_LAZY_LOAD_FIXTURE()
+    {
+        // Loading the last symbol of the library writes its index
+        CACHE_INDEX_FILE indexFile( wxT( "symbols" ), "KISYIDX", 2, m_libPath );
+
+        wxRemoveFile( indexFile.GetFilePath() );
+        wxRemoveFile( m_libPath );
+    }
+
+    /**
+     * Format a symbol with \a aPinCount pins, or a symbol derived from \a aParent.
+     */
+    static std::string formatSymbol( const wxString& aName, int aPinCount,
+                                     const wxString& aDescription = wxEmptyString,
+                                     bool aPower = false, LIB_SYMBOL* aParent = nullptr )
+    {
+        LIB_SYMBOL symbol( aName, aParent );
+
+        symbol.SetDescription( aDescription );
+
+        if( aPower )
+            symbol.SetPower();
+
+        for( int ii = 0; ii < aPinCount; ++ii )
+        {
+            symbol.AddDrawItem( new LIB_PIN( &symbol, wxString::Format( "P%d", ii ),
+                                             wxString::Format( "%d", ii + 1 ), PIN_RIGHT,
+                                             ELECTRICAL_PINTYPE::PT_PASSIVE, 2540, 500, 500, 1,
+                                             wxPoint( -5080, ii * 2540 ), 1 ) );
+        }
+
+        return format( &symbol );
+    }
+
+    static std::string formatDerivedSymbol( const wxString& aName, const wxString& aParentName )
+    {
+        LIB_SYMBOL parent( aParentName );
+
+        return formatSymbol( aName, 0, wxEmptyString, false, &parent );
+    }
+
+    static std::string format( LIB_SYMBOL* aSymbol )
+    {
+        STRING_FORMATTER formatter;
+
+        SCH_SEXPR_PLUGIN::FormatLibSymbol( aSymbol, formatter );
+        return formatter.GetString();
+    }
+
+    /**
+     * Write a library holding \a aSymbols, followed by enough other symbols for the library
+     * to be parsed on demand.
+     */
+    void writeLibrary( const std::string& aSymbols,
+                       int aVersion = SEXPR_SYMBOL_LIB_FILE_VERSION )
+    {
+        m_library = StrPrintf( "(kicad_symbol_lib (version %d) (generator kicad_symbol_editor)\n",
+                               aVersion );
+        m_library += aSymbols;
+
+        for( int ii = 0; m_library.size() < LAZY_LOAD_SIZE; ++ii )
+            m_library += formatSymbol( wxString::Format( "PAD_%d", ii ), 16 );
+
+        m_library += ")\n";
+
+        wxFFile file( m_libPath, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( m_library.data(), m_library.size() ) == m_library.size() );
+    }
+
+    /**
+     * Parse the whole library at once, the way small libraries are.
+     */
+    void parseLibrary( LIB_SYMBOL_MAP& aSymbols ) const
+    {
+        LOCALE_IO        toggle;
+        FILE_LINE_READER reader( m_libPath );
+        SCH_SEXPR_PARSER parser( &reader );
+
+        parser.ParseLib( aSymbols );
+    }
+
+    /**
+     * Check that loading the symbols of the library on demand gives the same symbols, in the
+     * same order, as parsing the whole library at once.
+     */
+    void checkSameAsFullParse()
+    {
+        LIB_SYMBOL_MAP   expected;
+        SCH_SEXPR_PLUGIN plugin;
+        wxArrayString    names;
+
+        parseLibrary( expected );
+
+        // The names only need the library to be skimmed
+        plugin.EnumerateSymbolLib( names, m_libPath );
+
+        BOOST_REQUIRE_EQUAL( names.size(), expected.size() );
+
+        auto it = expected.begin();
+
+        for( const wxString& name : names )
+        {
+            BOOST_TEST_CONTEXT( "Symbol " << name )
+            {
+                BOOST_CHECK_EQUAL( name, it->first );
+
+                LIB_SYMBOL* symbol = plugin.LoadSymbol( m_libPath, name );
+
+                BOOST_REQUIRE( symbol );
+                BOOST_CHECK_EQUAL( format( symbol ), format( it->second ) );
+            }
+
+            ++it;
+        }
+
+        for( std::pair<const wxString, LIB_SYMBOL*>& entry : expected )
+            delete entry.second;
+    }
+
+    wxString    m_libPath;
+    std::string m_library;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchSexprLazyLoad, SCH_SEXPR_LAZY_LOAD_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsFullParse )
+{
+    writeLibrary( formatSymbol( wxT( "R" ), 2, wxT( "Resistor" ) )
+                  + formatDerivedSymbol( wxT( "R_Small" ), wxT( "R" ) )
+                  + formatSymbol( wxT( "Rack" ), 4, wxT( "19\" rack, \\ 2U" ) )
+                  + formatSymbol( wxT( "GND" ), 1, wxEmptyString, true ) );
+
+    BOOST_REQUIRE_GE( m_library.size(), LAZY_LOAD_SIZE );
+
+    checkSameAsFullParse();
+}
+
+
+/**
+ * The parent of a derived symbol is parsed first, wherever it is in the library.
+ */
+BOOST_AUTO_TEST_CASE( ParentDeclaredLater )
+{
+    writeLibrary( formatDerivedSymbol( wxT( "R_Small" ), wxT( "R" ) )
+                  + formatSymbol( wxT( "R" ), 2, wxT( "Resistor" ) ) );
+
+    SCH_SEXPR_PLUGIN plugin;
+    LIB_SYMBOL*      derived = plugin.LoadSymbol( m_libPath, wxT( "R_Small" ) );
+
+    BOOST_REQUIRE( derived );
+    BOOST_CHECK( derived->IsAlias() );
+
+    std::shared_ptr<LIB_SYMBOL> parent = derived->GetParent().lock();
+
+    BOOST_REQUIRE( parent );
+    BOOST_CHECK_EQUAL( parent->GetName(), wxT( "R" ) );
+    BOOST_CHECK_EQUAL( parent->GetPinCount(), 2 );
+    BOOST_CHECK_EQUAL( parent.get(), plugin.LoadSymbol( m_libPath, wxT( "R" ) ) );
+}
+
+
+/**
+ * As when the library is parsed at once, the last symbol of a given name wins.
+ */
+BOOST_AUTO_TEST_CASE( DuplicateNames )
+{
+    writeLibrary( formatSymbol( wxT( "DUP" ), 1, wxT( "First" ) )
+                  + formatSymbol( wxT( "R" ), 2 )
+                  + formatSymbol( wxT( "DUP" ), 3, wxT( "Second" ) ) );
+
+    SCH_SEXPR_PLUGIN plugin;
+    LIB_SYMBOL*      dup = plugin.LoadSymbol( m_libPath, wxT( "DUP" ) );
+
+    BOOST_REQUIRE( dup );
+    BOOST_CHECK_EQUAL( dup->GetDescription(), wxT( "Second" ) );
+    BOOST_CHECK_EQUAL( dup->GetPinCount(), 3 );
+
+    checkSameAsFullParse();
+}
+
+
+/**
+ * Derived symbols are power symbols if their parent is one, which the list of power symbols
+ * knows before any symbol is parsed.
+ */
+BOOST_AUTO_TEST_CASE( PowerInheritance )
+{
+    writeLibrary( formatDerivedSymbol( wxT( "GND_ALT" ), wxT( "GND" ) )
+                  + formatSymbol( wxT( "GND" ), 1, wxEmptyString, true )
+                  + formatDerivedSymbol( wxT( "R_Small" ), wxT( "R" ) )
+                  + formatSymbol( wxT( "R" ), 2 ) );
+
+    SCH_SEXPR_PLUGIN plugin;
+    PROPERTIES       powerSymbolsOnly;
+    wxArrayString    names;
+
+    powerSymbolsOnly[ SYMBOL_LIB_TABLE::PropPowerSymsOnly ] = "";
+
+    plugin.EnumerateSymbolLib( names, m_libPath, &powerSymbolsOnly );
+
+    BOOST_REQUIRE_EQUAL( names.size(), 2 );
+    BOOST_CHECK_EQUAL( names[0], wxT( "GND" ) );
+    BOOST_CHECK_EQUAL( names[1], wxT( "GND_ALT" ) );
+
+    LIB_SYMBOL* derived = plugin.LoadSymbol( m_libPath, wxT( "GND_ALT" ) );
+
+    BOOST_REQUIRE( derived );
+    BOOST_CHECK( derived->IsPower() );
+    BOOST_CHECK( !plugin.LoadSymbol( m_libPath, wxT( "R_Small" ) )->IsPower() );
+}
+
+
+/**
+ * A symbol which fails to parse reports the error the full parse would, and leaves the
+ * library unusable (and unsaved) as if it had been parsed at once.
+ */
+BOOST_AUTO_TEST_CASE( ParseError )
+{
+    std::string broken = formatSymbol( wxT( "BROKEN" ), 2 );
+
+    broken.insert( broken.rfind( ')' ), "  (bogus)\n" );
+
+    writeLibrary( formatSymbol( wxT( "R" ), 2 ) + broken + formatSymbol( wxT( "C" ), 2 ) );
+
+    int      expectedLine = 0;
+    int      expectedOffset = 0;
+    wxString expectedProblem;
+
+    try
+    {
+        LIB_SYMBOL_MAP symbols;
+
+        parseLibrary( symbols );
+        BOOST_FAIL( "The library parsed" );
+    }
+    catch( const PARSE_ERROR& e )
+    {
+        expectedLine = e.lineNumber;
+        expectedOffset = e.byteIndex;
+        expectedProblem = e.Problem();
+    }
+
+    SCH_SEXPR_PLUGIN plugin;
+
+    // The other symbols are parsed on demand, regardless of the broken one
+    BOOST_CHECK( plugin.LoadSymbol( m_libPath, wxT( "R" ) ) );
+
+    try
+    {
+        plugin.LoadSymbol( m_libPath, wxT( "BROKEN" ) );
+        BOOST_FAIL( "The broken symbol loaded" );
+    }
+    catch( const PARSE_ERROR& e )
+    {
+        BOOST_CHECK_EQUAL( e.lineNumber, expectedLine );
+        BOOST_CHECK_EQUAL( e.byteIndex, expectedOffset );
+        BOOST_CHECK_EQUAL( e.Problem(), expectedProblem );
+    }
+
+    BOOST_CHECK_THROW( plugin.LoadSymbol( m_libPath, wxT( "R" ) ), IO_ERROR );
+    BOOST_CHECK_THROW( plugin.LoadSymbol( m_libPath, wxT( "C" ) ), IO_ERROR );
+
+    wxArrayString names;
+
+    BOOST_CHECK_THROW( plugin.EnumerateSymbolLib( names, m_libPath ), IO_ERROR );
+
+    // Saving would lose the symbols which were not parsed
+    LIB_SYMBOL* newSymbol = new LIB_SYMBOL( wxT( "NEW" ) );
+
+    BOOST_CHECK_THROW( plugin.SaveSymbol( m_libPath, newSymbol ), IO_ERROR );
+    delete newSymbol;
+
+    wxFFile     file( m_libPath, wxT( "rb" ) );
+    std::string contents( file.Length(), '\0' );
+
+    BOOST_REQUIRE( file.Read( &contents[0], contents.size() ) == contents.size() );
+    BOOST_CHECK( contents == m_library );
+}
+
+
+/**
+ * Libraries the skimmer cannot handle are parsed at once, which the broken symbol at their
+ * end makes visible.
+ */
+BOOST_AUTO_TEST_CASE( Fallback )
+{
+    std::string broken = formatSymbol( wxT( "BROKEN" ), 2 );
+
+    broken.insert( broken.rfind( ')' ), "  (bogus)\n" );
+
+    std::string commentLine = formatSymbol( wxT( "R" ), 2 ) + "# A comment\n"
+                              + formatSymbol( wxT( "C" ), 2 );
+    std::string escape = formatSymbol( wxT( "R" ), 2, wxT( "Two\nlines" ) )
+                         + formatSymbol( wxT( "C" ), 2 );
+
+    for( const std::string& symbols : { commentLine, escape } )
+    {
+        writeLibrary( symbols );
+        checkSameAsFullParse();
+
+        writeLibrary( symbols + broken );
+        BOOST_CHECK_THROW( SCH_SEXPR_PLUGIN().LoadSymbol( m_libPath, wxT( "R" ) ), IO_ERROR );
+    }
+
+    // Left to the parser, which knows how to complain about newer libraries
+    writeLibrary( formatSymbol( wxT( "R" ), 2 ), SEXPR_SYMBOL_LIB_FILE_VERSION + 1 );
+    BOOST_CHECK_THROW( SCH_SEXPR_PLUGIN().LoadSymbol( m_libPath, wxT( "R" ) ),
+                       FUTURE_FORMAT_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
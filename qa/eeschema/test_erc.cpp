@@ -0,0 +1,504 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_erc.cpp
+ * Test that the per-net ERC tests, which run on several threads, report the same markers in
+ * the same order as plain serial passes over the QA schematics.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include "eeschema_test_utils.h"
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <connection_graph.h>
+#include <erc.h>
+#include <erc_item.h>
+#include <lib_pin.h>
+#include <project.h>
+#include <sch_io_mgr.h>
+#include <sch_marker.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_symbol.h>
+#include <sch_text.h>
+#include <schematic.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+
+extern const std::set<ELECTRICAL_PINTYPE> DrivingPinTypes;
+extern const std::set<ELECTRICAL_PINTYPE> DrivingPowerPinTypes;
+extern const std::set<ELECTRICAL_PINTYPE> DrivenPinTypes;
+
+
+/*
+ * The serial passes below are the tests as they were written before they ran on several
+ * threads.  They are the reference the tests of ERC_TESTER are checked against.
+ */
+
+static void serialNoConnectPins( SCHEMATIC* aSchematic )
+{
+    for( const SCH_SHEET_PATH& sheet : aSchematic->GetSheets() )
+    {
+        std::map<wxPoint, std::vector<SCH_PIN*>> pinMap;
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items().OfType( SCH_SYMBOL_T ) )
+        {
+            SCH_SYMBOL* symbol = static_cast<SCH_SYMBOL*>( item );
+
+            for( SCH_PIN* pin : symbol->GetPins( &sheet ) )
+            {
+                if( pin->GetLibPin()->GetType() == ELECTRICAL_PINTYPE::PT_NC )
+                    pinMap[pin->GetPosition()].emplace_back( pin );
+            }
+        }
+
+        for( auto& pair : pinMap )
+        {
+            if( pair.second.size() > 1 )
+            {
+                std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( ERCE_NOCONNECT_CONNECTED );
+
+                ercItem->SetItems( pair.second[0], pair.second[1],
+                                   pair.second.size() > 2 ? pair.second[2] : nullptr,
+                                   pair.second.size() > 3 ? pair.second[3] : nullptr );
+                ercItem->SetErrorMessage( _( "Pins with \"no connection\" type are connected" ) );
+
+                sheet.LastScreen()->Append( new SCH_MARKER( ercItem, pair.first ) );
+            }
+        }
+    }
+}
+
+
+static void serialPinToPin( SCHEMATIC* aSchematic )
+{
+    ERC_SETTINGS&  settings = aSchematic->ErcSettings();
+    const NET_MAP& nets     = aSchematic->ConnectionGraph()->GetNetMap();
+
+    for( const NET_MAP::value_type& net : nets )
+    {
+        std::vector<SCH_PIN*>                      pins;
+        std::unordered_map<EDA_ITEM*, SCH_SCREEN*> pinToScreenMap;
+
+        for( CONNECTION_SUBGRAPH* subgraph : net.second )
+        {
+            for( EDA_ITEM* item : subgraph->m_items )
+            {
+                if( item->Type() == SCH_PIN_T )
+                {
+                    pins.emplace_back( static_cast<SCH_PIN*>( item ) );
+                    pinToScreenMap[item] = subgraph->m_sheet.LastScreen();
+                }
+            }
+        }
+
+        if( pins.size() < 2 )
+            continue;
+
+        std::set<std::pair<SCH_PIN*, SCH_PIN*>> tested;
+
+        SCH_PIN* needsDriver = nullptr;
+        bool     hasDriver   = false;
+        bool     ispowerNet  = false;
+
+        for( SCH_PIN* refPin : pins )
+        {
+            if( refPin->GetType() == ELECTRICAL_PINTYPE::PT_POWER_IN )
+            {
+                ispowerNet = true;
+                break;
+            }
+        }
+
+        for( SCH_PIN* refPin : pins )
+        {
+            ELECTRICAL_PINTYPE refType = refPin->GetType();
+
+            if( DrivenPinTypes.count( refType ) )
+            {
+                if( !needsDriver
+                        || ( !needsDriver->IsVisible() && refPin->IsVisible() )
+                        || ( ispowerNet != needsDriver->IsPowerConnection()
+                             && ispowerNet == refPin->IsPowerConnection() ) )
+                {
+                    needsDriver = refPin;
+                }
+            }
+
+            if( ispowerNet )
+                hasDriver |= ( DrivingPowerPinTypes.count( refType ) != 0 );
+            else
+                hasDriver |= ( DrivingPinTypes.count( refType ) != 0 );
+
+            for( SCH_PIN* testPin : pins )
+            {
+                if( testPin == refPin )
+                    continue;
+
+                if( tested.count( std::make_pair( refPin, testPin ) )
+                        || tested.count( std::make_pair( testPin, refPin ) ) )
+                {
+                    continue;
+                }
+
+                tested.insert( std::make_pair( refPin, testPin ) );
+                tested.insert( std::make_pair( testPin, refPin ) );
+
+                ELECTRICAL_PINTYPE testType = testPin->GetType();
+
+                if( ispowerNet )
+                    hasDriver |= ( DrivingPowerPinTypes.count( testType ) != 0 );
+                else
+                    hasDriver |= ( DrivingPinTypes.count( testType ) != 0 );
+
+                PIN_ERROR erc = settings.GetPinMapValue( refType, testType );
+
+                if( erc != PIN_ERROR::OK )
+                {
+                    std::shared_ptr<ERC_ITEM> ercItem =
+                            ERC_ITEM::Create( erc == PIN_ERROR::WARNING ? ERCE_PIN_TO_PIN_WARNING
+                                                                        : ERCE_PIN_TO_PIN_ERROR );
+                    ercItem->SetItems( refPin, testPin );
+                    ercItem->SetIsSheetSpecific();
+
+                    ercItem->SetErrorMessage(
+                            wxString::Format( _( "Pins of type %s and %s are connected" ),
+                                              ElectricalPinTypeGetText( refType ),
+                                              ElectricalPinTypeGetText( testType ) ) );
+
+                    pinToScreenMap[refPin]->Append(
+                            new SCH_MARKER( ercItem, refPin->GetTransformedPosition() ) );
+                }
+            }
+        }
+
+        if( needsDriver && !hasDriver )
+        {
+            int err_code = ispowerNet ? ERCE_POWERPIN_NOT_DRIVEN : ERCE_PIN_NOT_DRIVEN;
+            std::shared_ptr<ERC_ITEM> ercItem = ERC_ITEM::Create( err_code );
+
+            ercItem->SetItems( needsDriver );
+
+            pinToScreenMap[needsDriver]->Append(
+                    new SCH_MARKER( ercItem, needsDriver->GetTransformedPosition() ) );
+        }
+    }
+}
+
+
+static void serialSimilarLabels( SCHEMATIC* aSchematic )
+{
+    const NET_MAP& nets = aSchematic->ConnectionGraph()->GetNetMap();
+
+    std::unordered_map<wxString, SCH_TEXT*> labelMap;
+
+    for( const NET_MAP::value_type& net : nets )
+    {
+        for( CONNECTION_SUBGRAPH* subgraph : net.second )
+        {
+            for( EDA_ITEM* item : subgraph->m_items )
+            {
+                switch( item->Type() )
+                {
+                case SCH_LABEL_T:
+                case SCH_HIER_LABEL_T:
+                case SCH_GLOBAL_LABEL_T:
+                {
+                    SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
+                    wxString  normalized = text->GetShownText().Lower();
+
+                    if( !labelMap.count( normalized ) )
+                    {
+                        labelMap[normalized] = text;
+                    }
+                    else if( labelMap.at( normalized )->GetShownText() != text->GetShownText() )
+                    {
+                        std::shared_ptr<ERC_ITEM> ercItem =
+                                ERC_ITEM::Create( ERCE_SIMILAR_LABELS );
+                        ercItem->SetItems( text, labelMap.at( normalized ) );
+
+                        subgraph->m_sheet.LastScreen()->Append(
+                                new SCH_MARKER( ercItem, text->GetPosition() ) );
+                    }
+
+                    break;
+                }
+
+                default:
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+///< What a marker reports, without the KIID of the marker itself
+struct MARKER_INFO
+{
+    int      m_errorCode;
+    wxString m_items;
+    wxPoint  m_position;
+    wxString m_message;
+
+    bool operator==( const MARKER_INFO& aOther ) const
+    {
+        return m_errorCode == aOther.m_errorCode && m_items == aOther.m_items
+               && m_position == aOther.m_position && m_message == aOther.m_message;
+    }
+};
+
+
+std::ostream& operator<<( std::ostream& aStream, const MARKER_INFO& aMarker )
+{
+    aStream << aMarker.m_errorCode << " " << aMarker.m_items << " @ " << aMarker.m_position.x
+            << "," << aMarker.m_position.y << " \"" << aMarker.m_message << "\"";
+    return aStream;
+}
+
+
+class TEST_ERC_FIXTURE
+{
+public:
+    TEST_ERC_FIXTURE() :
+            m_schematic( nullptr ),
+            m_manager( true )
+    {
+        m_pi = SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_KICAD );
+    }
+
+    virtual ~TEST_ERC_FIXTURE()
+    {
+        m_schematic.Reset();
+        SCH_IO_MGR::ReleasePlugin( m_pi );
+    }
+
+    void loadSchematic( const wxString& aBaseName );
+
+    void deleteMarkers();
+
+    /**
+     * @return the ERC markers of each screen, in the order of the screen items.
+     */
+    std::vector<std::vector<MARKER_INFO>> collectMarkers();
+
+    void doErcTest( const wxString& aBaseName );
+
+    SCHEMATIC        m_schematic;
+    SCH_PLUGIN*      m_pi;
+    SETTINGS_MANAGER m_manager;
+};
+
+
+void TEST_ERC_FIXTURE::loadSchematic( const wxString& aBaseName )
+{
+    wxFileName fn = KI_TEST::GetEeschemaTestDataDir();
+    fn.AppendDir( "netlists" );
+    fn.AppendDir( aBaseName );
+    fn.SetName( aBaseName );
+    fn.SetExt( KiCadSchematicFileExtension );
+
+    BOOST_TEST_MESSAGE( fn.GetFullPath() );
+
+    wxFileName pro( fn );
+    pro.SetExt( ProjectFileExtension );
+
+    m_manager.LoadProject( pro.GetFullPath() );
+
+    m_manager.Prj().SetElem( PROJECT::ELEM_SCH_SYMBOL_LIBS, nullptr );
+
+    m_schematic.Reset();
+    m_schematic.SetProject( &m_manager.Prj() );
+    m_schematic.SetRoot( m_pi->Load( fn.GetFullPath(), &m_schematic ) );
+
+    BOOST_REQUIRE_EQUAL( m_pi->GetError().IsEmpty(), true );
+
+    m_schematic.CurrentSheet().push_back( &m_schematic.Root() );
+
+    SCH_SCREENS screens( m_schematic.Root() );
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->UpdateLocalLibSymbolLinks();
+
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+
+    sheets.UpdateSymbolInstances( m_schematic.RootScreen()->GetSymbolInstances() );
+    sheets.AnnotatePowerSymbols();
+
+    for( SCH_SHEET_PATH& sheet : sheets )
+        sheet.UpdateAllScreenReferences();
+
+    m_schematic.ConnectionGraph()->Recalculate( sheets, true );
+}
+
+
+void TEST_ERC_FIXTURE::deleteMarkers()
+{
+    SCH_SCREENS screens( m_schematic.Root() );
+
+    screens.DeleteAllMarkers( MARKER_BASE::MARKER_ERC, true );
+}
+
+
+std::vector<std::vector<MARKER_INFO>> TEST_ERC_FIXTURE::collectMarkers()
+{
+    std::vector<std::vector<MARKER_INFO>> markers;
+    SCH_SCREENS                           screens( m_schematic.Root() );
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        markers.emplace_back();
+
+        for( SCH_ITEM* item : screen->Items().OfType( SCH_MARKER_T ) )
+        {
+            SCH_MARKER*              marker = static_cast<SCH_MARKER*>( item );
+            std::shared_ptr<RC_ITEM> rcItem = marker->GetRCItem();
+
+            if( marker->GetMarkerType() != MARKER_BASE::MARKER_ERC )
+                continue;
+
+            wxString items = rcItem->GetMainItemID().AsString() + wxT( " " )
+                             + rcItem->GetAuxItemID().AsString() + wxT( " " )
+                             + rcItem->GetAuxItem2ID().AsString() + wxT( " " )
+                             + rcItem->GetAuxItem3ID().AsString();
+
+            markers.back().push_back( { rcItem->GetErrorCode(), items, marker->GetPos(),
+                                        rcItem->GetErrorMessage() } );
+        }
+    }
+
+    return markers;
+}
+
+
+void TEST_ERC_FIXTURE::doErcTest( const wxString& aBaseName )
+{
+    loadSchematic( aBaseName );
+
+    deleteMarkers();
+    serialNoConnectPins( &m_schematic );
+    serialPinToPin( &m_schematic );
+    serialSimilarLabels( &m_schematic );
+
+    std::vector<std::vector<MARKER_INFO>> expected = collectMarkers();
+
+    deleteMarkers();
+
+    ERC_TESTER tester( &m_schematic );
+
+    tester.TestNoConnectPins();
+    tester.TestPinToPin();
+    tester.TestSimilarLabels();
+
+    std::vector<std::vector<MARKER_INFO>> actual = collectMarkers();
+
+    BOOST_REQUIRE_EQUAL( actual.size(), expected.size() );
+
+    for( size_t ii = 0; ii < expected.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Screen " << ii )
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS( actual[ii].begin(), actual[ii].end(),
+                                           expected[ii].begin(), expected[ii].end() );
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ErcTester, TEST_ERC_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( BusJunctions )
+{
+    doErcTest( "bus_junctions" );
+}
+
+
+BOOST_AUTO_TEST_CASE( ComplexHierarchy )
+{
+    doErcTest( "complex_hierarchy" );
+}
+
+
+BOOST_AUTO_TEST_CASE( GroupBusMatching )
+{
+    doErcTest( "group_bus_matching" );
+}
+
+
+BOOST_AUTO_TEST_CASE( NoConnects )
+{
+    doErcTest( "noconnects" );
+}
+
+
+BOOST_AUTO_TEST_CASE( PrefixBusAlias )
+{
+    doErcTest( "prefix_bus_alias" );
+}
+
+
+BOOST_AUTO_TEST_CASE( GlobalPromotion )
+{
+    doErcTest( "test_global_promotion" );
+}
+
+
+BOOST_AUTO_TEST_CASE( GlobalPromotion2 )
+{
+    doErcTest( "test_global_promotion_2" );
+}
+
+
+BOOST_AUTO_TEST_CASE( HierRenaming )
+{
+    doErcTest( "test_hier_renaming" );
+}
+
+
+BOOST_AUTO_TEST_CASE( TopLevelHierPins )
+{
+    doErcTest( "top_level_hier_pins" );
+}
+
+
+BOOST_AUTO_TEST_CASE( Video )
+{
+    doErcTest( "video" );
+}
+
+
+BOOST_AUTO_TEST_CASE( WeakVectorBusDisambiguation )
+{
+    doErcTest( "weak_vector_bus_disambiguation" );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
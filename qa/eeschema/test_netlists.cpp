@@ -20,13 +20,24 @@
 #include <qa_utils/wx_utils/unit_test_utils.h>
 #include "eeschema_test_utils.h"
 
+#include <map>
+#include <memory>
+#include <set>
+
 #include <connection_graph.h>
+#include <convert_to_biu.h>
 #include <netlist_exporter_kicad.h>
 #include <netlist_reader/netlist_reader.h>
 #include <netlist_reader/pcb_netlist.h>
 #include <project.h>
 #include <sch_io_mgr.h>
+#include <sch_line.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
 #include <sch_sheet.h>
+#include <sch_sheet_pin.h>
+#include <sch_symbol.h>
+#include <sch_text.h>
 #include <schematic.h>
 #include <settings/settings_manager.h>
 #include <wildcards_and_files_ext.h>
@@ -60,6 +71,33 @@ public:
 
     void doNetlistTest( const wxString& aBaseName );
 
+    ///< What the connection graph found for one item on one sheet
+    struct ITEM_CONNECTIVITY
+    {
+        wxString                  m_netName;
+        int                       m_netCode;
+        std::set<const SCH_ITEM*> m_links;
+        bool                      m_dangling;
+
+        bool operator==( const ITEM_CONNECTIVITY& aOther ) const
+        {
+            return m_netName == aOther.m_netName && m_netCode == aOther.m_netCode
+                   && m_links == aOther.m_links && m_dangling == aOther.m_dangling;
+        }
+    };
+
+    typedef std::map<std::pair<wxString, const SCH_ITEM*>, ITEM_CONNECTIVITY> CONNECTIVITY_MAP;
+
+    CONNECTIVITY_MAP collectConnectivity();
+
+    /**
+     * Recalculate the connectivity after an edit the way the editor does, and check it against
+     * a full recalculation.
+     */
+    void checkIncrementalRecalculation( const wxString& aEdit );
+
+    void doIncrementalTest( const wxString& aBaseName );
+
     ///> Schematic to load
     SCHEMATIC m_schematic;
 
@@ -221,6 +259,190 @@ void TEST_NETLISTS_FIXTURE::doNetlistTest( const wxString& aBaseName )
 }
 
 
+TEST_NETLISTS_FIXTURE::CONNECTIVITY_MAP TEST_NETLISTS_FIXTURE::collectConnectivity()
+{
+    CONNECTIVITY_MAP connectivity;
+
+    for( const SCH_SHEET_PATH& sheet : m_schematic.GetSheets() )
+    {
+        auto record =
+                [&]( SCH_ITEM* aItem )
+                {
+                    ITEM_CONNECTIVITY& entry = connectivity[{ sheet.PathAsString(), aItem }];
+                    SCH_CONNECTION*    connection = aItem->Connection( &sheet );
+
+                    entry.m_netName = connection ? connection->Name() : wxString( "<none>" );
+                    entry.m_netCode = connection ? connection->NetCode() : -1;
+                    entry.m_dangling = aItem->IsDangling();
+
+                    for( SCH_ITEM* linked : aItem->ConnectedItems( sheet ) )
+                        entry.m_links.insert( linked );
+                };
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( !item->IsConnectable() )
+                continue;
+
+            record( item );
+
+            if( item->Type() == SCH_SHEET_T )
+            {
+                for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
+                    record( pin );
+            }
+            else if( item->Type() == SCH_SYMBOL_T )
+            {
+                for( SCH_PIN* pin : static_cast<SCH_SYMBOL*>( item )->GetPins( &sheet ) )
+                    record( pin );
+            }
+        }
+    }
+
+    return connectivity;
+}
+
+
+void TEST_NETLISTS_FIXTURE::checkIncrementalRecalculation( const wxString& aEdit )
+{
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+
+    BOOST_TEST_CONTEXT( aEdit )
+    {
+        // The relief valve may have been tripped by the full recalculation done on loading
+        CONNECTION_GRAPH::m_allowRealTime = true;
+
+        m_schematic.ConnectionGraph()->Recalculate( sheets, false );
+
+        BOOST_CHECK( CONNECTION_GRAPH::m_allowRealTime );
+
+        CONNECTIVITY_MAP incremental = collectConnectivity();
+
+        m_schematic.ConnectionGraph()->Recalculate( sheets, true );
+
+        CONNECTIVITY_MAP full = collectConnectivity();
+
+        BOOST_REQUIRE_EQUAL( incremental.size(), full.size() );
+
+        for( const auto& entry : full )
+        {
+            auto it = incremental.find( entry.first );
+
+            BOOST_REQUIRE( it != incremental.end() );
+            BOOST_CHECK_MESSAGE( it->second == entry.second,
+                                 "Incremental recalculation differs for "
+                                         << entry.first.second->GetSelectMenuText( EDA_UNITS::MILS )
+                                         << " on " << entry.first.first << ": "
+                                         << it->second.m_netName << " instead of "
+                                         << entry.second.m_netName );
+        }
+    }
+}
+
+
+static SCH_LINE* findWire( SCH_SCREEN* aScreen )
+{
+    for( SCH_ITEM* item : aScreen->Items().OfType( SCH_LINE_T ) )
+    {
+        if( static_cast<SCH_LINE*>( item )->IsWire() )
+            return static_cast<SCH_LINE*>( item );
+    }
+
+    return nullptr;
+}
+
+
+static SCH_TEXT* findLabel( SCH_SCREEN* aScreen )
+{
+    for( SCH_ITEM* item : aScreen->Items() )
+    {
+        switch( item->Type() )
+        {
+        case SCH_LABEL_T:
+        case SCH_GLOBAL_LABEL_T:
+        case SCH_HIER_LABEL_T:
+            return static_cast<SCH_TEXT*>( item );
+
+        default:
+            break;
+        }
+    }
+
+    return nullptr;
+}
+
+
+void TEST_NETLISTS_FIXTURE::doIncrementalTest( const wxString& aBaseName )
+{
+    loadSchematic( aBaseName );
+
+    SCH_SHEET_LIST sheets = m_schematic.GetSheets();
+    SCH_SCREEN*    root = sheets.front().LastScreen();
+    SCH_SCREEN*    last = sheets.back().LastScreen();
+
+    checkIncrementalRecalculation( "No edit" );
+
+    // Edits made through the undo list leave the items they touch dirty
+    SCH_LINE* wire = findWire( last );
+    BOOST_REQUIRE( wire );
+
+    last->Remove( wire );
+    wire->Move( wxPoint( Mils2iu( 50 ), Mils2iu( 50 ) ) );
+    wire->SetConnectivityDirty();
+    last->Append( wire );
+
+    checkIncrementalRecalculation( "Moved wire" );
+
+    // A deleted item leaves no dirty item behind
+    std::unique_ptr<SCH_LINE> deleted( findWire( root ) );
+    BOOST_REQUIRE( deleted );
+
+    root->Remove( deleted.get() );
+
+    checkIncrementalRecalculation( "Deleted wire" );
+
+    SCH_LINE* anchor = findWire( root );
+
+    if( anchor )
+    {
+        SCH_LINE* added = new SCH_LINE( anchor->GetStartPoint(), LAYER_WIRE );
+
+        added->SetEndPoint( anchor->GetStartPoint() + wxPoint( 0, Mils2iu( 200 ) ) );
+        root->Append( added );
+
+        checkIncrementalRecalculation( "Added wire" );
+    }
+
+    // Rebuilt pins leave no dirty item behind either, and may be allocated where the old ones
+    // were
+    for( SCH_ITEM* item : last->Items().OfType( SCH_SYMBOL_T ) )
+    {
+        int modifyCount = last->GetModifyCount();
+
+        static_cast<SCH_SYMBOL*>( item )->UpdatePins();
+        BOOST_CHECK_NE( last->GetModifyCount(), modifyCount );
+
+        checkIncrementalRecalculation( "Rebuilt pins" );
+        break;
+    }
+
+    SCH_TEXT* label = findLabel( last );
+
+    if( !label )
+        label = findLabel( root );
+
+    if( label )
+    {
+        label->SetText( label->GetText() + wxT( "_RENAMED" ) );
+        label->SetConnectivityDirty();
+
+        checkIncrementalRecalculation( "Renamed label" );
+    }
+
+    m_schematic.Reset();
+}
+
+
 BOOST_FIXTURE_TEST_SUITE( Netlists, TEST_NETLISTS_FIXTURE )
 
 
@@ -296,4 +518,32 @@ BOOST_AUTO_TEST_CASE( TopLevelHierPins )
 }
 
 
+/**
+ * Recalculating only the links of the sheets changed since the last recalculation must give
+ * the same nets as recalculating everything.
+ */
+BOOST_AUTO_TEST_CASE( IncrementalVideo )
+{
+    doIncrementalTest( "video" );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalComplexHierarchyShared )
+{
+    doIncrementalTest( "complex_hierarchy_shared" );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalHierRenaming )
+{
+    doIncrementalTest( "test_hier_renaming" );
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalBusJunctions )
+{
+    doIncrementalTest( "bus_junctions" );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
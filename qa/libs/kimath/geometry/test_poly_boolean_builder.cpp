@@ -0,0 +1,177 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <random>
+
+#include <geometry/poly_boolean_builder.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+struct BooleanBuilderFixture
+{
+    SHAPE_POLY_SET                board;
+    std::vector<SHAPE_LINE_CHAIN> knockouts;
+
+    BooleanBuilderFixture()
+    {
+        SHAPE_LINE_CHAIN outline( { VECTOR2I( 0, 0 ), VECTOR2I( 10000000, 0 ),
+                                    VECTOR2I( 10000000, 10000000 ), VECTOR2I( 0, 10000000 ) },
+                                  true );
+
+        board.AddOutline( outline );
+
+        // Enough overlapping pads to go through the divide-and-conquer union
+        std::mt19937                       rng( 7 );
+        std::uniform_int_distribution<int> coord( 0, 10000000 );
+
+        for( size_t ii = 0; ii < 2 * POLY_BOOLEAN_BUILDER::DIVIDE_THRESHOLD + 10; ++ii )
+        {
+            SHAPE_LINE_CHAIN pad;
+            VECTOR2I         center( coord( rng ), coord( rng ) );
+
+            for( int jj = 0; jj < 16; ++jj )
+            {
+                double angle = 2 * M_PI * jj / 16;
+
+                pad.Append( center.x + KiROUND( 200000 * cos( angle ) ),
+                            center.y + KiROUND( 200000 * sin( angle ) ) );
+            }
+
+            pad.SetClosed( true );
+            knockouts.push_back( pad );
+        }
+    }
+};
+
+
+/**
+ * Results of the builder can only differ from the one-at-a-time boolean ops by rounding of
+ * the intersection points.
+ */
+static void checkSameArea( SHAPE_POLY_SET aExpected, SHAPE_POLY_SET aActual )
+{
+    BOOST_CHECK_CLOSE( aActual.Area(), aExpected.Area(), 1e-4 );
+}
+
+
+static int holeCount( const SHAPE_POLY_SET& aPolys )
+{
+    int count = 0;
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+        count += aPolys.HoleCount( ii );
+
+    return count;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( PolyBooleanBuilder, BooleanBuilderFixture )
+
+
+BOOST_AUTO_TEST_CASE( Union )
+{
+    SHAPE_POLY_SET       expected;
+    SHAPE_POLY_SET       result;
+    POLY_BOOLEAN_BUILDER builder;
+
+    for( const SHAPE_LINE_CHAIN& pad : knockouts )
+    {
+        expected.AddOutline( pad );
+        builder.AddSubject( pad );
+    }
+
+    expected.Simplify( SHAPE_POLY_SET::PM_FAST );
+    builder.Union( result, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( result.OutlineCount(), expected.OutlineCount() );
+    checkSameArea( expected, result );
+}
+
+
+BOOST_AUTO_TEST_CASE( Subtract )
+{
+    SHAPE_POLY_SET       expected = board;
+    SHAPE_POLY_SET       result = board;
+    POLY_BOOLEAN_BUILDER builder;
+
+    builder.AddSubject( result );
+
+    for( const SHAPE_LINE_CHAIN& pad : knockouts )
+    {
+        expected.BooleanSubtract( SHAPE_POLY_SET( pad ), SHAPE_POLY_SET::PM_FAST );
+        builder.AddClip( pad );
+    }
+
+    // The builder must not depend on its operands staying alive or unchanged
+    builder.Subtract( result, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( result.OutlineCount(), expected.OutlineCount() );
+    BOOST_CHECK_EQUAL( holeCount( result ), holeCount( expected ) );
+    checkSameArea( expected, result );
+}
+
+
+BOOST_AUTO_TEST_CASE( Intersect )
+{
+    SHAPE_POLY_SET       pads;
+    SHAPE_POLY_SET       expected = board;
+    SHAPE_POLY_SET       result;
+    POLY_BOOLEAN_BUILDER builder;
+
+    for( const SHAPE_LINE_CHAIN& pad : knockouts )
+    {
+        pads.AddOutline( pad );
+        builder.AddClip( pad );
+    }
+
+    builder.AddSubject( board );
+
+    expected.BooleanIntersection( pads, SHAPE_POLY_SET::PM_FAST );
+    builder.Intersect( result, SHAPE_POLY_SET::PM_FAST );
+
+    checkSameArea( expected, result );
+}
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    SHAPE_POLY_SET       result = board;
+    POLY_BOOLEAN_BUILDER builder;
+
+    BOOST_CHECK( builder.IsEmpty() );
+
+    builder.Union( result, SHAPE_POLY_SET::PM_FAST );
+    BOOST_CHECK_EQUAL( result.OutlineCount(), 0 );
+
+    builder.AddSubject( board );
+    BOOST_CHECK( !builder.IsEmpty() );
+
+    builder.Subtract( result, SHAPE_POLY_SET::PM_FAST );
+    checkSameArea( board, result );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,125 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <random>
+
+#include <geometry/seg_batch.h>
+
+
+/**
+ * Reference result: test each segment in turn, as SHAPE_LINE_CHAIN_BASE::Collide() does.
+ */
+static bool pairwiseCollide( const std::vector<SEG>& aSegs, const SEG& aRef, int aClearance,
+                             int* aActual, VECTOR2I* aLocation )
+{
+    SEG::ecoord closest_dist_sq = VECTOR2I::ECOORD_MAX;
+    VECTOR2I    nearest;
+
+    for( const SEG& s : aSegs )
+    {
+        SEG::ecoord dist_sq = s.SquaredDistance( aRef );
+
+        if( dist_sq < closest_dist_sq )
+        {
+            nearest = s.NearestPoint( aRef );
+            closest_dist_sq = dist_sq;
+
+            if( closest_dist_sq == 0 )
+                break;
+        }
+    }
+
+    if( closest_dist_sq == 0 || closest_dist_sq < SEG::Square( aClearance ) )
+    {
+        *aLocation = nearest;
+        *aActual = sqrt( closest_dist_sq );
+        return true;
+    }
+
+    return false;
+}
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+/**
+ * Every kernel must give exactly the same answers as the pairwise tests, including for
+ * coordinates near the limits of the int range.
+ */
+BOOST_AUTO_TEST_CASE( KernelsMatchPairwise )
+{
+    std::mt19937 rng( 42 );
+
+    for( int scale : { 1000, 1000000, 2000000000 } )
+    {
+        std::uniform_int_distribution<int> coord( -scale, scale );
+        std::uniform_int_distribution<int> clearance( 0, scale / 10 );
+        std::vector<SEG>                   segs;
+
+        for( int i = 0; i < 500; i++ )
+            segs.emplace_back( VECTOR2I( coord( rng ), coord( rng ) ),
+                               VECTOR2I( coord( rng ), coord( rng ) ) );
+
+        for( SEG_BATCH::KERNEL kernel : { SEG_BATCH::KERNEL::SCALAR, SEG_BATCH::KERNEL::SSE4,
+                                          SEG_BATCH::KERNEL::AVX2 } )
+        {
+            if( !SEG_BATCH::IsSupported( kernel ) )
+                continue;
+
+            BOOST_TEST_CONTEXT( SEG_BATCH::KernelName( kernel ) << " at scale " << scale )
+            {
+                SEG_BATCH batch;
+                batch.SetKernel( kernel );
+
+                for( const SEG& seg : segs )
+                    batch.Add( seg );
+
+                for( int i = 0; i < 500; i++ )
+                {
+                    VECTOR2I a( coord( rng ) / 10, coord( rng ) / 10 );
+                    SEG      ref( a, i % 2 ? a : VECTOR2I( coord( rng ), coord( rng ) ) );
+                    int      cl = clearance( rng );
+
+                    int      expActual = -1, actual = -1;
+                    VECTOR2I expLocation, location;
+                    bool     exp = pairwiseCollide( segs, ref, cl, &expActual, &expLocation );
+
+                    BOOST_CHECK_EQUAL( batch.Collide( ref, cl ), exp );
+                    BOOST_CHECK_EQUAL( batch.Collide( ref, cl, &actual, &location ), exp );
+
+                    if( exp )
+                    {
+                        BOOST_CHECK_EQUAL( actual, expActual );
+                        BOOST_CHECK_EQUAL( location, expLocation );
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -47,7 +47,7 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 
     SHAPE_LINE_CHAIN arc_insert2( SHAPE_ARC( VECTOR2I( 0, 500 ), VECTOR2I( 0, 400 ), 180.0 ) );
 
-    BOOST_CHECK_EQUAL( base_chain.CShapes().size(), base_chain.CPoints().size() );
+    BOOST_CHECK( base_chain.CShapes().empty() ); // no arcs, so no shape indices
     BOOST_CHECK_EQUAL( arc_insert1.CShapes().size(), arc_insert1.CPoints().size() );
     BOOST_CHECK_EQUAL( arc_insert2.CShapes().size(), arc_insert2.CPoints().size() );
 
@@ -61,7 +61,8 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 
     base_chain.Replace( 0, 2, chain_insert );
     BOOST_CHECK( GEOM_TEST::IsOutlineValid( base_chain ) );
-    BOOST_CHECK_EQUAL( base_chain.CShapes().size(), base_chain.CPoints().size() );
+    BOOST_CHECK_EQUAL( base_chain.ArcCount(), 0 ); // the arc was replaced
+    BOOST_CHECK( base_chain.CShapes().empty() );
 }
 
 
@@ -108,4 +109,34 @@ BOOST_AUTO_TEST_CASE( ArcToPolylineLargeCoords )
 }
 
 
+// Chains without arcs don't store shape indices, until the first arc is added
+BOOST_AUTO_TEST_CASE( CompactStraightChains )
+{
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 0, 0 ), VECTOR2I( 0, 100000 ), VECTOR2I( 100000, 0 ) } );
+
+    chain.Append( VECTOR2I( 200000, 0 ) );
+    chain.Insert( 1, VECTOR2I( 0, 50000 ) );
+    chain.Remove( 2 );
+    chain.Append( SHAPE_LINE_CHAIN( { VECTOR2I( 200000, 0 ), VECTOR2I( 200000, 10000 ) } ) );
+
+    BOOST_CHECK_EQUAL( chain.PointCount(), 5 );
+    BOOST_CHECK_EQUAL( chain.ShapeCount(), 4 );
+    BOOST_CHECK( chain.CShapes().empty() );
+
+    chain.Append( SHAPE_ARC( VECTOR2I( 300000, 10000 ), VECTOR2I( 400000, 110000 ), 180.0 ) );
+
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 1 );
+    BOOST_CHECK_EQUAL( chain.CShapes().size(), chain.CPoints().size() );
+    BOOST_CHECK( !chain.IsPtOnArc( 4 ) );
+    BOOST_CHECK( chain.IsPtOnArc( 5 ) );
+
+    chain.ClearArcs();
+
+    BOOST_CHECK( GEOM_TEST::IsOutlineValid( chain ) );
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 0 );
+    BOOST_CHECK( chain.CShapes().empty() );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cmath>
+#include <random>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+/**
+ * A wavy outline of 256 vertices with four round holes of 64 vertices, large enough for
+ * SHAPE_POLY_SET to index its edges once it has been queried a few times.
+ */
+static SHAPE_POLY_SET buildPolygonWithHoles()
+{
+    SHAPE_POLY_SET   set;
+    SHAPE_LINE_CHAIN outline;
+
+    for( int i = 0; i < 256; i++ )
+    {
+        double angle = 2 * M_PI * i / 256;
+        double radius = 100000 + 20000 * sin( 7 * angle );
+
+        outline.Append( KiROUND( radius * cos( angle ) ), KiROUND( radius * sin( angle ) ) );
+    }
+
+    outline.SetClosed( true );
+    set.AddOutline( outline );
+
+    for( const VECTOR2I& center : { VECTOR2I( 40000, 0 ), VECTOR2I( -40000, 0 ),
+                                    VECTOR2I( 0, 40000 ), VECTOR2I( 0, -40000 ) } )
+    {
+        SHAPE_LINE_CHAIN hole;
+
+        for( int i = 0; i < 64; i++ )
+        {
+            double angle = 2 * M_PI * i / 64;
+
+            hole.Append( center.x + KiROUND( 15000 * cos( angle ) ),
+                         center.y + KiROUND( 15000 * sin( angle ) ) );
+        }
+
+        hole.SetClosed( true );
+        set.AddHole( hole );
+    }
+
+    return set;
+}
+
+
+/**
+ * Query \a aSet repeatedly (which builds its edge index) and check each answer against the
+ * one of a fresh copy, whose first query always searches the edges linearly.
+ */
+static void checkAgainstLinear( const SHAPE_POLY_SET& aSet, std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int> coord( -150000, 150000 );
+    std::uniform_int_distribution<int> clearance( 0, 10000 );
+
+    for( int i = 0; i < 200; i++ )
+    {
+        VECTOR2I p( coord( aRng ), coord( aRng ) );
+        SEG      seg( p, VECTOR2I( coord( aRng ), coord( aRng ) ) );
+        int      cl = clearance( aRng );
+
+        BOOST_TEST_CONTEXT( "Query " << i << " at " << p )
+        {
+            for( int accuracy : { 0, 1, 500 } )
+            {
+                BOOST_CHECK_EQUAL( aSet.Contains( p, -1, accuracy ),
+                                   SHAPE_POLY_SET( aSet ).Contains( p, -1, accuracy ) );
+            }
+
+            VECTOR2I nearest, expNearest;
+
+            BOOST_CHECK_EQUAL( aSet.SquaredDistance( p, &nearest ),
+                               SHAPE_POLY_SET( aSet ).SquaredDistance( p, &expNearest ) );
+            BOOST_CHECK_EQUAL( nearest, expNearest );
+
+            BOOST_CHECK_EQUAL( aSet.SquaredDistance( seg, &nearest ),
+                               SHAPE_POLY_SET( aSet ).SquaredDistance( seg, &expNearest ) );
+            BOOST_CHECK_EQUAL( nearest, expNearest );
+
+            int      actual = -1, expActual = -1;
+            VECTOR2I location, expLocation;
+
+            BOOST_CHECK_EQUAL( aSet.Collide( p, cl, &actual, &location ),
+                               SHAPE_POLY_SET( aSet ).Collide( p, cl, &expActual,
+                                                               &expLocation ) );
+            BOOST_CHECK_EQUAL( actual, expActual );
+            BOOST_CHECK_EQUAL( location, expLocation );
+
+            BOOST_CHECK_EQUAL( aSet.Collide( seg, cl, &actual, &location ),
+                               SHAPE_POLY_SET( aSet ).Collide( seg, cl, &expActual,
+                                                               &expLocation ) );
+            BOOST_CHECK_EQUAL( actual, expActual );
+            BOOST_CHECK_EQUAL( location, expLocation );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetEdgeIndex )
+
+
+BOOST_AUTO_TEST_CASE( MatchesLinearSearch )
+{
+    std::mt19937   rng( 42 );
+    SHAPE_POLY_SET set = buildPolygonWithHoles();
+
+    checkAgainstLinear( set, rng );
+}
+
+
+/**
+ * Changes made through the non-const accessors after the index was built must be seen by
+ * the next queries.
+ */
+BOOST_AUTO_TEST_CASE( MutationThroughAccessors )
+{
+    std::mt19937   rng( 42 );
+    SHAPE_POLY_SET set = buildPolygonWithHoles();
+
+    checkAgainstLinear( set, rng );
+
+    set.Outline( 0 ).Move( VECTOR2I( 7000, -3000 ) );
+    checkAgainstLinear( set, rng );
+
+    set.Hole( 0, 1 ).SetPoint( 0, VECTOR2I( -40000, 0 ) );
+    checkAgainstLinear( set, rng );
+}
+
+
+/**
+ * A reference taken from a non-const accessor may be used to modify the polygons long after
+ * later queries would have rebuilt the index.
+ */
+BOOST_AUTO_TEST_CASE( MutationThroughHeldReference )
+{
+    std::mt19937             rng( 42 );
+    SHAPE_POLY_SET           set = buildPolygonWithHoles();
+    SHAPE_POLY_SET::POLYGON& polygon = set.Polygon( 0 );
+    SHAPE_LINE_CHAIN&        hole = set.Hole( 0, 2 );
+
+    checkAgainstLinear( set, rng );
+
+    hole.Move( VECTOR2I( 0, 20000 ) );
+    checkAgainstLinear( set, rng );
+
+    VECTOR2I pt = polygon[0].CPoint( 10 );
+
+    polygon[0].SetPoint( 10, VECTOR2I( pt.x * 9 / 10, pt.y * 9 / 10 ) );
+    checkAgainstLinear( set, rng );
+
+    // Rebuilding the polygons ends the outstanding references, so indexing resumes
+    set.BooleanAdd( buildPolygonWithHoles(), SHAPE_POLY_SET::PM_FAST );
+    checkAgainstLinear( set, rng );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
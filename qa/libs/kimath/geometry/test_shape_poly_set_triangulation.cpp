@@ -0,0 +1,237 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+/**
+ * A wavy closed outline of \a aCount vertices around \a aCenter.
+ */
+static SHAPE_LINE_CHAIN wavyOutline( const VECTOR2I& aCenter, int aRadius, int aCount )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        double angle = 2 * M_PI * i / aCount;
+        double radius = aRadius + aRadius / 5 * sin( 7 * angle );
+
+        chain.Append( aCenter.x + KiROUND( radius * cos( angle ) ),
+                      aCenter.y + KiROUND( radius * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+    return chain;
+}
+
+
+/**
+ * A grid of \a aColumns by \a aRows separate polygons, each with two round holes.
+ */
+static SHAPE_POLY_SET buildPolygonGrid( int aColumns, int aRows )
+{
+    SHAPE_POLY_SET set;
+
+    for( int row = 0; row < aRows; row++ )
+    {
+        for( int col = 0; col < aColumns; col++ )
+        {
+            VECTOR2I center( col * 3000000, row * 3000000 );
+
+            set.AddOutline( wavyOutline( center, 1000000, 200 ) );
+            set.AddHole( wavyOutline( center + VECTOR2I( 400000, 0 ), 200000, 40 ) );
+            set.AddHole( wavyOutline( center - VECTOR2I( 400000, 0 ), 200000, 40 ) );
+        }
+    }
+
+    return set;
+}
+
+
+/**
+ * Twice the area enclosed by \a aChain, exact for integer coordinates.
+ */
+static int64_t doubledArea( const SHAPE_LINE_CHAIN& aChain )
+{
+    int64_t area = 0;
+
+    for( int i = 0; i < aChain.PointCount(); i++ )
+    {
+        const VECTOR2I& p = aChain.CPoint( i );
+        const VECTOR2I& q = aChain.CPoint( ( i + 1 ) % aChain.PointCount() );
+
+        area += (int64_t) p.x * q.y - (int64_t) q.x * p.y;
+    }
+
+    return std::abs( area );
+}
+
+
+/**
+ * Check the cached triangulation of \a aSet against the polygons it came from: the triangles
+ * must lie inside the polygons and cover exactly their area, holes excluded.
+ */
+static void checkTriangulationCovers( const SHAPE_POLY_SET& aSet )
+{
+    BOOST_REQUIRE( aSet.IsTriangulationUpToDate() );
+
+    int64_t expectedArea = 0;
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+    {
+        expectedArea += doubledArea( aSet.COutline( ii ) );
+
+        for( int jj = 0; jj < aSet.HoleCount( ii ); jj++ )
+            expectedArea -= doubledArea( aSet.CHole( ii, jj ) );
+    }
+
+    int64_t triangleArea = 0;
+
+    for( unsigned int ii = 0; ii < aSet.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aSet.TriangulatedPolygon( ii );
+
+        for( size_t jj = 0; jj < tri->GetTriangleCount(); jj++ )
+        {
+            VECTOR2I a, b, c;
+            tri->GetTriangle( jj, a, b, c );
+
+            int64_t area = (int64_t) ( b.x - a.x ) * ( c.y - a.y )
+                           - (int64_t) ( c.x - a.x ) * ( b.y - a.y );
+
+            BOOST_TEST_CONTEXT( "Triangle " << jj << " of " << ii << ": " << a << b << c )
+            {
+                BOOST_CHECK_NE( area, 0 );
+
+                // Allow for the rounding of the centroid on slivers along the edges
+                VECTOR2I centroid( ( a.x + b.x + c.x ) / 3, ( a.y + b.y + c.y ) / 3 );
+                BOOST_CHECK( aSet.Contains( centroid, -1, 1 ) );
+            }
+
+            triangleArea += std::abs( area );
+        }
+    }
+
+    BOOST_CHECK_EQUAL( triangleArea, expectedArea );
+}
+
+
+static void checkSameTriangulation( const SHAPE_POLY_SET& aSerial,
+                                    const SHAPE_POLY_SET& aParallel )
+{
+    BOOST_REQUIRE( aSerial.IsTriangulationUpToDate() );
+    BOOST_REQUIRE( aParallel.IsTriangulationUpToDate() );
+    BOOST_REQUIRE_EQUAL( aSerial.TriangulatedPolyCount(), aParallel.TriangulatedPolyCount() );
+
+    for( unsigned int ii = 0; ii < aSerial.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* serial = aSerial.TriangulatedPolygon( ii );
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* parallel = aParallel.TriangulatedPolygon( ii );
+
+        BOOST_TEST_CONTEXT( "Triangulated polygon " << ii )
+        {
+            BOOST_REQUIRE_EQUAL( serial->GetTriangleCount(), parallel->GetTriangleCount() );
+
+            for( size_t jj = 0; jj < serial->GetTriangleCount(); jj++ )
+            {
+                VECTOR2I a, b, c;
+                VECTOR2I pa, pb, pc;
+
+                serial->GetTriangle( jj, a, b, c );
+                parallel->GetTriangle( jj, pa, pb, pc );
+
+                BOOST_CHECK_EQUAL( a, pa );
+                BOOST_CHECK_EQUAL( b, pb );
+                BOOST_CHECK_EQUAL( c, pc );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetTriangulation )
+
+
+/**
+ * The parallel mode must give the same triangles, in the same order, as the serial one.
+ */
+BOOST_AUTO_TEST_CASE( ParallelMatchesSerial )
+{
+    for( bool partition : { false, true } )
+    {
+        BOOST_TEST_CONTEXT( "Partition " << partition )
+        {
+            SHAPE_POLY_SET serial = buildPolygonGrid( 6, 4 );
+            SHAPE_POLY_SET parallel = serial;
+
+            serial.CacheTriangulation( partition, false );
+            parallel.CacheTriangulation( partition, true );
+
+            checkSameTriangulation( serial, parallel );
+        }
+    }
+}
+
+
+/**
+ * Polygons with holes, small enough for the triangulator to sort its vertices with std::sort
+ * and large enough for it to radix sort them, must be covered exactly by their triangles.
+ */
+BOOST_AUTO_TEST_CASE( HolesCoveredExactly )
+{
+    SHAPE_POLY_SET small;
+    small.AddOutline( wavyOutline( VECTOR2I( 0, 0 ), 1000000, 60 ) );
+    small.AddHole( wavyOutline( VECTOR2I( 300000, 0 ), 200000, 24 ) );
+
+    SHAPE_POLY_SET large;
+    large.AddOutline( wavyOutline( VECTOR2I( 0, 0 ), 5000000, 1000 ) );
+
+    for( int i = 0; i < 8; i++ )
+    {
+        double   angle = 2 * M_PI * i / 8;
+        VECTOR2I center( KiROUND( 2500000 * cos( angle ) ), KiROUND( 2500000 * sin( angle ) ) );
+
+        large.AddHole( wavyOutline( center, 500000, 120 ) );
+    }
+
+    for( SHAPE_POLY_SET* set : { &small, &large } )
+    {
+        BOOST_TEST_CONTEXT( set->TotalVertices() << " vertices" )
+        {
+            // Without partitioning, so no vertices are rounded off by clipping
+            set->CacheTriangulation( false );
+            checkTriangulationCovers( *set );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -436,9 +436,10 @@ static void CheckCollisionsMatchExpected( BOARD& aBoard,
 /**
  * Run a single courtyard overlap testcase
  * @param aCase The testcase to run.
+ * @param aConcurrent Run the thread-safe test providers concurrently.
  */
 static void DoCourtyardOverlapTest( const COURTYARD_OVERLAP_TEST_CASE& aCase,
-                                    const KI_TEST::BOARD_DUMPER& aDumper )
+                                    const KI_TEST::BOARD_DUMPER& aDumper, bool aConcurrent )
 {
     auto board = MakeBoard( aCase.m_fpDefs );
 
@@ -458,6 +459,7 @@ static void DoCourtyardOverlapTest( const COURTYARD_OVERLAP_TEST_CASE& aCase,
     DRC_ENGINE drcEngine( board.get(), &board->GetDesignSettings() );
 
     drcEngine.InitEngine( wxFileName() );
+    drcEngine.SetConcurrentTestProviders( aConcurrent );
 
     drcEngine.SetViolationHandler(
             [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
@@ -476,13 +478,83 @@ static void DoCourtyardOverlapTest( const COURTYARD_OVERLAP_TEST_CASE& aCase,
 }
 
 
+/**
+ * Run a single courtyard overlap testcase incrementally, once for each footprint.  Only the
+ * collisions involving the re-tested footprint should be reported.
+ */
+static void DoIncrementalCourtyardOverlapTest( const COURTYARD_OVERLAP_TEST_CASE& aCase )
+{
+    auto board = MakeBoard( aCase.m_fpDefs );
+
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+
+    bds.m_DRCSeverities[ DRCE_OVERLAPPING_FOOTPRINTS ] = RPT_SEVERITY_ERROR;
+    bds.m_DRCSeverities[ DRCE_MISSING_COURTYARD ] = RPT_SEVERITY_IGNORE;
+
+    DRC_ENGINE drcEngine( board.get(), &board->GetDesignSettings() );
+
+    drcEngine.InitEngine( wxFileName() );
+
+    for( FOOTPRINT* footprint : board->Footprints() )
+    {
+        std::vector<std::unique_ptr<PCB_MARKER>> markers;
+        std::vector<COURTYARD_COLLISION>         expected;
+        std::string                              refdes = footprint->GetReference().ToStdString();
+
+        for( const COURTYARD_COLLISION& collision : aCase.m_collisions )
+        {
+            if( collision.m_refdes_a == refdes || collision.m_refdes_b == refdes )
+                expected.push_back( collision );
+        }
+
+        drcEngine.SetViolationHandler(
+                [&]( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+                {
+                    if( aItem->GetErrorCode() == DRCE_OVERLAPPING_FOOTPRINTS )
+                        markers.push_back( std::make_unique<PCB_MARKER>( aItem, aPos ) );
+                } );
+
+        drcEngine.RunIncrementalTests( EDA_UNITS::MILLIMETRES, { footprint } );
+
+        BOOST_TEST_CONTEXT( refdes )
+        {
+            CheckCollisionsMatchExpected( *board, markers, expected );
+        }
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE( OverlapCases )
 {
     for( const auto& c : courtyard_cases )
     {
         BOOST_TEST_CONTEXT( c.m_case_name )
         {
-            DoCourtyardOverlapTest( c, m_dumper );
+            DoCourtyardOverlapTest( c, m_dumper, false );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( OverlapCasesConcurrent )
+{
+    for( const auto& c : courtyard_cases )
+    {
+        BOOST_TEST_CONTEXT( c.m_case_name )
+        {
+            DoCourtyardOverlapTest( c, m_dumper, true );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( OverlapCasesIncremental )
+{
+    for( const auto& c : courtyard_cases )
+    {
+        BOOST_TEST_CONTEXT( c.m_case_name )
+        {
+            DoIncrementalCourtyardOverlapTest( c );
         }
     }
 }
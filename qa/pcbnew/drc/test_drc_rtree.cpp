@@ -0,0 +1,267 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc_rtree.cpp
+ * Test the queries of the packed DRC_RTREE against a brute-force scan of the same items.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <board.h>
+#include <pcb_track.h>
+#include <drc/drc_rtree.h>
+
+
+struct DRC_RTREE_FIXTURE
+{
+    DRC_RTREE_FIXTURE() :
+            m_rng( 1234 )
+    {
+    }
+
+    int randomCoord( int aRange )
+    {
+        return std::uniform_int_distribution<int>( -aRange, aRange )( m_rng );
+    }
+
+    /**
+     * Add a track on \a aLayer to the items, and to the tree as well as the brute-force list.
+     */
+    PCB_TRACK* addTrack( const wxPoint& aStart, const wxPoint& aEnd, int aWidth,
+                         PCB_LAYER_ID aLayer )
+    {
+        PCB_TRACK* track = new PCB_TRACK( &m_board );
+
+        track->SetStart( aStart );
+        track->SetEnd( aEnd );
+        track->SetWidth( aWidth );
+        track->SetLayer( aLayer );
+
+        m_items.emplace_back( track );
+        m_tree.Insert( track, aLayer );
+        m_layerItems[aLayer].push_back( track );
+        m_shapes[track] = track->GetEffectiveShape( aLayer );
+
+        return track;
+    }
+
+    /**
+     * Add \a aCount tracks at random, most of them short but some spanning a good part of the
+     * board, and a few stacked at the same place.
+     */
+    void addRandomTracks( size_t aCount, PCB_LAYER_ID aLayer )
+    {
+        for( size_t ii = 0; ii < aCount; ++ii )
+        {
+            wxPoint start( randomCoord( 50000000 ), randomCoord( 50000000 ) );
+            int     length = ( ii % 50 == 0 ) ? 30000000 : 2000000;
+            wxPoint end = start + wxPoint( randomCoord( length ), randomCoord( length ) );
+
+            if( ii % 97 == 0 )
+                end = start = wxPoint( 1000000, 1000000 );
+
+            addTrack( start, end, 100000 + ii % 5 * 50000, aLayer );
+        }
+    }
+
+    /**
+     * @return the items on \a aTargetLayer colliding with \a aRefItem, found by the tree.
+     */
+    std::set<BOARD_ITEM*> queryTree( BOARD_ITEM* aRefItem, PCB_LAYER_ID aTargetLayer,
+                                     int aClearance ) const
+    {
+        std::set<BOARD_ITEM*> found;
+
+        int count = m_tree.QueryColliding( aRefItem, aRefItem->GetLayer(), aTargetLayer, nullptr,
+                                           [&]( BOARD_ITEM* aItem ) -> bool
+                                           {
+                                               BOOST_CHECK( found.insert( aItem ).second );
+                                               return true;
+                                           },
+                                           aClearance );
+
+        BOOST_CHECK_EQUAL( count, (int) found.size() );
+        return found;
+    }
+
+    /**
+     * @return the items on \a aTargetLayer colliding with \a aRefItem, found by testing them
+     *         all.
+     */
+    std::set<BOARD_ITEM*> queryBruteForce( BOARD_ITEM* aRefItem, PCB_LAYER_ID aTargetLayer,
+                                           int aClearance ) const
+    {
+        std::set<BOARD_ITEM*> found;
+        const SHAPE*          refShape = m_shapes.at( aRefItem ).get();
+        auto                  it = m_layerItems.find( aTargetLayer );
+
+        if( it == m_layerItems.end() )
+            return found;
+
+        for( BOARD_ITEM* item : it->second )
+        {
+            if( item != aRefItem && refShape->Collide( m_shapes.at( item ).get(), aClearance ) )
+                found.insert( item );
+        }
+
+        return found;
+    }
+
+    /**
+     * Check the tree against the brute-force scan for every \a aStride'th item as the reference,
+     * on its own layer and on \a aOtherLayer, at a few clearances.
+     */
+    void checkQueries( PCB_LAYER_ID aOtherLayer, size_t aStride = 1 )
+    {
+        for( size_t ii = 0; ii < m_items.size(); ii += aStride )
+        {
+            const std::unique_ptr<BOARD_ITEM>& refItem = m_items[ii];
+
+            for( PCB_LAYER_ID layer : { refItem->GetLayer(), aOtherLayer } )
+            {
+                for( int clearance : { 0, 200000, 5000000 } )
+                {
+                    BOOST_TEST_CONTEXT( "Item at " << refItem->GetPosition().x << ","
+                                        << refItem->GetPosition().y << ", layer " << layer
+                                        << ", clearance " << clearance )
+                    {
+                        std::set<BOARD_ITEM*> expected = queryBruteForce( refItem.get(), layer,
+                                                                          clearance );
+                        std::set<BOARD_ITEM*> actual = queryTree( refItem.get(), layer,
+                                                                  clearance );
+
+                        BOOST_CHECK( actual == expected );
+
+                        SHAPE* refShape = m_shapes.at( refItem.get() ).get();
+                        bool   colliding = !expected.empty();
+
+                        // CheckColliding() also counts the reference item itself
+                        if( layer == refItem->GetLayer() )
+                            colliding = true;
+
+                        BOOST_CHECK_EQUAL( m_tree.CheckColliding( refShape, layer, clearance ),
+                                           colliding );
+                    }
+                }
+            }
+        }
+    }
+
+    BOARD                                            m_board;
+    DRC_RTREE                                        m_tree;
+    std::vector<std::unique_ptr<BOARD_ITEM>>         m_items;
+    std::map<PCB_LAYER_ID, std::vector<BOARD_ITEM*>> m_layerItems;
+    std::map<BOARD_ITEM*, std::shared_ptr<SHAPE>>    m_shapes;
+    std::mt19937                                     m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DrcRtree, DRC_RTREE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    PCB_TRACK track( &m_board );
+
+    track.SetEnd( wxPoint( 1000000, 0 ) );
+    track.SetLayer( F_Cu );
+
+    BOOST_CHECK( m_tree.empty() );
+    BOOST_CHECK_EQUAL( m_tree.QueryColliding( &track, F_Cu, F_Cu ), 0 );
+    BOOST_CHECK( m_tree.OnLayer( F_Cu ).begin() == m_tree.OnLayer( F_Cu ).end() );
+}
+
+
+/**
+ * Trees of one node level, of several levels, and of levels with a last node just starting.
+ */
+BOOST_AUTO_TEST_CASE( NodeBoundaries )
+{
+    for( size_t size : std::vector<size_t>{ 1, 2, 15, 16, 17, 255, 256, 257 } )
+    {
+        m_tree.clear();
+        m_items.clear();
+        m_layerItems.clear();
+        m_shapes.clear();
+
+        BOOST_TEST_CONTEXT( "Size " << size )
+        {
+            addRandomTracks( size, F_Cu );
+
+            BOOST_CHECK_EQUAL( m_tree.size(), size );
+
+            size_t count = 0;
+
+            for( DRC_RTREE::ITEM_WITH_SHAPE* item : m_tree.OnLayer( F_Cu ) )
+            {
+                (void) item;
+                count++;
+            }
+
+            BOOST_CHECK_EQUAL( count, size );
+
+            checkQueries( B_Cu );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( RandomTracks )
+{
+    addRandomTracks( 5000, F_Cu );
+    addRandomTracks( 500, B_Cu );
+
+    // One track across the whole board
+    addTrack( wxPoint( -60000000, -60000000 ), wxPoint( 60000000, 60000000 ), 250000, F_Cu );
+
+    // A brute-force scan for all of them would take too long
+    checkQueries( B_Cu, 7 );
+}
+
+
+/**
+ * Inserting after a query re-packs the layer before the next one.
+ */
+BOOST_AUTO_TEST_CASE( InsertAfterQuery )
+{
+    for( int batch = 0; batch < 5; ++batch )
+    {
+        BOOST_TEST_CONTEXT( "Batch " << batch )
+        {
+            addRandomTracks( 300, F_Cu );
+            addRandomTracks( 30, B_Cu );
+
+            checkQueries( B_Cu, 3 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,312 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc_rule_cache.cpp
+ * Test that the memoized rule resolution of DRC_ENGINE::EvalRules() gives the same constraints
+ * as resolving the rules afresh.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <drc/drc_engine.h>
+#include <drc/drc_rule.h>
+#include <netclass.h>
+#include <netinfo.h>
+#include <pcb_track.h>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+
+static const char RULES[] =
+        "(version 1)\n"
+        "(rule \"signal\"\n"
+        "  (constraint clearance (min 0.3mm))\n"
+        "  (condition \"A.NetClass == 'SIGNAL'\"))\n"
+        "(rule \"power_to_signal\"\n"
+        "  (constraint clearance (min 0.5mm))\n"
+        "  (condition \"A.NetClass == 'POWER' && B.NetClass == 'SIGNAL'\"))\n"
+        "(rule \"inner\"\n"
+        "  (layer inner)\n"
+        "  (constraint clearance (min 0.2mm)))\n"
+        "(rule \"micro_via_hole\"\n"
+        "  (constraint hole_clearance (min 0.4mm))\n"
+        "  (condition \"A.Type == 'Via' && A.Via_Type == 'Micro'\"))\n"
+        "(rule \"back_power\"\n"
+        "  (constraint track_width (min 0.5mm))\n"
+        "  (condition \"A.NetClass == 'POWER' && A.Layer == 'B.Cu'\"))\n"
+        "(rule \"wide_annulus\"\n"
+        "  (constraint annular_width (min 0.2mm))\n"
+        "  (condition \"A.Width > 0.6mm\"))\n";
+
+
+struct DRC_RULE_CACHE_FIXTURE
+{
+    DRC_RULE_CACHE_FIXTURE() :
+            m_engine( &m_board, &m_board.GetDesignSettings() )
+    {
+        m_rulesFile = wxFileName::CreateTempFileName( wxT( "qa_drc_rules" ) );
+
+        {
+            wxFFile file( m_rulesFile, wxT( "wb" ) );
+
+            BOOST_REQUIRE( file.IsOpened() );
+            BOOST_REQUIRE( file.Write( RULES, strlen( RULES ) ) == strlen( RULES ) );
+        }
+
+        m_board.SetCopperLayerCount( 4 );
+
+        NETCLASSES& netclasses = m_board.GetDesignSettings().GetNetClasses();
+        NETCLASSPTR power = std::make_shared<NETCLASS>( wxT( "POWER" ) );
+        NETCLASSPTR signal = std::make_shared<NETCLASS>( wxT( "SIGNAL" ) );
+
+        power->SetClearance( 400000 );
+        power->SetTrackWidth( 600000 );
+        signal->SetClearance( 150000 );
+        signal->SetTrackWidth( 150000 );
+        netclasses.Add( power );
+        netclasses.Add( signal );
+
+        addNet( wxT( "VCC" ), power );
+        addNet( wxT( "+5V" ), power );
+        addNet( wxT( "SDA" ), signal );
+        addNet( wxT( "GND" ), netclasses.GetDefault() );
+
+        // One track per copper layer and one via per via type on each net, plus an unconnected
+        // track
+        for( NETINFO_ITEM* net : m_nets )
+        {
+            for( PCB_LAYER_ID layer : { F_Cu, In1_Cu, B_Cu } )
+            {
+                PCB_TRACK* track = new PCB_TRACK( &m_board );
+
+                track->SetLayer( layer );
+                track->SetStart( wxPoint( 0, 0 ) );
+                track->SetEnd( wxPoint( 1000000, 0 ) );
+                track->SetWidth( layer == B_Cu ? 700000 : 250000 );
+                track->SetNet( net );
+                addItem( track );
+            }
+
+            for( VIATYPE viaType : { VIATYPE::THROUGH, VIATYPE::MICROVIA, VIATYPE::BLIND_BURIED } )
+            {
+                PCB_VIA* via = new PCB_VIA( &m_board );
+
+                via->SetViaType( viaType );
+
+                if( viaType == VIATYPE::THROUGH )
+                    via->SetLayerPair( F_Cu, B_Cu );
+                else if( viaType == VIATYPE::MICROVIA )
+                    via->SetLayerPair( F_Cu, In1_Cu );
+                else
+                    via->SetLayerPair( In1_Cu, B_Cu );
+
+                via->SetWidth( 800000 );
+                via->SetDrill( 400000 );
+                via->SetNet( net );
+                addItem( via );
+            }
+        }
+
+        PCB_TRACK* unconnected = new PCB_TRACK( &m_board );
+
+        unconnected->SetLayer( F_Cu );
+        unconnected->SetWidth( 200000 );
+        addItem( unconnected );
+
+        m_engine.InitEngine( wxFileName( m_rulesFile ) );
+    }
+
+    ~DRC_RULE_CACHE_FIXTURE()
+    {
+        wxRemoveFile( m_rulesFile );
+    }
+
+    void addNet( const wxString& aName, const NETCLASSPTR& aNetclass )
+    {
+        NETINFO_ITEM* net = new NETINFO_ITEM( &m_board, aName );
+
+        m_board.Add( net );
+        net->SetNetClass( aNetclass );
+        m_nets.push_back( net );
+    }
+
+    void addItem( BOARD_ITEM* aItem )
+    {
+        m_board.Add( aItem );
+        m_items.push_back( aItem );
+    }
+
+    ///< One EvalRules() query
+    struct QUERY
+    {
+        DRC_CONSTRAINT_T  m_constraintId;
+        const BOARD_ITEM* m_a;
+        const BOARD_ITEM* m_b;
+        PCB_LAYER_ID      m_layer;
+    };
+
+    /**
+     * @return every constraint type on every layer for every ordered pair of items, and every
+     *         item on its own.
+     */
+    std::vector<QUERY> makeQueries() const
+    {
+        std::vector<QUERY> queries;
+
+        for( DRC_CONSTRAINT_T id : { CLEARANCE_CONSTRAINT, HOLE_CLEARANCE_CONSTRAINT,
+                                     EDGE_CLEARANCE_CONSTRAINT, TRACK_WIDTH_CONSTRAINT,
+                                     HOLE_SIZE_CONSTRAINT, ANNULAR_WIDTH_CONSTRAINT } )
+        {
+            for( PCB_LAYER_ID layer : { F_Cu, In1_Cu, B_Cu, UNDEFINED_LAYER } )
+            {
+                for( const BOARD_ITEM* a : m_items )
+                {
+                    queries.push_back( { id, a, nullptr, layer } );
+
+                    for( const BOARD_ITEM* b : m_items )
+                    {
+                        if( b != a )
+                            queries.push_back( { id, a, b, layer } );
+                    }
+                }
+            }
+        }
+
+        return queries;
+    }
+
+    /**
+     * Evaluate a query with an empty cache: bumping the board timestamp drops the memoized
+     * resolutions.
+     */
+    DRC_CONSTRAINT evalUncached( const QUERY& aQuery )
+    {
+        m_board.IncrementTimeStamp();
+
+        return m_engine.EvalRules( aQuery.m_constraintId, aQuery.m_a, aQuery.m_b,
+                                   aQuery.m_layer );
+    }
+
+    static void checkSameConstraint( const DRC_CONSTRAINT& aActual,
+                                     const DRC_CONSTRAINT& aExpected )
+    {
+        BOOST_CHECK_EQUAL( aActual.m_Type, aExpected.m_Type );
+        BOOST_CHECK_EQUAL( aActual.GetName(), aExpected.GetName() );
+        BOOST_CHECK( aActual.GetParentRule() == aExpected.GetParentRule() );
+        BOOST_CHECK_EQUAL( aActual.m_DisallowFlags, aExpected.m_DisallowFlags );
+        BOOST_CHECK_EQUAL( aActual.GetValue().HasMin(), aExpected.GetValue().HasMin() );
+        BOOST_CHECK_EQUAL( aActual.GetValue().HasOpt(), aExpected.GetValue().HasOpt() );
+        BOOST_CHECK_EQUAL( aActual.GetValue().HasMax(), aExpected.GetValue().HasMax() );
+        BOOST_CHECK_EQUAL( aActual.GetValue().Min(), aExpected.GetValue().Min() );
+        BOOST_CHECK_EQUAL( aActual.GetValue().Opt(), aExpected.GetValue().Opt() );
+        BOOST_CHECK_EQUAL( aActual.GetValue().Max(), aExpected.GetValue().Max() );
+    }
+
+    BOARD                      m_board;
+    DRC_ENGINE                 m_engine;
+    wxString                   m_rulesFile;
+    std::vector<NETINFO_ITEM*> m_nets;
+    std::vector<BOARD_ITEM*>   m_items;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DrcRuleCache, DRC_RULE_CACHE_FIXTURE )
+
+
+/**
+ * Queries answered from entries other queries left in the cache, in either order of the items
+ * and of the queries, resolve to the same constraints as with an empty cache.
+ */
+BOOST_AUTO_TEST_CASE( CachedSameAsUncached )
+{
+    BOOST_REQUIRE( m_engine.RulesValid() );
+
+    std::vector<QUERY>          queries = makeQueries();
+    std::vector<DRC_CONSTRAINT> expected;
+
+    expected.reserve( queries.size() );
+
+    for( const QUERY& query : queries )
+        expected.push_back( evalUncached( query ) );
+
+    for( bool reverse : { false, true } )
+    {
+        m_board.IncrementTimeStamp();
+
+        for( size_t jj = 0; jj < queries.size(); ++jj )
+        {
+            size_t       ii = reverse ? queries.size() - 1 - jj : jj;
+            const QUERY& query = queries[ii];
+
+            BOOST_TEST_CONTEXT( "Query " << ii << ( reverse ? " (reversed)" : "" ) )
+            {
+                checkSameConstraint( m_engine.EvalRules( query.m_constraintId, query.m_a,
+                                                         query.m_b, query.m_layer ),
+                                     expected[ii] );
+            }
+        }
+    }
+}
+
+
+/**
+ * A rule on the netclasses of both items tells the items apart, so its cache entries must too.
+ */
+BOOST_AUTO_TEST_CASE( ItemPairOrder )
+{
+    const BOARD_ITEM* power = m_items[0];       // VCC track on F.Cu
+    const BOARD_ITEM* signal = m_items[12];     // SDA track on F.Cu
+
+    BOOST_REQUIRE( static_cast<const PCB_TRACK*>( power )->GetNetClassName() == "POWER" );
+    BOOST_REQUIRE( static_cast<const PCB_TRACK*>( signal )->GetNetClassName() == "SIGNAL" );
+
+    DRC_CONSTRAINT powerToSignal = m_engine.EvalRules( CLEARANCE_CONSTRAINT, power, signal,
+                                                       F_Cu );
+    DRC_CONSTRAINT signalToPower = m_engine.EvalRules( CLEARANCE_CONSTRAINT, signal, power,
+                                                       F_Cu );
+
+    BOOST_CHECK_EQUAL( powerToSignal.GetValue().Min(), 500000 );
+    BOOST_CHECK_EQUAL( signalToPower.GetValue().Min(), 300000 );
+
+    // And again, now that both are in the cache
+    BOOST_CHECK_EQUAL( m_engine.EvalRules( CLEARANCE_CONSTRAINT, signal, power, F_Cu )
+                               .GetValue().Min(), 300000 );
+    BOOST_CHECK_EQUAL( m_engine.EvalRules( CLEARANCE_CONSTRAINT, power, signal, F_Cu )
+                               .GetValue().Min(), 500000 );
+
+    // The inner layer rule comes last, so it wins on inner layers whatever the netclasses
+    BOOST_CHECK_EQUAL( m_engine.EvalRules( CLEARANCE_CONSTRAINT, power, signal, In1_Cu )
+                               .GetValue().Min(), 200000 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
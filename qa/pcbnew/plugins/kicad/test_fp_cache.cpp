@@ -0,0 +1,342 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_fp_cache.cpp
+ * Test the footprint cache of the KiCad footprint library plugin, and the index of footprint
+ * files which lets it skip parsing the unchanged ones.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <footprint.h>
+#include <ki_exception.h>
+#include <kiid.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+
+struct FP_CACHE_FIXTURE
+{
+    FP_CACHE_FIXTURE()
+    {
+        // A fresh library path for each test, so that no index from an earlier run applies
+        wxFileName dir( wxFileName::CreateTempFileName( wxT( "qa_fp_cache" ) ) );
+
+        wxRemoveFile( dir.GetFullPath() );
+        dir.SetExt( wxT( "pretty" ) );
+
+        m_libPath = dir.GetFullPath();
+        wxFileName::Mkdir( m_libPath );
+
+        m_time = wxDateTime::Now() - wxTimeSpan::Hour();
+    }
+
+    ~FP_CACHE_FIXTURE()
+    {
+        wxFileName::Rmdir( m_libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    wxString footprintPath( const wxString& aName ) const
+    {
+        return wxFileName( m_libPath, aName, KiCadFootprintFileExtension ).GetFullPath();
+    }
+
+    /**
+     * Write \a aContents to the file of footprint \a aName and give it a modification time
+     * of its own, later than the one of any file written before.
+     */
+    void writeFile( const wxString& aName, const wxString& aContents )
+    {
+        {
+            wxFFile file( footprintPath( aName ), wxT( "wb" ) );
+
+            BOOST_REQUIRE( file.IsOpened() );
+            BOOST_REQUIRE( file.Write( aContents ) );
+        }
+
+        m_time += wxTimeSpan::Minute();
+        setModTime( aName, m_time );
+    }
+
+    void setModTime( const wxString& aName, const wxDateTime& aTime )
+    {
+        BOOST_REQUIRE( wxFileName( footprintPath( aName ) ).SetTimes( nullptr, &aTime,
+                                                                      nullptr ) );
+    }
+
+    void writeFootprint( const wxString& aName, const wxString& aDescription )
+    {
+        writeFile( aName, wxString::Format( wxT( "(footprint \"%s\" (version 20210722) "
+                                                 "(generator pcbnew)\n"
+                                                 "  (layer \"F.Cu\")\n"
+                                                 "  (descr \"%s\")\n"
+                                                 ")\n" ),
+                                            aName, aDescription ) );
+    }
+
+    /**
+     * Overwrite the file of footprint \a aName with as many bytes of garbage, and give it
+     * back its modification time: nothing but parsing it can tell it has changed.
+     */
+    void corruptFootprintUnnoticed( const wxString& aName )
+    {
+        wxDateTime modTime = wxFileName( footprintPath( aName ) ).GetModificationTime();
+        wxFFile    file( footprintPath( aName ), wxT( "r+b" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+
+        std::string garbage( file.Length(), 'x' );
+
+        BOOST_REQUIRE( file.Write( garbage.data(), garbage.size() ) == garbage.size() );
+        file.Close();
+
+        setModTime( aName, modTime );
+    }
+
+    std::set<wxString> enumerate( PCB_IO& aPlugin, bool aBestEfforts = false )
+    {
+        wxArrayString names;
+
+        aPlugin.FootprintEnumerate( names, m_libPath, aBestEfforts );
+
+        return std::set<wxString>( names.begin(), names.end() );
+    }
+
+    wxString description( PCB_IO& aPlugin, const wxString& aName )
+    {
+        std::unique_ptr<FOOTPRINT> footprint( aPlugin.FootprintLoad( m_libPath, aName ) );
+
+        BOOST_REQUIRE( footprint );
+        return footprint->GetDescription();
+    }
+
+    wxString   m_libPath;
+    wxDateTime m_time;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FootprintCache, FP_CACHE_FIXTURE )
+
+
+/**
+ * Files which are unchanged since the index was written are enumerated without parsing them.
+ */
+BOOST_AUTO_TEST_CASE( EnumerateFromIndex )
+{
+    writeFootprint( wxT( "A" ), wxT( "first" ) );
+    writeFootprint( wxT( "B" ), wxT( "second" ) );
+    writeFootprint( wxT( "C" ), wxT( "third" ) );
+
+    const std::set<wxString> all = { wxT( "A" ), wxT( "B" ), wxT( "C" ) };
+
+    {
+        PCB_IO plugin;
+        BOOST_CHECK( enumerate( plugin ) == all );
+    }
+
+    // B no longer parses, but only parsing it could tell
+    corruptFootprintUnnoticed( wxT( "B" ) );
+
+    PCB_IO plugin;
+
+    BOOST_CHECK( enumerate( plugin ) == all );
+    BOOST_CHECK_EQUAL( description( plugin, wxT( "A" ) ), wxT( "first" ) );
+    BOOST_CHECK_EQUAL( description( plugin, wxT( "C" ) ), wxT( "third" ) );
+}
+
+
+/**
+ * A modified file is parsed again, by the cache which had read it as well as by a fresh one
+ * which only knows it from the index.
+ */
+BOOST_AUTO_TEST_CASE( ReparseModified )
+{
+    writeFootprint( wxT( "A" ), wxT( "first" ) );
+    writeFootprint( wxT( "B" ), wxT( "second" ) );
+
+    PCB_IO plugin;
+
+    BOOST_CHECK_EQUAL( description( plugin, wxT( "A" ) ), wxT( "first" ) );
+
+    writeFootprint( wxT( "A" ), wxT( "first, modified" ) );
+    BOOST_CHECK_EQUAL( description( plugin, wxT( "A" ) ), wxT( "first, modified" ) );
+
+    writeFootprint( wxT( "A" ), wxT( "first, modified again" ) );
+
+    PCB_IO freshPlugin;
+
+    BOOST_CHECK_EQUAL( description( freshPlugin, wxT( "A" ) ), wxT( "first, modified again" ) );
+    BOOST_CHECK_EQUAL( description( freshPlugin, wxT( "B" ) ), wxT( "second" ) );
+}
+
+
+/**
+ * A deleted file is dropped from the cache and from the index.
+ */
+BOOST_AUTO_TEST_CASE( DropDeleted )
+{
+    writeFootprint( wxT( "A" ), wxT( "first" ) );
+    writeFootprint( wxT( "B" ), wxT( "second" ) );
+
+    PCB_IO plugin;
+
+    BOOST_CHECK( enumerate( plugin ) == std::set<wxString>( { wxT( "A" ), wxT( "B" ) } ) );
+
+    BOOST_REQUIRE( wxRemoveFile( footprintPath( wxT( "B" ) ) ) );
+
+    BOOST_CHECK( enumerate( plugin ) == std::set<wxString>( { wxT( "A" ) } ) );
+    BOOST_CHECK( !plugin.GetEnumeratedFootprint( m_libPath, wxT( "B" ) ) );
+
+    PCB_IO freshPlugin;
+
+    BOOST_CHECK( enumerate( freshPlugin ) == std::set<wxString>( { wxT( "A" ) } ) );
+    BOOST_CHECK( !freshPlugin.GetEnumeratedFootprint( m_libPath, wxT( "B" ) ) );
+}
+
+
+/**
+ * A file enumerated from the index which fails to parse once it is needed yields no
+ * footprint, and is then reported like any other bad file.
+ */
+BOOST_AUTO_TEST_CASE( LazyParseFailure )
+{
+    writeFootprint( wxT( "A" ), wxT( "first" ) );
+    writeFootprint( wxT( "B" ), wxT( "second" ) );
+
+    {
+        PCB_IO plugin;
+        enumerate( plugin );
+    }
+
+    corruptFootprintUnnoticed( wxT( "B" ) );
+
+    PCB_IO plugin;
+
+    BOOST_CHECK( enumerate( plugin ) == std::set<wxString>( { wxT( "A" ), wxT( "B" ) } ) );
+    BOOST_CHECK( !plugin.GetEnumeratedFootprint( m_libPath, wxT( "B" ) ) );
+
+    // The entry is gone from the cache and from the index, so B is parsed again, and fails
+    BOOST_CHECK_THROW( enumerate( plugin ), IO_ERROR );
+    BOOST_CHECK( enumerate( plugin, true ) == std::set<wxString>( { wxT( "A" ) } ) );
+
+    PCB_IO freshPlugin;
+
+    BOOST_CHECK_THROW( enumerate( freshPlugin ), IO_ERROR );
+    BOOST_CHECK( enumerate( freshPlugin, true ) == std::set<wxString>( { wxT( "A" ) } ) );
+}
+
+
+/**
+ * Large libraries are parsed on several threads.  The errors must still be reported in the
+ * same order, and the footprints built concurrently must not share UUIDs.
+ */
+BOOST_AUTO_TEST_CASE( ConcurrentParse )
+{
+    std::vector<wxString> badNames;
+
+    // Written in reverse order, so directory order is unlikely to match the sorted one
+    for( int i = 63; i >= 0; i-- )
+    {
+        wxString name = wxString::Format( wxT( "FP%02d" ), i );
+
+        if( i % 7 == 3 )
+        {
+            writeFile( name, wxT( "(footprint broken" ) );
+            badNames.insert( badNames.begin(), name );
+        }
+        else
+        {
+            writeFootprint( name, name );
+        }
+    }
+
+    wxString firstError;
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        PCB_IO   plugin;
+        wxString error;
+
+        try
+        {
+            enumerate( plugin );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            error = ioe.What();
+        }
+
+        BOOST_TEST_CONTEXT( "Pass " << pass )
+        {
+            size_t pos = 0;
+
+            for( const wxString& name : badNames )
+            {
+                size_t next = error.find( footprintPath( name ), pos );
+
+                BOOST_CHECK_MESSAGE( next != wxString::npos,
+                                     "Error for " << name << " missing or out of order" );
+
+                if( next != wxString::npos )
+                    pos = next;
+            }
+
+            if( pass == 0 )
+                firstError = error;
+            else
+                BOOST_CHECK_EQUAL( error, firstError );
+
+            std::set<KIID> uuids;
+            size_t         count = 0;
+
+            for( const wxString& name : enumerate( plugin, true ) )
+            {
+                const FOOTPRINT* footprint = plugin.GetEnumeratedFootprint( m_libPath, name );
+
+                BOOST_REQUIRE( footprint );
+                BOOST_CHECK_EQUAL( footprint->GetDescription(), name );
+
+                uuids.insert( footprint->m_Uuid );
+                uuids.insert( footprint->Reference().m_Uuid );
+                uuids.insert( footprint->Value().m_Uuid );
+                count += 3;
+            }
+
+            BOOST_CHECK_EQUAL( count, 3 * ( 64 - badNames.size() ) );
+            BOOST_CHECK_EQUAL( uuids.size(), count );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
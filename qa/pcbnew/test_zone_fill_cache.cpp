@@ -0,0 +1,283 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_fill_cache.cpp
+ * Test the zone fill cache file saved alongside boards.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cstring>
+#include <string>
+
+#include <board.h>
+#include <zone.h>
+#include <zone_fill_cache.h>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+
+static const size_t INPUTS_HASH = 0x1234567;
+
+
+static SHAPE_LINE_CHAIN square( int aX, int aY, int aSize )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    chain.Append( aX, aY );
+    chain.Append( aX + aSize, aY );
+    chain.Append( aX + aSize, aY + aSize );
+    chain.Append( aX, aY + aSize );
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+struct ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_CACHE_FIXTURE() :
+            m_zone( &m_board )
+    {
+        m_fileName = wxFileName::CreateTempFileName( wxT( "qa_zone_fill_cache" ) );
+
+        m_zone.SetLayerSet( LSET( 2, F_Cu, B_Cu ) );
+
+        // A square with a hole on the front, two squares (one an island) on the back
+        m_frontFill.AddOutline( square( 0, 0, 1000000 ) );
+        m_frontFill.AddHole( square( 250000, 250000, 500000 ) );
+
+        m_backFill.AddOutline( square( 0, 0, 1000000 ) );
+        m_backFill.AddOutline( square( 2000000, 0, 300000 ) );
+
+        m_zone.SetFilledPolysList( F_Cu, m_frontFill );
+        m_zone.SetFilledPolysList( B_Cu, m_backFill );
+        m_zone.SetIsIsland( B_Cu, 1 );
+        m_zone.SetIsFilled( true );
+        m_zone.SetFillVersion( 6 );
+        m_zone.SetFillInputsHash( INPUTS_HASH );
+    }
+
+    ~ZONE_FILL_CACHE_FIXTURE()
+    {
+        wxRemoveFile( m_fileName );
+    }
+
+    /**
+     * Save a cache holding the fill of the zone.
+     */
+    void saveCache()
+    {
+        ZONE_FILL_CACHE cache;
+
+        cache.Store( &m_zone );
+        BOOST_REQUIRE( cache.Save( m_fileName ) );
+    }
+
+    std::string readFile() const
+    {
+        wxFFile file( m_fileName, wxT( "rb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+
+        std::string contents( file.Length(), '\0' );
+
+        BOOST_REQUIRE( file.Read( &contents[0], contents.size() ) == contents.size() );
+        return contents;
+    }
+
+    void writeFile( const std::string& aContents ) const
+    {
+        wxFFile file( m_fileName, wxT( "wb" ) );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aContents.data(), aContents.size() ) == aContents.size() );
+    }
+
+    static void checkSamePolys( const SHAPE_POLY_SET& aActual, const SHAPE_POLY_SET& aExpected )
+    {
+        BOOST_REQUIRE_EQUAL( aActual.OutlineCount(), aExpected.OutlineCount() );
+
+        for( int ii = 0; ii < aExpected.OutlineCount(); ++ii )
+        {
+            const SHAPE_POLY_SET::POLYGON& actual = aActual.CPolygon( ii );
+            const SHAPE_POLY_SET::POLYGON& expected = aExpected.CPolygon( ii );
+
+            BOOST_REQUIRE_EQUAL( actual.size(), expected.size() );
+
+            for( size_t jj = 0; jj < expected.size(); ++jj )
+            {
+                BOOST_REQUIRE_EQUAL( actual[jj].PointCount(), expected[jj].PointCount() );
+
+                for( int pt = 0; pt < expected[jj].PointCount(); ++pt )
+                    BOOST_CHECK_EQUAL( actual[jj].CPoint( pt ), expected[jj].CPoint( pt ) );
+            }
+        }
+    }
+
+    BOARD          m_board;
+    ZONE           m_zone;
+    SHAPE_POLY_SET m_frontFill;
+    SHAPE_POLY_SET m_backFill;
+    wxString       m_fileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCache, ZONE_FILL_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    saveCache();
+
+    ZONE_FILL_CACHE cache;
+
+    BOOST_REQUIRE( cache.Load( m_fileName ) );
+    BOOST_CHECK( !cache.IsEmpty() );
+
+    m_zone.UnFill();
+    m_zone.SetFillVersion( 5 );
+    m_zone.SetFillInputsHash( 0 );
+
+    BOOST_REQUIRE( cache.Restore( &m_zone, INPUTS_HASH ) );
+
+    BOOST_CHECK( m_zone.IsFilled() );
+    BOOST_CHECK_EQUAL( m_zone.GetFillVersion(), 6 );
+    BOOST_CHECK_EQUAL( m_zone.GetFillInputsHash(), INPUTS_HASH );
+
+    checkSamePolys( m_zone.GetFilledPolysList( F_Cu ), m_frontFill );
+    checkSamePolys( m_zone.GetFilledPolysList( B_Cu ), m_backFill );
+
+    BOOST_CHECK( !m_zone.IsIsland( F_Cu, 0 ) );
+    BOOST_CHECK( !m_zone.IsIsland( B_Cu, 0 ) );
+    BOOST_CHECK( m_zone.IsIsland( B_Cu, 1 ) );
+}
+
+
+/**
+ * A fill computed from other inputs is never restored, and leaves the zone alone.
+ */
+BOOST_AUTO_TEST_CASE( StaleHash )
+{
+    saveCache();
+
+    ZONE_FILL_CACHE cache;
+    SHAPE_POLY_SET  newFill;
+
+    newFill.AddOutline( square( 0, 0, 500000 ) );
+
+    BOOST_REQUIRE( cache.Load( m_fileName ) );
+
+    m_zone.SetFilledPolysList( F_Cu, newFill );
+
+    BOOST_CHECK( !cache.Restore( &m_zone, INPUTS_HASH + 1 ) );
+    BOOST_CHECK( !cache.Restore( &m_zone, 0 ) );
+
+    checkSamePolys( m_zone.GetFilledPolysList( F_Cu ), newFill );
+
+    // Nor is the fill of another zone
+    ZONE otherZone( &m_board );
+
+    otherZone.SetLayerSet( LSET( 2, F_Cu, B_Cu ) );
+    BOOST_CHECK( !cache.Restore( &otherZone, INPUTS_HASH ) );
+    BOOST_CHECK( !otherZone.IsFilled() );
+
+    // Nor a fill missing a layer of the zone
+    m_zone.SetLayerSet( LSET( 3, F_Cu, In1_Cu, B_Cu ) );
+    BOOST_CHECK( !cache.Restore( &m_zone, INPUTS_HASH ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    ZONE_FILL_CACHE cache;
+
+    BOOST_CHECK( !cache.Load( m_fileName + wxT( "x" ) ) );
+    BOOST_CHECK( cache.IsEmpty() );
+}
+
+
+/**
+ * Truncated anywhere, the file is rejected as a whole.
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    saveCache();
+
+    std::string contents = readFile();
+
+    for( size_t size : { (size_t) 0, (size_t) 10, contents.size() / 2, contents.size() - 1 } )
+    {
+        BOOST_TEST_CONTEXT( "Size " << size )
+        {
+            writeFile( contents.substr( 0, size ) );
+
+            ZONE_FILL_CACHE cache;
+
+            BOOST_CHECK( !cache.Load( m_fileName ) );
+            BOOST_CHECK( cache.IsEmpty() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( MismatchedVersion )
+{
+    saveCache();
+
+    std::string contents = readFile();
+
+    // The format version follows the magic, itself a uint32 length and the characters
+    size_t   versionOffset = sizeof( uint32_t ) + strlen( "KICAD_ZONE_FILL_CACHE" );
+    uint32_t version;
+
+    memcpy( &version, &contents[versionOffset], sizeof( version ) );
+    version++;
+    memcpy( &contents[versionOffset], &version, sizeof( version ) );
+    writeFile( contents );
+
+    ZONE_FILL_CACHE cache;
+
+    BOOST_CHECK( !cache.Load( m_fileName ) );
+    BOOST_CHECK( cache.IsEmpty() );
+
+    // Another build of KiCad may fill differently
+    contents = readFile();
+    version--;
+    memcpy( &contents[versionOffset], &version, sizeof( version ) );
+
+    size_t buildVersionOffset = versionOffset + sizeof( uint32_t ) + sizeof( uint32_t );
+
+    BOOST_REQUIRE( buildVersionOffset < contents.size() );
+    contents[buildVersionOffset] ^= 1;
+    writeFile( contents );
+
+    BOOST_CHECK( !cache.Load( m_fileName ) );
+    BOOST_CHECK( cache.IsEmpty() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_filler.cpp
+ * Test the hash of the board items zone fills depend on, which decides which zones are
+ * refilled after an edit.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <convert_basic_shapes_to_polygon.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_shape.h>
+#include <zone_filler.h>
+
+
+struct ZONE_FILLER_FIXTURE
+{
+    ZONE_FILLER_FIXTURE() :
+            m_footprint( &m_board )
+    {
+        m_pad = new PAD( &m_footprint );
+        m_pad->SetLayerSet( PAD::SMDMask() );
+        m_pad->SetAttribute( PAD_ATTRIB::SMD );
+        m_pad->SetSize( wxSize( 1000000, 1000000 ) );
+        m_footprint.Add( m_pad );
+    }
+
+    BOARD     m_board;
+    FOOTPRINT m_footprint;
+    PAD*      m_pad;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillDependencyHash, ZONE_FILLER_FIXTURE )
+
+
+/**
+ * Moving a vertex of a graphic polygon changes its hash, even when its bounding box, start
+ * and end stay the same.
+ */
+BOOST_AUTO_TEST_CASE( PolygonVertex )
+{
+    PCB_SHAPE shape( &m_board );
+
+    shape.SetShape( SHAPE_T::POLY );
+    shape.SetLayer( F_Cu );
+    shape.SetPolyPoints( { wxPoint( 0, 0 ), wxPoint( 1000000, 0 ), wxPoint( 1000000, 1000000 ),
+                           wxPoint( 500000, 500000 ), wxPoint( 0, 1000000 ) } );
+
+    size_t   hash = ZONE_FILLER::FillDependencyHash( &shape );
+    EDA_RECT bbox = shape.GetBoundingBox();
+
+    BOOST_CHECK_EQUAL( ZONE_FILLER::FillDependencyHash( &shape ), hash );
+
+    shape.GetPolyShape().Outline( 0 ).SetPoint( 3, VECTOR2I( 600000, 400000 ) );
+
+    BOOST_CHECK( shape.GetBoundingBox().GetOrigin() == bbox.GetOrigin() );
+    BOOST_CHECK( shape.GetBoundingBox().GetSize() == bbox.GetSize() );
+    BOOST_CHECK_NE( ZONE_FILLER::FillDependencyHash( &shape ), hash );
+}
+
+
+BOOST_AUTO_TEST_CASE( BezierControlPoint )
+{
+    PCB_SHAPE shape( &m_board );
+
+    shape.SetShape( SHAPE_T::BEZIER );
+    shape.SetLayer( F_Cu );
+    shape.SetStart( wxPoint( 0, 0 ) );
+    shape.SetEnd( wxPoint( 1000000, 0 ) );
+    shape.SetBezierC1( wxPoint( 200000, 500000 ) );
+    shape.SetBezierC2( wxPoint( 800000, 500000 ) );
+
+    size_t hash = ZONE_FILLER::FillDependencyHash( &shape );
+
+    shape.SetBezierC2( wxPoint( 800000, -500000 ) );
+    BOOST_CHECK_NE( ZONE_FILLER::FillDependencyHash( &shape ), hash );
+}
+
+
+/**
+ * Moving a vertex of a custom pad primitive changes the pad's hash.
+ */
+BOOST_AUTO_TEST_CASE( CustomPadPrimitive )
+{
+    m_pad->SetShape( PAD_SHAPE::CUSTOM );
+    m_pad->SetAnchorPadShape( PAD_SHAPE::CIRCLE );
+    m_pad->AddPrimitivePoly( { wxPoint( 0, 0 ), wxPoint( 2000000, 0 ),
+                               wxPoint( 2000000, 500000 ), wxPoint( 1000000, 250000 ) },
+                             0, true );
+    m_pad->AddPrimitiveSegment( wxPoint( 0, 0 ), wxPoint( 0, 2000000 ), 100000 );
+
+    size_t hash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    BOOST_CHECK_EQUAL( ZONE_FILLER::FillDependencyHash( m_pad ), hash );
+
+    std::shared_ptr<PCB_SHAPE> primitive = m_pad->GetPrimitives()[0];
+
+    primitive->GetPolyShape().Outline( 0 ).SetPoint( 3, VECTOR2I( 1000000, 300000 ) );
+
+    size_t movedVertexHash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    BOOST_CHECK_NE( movedVertexHash, hash );
+
+    m_pad->GetPrimitives()[1]->SetEnd( wxPoint( 100000, 2000000 ) );
+    BOOST_CHECK_NE( ZONE_FILLER::FillDependencyHash( m_pad ), movedVertexHash );
+}
+
+
+BOOST_AUTO_TEST_CASE( PadCorners )
+{
+    m_pad->SetShape( PAD_SHAPE::ROUNDRECT );
+    m_pad->SetRoundRectRadiusRatio( 0.25 );
+
+    size_t hash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    m_pad->SetRoundRectRadiusRatio( 0.1 );
+
+    size_t roundRectHash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    BOOST_CHECK_NE( roundRectHash, hash );
+
+    m_pad->SetShape( PAD_SHAPE::CHAMFERED_RECT );
+    m_pad->SetChamferRectRatio( 0.2 );
+    m_pad->SetChamferPositions( RECT_CHAMFER_TOP_LEFT );
+
+    size_t chamferHash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    m_pad->SetChamferPositions( RECT_CHAMFER_TOP_LEFT | RECT_CHAMFER_BOTTOM_RIGHT );
+
+    size_t moreChamfersHash = ZONE_FILLER::FillDependencyHash( m_pad );
+
+    BOOST_CHECK_NE( moreChamfersHash, chamferHash );
+
+    m_pad->SetChamferRectRatio( 0.3 );
+    BOOST_CHECK_NE( ZONE_FILLER::FillDependencyHash( m_pad ), moreChamfersHash );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()